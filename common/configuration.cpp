@@ -105,6 +105,7 @@ uint32_t Configuration::num_replicas() const { return config_.replicas_size(); }
 uint32_t Configuration::num_partitions() const { return config_.num_partitions(); }
 
 uint32_t Configuration::num_workers() const { return std::max(config_.num_workers(), 1U); }
+uint32_t Configuration::num_lock_manager_shards() const { return std::max(config_.num_lock_manager_shards(), 1U); }
 
 uint32_t Configuration::broker_ports(int i) const { return config_.broker_ports(i); }
 uint32_t Configuration::broker_ports_size() const { return config_.broker_ports_size(); }
@@ -201,6 +202,16 @@ int Configuration::recv_retries() const { return config_.recv_retries() == 0 ? 1
 
 internal::ExecutionType Configuration::execution_type() const { return config_.execution_type(); }
 
+internal::StorageType Configuration::storage_type() const { return config_.storage_type(); }
+
+bool Configuration::numa_dispatch() const { return config_.numa_dispatch(); }
+
+internal::DispatchPolicy Configuration::dispatch_policy() const { return config_.dispatch_policy(); }
+
+bool Configuration::work_stealing() const { return config_.work_stealing(); }
+
+bool Configuration::batch_remote_reads() const { return config_.batch_remote_reads(); }
+
 const vector<uint32_t> Configuration::replication_order() const { return replication_order_; }
 
 bool Configuration::synchronized_batching() const { return config_.synchronized_batching(); }
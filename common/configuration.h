@@ -33,6 +33,7 @@ class Configuration {
   uint32_t num_replicas() const;
   uint32_t num_partitions() const;
   uint32_t num_workers() const;
+  uint32_t num_lock_manager_shards() const;
   std::vector<MachineId> all_machine_ids() const;
   std::chrono::milliseconds mh_orderer_batch_duration() const;
   std::chrono::milliseconds forwarder_batch_duration() const;
@@ -60,6 +61,11 @@ class Configuration {
   bool return_dummy_txn() const;
   int recv_retries() const;
   internal::ExecutionType execution_type() const;
+  internal::StorageType storage_type() const;
+  bool numa_dispatch() const;
+  internal::DispatchPolicy dispatch_policy() const;
+  bool work_stealing() const;
+  bool batch_remote_reads() const;
   const std::vector<uint32_t> replication_order() const;
   bool synchronized_batching() const;
   uint32_t sample_rate() const;
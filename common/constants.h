@@ -28,6 +28,24 @@ const uint32_t kMaxNumMachines = 100;
 const uint32_t kPaxosDefaultLeaderPosition = 0;
 
 const size_t kLockTableSizeLimit = 1000000;
+// Number of idle lock table entries that a lock manager checks at every iteration of the
+// scheduler once it keeps more than kMaxIdleLockTableEntries of them
+const size_t kLockTableGCBatchSize = 16;
+const size_t kMaxIdleLockTableEntries = 100000;
+// Number of in-flight txns that a lock manager sizes its txn index for up front. Every shard of
+// the lock table tracks all txns, and the index doubles when it runs out of room
+const size_t kLockManagerInitialNumTxns = 16384;
+// Number of elements that each queue between the scheduler and a worker holds before the
+// sender has to keep the rest on its side
+const size_t kWorkerQueueCapacity = 8192;
+// With the key-affinity dispatch policies, a txn goes to the least loaded worker instead when the
+// worker of its key has this many more txns in flight
+const uint32_t kDispatchImbalanceThreshold = 16;
+// Number of records of the initial data that a loading thread buffers before bulk-loading them
+const size_t kBulkLoadChunkSize = 256 * 1024;
+// Number of groups that the buffer of a loading thread is split into. Threads bulk-load records of
+// different groups concurrently. Must be a power of 2 of at most 256
+const uint32_t kBulkLoadGroups = 64;
 
 /****************************
  *      Statistic Keys
@@ -37,6 +55,7 @@ const size_t kLockTableSizeLimit = 1000000;
 const char TXN_ID_COUNTER[] = "txn_id_counter";
 const char NUM_PENDING_RESPONSES[] = "num_pending_responses";
 const char NUM_PARTIALLY_FINISHED_TXNS[] = "num_partially_finished_txns";
+const char NUM_SNAPSHOT_READ_TXNS[] = "num_snapshot_read_txns";
 const char PENDING_RESPONSES[] = "pending_responses";
 const char PARTIALLY_FINISHED_TXNS[] = "partially_finished_txns";
 
@@ -57,9 +76,16 @@ const char ALL_TXNS[] = "all_txns";
 const char NUM_ALL_TXNS[] = "num_all_txns";
 const char NUM_LOCKED_KEYS[] = "num_locked_keys";
 const char LOCK_MANAGER_TYPE[] = "lock_manager_type";
+const char NUM_LOCK_MANAGER_SHARDS[] = "num_lock_manager_shards";
+const char WORKER_QUEUE_DEPTHS[] = "worker_queue_depths";
+const char NUM_REBALANCED_DISPATCHES[] = "num_rebalanced_dispatches";
+const char NUM_STOLEN_TXNS[] = "num_stolen_txns";
+const char NUM_REMOTE_READ_RESULTS[] = "num_remote_read_results";
+const char NUM_REMOTE_READ_MESSAGES[] = "num_remote_read_messages";
 const char NUM_TXNS_WAITING_FOR_LOCK[] = "num_txns_waiting_for_lock";
 const char NUM_WAITING_FOR_PER_TXN[] = "num_waiting_for_per_txn";
 const char LOCK_TABLE[] = "lock_table";
+const char LOCK_TABLE_SIZE[] = "lock_table_size";
 const char WAITED_BY_GRAPH[] = "waited_by_graph";
 const char TXN_ID[] = "id";
 const char TXN_DONE[] = "done";
@@ -69,5 +95,17 @@ const char TXN_NUM_DISPATCHES[] = "num_dispatches";
 const char TXN_EXPECTED_NUM_LO[] = "expected_num_lo";
 const char TXN_MULTI_HOME[] = "multi_home";
 const char TXN_MULTI_PARTITION[] = "multi_partition";
+const char STORAGE_NUM_NODES[] = "storage_num_nodes";
+const char STORAGE_BYTES[] = "storage_bytes";
+const char STORAGE_MAX_SEGMENT_BYTES[] = "storage_max_segment_bytes";
+const char STORAGE_NUM_REHASHES[] = "storage_num_rehashes";
+const char STORAGE_REHASH_NS[] = "storage_rehash_ns";
+const char STORAGE_NUM_LATCH_WAITS[] = "storage_num_latch_waits";
+const char STORAGE_LATCH_WAIT_NS[] = "storage_latch_wait_ns";
+const char STORAGE_NUM_READS[] = "storage_num_reads";
+const char STORAGE_NUM_WRITES[] = "storage_num_writes";
+const char STORAGE_READS_PER_SEC[] = "storage_reads_per_sec";
+const char STORAGE_WRITES_PER_SEC[] = "storage_writes_per_sec";
+const char STORAGE_SEGMENTS[] = "storage_segments";
 
 }  // namespace slog
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "common/numa.h"
+
+#include <dirent.h>
+#include <glog/logging.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "common/thread_utils.h"
+
+namespace slog {
+
+namespace {
+// From linux/mempolicy.h, which is not always installed
+constexpr int kMpolPreferred = 1;
+constexpr unsigned long kMpolFNode = 1 << 0;
+constexpr unsigned long kMpolFAddr = 1 << 1;
+}  // namespace
+
+NumaTopology NumaTopology::Detect(const std::string& sys_node_dir) {
+  std::vector<std::pair<int, std::vector<int>>> nodes;
+  if (auto dir = opendir(sys_node_dir.c_str()); dir != nullptr) {
+    while (auto entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+          !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        continue;
+      }
+      std::ifstream cpu_list_file(sys_node_dir + "/" + name + "/cpulist");
+      std::string cpu_list;
+      std::getline(cpu_list_file, cpu_list);
+      // Memory-only nodes have no CPU to run on
+      if (auto cpus = ParseCpuList(cpu_list); !cpus.empty()) {
+        nodes.emplace_back(std::stoi(name.substr(4)), std::move(cpus));
+      }
+    }
+    closedir(dir);
+  }
+  // readdir does not list the nodes in order
+  std::sort(nodes.begin(), nodes.end());
+  std::vector<std::vector<int>> cpus_of_node;
+  std::vector<int> kernel_nodes;
+  for (auto& [kernel_node, cpus] : nodes) {
+    kernel_nodes.push_back(kernel_node);
+    cpus_of_node.push_back(std::move(cpus));
+  }
+  if (cpus_of_node.empty()) {
+    std::vector<int> all_cpus(std::max(1U, std::thread::hardware_concurrency()));
+    for (size_t i = 0; i < all_cpus.size(); i++) {
+      all_cpus[i] = i;
+    }
+    cpus_of_node.push_back(std::move(all_cpus));
+    kernel_nodes.push_back(0);
+  }
+  NumaTopology topology(std::move(cpus_of_node));
+  topology.kernel_nodes_ = std::move(kernel_nodes);
+  return topology;
+}
+
+NumaTopology::NumaTopology(std::vector<std::vector<int>> cpus_of_node) : cpus_of_node_(std::move(cpus_of_node)) {
+  for (size_t node = 0; node < cpus_of_node_.size(); node++) {
+    kernel_nodes_.push_back(node);
+  }
+}
+
+int NumaTopology::NodeOfKernelNode(int kernel_node) const {
+  auto it = std::find(kernel_nodes_.begin(), kernel_nodes_.end(), kernel_node);
+  return it == kernel_nodes_.end() ? -1 : it - kernel_nodes_.begin();
+}
+
+int NumaTopology::NodeOfCpu(int cpu) const {
+  for (size_t node = 0; node < cpus_of_node_.size(); node++) {
+    if (std::find(cpus_of_node_[node].begin(), cpus_of_node_[node].end(), cpu) != cpus_of_node_[node].end()) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+int NumaTopology::CurrentNode() const {
+  if (num_nodes() == 1) {
+    return 0;
+  }
+  auto cpu = sched_getcpu();
+  return cpu < 0 ? 0 : NodeOfCpu(cpu);
+}
+
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < cpu_list.size() && !isspace(cpu_list[pos])) {
+    auto end = cpu_list.find(',', pos);
+    if (end == std::string::npos) {
+      end = cpu_list.size();
+    }
+    auto range = cpu_list.substr(pos, end - pos);
+    try {
+      auto dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; cpu++) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception&) {
+      return {};
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+bool PreferMemoryNode(int kernel_node) {
+  if (kernel_node < 0) {
+    LOG(WARNING) << "Cannot set preferred memory node to " << kernel_node;
+    return false;
+  }
+  // The mask has as many words as needed to hold the bit of the node
+  constexpr int kBitsPerWord = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> node_mask(kernel_node / kBitsPerWord + 1);
+  node_mask[kernel_node / kBitsPerWord] = 1UL << (kernel_node % kBitsPerWord);
+  // set_mempolicy only reads maxnode - 1 bits of the mask, so pass one more than its size so that
+  // a node on the last bit of the mask, such as node 63, is not dropped
+  auto max_node = node_mask.size() * kBitsPerWord + 1;
+  if (syscall(SYS_set_mempolicy, kMpolPreferred, node_mask.data(), max_node) != 0) {
+    LOG(WARNING) << "Cannot set preferred memory node to " << kernel_node << ": " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+int NodeOfAddress(const void* addr) {
+  int node = -1;
+  if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr, kMpolFNode | kMpolFAddr) != 0) {
+    return -1;
+  }
+  return node;
+}
+
+std::thread StartOnNode(const NumaTopology& topology, int node, std::function<void()> fn) {
+  if (topology.num_nodes() == 1) {
+    return std::thread(std::move(fn));
+  }
+  return std::thread([cpus = topology.cpus(node), kernel_node = topology.kernel_node(node), fn = std::move(fn)] {
+    PinToCpus(pthread_self(), cpus);
+    PreferMemoryNode(kernel_node);
+    fn();
+  });
+}
+
+}  // namespace slog
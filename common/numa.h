@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace slog {
+
+/**
+ * CPUs of each NUMA node of the machine. The topology is read from sysfs so that it does not
+ * depend on libnuma. Machines without NUMA, or without the sysfs entries, are seen as a single
+ * node holding all CPUs.
+ *
+ * Nodes without CPUs are left out, so the nodes are numbered from 0 without gaps. The number
+ * that the kernel gives to a node, which the memory policy syscalls use, is kept separately.
+ */
+class NumaTopology {
+ public:
+  static NumaTopology Detect(const std::string& sys_node_dir = "/sys/devices/system/node");
+
+  // The nodes are given the kernel node numbers 0, 1, ...
+  explicit NumaTopology(std::vector<std::vector<int>> cpus_of_node);
+
+  size_t num_nodes() const { return cpus_of_node_.size(); }
+  const std::vector<int>& cpus(int node) const { return cpus_of_node_[node]; }
+  int kernel_node(int node) const { return kernel_nodes_[node]; }
+  // Returns -1 if the kernel node has no CPU, or does not exist
+  int NodeOfKernelNode(int kernel_node) const;
+  // Returns 0 if cpu does not belong to any node
+  int NodeOfCpu(int cpu) const;
+  // Node of the CPU that the calling thread is running on
+  int CurrentNode() const;
+
+ private:
+  std::vector<std::vector<int>> cpus_of_node_;
+  std::vector<int> kernel_nodes_;
+};
+
+// Parses a CPU list in the sysfs format, e.g. "0-3,8,10-11". Returns an empty list on error
+std::vector<int> ParseCpuList(const std::string& cpu_list);
+
+/**
+ * Makes the calling thread prefer allocating new memory on the given kernel node, without libnuma.
+ * Memory is otherwise placed on the node of the thread that first touches it, so this only
+ * matters if the thread can run outside of the node. Returns false if the kernel refuses
+ */
+bool PreferMemoryNode(int kernel_node);
+
+// Kernel node of the memory page holding addr. Returns -1 if the page is not mapped or the kernel refuses
+int NodeOfAddress(const void* addr);
+
+/**
+ * Runs fn on a new thread pinned to node and preferring memory of node. Threads created by fn
+ * inherit both. The thread is not pinned if there is a single node
+ */
+std::thread StartOnNode(const NumaTopology& topology, int node, std::function<void()> fn);
+
+}  // namespace slog
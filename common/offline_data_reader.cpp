@@ -1,13 +1,122 @@
 #include "common/offline_data_reader.h"
 
+#include <fcntl.h>
 #include <glog/logging.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <thread>
 
 using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
 using google::protobuf::io::FileInputStream;
 
 namespace slog {
 
+namespace {
+
+// The headers are copied to and from the file as they are laid out in memory
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Chunked data files need a little-endian host");
+
+constexpr char kMagic[8] = {'S', 'L', 'O', 'G', 'D', 'A', 'T', 'A'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_chunks;
+  uint64_t num_datums;
+  uint64_t index_offset;
+};
+
+struct ChunkInfo {
+  uint64_t offset;
+  uint64_t size;
+  uint64_t num_datums;
+};
+
+// Returns false if the chunk does not contain exactly the datums that the index says it does
+bool ParseChunk(const char* data, const ChunkInfo& chunk, const std::function<void(const Datum&)>& fn) {
+  CodedInputStream input(reinterpret_cast<const uint8_t*>(data + chunk.offset), chunk.size);
+  Datum datum;
+  for (uint64_t i = 0; i < chunk.num_datums; i++) {
+    int sz;
+    if (!input.ReadVarintSizeAsInt(&sz)) {
+      return false;
+    }
+    auto limit = input.PushLimit(sz);
+    if (!datum.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
+      return false;
+    }
+    input.PopLimit(limit);
+    fn(datum);
+  }
+  return input.CurrentPosition() == static_cast<int>(chunk.size);
+}
+
+// Returns false if the file is malformed
+bool ReadChunkedData(const std::string& path, const char* data, uint64_t file_size, uint32_t num_threads,
+                     const std::function<void(const Datum&)>& fn) {
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  bool ok = header.version == kVersion && header.index_offset <= file_size &&
+            (file_size - header.index_offset) / sizeof(ChunkInfo) >= header.num_chunks;
+  std::vector<ChunkInfo> chunks;
+  if (ok) {
+    chunks.resize(header.num_chunks);
+    memcpy(chunks.data(), data + header.index_offset, chunks.size() * sizeof(ChunkInfo));
+    for (const auto& chunk : chunks) {
+      ok &= chunk.offset >= sizeof(Header) && chunk.offset <= header.index_offset &&
+            chunk.size <= header.index_offset - chunk.offset && chunk.size <= INT32_MAX;
+    }
+  }
+  if (!ok) {
+    LOG(ERROR) << "Malformed data file \"" << path << "\"";
+    return false;
+  }
+
+  num_threads = std::max(std::min<uint32_t>(num_threads, chunks.size()), 1U);
+  LOG(INFO) << "Loading " << header.num_datums << " datums in " << chunks.size() << " chunks from \"" << path
+            << "\" using " << num_threads << " threads";
+
+  // Threads grab the next unprocessed chunk so that they stay busy until the end
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<bool> malformed = false;
+  auto ReadFn = [&]() {
+    for (auto i = next_chunk++; i < chunks.size() && !malformed; i = next_chunk++) {
+      if (!ParseChunk(data, chunks[i], fn)) {
+        malformed = true;
+      }
+    }
+  };
+  if (num_threads == 1) {
+    ReadFn();
+  } else {
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(ReadFn);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  if (malformed) {
+    LOG(ERROR) << "Malformed data file \"" << path << "\"";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 OfflineDataReader::OfflineDataReader(int fd)
     : raw_input_(new FileInputStream(fd)), coded_input_(new CodedInputStream(raw_input_)) {
   if (!coded_input_->ReadVarint32(&num_datums_)) {
@@ -46,4 +155,104 @@ Datum OfflineDataReader::GetNextDatum() {
   return datum;
 }
 
-}  // namespace slog
\ No newline at end of file
+OfflineDataWriter::OfflineDataWriter(const std::string& path, uint64_t datums_per_chunk)
+    : file_(fopen(path.c_str(), "wb")), datums_per_chunk_(datums_per_chunk), offset_(0), num_datums_(0), ok_(true) {
+  if (file_ == nullptr) {
+    LOG(ERROR) << "Cannot open \"" << path << "\": " << strerror(errno);
+    ok_ = false;
+    return;
+  }
+  // The header is rewritten with the final counts in Finish
+  Header header{};
+  Append(&header, sizeof(header));
+}
+
+OfflineDataWriter::~OfflineDataWriter() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+void OfflineDataWriter::AddDatum(const Datum& datum) {
+  if (chunks_.empty() || chunks_.back().num_datums == datums_per_chunk_) {
+    chunks_.push_back({offset_, 0, 0});
+  }
+  datum.SerializeToString(&buf_);
+  // A varint32 takes at most 5 bytes
+  uint8_t size_buf[5];
+  auto size_end = CodedOutputStream::WriteVarint32ToArray(buf_.size(), size_buf);
+  size_t size_len = size_end - size_buf;
+  Append(size_buf, size_len);
+  Append(buf_.data(), buf_.size());
+  chunks_.back().size += size_len + buf_.size();
+  chunks_.back().num_datums++;
+  num_datums_++;
+}
+
+bool OfflineDataWriter::Finish() {
+  if (file_ == nullptr) {
+    return false;
+  }
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_chunks = chunks_.size();
+  header.num_datums = num_datums_;
+  header.index_offset = offset_;
+  Append(chunks_.data(), chunks_.size() * sizeof(ChunkInfo));
+  if (ok_ && (fseek(file_, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file_) != 1)) {
+    ok_ = false;
+  }
+  ok_ = fclose(file_) == 0 && ok_;
+  file_ = nullptr;
+  return ok_;
+}
+
+void OfflineDataWriter::Append(const void* data, size_t size) {
+  if (size > 0 && ok_ && fwrite(data, size, 1, file_) != 1) {
+    ok_ = false;
+  }
+  offset_ += size;
+}
+
+bool ReadOfflineData(const std::string& path, uint32_t num_threads, const std::function<void(const Datum&)>& fn) {
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open \"" << path << "\": " << strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG(ERROR) << "Cannot stat \"" << path << "\": " << strerror(errno);
+    close(fd);
+    return false;
+  }
+  uint64_t file_size = st.st_size;
+
+  char magic[sizeof(kMagic)];
+  bool chunked = file_size >= sizeof(Header) && pread(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+                 memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+  if (!chunked) {
+    // Fall back to the original format
+    OfflineDataReader reader(fd);
+    LOG(INFO) << "Loading " << reader.GetNumDatums() << " datums from \"" << path << "\"";
+    while (reader.HasNextDatum()) {
+      fn(reader.GetNextDatum());
+    }
+    close(fd);
+    return true;
+  }
+
+  auto mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG(ERROR) << "Cannot map \"" << path << "\": " << strerror(errno);
+    return false;
+  }
+  madvise(mapped, file_size, MADV_WILLNEED);
+  auto ok = ReadChunkedData(path, static_cast<const char*>(mapped), file_size, num_threads, fn);
+  munmap(mapped, file_size);
+  return ok;
+}
+
+}  // namespace slog
@@ -3,10 +3,19 @@
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "proto/offline_data.pb.h"
 
 namespace slog {
 
+/**
+ * Reads a data file in the original format: the number of datums as a varint followed by the
+ * datums, each prefixed by its size as a varint
+ */
 class OfflineDataReader {
  public:
   OfflineDataReader(int fd);
@@ -23,4 +32,52 @@ class OfflineDataReader {
   uint32_t num_read_datums_;
 };
 
-}  // namespace slog
\ No newline at end of file
+/**
+ * Writes a data file in the chunked format, which can be read by multiple threads at once.
+ *
+ * File layout (all integers are little-endian):
+ *   Header:  magic "SLOGDATA" (8 bytes), version (u32), number of chunks (u32), number of
+ *            datums (u64), offset of the chunk index (u64)
+ *   Chunks:  datums, each prefixed by its size as a varint
+ *   Index:   for each chunk, its offset (u64), size in bytes (u64) and number of datums (u64)
+ *
+ * The magic cannot be mistaken for the beginning of a file in the original format because the
+ * byte after it would have to start a datum but is not a valid protobuf tag.
+ */
+class OfflineDataWriter {
+ public:
+  OfflineDataWriter(const std::string& path, uint64_t datums_per_chunk = 64 * 1024);
+  ~OfflineDataWriter();
+
+  void AddDatum(const Datum& datum);
+  // Writes the chunk index and closes the file. Returns false if any write failed
+  bool Finish();
+
+ private:
+  struct ChunkInfo {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t num_datums;
+  };
+
+  void Append(const void* data, size_t size);
+
+  FILE* file_;
+  uint64_t datums_per_chunk_;
+  uint64_t offset_;
+  uint64_t num_datums_;
+  std::vector<ChunkInfo> chunks_;
+  std::string buf_;
+  bool ok_;
+};
+
+/**
+ * Calls fn on every datum of the data file at the given path. A file in the chunked format is
+ * memory-mapped and its chunks are parsed by num_threads threads, so fn may be called concurrently.
+ * A file in the original format is read sequentially by the calling thread. Returns false if the
+ * file cannot be opened or a file in the chunked format is malformed, in which case fn may have
+ * been called on part of the datums.
+ */
+bool ReadOfflineData(const std::string& path, uint32_t num_threads, const std::function<void(const Datum&)>& fn);
+
+}  // namespace slog
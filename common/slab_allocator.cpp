@@ -0,0 +1,285 @@
+#include "common/slab_allocator.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "common/spin_latch.h"
+
+namespace slog {
+
+namespace {
+
+constexpr size_t kMinClassShift = 4;
+constexpr size_t kNumClasses = 9;
+static_assert((SlabAllocator::kMinClassSize << (kNumClasses - 1)) == SlabAllocator::kMaxClassSize);
+// Max number of bytes of free blocks that a thread caches for each class
+constexpr size_t kMaxCachedBytes = 256 * 1024;
+// Number of blocks taken from the central free list at once
+constexpr size_t kRefillBatch = 32;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  void Push(FreeBlock* block) {
+    block->next = head;
+    head = block;
+    count++;
+  }
+
+  FreeBlock* Pop() {
+    auto block = head;
+    head = head->next;
+    count--;
+    return block;
+  }
+
+  // Detaches the first n blocks as a chain and returns the first and last block of the chain
+  std::pair<FreeBlock*, FreeBlock*> PopChain(size_t n) {
+    auto first = head;
+    auto last = head;
+    for (size_t i = 1; i < n; i++) {
+      last = last->next;
+    }
+    head = last->next;
+    last->next = nullptr;
+    count -= n;
+    return {first, last};
+  }
+
+  void PushChain(FreeBlock* first, FreeBlock* last, size_t n) {
+    last->next = head;
+    head = first;
+    count += n;
+  }
+
+  FreeBlock* head = nullptr;
+  size_t count = 0;
+};
+
+size_t ClassIndex(size_t capacity) { return __builtin_ctzll(capacity) - kMinClassShift; }
+
+size_t ClassSize(size_t index) { return SlabAllocator::kMinClassSize << index; }
+
+class ThreadCache;
+
+struct State {
+  struct alignas(64) CentralList {
+    SpinLatch latch;
+    FreeList list;
+  };
+  CentralList central[kNumClasses];
+
+  SpinLatch slabs_latch;
+  std::vector<char*> slabs;
+
+  // Caches of the live threads and the counters of the threads that are gone
+  SpinLatch caches_latch;
+  std::vector<ThreadCache*> caches;
+  uint64_t retired_slab_allocations = 0;
+  uint64_t retired_large_allocations = 0;
+};
+
+// The state is never destroyed so that it outlives all thread-local caches
+State& GlobalState() {
+  static auto state = new State();
+  return *state;
+}
+
+// Carves a new slab into blocks of the given class and adds them to the list
+void AllocateSlab(size_t index, FreeList& list) {
+  auto& state = GlobalState();
+  auto slab = static_cast<char*>(::operator new(SlabAllocator::kSlabSize));
+  {
+    std::lock_guard<SpinLatch> guard(state.slabs_latch);
+    state.slabs.push_back(slab);
+  }
+  auto class_size = ClassSize(index);
+  for (size_t offset = 0; offset + class_size <= SlabAllocator::kSlabSize; offset += class_size) {
+    list.Push(reinterpret_cast<FreeBlock*>(slab + offset));
+  }
+}
+
+// Set when the cache of the current thread is destroyed at thread exit. Buffers
+// freed after that point, e.g. by other thread-local objects, go to the central lists
+thread_local bool tls_cache_destroyed = false;
+
+class ThreadCache {
+ public:
+  ThreadCache() {
+    auto& state = GlobalState();
+    std::lock_guard<SpinLatch> guard(state.caches_latch);
+    state.caches.push_back(this);
+  }
+
+  ~ThreadCache() {
+    auto& state = GlobalState();
+    for (size_t i = 0; i < kNumClasses; i++) {
+      if (lists_[i].count > 0) {
+        ReleaseToCentral(i, lists_[i].count);
+      }
+    }
+    {
+      std::lock_guard<SpinLatch> guard(state.caches_latch);
+      state.retired_slab_allocations += slab_allocations_.load(std::memory_order_relaxed);
+      state.retired_large_allocations += large_allocations_.load(std::memory_order_relaxed);
+      for (auto it = state.caches.begin(); it != state.caches.end(); it++) {
+        if (*it == this) {
+          state.caches.erase(it);
+          break;
+        }
+      }
+    }
+    tls_cache_destroyed = true;
+  }
+
+  char* Allocate(size_t index) {
+    auto& list = lists_[index];
+    if (list.head == nullptr) {
+      Refill(index);
+    }
+    Increment(slab_allocations_);
+    return reinterpret_cast<char*>(list.Pop());
+  }
+
+  void Deallocate(char* buf, size_t index) {
+    auto& list = lists_[index];
+    list.Push(reinterpret_cast<FreeBlock*>(buf));
+    if (list.count * ClassSize(index) > kMaxCachedBytes) {
+      ReleaseToCentral(index, list.count / 2);
+    }
+  }
+
+  void CountLargeAllocation() { Increment(large_allocations_); }
+
+  uint64_t slab_allocations() const { return slab_allocations_.load(std::memory_order_relaxed); }
+  uint64_t large_allocations() const { return large_allocations_.load(std::memory_order_relaxed); }
+
+ private:
+  // Counters are only written by the owning thread but can be read by any thread
+  static void Increment(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void Refill(size_t index) {
+    auto& central = GlobalState().central[index];
+    {
+      std::lock_guard<SpinLatch> guard(central.latch);
+      auto n = std::min(kRefillBatch, central.list.count);
+      if (n > 0) {
+        auto [first, last] = central.list.PopChain(n);
+        lists_[index].PushChain(first, last, n);
+        return;
+      }
+    }
+    AllocateSlab(index, lists_[index]);
+  }
+
+  void ReleaseToCentral(size_t index, size_t n) {
+    auto [first, last] = lists_[index].PopChain(n);
+    auto& central = GlobalState().central[index];
+    std::lock_guard<SpinLatch> guard(central.latch);
+    central.list.PushChain(first, last, n);
+  }
+
+  FreeList lists_[kNumClasses];
+  std::atomic<uint64_t> slab_allocations_{0};
+  std::atomic<uint64_t> large_allocations_{0};
+};
+
+// Used by threads whose cache is already destroyed
+char* AllocateFromCentral(size_t index) {
+  auto& central = GlobalState().central[index];
+  {
+    std::lock_guard<SpinLatch> guard(central.latch);
+    if (central.list.count > 0) {
+      return reinterpret_cast<char*>(central.list.Pop());
+    }
+  }
+  FreeList list;
+  AllocateSlab(index, list);
+  auto buf = reinterpret_cast<char*>(list.Pop());
+  auto n = list.count;
+  auto [first, last] = list.PopChain(n);
+  std::lock_guard<SpinLatch> guard(central.latch);
+  central.list.PushChain(first, last, n);
+  return buf;
+}
+
+ThreadCache& LocalCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+}  // namespace
+
+size_t SlabAllocator::Capacity(size_t size) {
+  if (size <= kMinClassSize) {
+    return kMinClassSize;
+  }
+  if (size <= kMaxClassSize) {
+    return size_t{1} << (64 - __builtin_clzll(size - 1));
+  }
+  return size;
+}
+
+char* SlabAllocator::Allocate(size_t capacity) {
+  DCHECK_EQ(capacity, Capacity(capacity));
+  if (capacity > kMaxClassSize) {
+    if (!tls_cache_destroyed) {
+      LocalCache().CountLargeAllocation();
+    }
+    return static_cast<char*>(::operator new(capacity));
+  }
+  auto index = ClassIndex(capacity);
+  if (tls_cache_destroyed) {
+    return AllocateFromCentral(index);
+  }
+  return LocalCache().Allocate(index);
+}
+
+void SlabAllocator::Deallocate(char* buf, size_t capacity) {
+  if (buf == nullptr) {
+    return;
+  }
+  if (capacity > kMaxClassSize) {
+    ::operator delete(buf);
+    return;
+  }
+  auto index = ClassIndex(capacity);
+  if (tls_cache_destroyed) {
+    auto& central = GlobalState().central[index];
+    std::lock_guard<SpinLatch> guard(central.latch);
+    central.list.Push(reinterpret_cast<FreeBlock*>(buf));
+    return;
+  }
+  LocalCache().Deallocate(buf, index);
+}
+
+SlabAllocator::Stats SlabAllocator::GetStats() {
+  auto& state = GlobalState();
+  Stats stats;
+  {
+    std::lock_guard<SpinLatch> guard(state.caches_latch);
+    stats.slab_allocations = state.retired_slab_allocations;
+    stats.large_allocations = state.retired_large_allocations;
+    for (auto cache : state.caches) {
+      stats.slab_allocations += cache->slab_allocations();
+      stats.large_allocations += cache->large_allocations();
+    }
+  }
+  {
+    std::lock_guard<SpinLatch> guard(state.slabs_latch);
+    stats.slabs = state.slabs.size();
+  }
+  return stats;
+}
+
+}  // namespace slog
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace slog {
+
+/**
+ * Allocator for small variable-sized buffers such as record payloads.
+ *
+ * Requests are rounded up to a power-of-2 size class between kMinClassSize and kMaxClassSize.
+ * Blocks of each class are carved out of kSlabSize-byte slabs that are never returned to the
+ * system. Each thread keeps a cache of free blocks per class so allocation and deallocation
+ * normally do not synchronize with other threads. When a cache grows too large, half of it is
+ * moved to a central free list which is used to refill the caches of other threads.
+ *
+ * Requests larger than kMaxClassSize go directly to the system allocator.
+ */
+class SlabAllocator {
+ public:
+  static constexpr size_t kMinClassSize = 16;
+  static constexpr size_t kMaxClassSize = 4096;
+  static constexpr size_t kSlabSize = 64 * 1024;
+
+  struct Stats {
+    // Number of blocks handed out from the slabs
+    uint64_t slab_allocations = 0;
+    // Number of requests larger than kMaxClassSize
+    uint64_t large_allocations = 0;
+    // Number of slabs allocated from the system
+    uint64_t slabs = 0;
+
+    // Number of calls to the system allocator
+    uint64_t system_allocations() const { return large_allocations + slabs; }
+  };
+
+  /**
+   * Returns the actual number of bytes reserved for a request of the given size
+   */
+  static size_t Capacity(size_t size);
+
+  /**
+   * capacity must be a value returned by Capacity()
+   */
+  static char* Allocate(size_t capacity);
+
+  /**
+   * capacity must be the same value used to allocate the buffer. The buffer can be
+   * deallocated from a different thread than the one that allocated it.
+   */
+  static void Deallocate(char* buf, size_t capacity);
+
+  static Stats GetStats();
+};
+
+}  // namespace slog
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 
 // See https://rigtorp.se/spinlock/
 class SpinLatch {
@@ -20,3 +21,40 @@ class SpinLatch {
  private:
   std::atomic<bool> lock_ = {false};
 };
+
+/**
+ * A reader-writer variant of the spin latch above. It should only be used
+ * for very short critical sections.
+ */
+class RWSpinLatch {
+  static constexpr uint32_t kWriter = 1U << 31;
+
+ public:
+  void lock() {
+    // Announce the writer first so that new readers cannot starve it
+    for (;;) {
+      auto state = state_.load(std::memory_order_relaxed);
+      if ((state & kWriter) == 0 && state_.compare_exchange_weak(state, state | kWriter, std::memory_order_acquire)) {
+        break;
+      }
+    }
+    while (state_.load(std::memory_order_acquire) != kWriter)
+      ;
+  }
+
+  void unlock() { state_.store(0, std::memory_order_release); }
+
+  void lock_shared() {
+    for (;;) {
+      auto state = state_.load(std::memory_order_relaxed);
+      if ((state & kWriter) == 0 && state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+        break;
+      }
+    }
+  }
+
+  void unlock_shared() { state_.fetch_sub(1, std::memory_order_release); }
+
+ private:
+  std::atomic<uint32_t> state_ = {0};
+};
@@ -4,6 +4,7 @@
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 namespace slog {
 
@@ -19,4 +20,16 @@ inline void PinToCpu(pthread_t thread, int cpu) {
   }
 }
 
+inline void PinToCpus(pthread_t thread, const std::vector<int>& cpus) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (auto cpu : cpus) {
+    CPU_SET(cpu, &cpuset);
+  }
+  int rc = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+  if (rc != 0) {
+    LOG(ERROR) << "Failed to pin thread to " << cpus.size() << " CPUs. Error code: " << rc;
+  }
+}
+
 }  // namespace slog
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstring>
 #include <string>
 
+#include "common/slab_allocator.h"
 #include "proto/transaction.pb.h"
 
 namespace slog {
@@ -28,19 +30,36 @@ struct Metadata {
   uint32_t counter = 0;
 };
 
+/**
+ * Values of up to kInlineCapacity bytes are stored inside the record itself. Larger
+ * values are stored in a buffer from the SlabAllocator. The buffer is reused when a
+ * new value of the same size class is set.
+ */
 struct Record {
+  static constexpr size_t kInlineCapacity = 32;
+
   Record(const std::string& v, uint32_t m = 0, uint32_t c = 0) : metadata_(m, c) { SetValue(v); }
 
-  Record(const Record& other) {
-    SetValue(other.data_.get(), other.size_);
-    SetMetadata(other.metadata_);
-  }
+  Record(const Record& other) : metadata_(other.metadata_) { SetValue(other.data(), other.size_); }
+
+  Record(Record&& other) noexcept : metadata_(other.metadata_) { MoveFrom(other); }
+
+  ~Record() { Release(); }
 
   Record& operator=(const Record& other) {
-    Record tmp(other);
-    data_.swap(tmp.data_);
-    std::swap(size_, tmp.size_);
-    std::swap(metadata_, tmp.metadata_);
+    if (this != &other) {
+      SetValue(other.data(), other.size_);
+      metadata_ = other.metadata_;
+    }
+    return *this;
+  }
+
+  Record& operator=(Record&& other) noexcept {
+    if (this != &other) {
+      Release();
+      MoveFrom(other);
+      metadata_ = other.metadata_;
+    }
     return *this;
   }
 
@@ -49,30 +68,75 @@ struct Record {
   void SetValue(const std::string& v) { SetValue(v.data(), v.size()); }
 
   void SetValue(const char* data, size_t size) {
+    bool fits_inline = size <= kInlineCapacity;
+    auto capacity = fits_inline ? 0 : SlabAllocator::Capacity(size);
+    if (capacity != capacity_) {
+      // Release the old buffer only after copying in case data points into it
+      auto old_heap = capacity_ > 0 ? buf_.heap : nullptr;
+      auto old_capacity = capacity_;
+      if (fits_inline) {
+        memcpy(buf_.inline_, data, size);
+      } else {
+        auto heap = SlabAllocator::Allocate(capacity);
+        memcpy(heap, data, size);
+        buf_.heap = heap;
+      }
+      capacity_ = capacity;
+      SlabAllocator::Deallocate(old_heap, old_capacity);
+    } else if (fits_inline) {
+      memmove(buf_.inline_, data, size);
+    } else {
+      memmove(buf_.heap, data, size);
+    }
     size_ = size;
-    data_.reset(new char[size_]);
-    memcpy(data_.get(), data, size_);
   }
 
-  std::string to_string() const {
-    if (data_ == nullptr) {
-      return "";
-    }
-    return std::string(data_.get(), size_);
-  }
+  std::string to_string() const { return std::string(data(), size_); }
 
   Record() = default;
 
   const Metadata& metadata() const { return metadata_; }
-  char* data() { return data_.get(); }
-  size_t size() { return size_; }
+  char* data() { return capacity_ > 0 ? buf_.heap : buf_.inline_; }
+  const char* data() const { return capacity_ > 0 ? buf_.heap : buf_.inline_; }
+  size_t size() const { return size_; }
+  // Bytes taken from the slab allocator, 0 if the value is stored inline
+  size_t heap_bytes() const { return capacity_; }
 
  private:
+  void Release() {
+    if (capacity_ > 0) {
+      SlabAllocator::Deallocate(buf_.heap, capacity_);
+    }
+    capacity_ = 0;
+    size_ = 0;
+  }
+
+  // This record must not own a buffer
+  void MoveFrom(Record& other) {
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    if (capacity_ > 0) {
+      buf_.heap = other.buf_.heap;
+    } else {
+      memcpy(buf_.inline_, other.buf_.inline_, size_);
+    }
+    other.capacity_ = 0;
+    other.size_ = 0;
+  }
+
   Metadata metadata_;
-  std::unique_ptr<char[]> data_;
-  size_t size_ = 0;
+  uint32_t size_ = 0;
+  // Capacity of the buffer from the slab allocator, 0 if the value is stored inline
+  uint32_t capacity_ = 0;
+  union {
+    char inline_[kInlineCapacity];
+    char* heap;
+  } buf_{};
 };
 
+// Lets ConcurrentHashMap account for the values stored outside of the records
+inline size_t HeapBytes(const Record& record) { return record.heap_bytes(); }
+
 enum class LockMode { UNLOCKED, READ, WRITE };
 enum class AcquireLocksResult { ACQUIRED, WAITING, ABORT };
 
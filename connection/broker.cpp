@@ -90,6 +90,10 @@ class BrokerThread : public Module {
         ForwardMessage(chan_it->second.socket, chan_it->second.send_raw, move(msg));
       }
       entry.pending_msgs.clear();
+      for (auto& pending_env : entry.pending_envs) {
+        SendEnvelope(chan_it->second.socket, move(pending_env));
+      }
+      entry.pending_envs.clear();
     }
 
     if (recv_retries_ > 0) {
@@ -109,6 +113,12 @@ class BrokerThread : public Module {
 
     auto chan_id = tag_or_chan_id;
 
+    // The broker channels are not in the channel table. A message sent to one of them is for the broker itself
+    if (tag_or_chan_id >= kBrokerChannel && tag_or_chan_id < kMaxChannel) {
+      DemultiplexRemoteReadResults(msg);
+      return;
+    }
+
     // Check if this is a tag or a channel id.
     // This condition effectively allows sending messages to a worker only via redirection since
     // workers' channel ids are larger than kMaxChannel
@@ -129,6 +139,27 @@ class BrokerThread : public Module {
     ForwardMessage(chan_it->second.socket, chan_it->second.send_raw, move(msg));
   }
 
+  // Hands each result of a batch of remote read results to the channel that its txn is redirected to
+  void DemultiplexRemoteReadResults(const zmq::message_t& msg) {
+    auto env = DeserializeEnvelope(msg);
+    if (env == nullptr || !env->has_request() || !env->request().has_remote_read_results()) {
+      LOG(ERROR) << "Invalid message for broker. Dropping message";
+      return;
+    }
+    for (auto& result : *env->mutable_request()->mutable_remote_read_results()->mutable_results()) {
+      auto result_env = std::make_unique<Envelope>();
+      result_env->set_from(env->from());
+      auto& entry = redirect_[result.txn_id()];
+      result_env->mutable_request()->mutable_remote_read_result()->Swap(&result);
+      if (!entry.to.has_value()) {
+        entry.pending_envs.push_back(move(result_env));
+        continue;
+      }
+      // A channel that receives raw messages also takes deserialized ones
+      SendEnvelope(channels_.at(entry.to.value()).socket, move(result_env));
+    }
+  }
+
   void ForwardMessage(zmq::socket_t& socket, bool send_raw, zmq::message_t&& msg) {
     MachineId machine_id = -1;
     ParseMachineId(machine_id, msg);
@@ -167,6 +198,8 @@ class BrokerThread : public Module {
   struct RedirectEntry {
     std::optional<Channel> to;
     vector<zmq::message_t> pending_msgs;
+    // Demultiplexed from batches of remote read results
+    vector<EnvelopePtr> pending_envs;
   };
   unordered_map<uint64_t, RedirectEntry> redirect_;
 };
@@ -55,6 +55,12 @@ class Broker {
 
   static Channel MakeChannel(int broker_num) { return kBrokerChannel + broker_num; }
 
+  // The last broker keeps the redirections of tags, so every message sent to a tag must reach it
+  static int RedirectionBrokerNum(const ConfigurationPtr& config) { return config->broker_ports_size() - 1; }
+  static Channel RedirectionChannel(const ConfigurationPtr& config) {
+    return MakeChannel(RedirectionBrokerNum(config));
+  }
+
   void StartInNewThreads();
   void Stop();
 
@@ -1,5 +1,7 @@
 #include "connection/poller.h"
 
+#include <unistd.h>
+
 using namespace std::chrono;
 
 using std::optional;
@@ -16,6 +18,14 @@ void Poller::PushSocket(zmq::socket_t& socket) {
   });
 }
 
+void Poller::PushEventFd(int fd) {
+  event_fd_items_.push_back(poll_items_.size());
+  poll_items_.push_back({
+      nullptr, fd, /* socket */
+      ZMQ_POLLIN, 0 /* revent */
+  });
+}
+
 bool Poller::NextEvent(bool dont_wait) {
   auto may_have_msg = true;
   if (!dont_wait) {
@@ -43,6 +53,14 @@ bool Poller::NextEvent(bool dont_wait) {
       rc = zmq::poll(poll_items_, -1);
     }
     may_have_msg = rc > 0;
+
+    for (auto i : event_fd_items_) {
+      if (poll_items_[i].revents & ZMQ_POLLIN) {
+        uint64_t count;
+        // The eventfd is non-blocking, and a failed read only means that it was already reset
+        [[maybe_unused]] auto n = read(poll_items_[i].fd, &count, sizeof(count));
+      }
+    }
   }
 
   // Process and clean up triggered callbacks
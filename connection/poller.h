@@ -18,6 +18,10 @@ class Poller {
 
   void PushSocket(zmq::socket_t& socket);
 
+  // Polls an eventfd along with the sockets. The eventfd is reset every time it is found
+  // readable, so the caller only has to look for the events that it signals afterwards
+  void PushEventFd(int fd);
+
   bool is_socket_ready(size_t i) const;
 
   void AddTimedCallback(std::chrono::microseconds timeout, std::function<void()>&& cb);
@@ -32,6 +36,8 @@ class Poller {
 
   std::optional<std::chrono::microseconds> poll_timeout_;
   std::vector<zmq::pollitem_t> poll_items_;
+  // Positions of the eventfds in poll_items_
+  std::vector<size_t> event_fd_items_;
   std::list<TimedCallback> timed_callbacks_;
 };
 
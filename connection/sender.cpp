@@ -66,7 +66,9 @@ void Sender::Send(EnvelopePtr&& envelope, const std::vector<MachineId>& to_machi
 Sender::SocketPtr& Sender::GetRemoteSocket(MachineId machine_id, Channel channel) {
   uint32_t port;
   if (channel >= kMaxChannel) {
-    port = config_->broker_ports(config_->broker_ports_size() - 1);
+    port = config_->broker_ports(Broker::RedirectionBrokerNum(config_));
+  } else if (channel >= kBrokerChannel) {
+    port = config_->broker_ports(channel - kBrokerChannel);
   } else {
     switch (channel) {
       case kForwarderChannel:
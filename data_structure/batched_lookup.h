@@ -0,0 +1,50 @@
+/**
+ * batched_lookup.h
+ *
+ * Helpers for looking up many keys at once in the sharded hash maps. The keys are hashed
+ * once and grouped by segment so that each segment only needs to be entered once per batch.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace slog {
+
+template <typename KeyType>
+struct BatchedLookupKey {
+  const KeyType* key;
+  size_t hash;
+  // Position of the key in the original batch
+  size_t index;
+};
+
+/**
+ * Hashes the keys and calls fn(segment, lookup_keys, n) for each group of keys falling into the
+ * same segment. The segment of a key is given by the lowest ShardBits bits of its hash.
+ */
+template <typename KeyType, typename HashFn, uint8_t ShardBits, typename Fn>
+void ForEachSegmentInBatch(const std::vector<const KeyType*>& keys, Fn&& fn) {
+  constexpr uint64_t kShardMask = (1ULL << ShardBits) - 1;
+  std::vector<BatchedLookupKey<KeyType>> lookup_keys;
+  lookup_keys.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    lookup_keys.push_back({keys[i], HashFn{}(*keys[i]), i});
+  }
+  std::sort(lookup_keys.begin(), lookup_keys.end(),
+            [](const auto& a, const auto& b) { return (a.hash & kShardMask) < (b.hash & kShardMask); });
+
+  size_t start = 0;
+  while (start < lookup_keys.size()) {
+    auto segment = lookup_keys[start].hash & kShardMask;
+    auto end = start + 1;
+    while (end < lookup_keys.size() && (lookup_keys[end].hash & kShardMask) == segment) {
+      end++;
+    }
+    fn(segment, lookup_keys.data() + start, end - start);
+    start = end;
+  }
+}
+
+}  // namespace slog
@@ -0,0 +1,74 @@
+/**
+ * bulk_insert.h
+ *
+ * Helpers for filling the sharded hash maps with many entries at once while nothing else
+ * accesses them. The entries are hashed once and grouped by segment, then the segments are
+ * filled in parallel with each segment owned by a single thread, so no latch is needed.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace slog {
+
+struct BulkInsertEntry {
+  size_t hash;
+  // Position of the entry in the original batch
+  size_t index;
+};
+
+/**
+ * Hashes the keys of the entries and calls fn(segment, bulk_entries, n) for each group of entries
+ * falling into the same segment, using num_threads threads. Each segment is passed to exactly one
+ * call and entries of a segment keep their relative order in the batch.
+ */
+template <typename KeyType, typename ValueType, typename HashFn, uint8_t ShardBits, typename Fn>
+void ForEachSegmentInParallel(const std::vector<std::pair<KeyType, ValueType>>& entries, uint32_t num_threads,
+                              Fn&& fn) {
+  constexpr uint64_t kNumShards = 1ULL << ShardBits;
+  constexpr uint64_t kShardMask = kNumShards - 1;
+
+  // Counting sort by segment, which is stable
+  std::vector<size_t> hashes(entries.size());
+  std::vector<size_t> offsets(kNumShards + 1, 0);
+  for (size_t i = 0; i < entries.size(); i++) {
+    hashes[i] = HashFn{}(entries[i].first);
+    offsets[(hashes[i] & kShardMask) + 1]++;
+  }
+  for (uint64_t s = 0; s < kNumShards; s++) {
+    offsets[s + 1] += offsets[s];
+  }
+  std::vector<BulkInsertEntry> bulk_entries(entries.size());
+  auto next = offsets;
+  for (size_t i = 0; i < entries.size(); i++) {
+    bulk_entries[next[hashes[i] & kShardMask]++] = {hashes[i], i};
+  }
+
+  std::atomic<uint64_t> next_segment = 0;
+  auto InsertFn = [&]() {
+    for (auto s = next_segment++; s < kNumShards; s = next_segment++) {
+      if (offsets[s + 1] > offsets[s]) {
+        fn(s, bulk_entries.data() + offsets[s], offsets[s + 1] - offsets[s]);
+      }
+    }
+  };
+  num_threads = std::max(std::min<uint32_t>(num_threads, kNumShards), 1U);
+  if (num_threads == 1) {
+    InsertFn();
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(InsertFn);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+}  // namespace slog
@@ -2,8 +2,21 @@
  * concurrent_hash_map.h
  *
  * This implementation borrows from folly::ConcurrentHashMap the idea of sharding key space
- * into different segments. However, each segment here is only coarsely guarded with a read-write
- * latch as opposed to a more granular approach in the highly-optimized folly::ConcurrentHashMap.
+ * into different segments. Writers of a segment are serialized with a mutex while readers do
+ * not take any latch. Each bucket is a linked list of immutable nodes that writers modify in
+ * the same way as an RCU list: a new node is fully built before it is published and a replaced
+ * or erased node is unlinked but never modified afterwards, so a reader walking a bucket always
+ * sees a well-formed chain. Unlinked nodes are freed with epoch-based reclamation once no reader
+ * can be holding a pointer to them.
+ *
+ * Rehashing is the only operation that relinks existing nodes. It is guarded by a per-segment
+ * sequence number (seqlock): a reader that does not find its key re-checks the sequence number
+ * and retries if a rehash happened in the meantime.
+ *
+ * Each segment keeps statistics about its footprint, rehashes and latch contention. They are
+ * only updated by the latch holder, and the latch wait is only timed when the latch is taken,
+ * so they cost nothing on the uncontended read and write paths. Reads and writes are counted
+ * per map in sharded counters.
  *
  * This map should be used in conjuction with shared_ptr because its destructor is not
  * thread-safe. With shared_ptr, the last thread that releases the pointer will be the only
@@ -11,10 +24,22 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
-
-#include "data_structure/rwlatch.h"
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "data_structure/batched_lookup.h"
+#include "data_structure/bulk_insert.h"
+#include "data_structure/epoch.h"
+#include "data_structure/sharded_counter.h"
+#include "storage/storage_stats.h"
 
 namespace slog {
 
@@ -22,193 +47,414 @@ namespace concurrent_hash_map {
 
 template <typename KeyType, typename ValueType>
 struct NodeT {
-  NodeT() = default;
-
-  NodeT(const NodeT& other) {
-    next = other.next;
-    key = other.key;
-    value = other.value;
-  }
+  NodeT(const KeyType& key, const ValueType& value) : key(key), value(value) {}
+  NodeT(KeyType&& key, ValueType&& value) : key(std::move(key)), value(std::move(value)) {}
 
-  NodeT* next{nullptr};
+  std::atomic<NodeT*> next{nullptr};
+  // Key and value must not be modified once the node is reachable by readers
   KeyType key;
   ValueType value;
 };
 
+/**
+ * Memory owned by a key or a value outside of its node, used to account for the footprint of
+ * a segment. Types owning memory can overload this in their own namespace
+ */
+template <typename T>
+size_t HeapBytes(const T&) {
+  return 0;
+}
+
+inline size_t HeapBytes(const std::string& str) {
+  // Short strings are stored inside the string object itself
+  auto data = str.data();
+  auto object = reinterpret_cast<const char*>(&str);
+  return data >= object && data < object + sizeof(str) ? 0 : str.capacity() + 1;
+}
+
 template <typename KeyType, typename ValueType, typename HashFn = std::hash<KeyType>, uint8_t ShardBits = 8>
 class SegmentT {
   using Node = NodeT<KeyType, ValueType>;
 
   static constexpr float kLoadFactor = 1.05;
+  // Number of keys whose buckets are prefetched together in MultiVisit
+  static constexpr size_t kPrefetchBatch = 16;
 
  public:
   /**
    * initial_bucket_count must be a power of 2
    */
   SegmentT(size_t initial_bucket_count = 8)
-      : load_factor_max_size_(static_cast<size_t>(kLoadFactor * initial_bucket_count)), size_(0) {
-    buckets_.reset(Buckets::CreateBuckets(initial_bucket_count));
+      : load_factor_max_size_(static_cast<size_t>(kLoadFactor * initial_bucket_count)) {
+    buckets_.store(Buckets::CreateBuckets(initial_bucket_count));
+    num_buckets_.store(initial_bucket_count, std::memory_order_relaxed);
   }
 
+  ~SegmentT() { delete buckets_.load(); }
+
   bool Get(ValueType& res, const KeyType& key) const {
+    return Visit(key, [&res](const ValueType& value) { res = value; });
+  }
+
+  /**
+   * Calls fn on the value of the given key without copying it out of the map.
+   * The reference passed to fn is only valid during the call.
+   */
+  template <typename Fn>
+  bool Visit(const KeyType& key, Fn&& fn) const {
     auto h = HashFn{}(key);
-    bool found = false;
 
-    rw_latch_.RLock();
+    epoch::Guard guard;
 
-    auto idx = GetIndex(buckets_->count, h);
-    auto node = buckets_->bucket_roots[idx];
-    while (node) {
-      if (key == node->key) {
-        break;
+    for (;;) {
+      auto version = BeginRead();
+      auto buckets = buckets_.load(std::memory_order_acquire);
+      auto idx = GetIndex(buckets->count, h);
+      auto node = buckets->bucket_roots[idx].load(std::memory_order_acquire);
+      while (node) {
+        if (key == node->key) {
+          // A node is never modified after being published so it is safe to read it
+          // even if a writer has just unlinked it
+          fn(node->value);
+          return true;
+        }
+        node = node->next.load(std::memory_order_acquire);
+      }
+      // The key might have been missed if a rehash moved the nodes around
+      if (ValidateRead(version)) {
+        return false;
       }
-      node = node->next;
-    }
-    if (node) {
-      res = node->value;
-      found = true;
     }
+  }
 
-    rw_latch_.RUnlock();
+  /**
+   * Looks up n keys of this segment at once. For each batch of keys, the bucket roots are
+   * prefetched first, then the first nodes of the chains, before any chain is walked so that
+   * the cache misses of different keys overlap. fn(index, value) is called for the found keys.
+   * Must be called under an epoch guard.
+   */
+  template <typename Fn>
+  void MultiVisit(const BatchedLookupKey<KeyType>* lookup_keys, size_t n, Fn& fn) const {
+    auto version = BeginRead();
+    auto buckets = buckets_.load(std::memory_order_acquire);
+    std::vector<const BatchedLookupKey<KeyType>*> missed;
+
+    for (size_t start = 0; start < n; start += kPrefetchBatch) {
+      auto end = std::min(n, start + kPrefetchBatch);
+      const Node* nodes[kPrefetchBatch];
+      for (auto i = start; i < end; i++) {
+        __builtin_prefetch(&buckets->bucket_roots[GetIndex(buckets->count, lookup_keys[i].hash)]);
+      }
+      for (auto i = start; i < end; i++) {
+        auto idx = GetIndex(buckets->count, lookup_keys[i].hash);
+        auto node = buckets->bucket_roots[idx].load(std::memory_order_acquire);
+        if (node) {
+          __builtin_prefetch(node);
+        }
+        nodes[i - start] = node;
+      }
+      for (auto i = start; i < end; i++) {
+        auto node = nodes[i - start];
+        while (node && !(*lookup_keys[i].key == node->key)) {
+          node = node->next.load(std::memory_order_acquire);
+        }
+        if (node) {
+          fn(lookup_keys[i].index, node->value);
+        } else {
+          missed.push_back(&lookup_keys[i]);
+        }
+      }
+    }
 
-    return found;
+    // The missed keys might have been moved by a concurrent rehash so look them up again
+    if (!missed.empty() && !ValidateRead(version)) {
+      for (auto lookup_key : missed) {
+        Visit(*lookup_key->key, [&fn, lookup_key](const ValueType& value) { fn(lookup_key->index, value); });
+      }
+    }
   }
 
+  /**
+   * Not thread-safe. The returned pointer is invalidated by any subsequent write to the map
+   */
   ValueType* GetUnsafe(const KeyType& key) {
     auto h = HashFn{}(key);
-    auto idx = GetIndex(buckets_->count, h);
-    auto node = buckets_->bucket_roots[idx];
+    auto buckets = buckets_.load(std::memory_order_relaxed);
+    auto idx = GetIndex(buckets->count, h);
+    auto node = buckets->bucket_roots[idx].load(std::memory_order_relaxed);
     while (node) {
       if (key == node->key) {
         return &node->value;
       }
-      node = node->next;
+      node = node->next.load(std::memory_order_relaxed);
     }
     return nullptr;
   }
 
   bool InsertOrUpdate(const KeyType& key, const ValueType& value) {
     auto h = HashFn{}(key);
+    // Build the node outside of the critical section
+    auto new_node = new Node(key, value);
 
-    rw_latch_.WLock();
+    auto guard = LockForWrite();
 
-    auto idx = GetIndex(buckets_->count, h);
-    Node* prev = nullptr;
-    bool key_exists = false;
-    auto node = buckets_->bucket_roots[idx];
-    while (node) {
-      if (key == node->key) {
-        key_exists = true;
-        // If key already exists, replace the corresponding
-        // node with a new node containing the new value
-        auto new_node = new Node();
-        new_node->key = key;
-        new_node->value = value;
-        new_node->next = node->next;
-        if (prev) {
-          prev->next = new_node;
-        } else {
-          buckets_->bucket_roots[idx] = new_node;
-        }
-        delete node;
+    return Upsert(new_node, h);
+  }
 
-        break;
-      }
-      prev = node;
-      node = node->next;
-    }
+  /**
+   * Calls fn on a pointer to the current value of key, or nullptr if key does not exist, then
+   * replaces the value with the one returned by fn. If fn returns an empty optional, key is
+   * erased instead. The whole operation is atomic with respect to other writers of the segment.
+   * Returns true if key existed
+   */
+  template <typename Fn>
+  bool Compute(const KeyType& key, Fn&& fn) {
+    auto h = HashFn{}(key);
+
+    auto guard = LockForWrite();
 
-    if (!key_exists) {
-      // If key does not exist, at new node to the bucket
-      auto new_node = new Node();
-      new_node->key = key;
-      new_node->value = value;
-      new_node->next = buckets_->bucket_roots[idx];
-      buckets_->bucket_roots[idx] = new_node;
-      size_++;
+    auto buckets = buckets_.load(std::memory_order_relaxed);
+    auto idx = GetIndex(buckets->count, h);
+    auto link = &buckets->bucket_roots[idx];
+    auto node = link->load(std::memory_order_relaxed);
+    while (node && !(key == node->key)) {
+      link = &node->next;
+      node = link->load(std::memory_order_relaxed);
     }
 
-    if (size_ >= load_factor_max_size_) {
-      Rehash();
+    std::optional<ValueType> new_value = fn(node ? &node->value : nullptr);
+    if (new_value.has_value()) {
+      Upsert(new Node(KeyType(key), std::move(*new_value)), h);
+    } else if (node) {
+      link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+      Unlinked(node);
     }
+    return node != nullptr;
+  }
+
+  /**
+   * Grows the segment so that it can hold num_entries entries without rehashing
+   */
+  void Reserve(size_t num_entries) {
+    auto guard = LockForWrite();
+    Grow(num_entries);
+  }
 
-    rw_latch_.WUnlock();
+  /**
+   * Moves entries[bulk_entries[i].index] for i in [0, n) into the segment without taking the
+   * latch. There must not be any concurrent reader or writer of the segment
+   */
+  void BulkInsert(std::vector<std::pair<KeyType, ValueType>>& entries, const BulkInsertEntry* bulk_entries, size_t n) {
+    Grow(size_.load(std::memory_order_relaxed) + n);
+    for (size_t i = 0; i < n; i++) {
+      auto& entry = entries[bulk_entries[i].index];
+      Upsert(new Node(std::move(entry.first), std::move(entry.second)), bulk_entries[i].hash);
+    }
+  }
 
-    return key_exists;
+  /**
+   * Calls fn(key, value) on every entry. Writers of the segment are blocked during the call
+   */
+  template <typename Fn>
+  void ForEach(Fn& fn) const {
+    auto guard = LockForWrite();
+    auto buckets = buckets_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < buckets->count; i++) {
+      auto node = buckets->bucket_roots[i].load(std::memory_order_relaxed);
+      while (node) {
+        fn(node->key, node->value);
+        node = node->next.load(std::memory_order_relaxed);
+      }
+    }
   }
 
   bool Erase(const KeyType& key) {
     auto h = HashFn{}(key);
 
-    rw_latch_.WLock();
+    auto guard = LockForWrite();
 
-    bool key_exists = false;
-    auto idx = GetIndex(buckets_->count, h);
-    Node* prev = nullptr;
-    auto node = buckets_->bucket_roots[idx];
+    auto buckets = buckets_.load(std::memory_order_relaxed);
+    auto idx = GetIndex(buckets->count, h);
+    auto link = &buckets->bucket_roots[idx];
+    auto node = link->load(std::memory_order_relaxed);
     while (node) {
       if (key == node->key) {
-        key_exists = true;
-        if (prev) {
-          prev->next = node->next;
-        } else {
-          buckets_->bucket_roots[idx] = node->next;
-        }
-        delete node;
-        break;
+        // The erased node keeps its next pointer so that readers currently on it can move on
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        Unlinked(node);
+        return true;
       }
-      prev = node;
-      node = node->next;
+      link = &node->next;
+      node = link->load(std::memory_order_relaxed);
     }
 
-    rw_latch_.WUnlock();
+    return false;
+  }
 
-    return key_exists;
+  /**
+   * Can be called concurrently with any operation. The counters are read one by one so
+   * they may not be consistent with each other
+   */
+  SegmentStats GetStats() const {
+    SegmentStats stats;
+    stats.num_nodes = size_.load(std::memory_order_relaxed);
+    stats.num_buckets = num_buckets_.load(std::memory_order_relaxed);
+    stats.bytes = sizeof(*this) + stats.num_buckets * sizeof(std::atomic<Node*>) +
+                  node_bytes_.load(std::memory_order_relaxed);
+    stats.num_rehashes = num_rehashes_.load(std::memory_order_relaxed);
+    stats.rehash_ns = rehash_ns_.load(std::memory_order_relaxed);
+    stats.num_latch_waits = num_latch_waits_.load(std::memory_order_relaxed);
+    stats.latch_wait_ns = latch_wait_ns_.load(std::memory_order_relaxed);
+    return stats;
   }
 
  private:
-  // Must hold lock
+  // Only the latch holder updates the counters so they do not need atomic read-modify-writes
+  static void Increase(std::atomic<uint64_t>& counter, int64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+  static int64_t NodeBytes(const Node* node) {
+    return sizeof(Node) + HeapBytes(node->key) + HeapBytes(node->value);
+  }
+
+  // The wait is only timed if the latch is already taken, which keeps the clock off the uncontended path
+  std::unique_lock<std::mutex> LockForWrite() const {
+    std::unique_lock<std::mutex> lock(write_mut_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      auto start = std::chrono::steady_clock::now();
+      lock.lock();
+      auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      Increase(num_latch_waits_, 1);
+      Increase(latch_wait_ns_, wait.count());
+    }
+    return lock;
+  }
+
+  // Must hold lock or have exclusive access to the segment. Called once node is unlinked from its bucket
+  void Unlinked(Node* node) {
+    Increase(size_, -1);
+    Increase(node_bytes_, -NodeBytes(node));
+    retired_.Retire(node);
+  }
+
   static uint64_t GetIndex(size_t nbuckets, size_t hash) { return (hash >> ShardBits) & (nbuckets - 1); }
 
-  // Must hold lock
-  void Rehash() {
-    auto new_bucket_count = buckets_->count << 1;
-    auto new_buckets = Buckets::CreateBuckets(new_bucket_count);
+  // Must hold lock or have exclusive access to the segment. Returns true if the key already exists
+  bool Upsert(Node* new_node, size_t h) {
+    const auto& key = new_node->key;
+    auto buckets = buckets_.load(std::memory_order_relaxed);
+    auto idx = GetIndex(buckets->count, h);
+    auto link = &buckets->bucket_roots[idx];
+    auto node = link->load(std::memory_order_relaxed);
+    while (node) {
+      if (key == node->key) {
+        // If key already exists, replace the corresponding
+        // node with the new node containing the new value
+        new_node->next.store(node->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(new_node, std::memory_order_release);
+        Increase(node_bytes_, NodeBytes(new_node) - NodeBytes(node));
+        retired_.Retire(node);
+        return true;
+      }
+      link = &node->next;
+      node = link->load(std::memory_order_relaxed);
+    }
+
+    // If key does not exist, add the new node to the bucket
+    auto& root = buckets->bucket_roots[idx];
+    new_node->next.store(root.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    root.store(new_node, std::memory_order_release);
+    Increase(size_, 1);
+    Increase(node_bytes_, NodeBytes(new_node));
+
+    if (size_.load(std::memory_order_relaxed) >= load_factor_max_size_) {
+      Rehash(buckets->count << 1);
+    }
+
+    return false;
+  }
+
+  // Must hold lock or have exclusive access to the segment
+  void Grow(size_t num_entries) {
+    auto bucket_count = buckets_.load(std::memory_order_relaxed)->count;
+    auto new_bucket_count = bucket_count;
+    while (static_cast<size_t>(kLoadFactor * new_bucket_count) <= num_entries) {
+      new_bucket_count <<= 1;
+    }
+    if (new_bucket_count > bucket_count) {
+      Rehash(new_bucket_count);
+    }
+  }
 
-    for (size_t idx = 0; idx < buckets_->count; idx++) {
-      auto node = buckets_->bucket_roots[idx];
-      if (node == nullptr) {
-        continue;
+  // Waits until there is no rehash in progress and returns the current version
+  uint64_t BeginRead() const {
+    for (;;) {
+      auto version = version_.load(std::memory_order_acquire);
+      if ((version & 1) == 0) {
+        return version;
       }
+      std::this_thread::yield();
+    }
+  }
+
+  bool ValidateRead(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+  // Must hold lock or have exclusive access to the segment. new_bucket_count must be a power of 2
+  void Rehash(size_t new_bucket_count) {
+    auto start = std::chrono::steady_clock::now();
+    auto old_buckets = buckets_.load(std::memory_order_relaxed);
+    auto new_buckets = Buckets::CreateBuckets(new_bucket_count);
 
+    // Readers that overlap with this section may see broken chains and must retry
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t idx = 0; idx < old_buckets->count; idx++) {
+      auto node = old_buckets->bucket_roots[idx].load(std::memory_order_relaxed);
       while (node) {
-        auto next_node = node->next;
+        auto next_node = node->next.load(std::memory_order_relaxed);
 
-        auto idx = GetIndex(new_bucket_count, HashFn{}(node->key));
-        node->next = new_buckets->bucket_roots[idx];
-        new_buckets->bucket_roots[idx] = node;
+        auto new_idx = GetIndex(new_bucket_count, HashFn{}(node->key));
+        auto& new_root = new_buckets->bucket_roots[new_idx];
+        node->next.store(new_root.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        new_root.store(node, std::memory_order_relaxed);
 
         node = next_node;
       }
-      buckets_->bucket_roots[idx] = nullptr;
+      old_buckets->bucket_roots[idx].store(nullptr, std::memory_order_relaxed);
     }
-    buckets_.reset(new_buckets);
-    load_factor_max_size_ = static_cast<size_t>(kLoadFactor * buckets_->count);
+    buckets_.store(new_buckets, std::memory_order_release);
+
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    // Readers may still be holding the old bucket array. Since its roots have been cleared,
+    // deleting it later does not touch the nodes that were moved to the new array
+    retired_.Retire(old_buckets);
+    load_factor_max_size_ = static_cast<size_t>(kLoadFactor * new_bucket_count);
+
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    num_buckets_.store(new_bucket_count, std::memory_order_relaxed);
+    Increase(num_rehashes_, 1);
+    Increase(rehash_ns_, duration.count());
   }
 
   struct Buckets {
     static Buckets* CreateBuckets(size_t num_buckets) {
       auto buckets = new Buckets();
       buckets->count = num_buckets;
-      buckets->bucket_roots = std::make_unique<Node*[]>(num_buckets);
+      buckets->bucket_roots = std::make_unique<std::atomic<Node*>[]>(num_buckets);
       return buckets;
     }
 
     ~Buckets() {
       for (size_t i = 0; i < count; i++) {
-        auto node = bucket_roots[i];
+        auto node = bucket_roots[i].load(std::memory_order_relaxed);
         while (node) {
-          auto next = node->next;
+          auto next = node->next.load(std::memory_order_relaxed);
           delete node;
           node = next;
         }
@@ -216,13 +462,26 @@ class SegmentT {
     }
 
     size_t count;
-    std::unique_ptr<Node*[]> bucket_roots;
+    std::unique_ptr<std::atomic<Node*>[]> bucket_roots;
   };
 
-  mutable bustub::ReaderWriterLatch rw_latch_;
-  std::unique_ptr<Buckets> buckets_;
+  // Readers only touch the version and the bucket array, so keep
+  // them away from the cache line written by the writers
+  alignas(64) std::atomic<uint64_t> version_{0};
+  std::atomic<Buckets*> buckets_;
+
+  alignas(64) mutable std::mutex write_mut_;
+  epoch::RetireList retired_;
   size_t load_factor_max_size_;
-  size_t size_;
+
+  // Statistics. Written by the latch holder and read by GetStats without latching
+  std::atomic<uint64_t> size_{0};
+  std::atomic<uint64_t> num_buckets_{0};
+  std::atomic<uint64_t> node_bytes_{0};
+  std::atomic<uint64_t> num_rehashes_{0};
+  std::atomic<uint64_t> rehash_ns_{0};
+  mutable std::atomic<uint64_t> num_latch_waits_{0};
+  mutable std::atomic<uint64_t> latch_wait_ns_{0};
 };
 
 }  // namespace concurrent_hash_map
@@ -254,19 +513,102 @@ class ConcurrentHashMap {
 
   bool Get(ValueType& res, const KeyType& key) const {
     auto idx = PickSegment(key);
+    num_reads_.Add();
     return EnsureSegment(idx)->Get(res, key);
   }
 
+  template <typename Fn>
+  bool Visit(const KeyType& key, Fn&& fn) const {
+    auto idx = PickSegment(key);
+    num_reads_.Add();
+    return EnsureSegment(idx)->Visit(key, std::forward<Fn>(fn));
+  }
+
+  /**
+   * Calls fn(i, value) for each keys[i] that exists in the map. The order of the calls is unspecified
+   */
+  template <typename Fn>
+  void MultiVisit(const std::vector<const KeyType*>& keys, Fn&& fn) const {
+    num_reads_.Add(keys.size());
+    epoch::Guard guard;
+    ForEachSegmentInBatch<KeyType, HashFn, ShardBits>(
+        keys, [this, &fn](uint64_t idx, const BatchedLookupKey<KeyType>* lookup_keys, size_t n) {
+          EnsureSegment(idx)->MultiVisit(lookup_keys, n, fn);
+        });
+  }
+
   bool InsertOrUpdate(const KeyType& key, const ValueType& value) {
     auto idx = PickSegment(key);
+    num_writes_.Add();
     return EnsureSegment(idx)->InsertOrUpdate(key, value);
   }
 
+  template <typename Fn>
+  bool Compute(const KeyType& key, Fn&& fn) {
+    auto idx = PickSegment(key);
+    num_writes_.Add();
+    return EnsureSegment(idx)->Compute(key, std::forward<Fn>(fn));
+  }
+
+  /**
+   * Grows the map so that it can hold num_entries entries, assuming that they are evenly spread
+   * across the segments, without rehashing
+   */
+  void Reserve(size_t num_entries) {
+    // Leave some room for the uneven spread of the keys
+    auto per_segment = (num_entries + num_entries / 8) / NumShards + 1;
+    for (uint64_t i = 0; i < NumShards; i++) {
+      EnsureSegment(i)->Reserve(per_segment);
+    }
+  }
+
+  /**
+   * Inserts or updates all entries, moving them out of the vector. The segments are sized for
+   * their new entries then filled by num_threads threads without latching. If a key appears
+   * more than once, the last entry wins. Must not be called concurrently with any other operation
+   */
+  void BulkInsert(std::vector<std::pair<KeyType, ValueType>>&& entries, uint32_t num_threads) {
+    ForEachSegmentInParallel<KeyType, ValueType, HashFn, ShardBits>(
+        entries, num_threads, [this, &entries](uint64_t idx, const BulkInsertEntry* bulk_entries, size_t n) {
+          EnsureSegment(idx)->BulkInsert(entries, bulk_entries, n);
+        });
+  }
+
   bool Erase(const KeyType& key) {
     auto idx = PickSegment(key);
+    num_writes_.Add();
     return EnsureSegment(idx)->Erase(key);
   }
 
+  /**
+   * Calls fn(key, value) on every entry, one segment at a time. The entries of a segment
+   * are visited while the segment is latched so fn must not access the map
+   */
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    for (uint64_t i = 0; i < NumShards; i++) {
+      auto segment = segments_[i].load();
+      if (segment) {
+        segment->ForEach(fn);
+      }
+    }
+  }
+
+  // Can be called concurrently with any operation
+  StorageStats GetStats() const {
+    StorageStats stats;
+    stats.segments.resize(NumShards);
+    for (uint64_t i = 0; i < NumShards; i++) {
+      auto segment = segments_[i].load();
+      if (segment) {
+        stats.segments[i] = segment->GetStats();
+      }
+    }
+    stats.num_reads = num_reads_.Sum();
+    stats.num_writes = num_writes_.Sum();
+    return stats;
+  }
+
  private:
   uint64_t PickSegment(const KeyType& key) const {
     auto h = HashFn{}(key);
@@ -289,6 +631,8 @@ class ConcurrentHashMap {
   static constexpr uint64_t NumShards = (1LL << ShardBits);
 
   mutable std::atomic<Segment*> segments_[NumShards];
+  mutable ShardedCounter num_reads_;
+  ShardedCounter num_writes_;
 };
 
 }  // namespace slog
\ No newline at end of file
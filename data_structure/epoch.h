@@ -0,0 +1,197 @@
+/**
+ * epoch.h
+ *
+ * A minimal epoch-based memory reclamation scheme for data structures whose readers do not
+ * take any latch.
+ *
+ * Readers pin the current global epoch for as long as they hold raw pointers into a shared
+ * structure (see epoch::Guard). A writer first unlinks an object so that no new reader can
+ * reach it, then retires it into a RetireList tagged with the global epoch at that time. The
+ * object is only deleted after every pinned reader has announced a newer epoch, that is, after
+ * all readers that could have seen the object are gone.
+ */
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace slog {
+
+namespace epoch {
+
+class EpochManager {
+ public:
+  static constexpr size_t kMaxThreads = 512;
+  static constexpr uint64_t kQuiescent = std::numeric_limits<uint64_t>::max();
+
+  static EpochManager& Get() {
+    static EpochManager manager;
+    return manager;
+  }
+
+  void Enter() {
+    auto& local = LocalSlot();
+    if (local.depth++ > 0) {
+      return;
+    }
+    auto& slot = slots_[local.index];
+    slot.epoch.store(global_epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    // Make the announced epoch visible before any pointer into the shared structure is loaded
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void Exit() {
+    auto& local = LocalSlot();
+    if (--local.depth > 0) {
+      return;
+    }
+    slots_[local.index].epoch.store(kQuiescent, std::memory_order_release);
+  }
+
+  uint64_t current() const { return global_epoch_.load(std::memory_order_acquire); }
+
+  void Advance() { global_epoch_.fetch_add(1, std::memory_order_seq_cst); }
+
+  /**
+   * Returns the oldest epoch announced by an active reader, or kQuiescent if there is none.
+   * Objects retired in an epoch strictly older than the returned value can be freed.
+   */
+  uint64_t MinActiveEpoch() const {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto min_epoch = kQuiescent;
+    auto num_slots = num_slots_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_slots; i++) {
+      auto e = slots_[i].epoch.load(std::memory_order_acquire);
+      if (e < min_epoch) {
+        min_epoch = e;
+      }
+    }
+    return min_epoch;
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{kQuiescent};
+    std::atomic<bool> in_use{false};
+  };
+
+  // Per-thread handle to a slot. The slot is given back when the thread exits
+  struct LocalSlotHandle {
+    LocalSlotHandle(EpochManager& manager) : manager(manager), index(manager.AcquireSlot()), depth(0) {}
+    ~LocalSlotHandle() { manager.ReleaseSlot(index); }
+
+    EpochManager& manager;
+    size_t index;
+    uint32_t depth;
+  };
+
+  EpochManager() = default;
+
+  LocalSlotHandle& LocalSlot() {
+    thread_local LocalSlotHandle handle(*this);
+    return handle;
+  }
+
+  size_t AcquireSlot() {
+    for (size_t i = 0; i < kMaxThreads; i++) {
+      bool expected = false;
+      if (slots_[i].in_use.compare_exchange_strong(expected, true)) {
+        // Grow the number of slots scanned by writers to cover this new slot
+        auto num_slots = num_slots_.load();
+        while (num_slots < i + 1 && !num_slots_.compare_exchange_weak(num_slots, i + 1)) {
+        }
+        return i;
+      }
+    }
+    LOG(FATAL) << "Exceeded the maximum number of threads (" << kMaxThreads << ") in epoch-based reclamation";
+    return 0;
+  }
+
+  void ReleaseSlot(size_t index) {
+    slots_[index].epoch.store(kQuiescent, std::memory_order_release);
+    slots_[index].in_use.store(false, std::memory_order_release);
+  }
+
+  alignas(64) std::atomic<uint64_t> global_epoch_{1};
+  alignas(64) std::atomic<size_t> num_slots_{0};
+  Slot slots_[kMaxThreads];
+};
+
+/**
+ * Pins the current epoch in the scope of the guard. Guards can be nested.
+ */
+class Guard {
+ public:
+  Guard() { EpochManager::Get().Enter(); }
+  ~Guard() { EpochManager::Get().Exit(); }
+
+  Guard(const Guard&) = delete;
+  Guard& operator=(const Guard&) = delete;
+};
+
+/**
+ * A list of unlinked objects waiting to be freed. This class is not thread-safe.
+ * It is meant to be protected by the same latch that serializes the writers of
+ * the owning structure.
+ */
+class RetireList {
+  static constexpr size_t kReclaimThreshold = 64;
+
+ public:
+  RetireList() = default;
+  RetireList(const RetireList&) = delete;
+  RetireList& operator=(const RetireList&) = delete;
+
+  // There must be no concurrent reader when the list is destroyed
+  ~RetireList() {
+    for (auto& r : retired_) {
+      r.deleter(r.ptr);
+    }
+  }
+
+  template <typename T>
+  void Retire(T* ptr) {
+    auto& manager = EpochManager::Get();
+    // The object must be unlinked before reading the epoch that it is tagged with
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    retired_.push_back({manager.current(), ptr, [](void* p) { delete static_cast<T*>(p); }});
+    if (retired_.size() >= next_reclaim_size_) {
+      manager.Advance();
+      Reclaim(manager.MinActiveEpoch());
+      // Back off if long-running readers keep most of the objects alive
+      next_reclaim_size_ = std::max(kReclaimThreshold, 2 * retired_.size());
+    }
+  }
+
+  size_t size() const { return retired_.size(); }
+
+ private:
+  void Reclaim(uint64_t min_active_epoch) {
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); i++) {
+      if (retired_[i].epoch < min_active_epoch) {
+        retired_[i].deleter(retired_[i].ptr);
+      } else {
+        retired_[kept++] = retired_[i];
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  struct Retired {
+    uint64_t epoch;
+    void* ptr;
+    void (*deleter)(void*);
+  };
+  std::vector<Retired> retired_;
+  size_t next_reclaim_size_ = kReclaimThreshold;
+};
+
+}  // namespace epoch
+
+}  // namespace slog
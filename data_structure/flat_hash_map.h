@@ -0,0 +1,474 @@
+/**
+ * flat_hash_map.h
+ *
+ * A sharded hash map with the same interface as ConcurrentHashMap but each segment is an
+ * open-addressing table in the style of Abseil's SwissTable instead of chained buckets.
+ *
+ * The slots of a segment are divided into groups of 16. Each slot has a control byte that is
+ * either empty, deleted (a tombstone), or holds a 7-bit fingerprint of the key hash. The control
+ * bytes of a group are kept together so that a lookup can compare the fingerprint against the
+ * whole group at once and only touch the slots whose fingerprint matches. Updating an existing
+ * key overwrites the value in place and erasing a key destroys the slot right away. The table
+ * is rebuilt when the tombstones make up too much of it.
+ *
+ * Unlike ConcurrentHashMap, readers take a shared latch on the segment because values are
+ * updated in place.
+ */
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "common/spin_latch.h"
+#include "data_structure/batched_lookup.h"
+#include "data_structure/bulk_insert.h"
+
+namespace slog {
+
+namespace flat_hash_map {
+
+constexpr size_t kGroupSize = 16;
+// Memory of each segment is aligned to cache lines
+constexpr size_t kAlignment = 64;
+
+// Values of the control bytes. A full slot stores a fingerprint in [0, 127] so
+// a control byte with the sign bit set means that the slot can be used for insertion
+constexpr int8_t kEmpty = -128;
+constexpr int8_t kDeleted = -2;
+
+// Returns a bitmask of the bytes in the group that are equal to b
+inline uint32_t MatchByte(const int8_t* group, int8_t b) {
+#if defined(__SSE2__)
+  auto ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(b), ctrl)));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupSize; i++) {
+    mask |= static_cast<uint32_t>(group[i] == b) << i;
+  }
+  return mask;
+#endif
+}
+
+// Returns a bitmask of the bytes in the group that are either empty or deleted
+inline uint32_t MatchNonFull(const int8_t* group) {
+#if defined(__SSE2__)
+  auto ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupSize; i++) {
+    mask |= static_cast<uint32_t>(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename HashFn = std::hash<KeyType>, uint8_t ShardBits = 8>
+class SegmentT {
+  struct Slot {
+    Slot(const KeyType& key, const ValueType& value) : key(key), value(value) {}
+    Slot(const KeyType& key, ValueType&& value) : key(key), value(std::move(value)) {}
+    Slot(KeyType&& key, ValueType&& value) : key(std::move(key)), value(std::move(value)) {}
+    KeyType key;
+    ValueType value;
+  };
+
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+ public:
+  /**
+   * initial_capacity must be a power of 2 and at least kGroupSize
+   */
+  SegmentT(size_t initial_capacity = kGroupSize) : size_(0), tombstones_(0) { Allocate(initial_capacity); }
+
+  ~SegmentT() {
+    DestroySlots();
+    Deallocate();
+  }
+
+  SegmentT(const SegmentT&) = delete;
+  SegmentT& operator=(const SegmentT&) = delete;
+
+  bool Get(ValueType& res, const KeyType& key) const {
+    return Visit(key, [&res](const ValueType& value) { res = value; });
+  }
+
+  /**
+   * Calls fn on the value of the given key under the read latch of the segment.
+   * The reference passed to fn is only valid during the call.
+   */
+  template <typename Fn>
+  bool Visit(const KeyType& key, Fn&& fn) const {
+    auto h = Hash(key);
+    bool found = false;
+
+    latch_.lock_shared();
+
+    auto idx = Find(key, h);
+    if (idx != kNotFound) {
+      const auto& value = slots_[idx].value;
+      fn(value);
+      found = true;
+    }
+
+    latch_.unlock_shared();
+
+    return found;
+  }
+
+  /**
+   * Looks up n keys of this segment under a single acquisition of the read latch. The first
+   * control group of every key is prefetched before any of the keys is probed. fn(index, value)
+   * is called for the found keys.
+   */
+  template <typename Fn>
+  void MultiVisit(const BatchedLookupKey<KeyType>* lookup_keys, size_t n, Fn& fn) const {
+    latch_.lock_shared();
+
+    auto group_mask = num_groups() - 1;
+    for (size_t i = 0; i < n; i++) {
+      auto g = (lookup_keys[i].hash >> (ShardBits + 7)) & group_mask;
+      __builtin_prefetch(ctrl_ + g * kGroupSize);
+    }
+    for (size_t i = 0; i < n; i++) {
+      auto idx = Find(*lookup_keys[i].key, lookup_keys[i].hash >> ShardBits);
+      if (idx != kNotFound) {
+        const auto& value = slots_[idx].value;
+        fn(lookup_keys[i].index, value);
+      }
+    }
+
+    latch_.unlock_shared();
+  }
+
+  /**
+   * Calls fn(key, value) on every entry under the read latch of the segment
+   */
+  template <typename Fn>
+  void ForEach(Fn& fn) const {
+    latch_.lock_shared();
+    for (size_t i = 0; i < capacity_; i++) {
+      if (ctrl_[i] >= 0) {
+        const auto& slot = slots_[i];
+        fn(slot.key, slot.value);
+      }
+    }
+    latch_.unlock_shared();
+  }
+
+  bool InsertOrUpdate(const KeyType& key, const ValueType& value) {
+    // Copy outside of the latch so that only a move happens under it
+    ValueType copy(value);
+    return InsertOrUpdate(key, std::move(copy));
+  }
+
+  bool InsertOrUpdate(const KeyType& key, ValueType&& value) {
+    auto h = Hash(key);
+    // The old value of an existing key is swapped into this local, which is declared before the
+    // guard so that the old value is destroyed after the latch is released
+    ValueType local(std::move(value));
+    std::lock_guard<RWSpinLatch> guard(latch_);
+    return Upsert(key, std::move(local), h);
+  }
+
+  /**
+   * Grows the segment so that it can hold num_entries entries without rehashing
+   */
+  void Reserve(size_t num_entries) {
+    std::lock_guard<RWSpinLatch> guard(latch_);
+    Grow(num_entries);
+  }
+
+  /**
+   * Moves entries[bulk_entries[i].index] for i in [0, n) into the segment without taking the
+   * latch. There must not be any concurrent reader or writer of the segment
+   */
+  void BulkInsert(std::vector<std::pair<KeyType, ValueType>>& entries, const BulkInsertEntry* bulk_entries, size_t n) {
+    Grow(size_ + n);
+    for (size_t i = 0; i < n; i++) {
+      auto& entry = entries[bulk_entries[i].index];
+      Upsert(std::move(entry.first), std::move(entry.second), bulk_entries[i].hash >> ShardBits);
+    }
+  }
+
+  bool Erase(const KeyType& key) {
+    auto h = Hash(key);
+    std::lock_guard<RWSpinLatch> guard(latch_);
+    auto idx = Find(key, h);
+    if (idx == kNotFound) {
+      return false;
+    }
+    slots_[idx].~Slot();
+    size_--;
+    // A group that still has an empty slot has never been full, so no probe sequence has ever
+    // gone past it and the erased slot can be marked as empty instead of as a tombstone
+    auto group = ctrl_ + (idx & ~(kGroupSize - 1));
+    if (MatchByte(group, kEmpty)) {
+      ctrl_[idx] = kEmpty;
+    } else {
+      ctrl_[idx] = kDeleted;
+      tombstones_++;
+    }
+    return true;
+  }
+
+ private:
+  // The lowest ShardBits bits of the hash are used for picking the segment
+  static size_t Hash(const KeyType& key) { return HashFn{}(key) >> ShardBits; }
+  static int8_t Fingerprint(size_t h) { return static_cast<int8_t>(h & 0x7F); }
+
+  // Must hold latch or have exclusive access to the segment. Returns true if the key already exists
+  template <typename K>
+  bool Upsert(K&& key, ValueType&& value, size_t h) {
+    auto idx = Find(key, h);
+    if (idx != kNotFound) {
+      // Update in place, handing the old value back through value
+      std::swap(slots_[idx].value, value);
+      return true;
+    }
+    // Keep the load factor including tombstones under 7/8
+    if ((size_ + tombstones_ + 1) * 8 > capacity_ * 7) {
+      // Only grow if the tombstones cannot free up enough space
+      Rehash((size_ + 1) * 16 > capacity_ * 7 ? capacity_ << 1 : capacity_);
+    }
+    idx = FindFirstNonFull(h);
+    if (ctrl_[idx] == kDeleted) {
+      tombstones_--;
+    }
+    new (&slots_[idx]) Slot(std::forward<K>(key), std::move(value));
+    ctrl_[idx] = Fingerprint(h);
+    size_++;
+    return false;
+  }
+
+  // Must hold latch or have exclusive access to the segment
+  void Grow(size_t num_entries) {
+    auto new_capacity = capacity_;
+    while (num_entries * 8 > new_capacity * 7) {
+      new_capacity <<= 1;
+    }
+    if (new_capacity > capacity_) {
+      Rehash(new_capacity);
+    }
+  }
+
+  // Must hold latch. Groups are probed in a triangular sequence which visits every group when
+  // the number of groups is a power of 2
+  size_t Find(const KeyType& key, size_t h) const {
+    auto fingerprint = Fingerprint(h);
+    auto group_mask = num_groups() - 1;
+    auto g = (h >> 7) & group_mask;
+    for (size_t i = 1; i <= num_groups(); i++) {
+      auto group = ctrl_ + g * kGroupSize;
+      for (auto mask = MatchByte(group, fingerprint); mask; mask &= mask - 1) {
+        auto idx = g * kGroupSize + __builtin_ctz(mask);
+        if (slots_[idx].key == key) {
+          return idx;
+        }
+      }
+      if (MatchByte(group, kEmpty)) {
+        return kNotFound;
+      }
+      g = (g + i) & group_mask;
+    }
+    return kNotFound;
+  }
+
+  // Must hold latch. There must be at least one non-full slot in the table
+  size_t FindFirstNonFull(size_t h) const {
+    auto group_mask = num_groups() - 1;
+    auto g = (h >> 7) & group_mask;
+    for (size_t i = 1;; i++) {
+      auto mask = MatchNonFull(ctrl_ + g * kGroupSize);
+      if (mask) {
+        return g * kGroupSize + __builtin_ctz(mask);
+      }
+      g = (g + i) & group_mask;
+    }
+  }
+
+  // Must hold latch
+  void Rehash(size_t new_capacity) {
+    auto old_ctrl = ctrl_;
+    auto old_slots = slots_;
+    auto old_capacity = capacity_;
+
+    Allocate(new_capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] < 0) {
+        continue;
+      }
+      auto h = Hash(old_slots[i].key);
+      auto idx = FindFirstNonFull(h);
+      new (&slots_[idx]) Slot(std::move(old_slots[i]));
+      ctrl_[idx] = Fingerprint(h);
+      old_slots[i].~Slot();
+    }
+    tombstones_ = 0;
+
+    ::operator delete(old_ctrl, std::align_val_t(kAlignment));
+    ::operator delete(old_slots, std::align_val_t(kAlignment));
+  }
+
+  void Allocate(size_t capacity) {
+    capacity_ = capacity;
+    ctrl_ = static_cast<int8_t*>(::operator new(capacity_, std::align_val_t(kAlignment)));
+    memset(ctrl_, kEmpty, capacity_);
+    slots_ = static_cast<Slot*>(::operator new(capacity_ * sizeof(Slot), std::align_val_t(kAlignment)));
+  }
+
+  void Deallocate() {
+    ::operator delete(ctrl_, std::align_val_t(kAlignment));
+    ::operator delete(slots_, std::align_val_t(kAlignment));
+  }
+
+  void DestroySlots() {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (ctrl_[i] >= 0) {
+        slots_[i].~Slot();
+      }
+    }
+  }
+
+  size_t num_groups() const { return capacity_ / kGroupSize; }
+
+  mutable RWSpinLatch latch_;
+  int8_t* ctrl_;
+  Slot* slots_;
+  size_t capacity_;
+  size_t size_;
+  size_t tombstones_;
+};
+
+}  // namespace flat_hash_map
+
+template <typename KeyType, typename ValueType, typename HashFn = std::hash<KeyType>, uint8_t ShardBits = 8>
+class FlatHashMap {
+  using Segment = flat_hash_map::SegmentT<KeyType, ValueType, HashFn, ShardBits>;
+
+ public:
+  FlatHashMap() {
+    for (uint64_t i = 0; i < NumShards; i++) {
+      segments_[i].store(nullptr);
+    }
+  }
+
+  ~FlatHashMap() {
+    for (uint64_t i = 0; i < NumShards; i++) {
+      auto segment = segments_[i].load();
+      if (segment) {
+        delete segment;
+      }
+    }
+  }
+
+  bool Get(ValueType& res, const KeyType& key) const {
+    auto idx = PickSegment(key);
+    return EnsureSegment(idx)->Get(res, key);
+  }
+
+  template <typename Fn>
+  bool Visit(const KeyType& key, Fn&& fn) const {
+    auto idx = PickSegment(key);
+    return EnsureSegment(idx)->Visit(key, std::forward<Fn>(fn));
+  }
+
+  /**
+   * Calls fn(i, value) for each keys[i] that exists in the map. The order of the calls is unspecified
+   */
+  template <typename Fn>
+  void MultiVisit(const std::vector<const KeyType*>& keys, Fn&& fn) const {
+    ForEachSegmentInBatch<KeyType, HashFn, ShardBits>(
+        keys, [this, &fn](uint64_t idx, const BatchedLookupKey<KeyType>* lookup_keys, size_t n) {
+          EnsureSegment(idx)->MultiVisit(lookup_keys, n, fn);
+        });
+  }
+
+  bool InsertOrUpdate(const KeyType& key, const ValueType& value) {
+    auto idx = PickSegment(key);
+    return EnsureSegment(idx)->InsertOrUpdate(key, value);
+  }
+
+  bool InsertOrUpdate(const KeyType& key, ValueType&& value) {
+    auto idx = PickSegment(key);
+    return EnsureSegment(idx)->InsertOrUpdate(key, std::move(value));
+  }
+
+  /**
+   * Grows the map so that it can hold num_entries entries, assuming that they are evenly spread
+   * across the segments, without rehashing
+   */
+  void Reserve(size_t num_entries) {
+    // Leave some room for the uneven spread of the keys
+    auto per_segment = (num_entries + num_entries / 8) / NumShards + 1;
+    for (uint64_t i = 0; i < NumShards; i++) {
+      EnsureSegment(i)->Reserve(per_segment);
+    }
+  }
+
+  /**
+   * Inserts or updates all entries, moving them out of the vector. The segments are sized for
+   * their new entries then filled by num_threads threads without latching. If a key appears
+   * more than once, the last entry wins. Must not be called concurrently with any other operation
+   */
+  void BulkInsert(std::vector<std::pair<KeyType, ValueType>>&& entries, uint32_t num_threads) {
+    ForEachSegmentInParallel<KeyType, ValueType, HashFn, ShardBits>(
+        entries, num_threads, [this, &entries](uint64_t idx, const BulkInsertEntry* bulk_entries, size_t n) {
+          EnsureSegment(idx)->BulkInsert(entries, bulk_entries, n);
+        });
+  }
+
+  bool Erase(const KeyType& key) {
+    auto idx = PickSegment(key);
+    return EnsureSegment(idx)->Erase(key);
+  }
+
+  /**
+   * Calls fn(key, value) on every entry, one segment at a time. The entries of a segment
+   * are visited while the segment is latched so fn must not access the map
+   */
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    for (uint64_t i = 0; i < NumShards; i++) {
+      auto segment = segments_[i].load();
+      if (segment) {
+        segment->ForEach(fn);
+      }
+    }
+  }
+
+ private:
+  uint64_t PickSegment(const KeyType& key) const {
+    auto h = HashFn{}(key);
+    return h & (NumShards - 1);
+  }
+
+  Segment* EnsureSegment(uint64_t idx) const {
+    auto segment = segments_[idx].load();
+    if (segment == nullptr) {
+      auto new_segment = new Segment();
+      if (!segments_[idx].compare_exchange_strong(segment, new_segment)) {
+        delete new_segment;
+      } else {
+        segment = new_segment;
+      }
+    }
+    return segment;
+  }
+
+  static constexpr uint64_t NumShards = (1LL << ShardBits);
+
+  mutable std::atomic<Segment*> segments_[NumShards];
+};
+
+}  // namespace slog
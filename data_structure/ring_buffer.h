@@ -0,0 +1,157 @@
+/**
+ * ring_buffer.h
+ *
+ * A FIFO queue of trivially copyable elements for the per-key state of the lock managers.
+ * The first kInlineCapacity elements are stored inside the object, so a queue that stays
+ * small never allocates. A queue that outgrows its storage moves into a buffer twice as
+ * large from the slab allocator, whose per-thread caches keep the overflow buffers of hot
+ * keys pooled, and gives the buffer back as soon as it becomes empty again.
+ *
+ * Besides popping from the front, elements can be removed from anywhere with EraseIf, which
+ * keeps the order of the remaining elements.
+ */
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "common/slab_allocator.h"
+
+namespace slog {
+
+template <typename T, uint32_t kInlineCapacity>
+class RingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>, "Elements are moved with plain copies");
+  static_assert(kInlineCapacity > 0 && (kInlineCapacity & (kInlineCapacity - 1)) == 0,
+                "Inline capacity must be a power of 2");
+
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator(const RingBuffer* ring, uint32_t i) : ring_(ring), i_(i) {}
+
+    reference operator*() const { return ring_->at(i_); }
+    pointer operator->() const { return &ring_->at(i_); }
+    const_iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const { return i_ == other.i_; }
+    bool operator!=(const const_iterator& other) const { return i_ != other.i_; }
+
+   private:
+    const RingBuffer* ring_;
+    uint32_t i_;
+  };
+
+  RingBuffer() = default;
+  RingBuffer(const RingBuffer& other) { *this = other; }
+  RingBuffer& operator=(const RingBuffer& other) {
+    if (this != &other) {
+      clear();
+      for (const auto& e : other) {
+        push_back(e);
+      }
+    }
+    return *this;
+  }
+  ~RingBuffer() { ReleaseOverflow(); }
+
+  bool empty() const { return size_ == 0; }
+  uint32_t size() const { return size_; }
+  // Number of elements that can be held without moving to a larger buffer
+  uint32_t capacity() const { return capacity_; }
+
+  const T& front() const { return data()[head_]; }
+  const T& at(uint32_t i) const { return data()[(head_ + i) & (capacity_ - 1)]; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+  void push_back(const T& e) {
+    if (size_ == capacity_) {
+      Grow();
+    }
+    data()[(head_ + size_) & (capacity_ - 1)] = e;
+    size_++;
+  }
+
+  void pop_front() {
+    head_ = (head_ + 1) & (capacity_ - 1);
+    size_--;
+    if (size_ == 0) {
+      clear();
+    }
+  }
+
+  void clear() {
+    ReleaseOverflow();
+    head_ = 0;
+    size_ = 0;
+  }
+
+  // Removes the elements matching pred. Returns the number of removed elements
+  template <typename Pred>
+  uint32_t EraseIf(Pred pred) {
+    auto buf = data();
+    auto mask = capacity_ - 1;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < size_; i++) {
+      const auto& e = buf[(head_ + i) & mask];
+      if (!pred(e)) {
+        buf[(head_ + kept) & mask] = e;
+        kept++;
+      }
+    }
+    auto removed = size_ - kept;
+    size_ = kept;
+    if (size_ == 0) {
+      clear();
+    }
+    return removed;
+  }
+
+ private:
+  bool is_inline() const { return capacity_ == kInlineCapacity; }
+  T* data() { return is_inline() ? storage_.inline_elems : storage_.overflow; }
+  const T* data() const { return is_inline() ? storage_.inline_elems : storage_.overflow; }
+
+  static size_t BufferBytes(uint32_t capacity) { return SlabAllocator::Capacity(capacity * sizeof(T)); }
+
+  void Grow() {
+    auto new_capacity = capacity_ * 2;
+    auto new_buf = reinterpret_cast<T*>(SlabAllocator::Allocate(BufferBytes(new_capacity)));
+    for (uint32_t i = 0; i < size_; i++) {
+      new_buf[i] = at(i);
+    }
+    ReleaseOverflow();
+    storage_.overflow = new_buf;
+    capacity_ = new_capacity;
+    head_ = 0;
+  }
+
+  void ReleaseOverflow() {
+    if (!is_inline()) {
+      SlabAllocator::Deallocate(reinterpret_cast<char*>(storage_.overflow), BufferBytes(capacity_));
+      capacity_ = kInlineCapacity;
+    }
+  }
+
+  union Storage {
+    T inline_elems[kInlineCapacity];
+    T* overflow;
+  } storage_;
+  uint32_t capacity_ = kInlineCapacity;
+  uint32_t head_ = 0;
+  uint32_t size_ = 0;
+};
+
+}  // namespace slog
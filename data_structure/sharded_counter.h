@@ -0,0 +1,45 @@
+/**
+ * sharded_counter.h
+ *
+ * A counter that many threads can increment without bouncing a shared cache line between
+ * them. Each thread increments one of a fixed number of cache-line-sized slots, and reading
+ * the counter sums up all slots. Threads only share a slot when there are more threads than
+ * slots, in which case the increments are still correct but contend with each other.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace slog {
+
+class ShardedCounter {
+ public:
+  static constexpr size_t kNumSlots = 64;
+
+  void Add(uint64_t n = 1) { slots_[ThreadSlot()].value.fetch_add(n, std::memory_order_relaxed); }
+
+  // Increments made concurrently with the call may or may not be counted
+  uint64_t Sum() const {
+    uint64_t sum = 0;
+    for (const auto& slot : slots_) {
+      sum += slot.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static size_t ThreadSlot() {
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kNumSlots;
+    return slot;
+  }
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> value{0};
+  };
+
+  Slot slots_[kNumSlots];
+};
+
+}  // namespace slog
@@ -0,0 +1,217 @@
+/**
+ * skip_list.h
+ *
+ * An ordered map implemented as a skiplist, for storages that need to scan keys in order.
+ *
+ * Readers do not take any latch. Writers are serialized by a mutex and publish a new node only
+ * after all of its forward pointers are set, so a reader always sees a well-formed list. A
+ * value is never modified in place: an update swaps in a new copy of the value. Erased nodes
+ * and replaced values are reclaimed with epoch-based reclamation (see epoch.h).
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <random>
+#include <utility>
+
+#include "data_structure/epoch.h"
+
+namespace slog {
+
+template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType>>
+class ConcurrentSkipList {
+  static constexpr int kMaxHeight = 16;
+  // Each node is promoted to the next level with a probability of 1/kBranching
+  static constexpr uint32_t kBranching = 4;
+
+  struct Node {
+    static Node* New(const KeyType& key, ValueType* value, int height) {
+      auto mem = ::operator new(sizeof(Node) + (height - 1) * sizeof(std::atomic<Node*>));
+      auto node = new (mem) Node(key, value, height);
+      for (int i = 1; i < height; i++) {
+        new (&node->next[i]) std::atomic<Node*>(nullptr);
+      }
+      return node;
+    }
+
+    // Matches the allocation in New
+    static void operator delete(void* p) { ::operator delete(p); }
+
+    ~Node() { delete value.load(std::memory_order_relaxed); }
+
+    KeyType key;
+    std::atomic<ValueType*> value;
+    int height;
+    // Forward pointers of all levels. The memory for levels above 0 is allocated past the end of the node
+    std::atomic<Node*> next[1];
+
+   private:
+    Node(const KeyType& key, ValueType* value, int height) : key(key), value(value), height(height), next{nullptr} {}
+  };
+
+ public:
+  ConcurrentSkipList() : head_(Node::New(KeyType(), nullptr, kMaxHeight)), height_(1), size_(0) {}
+
+  ~ConcurrentSkipList() {
+    auto node = head_;
+    while (node != nullptr) {
+      auto next = node->next[0].load(std::memory_order_relaxed);
+      delete node;
+      node = next;
+    }
+  }
+
+  ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+  ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+  bool Get(ValueType& res, const KeyType& key) const {
+    return Visit(key, [&res](const ValueType& value) { res = value; });
+  }
+
+  /**
+   * Calls fn on the value of the given key without copying it. The reference passed
+   * to fn is only valid during the call.
+   */
+  template <typename Fn>
+  bool Visit(const KeyType& key, Fn&& fn) const {
+    epoch::Guard guard;
+    auto node = FindGreaterOrEqual(key, nullptr);
+    if (node == nullptr || !Equal(node->key, key)) {
+      return false;
+    }
+    fn(*node->value.load(std::memory_order_acquire));
+    return true;
+  }
+
+  /**
+   * Calls fn(key, value) in key order on every entry whose key is in [begin, end)
+   */
+  template <typename Fn>
+  void Scan(const KeyType& begin, const KeyType& end, Fn&& fn) const {
+    epoch::Guard guard;
+    auto node = FindGreaterOrEqual(begin, nullptr);
+    while (node != nullptr && compare_(node->key, end)) {
+      fn(node->key, *node->value.load(std::memory_order_acquire));
+      node = node->next[0].load(std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * Calls fn(key, value) on every entry in key order
+   */
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    epoch::Guard guard;
+    auto node = head_->next[0].load(std::memory_order_acquire);
+    while (node != nullptr) {
+      fn(node->key, *node->value.load(std::memory_order_acquire));
+      node = node->next[0].load(std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * Returns true if the key already exists
+   */
+  bool InsertOrUpdate(const KeyType& key, const ValueType& value) { return Upsert(key, new ValueType(value)); }
+
+  bool InsertOrUpdate(const KeyType& key, ValueType&& value) { return Upsert(key, new ValueType(std::move(value))); }
+
+  bool Erase(const KeyType& key) {
+    std::lock_guard<std::mutex> guard(write_mut_);
+    Node* preds[kMaxHeight];
+    auto node = FindGreaterOrEqual(key, preds);
+    if (node == nullptr || !Equal(node->key, key)) {
+      return false;
+    }
+    // Unlink from the top so that the node stays reachable from the bottom level while
+    // it is still reachable from any upper level
+    for (int i = node->height - 1; i >= 0; i--) {
+      preds[i]->next[i].store(node->next[i].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    retired_.Retire(node);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  bool Equal(const KeyType& a, const KeyType& b) const { return !compare_(a, b) && !compare_(b, a); }
+
+  bool Upsert(const KeyType& key, ValueType* value) {
+    std::lock_guard<std::mutex> guard(write_mut_);
+    Node* preds[kMaxHeight];
+    auto node = FindGreaterOrEqual(key, preds);
+    if (node != nullptr && Equal(node->key, key)) {
+      auto old_value = node->value.exchange(value, std::memory_order_acq_rel);
+      retired_.Retire(old_value);
+      return true;
+    }
+
+    auto height = RandomHeight();
+    auto cur_height = height_.load(std::memory_order_relaxed);
+    if (height > cur_height) {
+      for (int i = cur_height; i < height; i++) {
+        preds[i] = head_;
+      }
+      // A reader that sees the new height before the new node only goes through
+      // null pointers of the head at the new levels, which is harmless
+      height_.store(height, std::memory_order_relaxed);
+    }
+
+    auto new_node = Node::New(key, value, height);
+    for (int i = 0; i < height; i++) {
+      new_node->next[i].store(preds[i]->next[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    // Publish from the bottom so that a node reachable from an upper level is always
+    // reachable from the levels below it
+    for (int i = 0; i < height; i++) {
+      preds[i]->next[i].store(new_node, std::memory_order_release);
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Returns the first node whose key is not less than key. If preds is not null, it is
+  // filled with the last node before the returned node at each level
+  Node* FindGreaterOrEqual(const KeyType& key, Node** preds) const {
+    auto node = head_;
+    for (int level = height_.load(std::memory_order_relaxed) - 1;; level--) {
+      auto next = node->next[level].load(std::memory_order_acquire);
+      while (next != nullptr && compare_(next->key, key)) {
+        node = next;
+        next = node->next[level].load(std::memory_order_acquire);
+      }
+      if (preds != nullptr) {
+        preds[level] = node;
+      }
+      if (level == 0) {
+        return next;
+      }
+    }
+  }
+
+  // Must hold write_mut_
+  int RandomHeight() {
+    int height = 1;
+    while (height < kMaxHeight && rg_() % kBranching == 0) {
+      height++;
+    }
+    return height;
+  }
+
+  Node* const head_;
+  std::atomic<int> height_;
+  std::atomic<size_t> size_;
+  Compare compare_;
+
+  std::mutex write_mut_;
+  std::mt19937 rg_;
+  epoch::RetireList retired_;
+};
+
+}  // namespace slog
@@ -0,0 +1,354 @@
+/**
+ * slot_pool.h
+ *
+ * SlotPool keeps its elements in fixed-size chunks of slots that are never moved or given back,
+ * so a pointer to an element stays valid until the element is erased, and a freed slot is reused
+ * by the next insertion without going through the heap. Each slot has a generation that is
+ * bumped whenever its element is erased. A SlotHandle is the index of a slot plus the generation
+ * that it was issued for, so looking up a handle is an array access that also tells whether the
+ * element is still there.
+ *
+ * SlotMap puts a SlotPool behind an index from integer keys, such as txn ids, to handles. The
+ * index is an open-addressing table of (key, handle) pairs with linear probing, so neither the
+ * index nor the pool allocates for each entry. Code that already has the handle of an entry, or
+ * a pointer to it, does not need to go through the index at all.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace slog {
+
+struct SlotHandle {
+  static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = kInvalidIndex;
+  uint32_t generation = 0;
+
+  bool is_valid() const { return index != kInvalidIndex; }
+  bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+  bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+template <typename T>
+class SlotPool {
+  static constexpr uint32_t kChunkSize = 1024;
+
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+    uint32_t generation = 0;
+    uint32_t next_free = SlotHandle::kInvalidIndex;
+    bool occupied = false;
+
+    T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    const T* value() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+  };
+
+ public:
+  template <bool kConst>
+  class Iterator {
+    using Pool = std::conditional_t<kConst, const SlotPool, SlotPool>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const T*, T*>;
+    using reference = std::conditional_t<kConst, const T&, T&>;
+
+    Iterator(Pool* pool, uint32_t i) : pool_(pool), i_(i) {}
+    // Lets an iterator be passed where a const iterator is expected
+    template <bool kOtherConst, typename = std::enable_if_t<kConst && !kOtherConst>>
+    Iterator(const Iterator<kOtherConst>& other) : pool_(other.pool_), i_(other.i_) {}
+
+    reference operator*() const { return *pool_->slot(i_).value(); }
+    pointer operator->() const { return pool_->slot(i_).value(); }
+    Iterator& operator++() {
+      i_ = pool_->NextOccupied(i_ + 1);
+      return *this;
+    }
+    bool operator==(const Iterator& other) const { return i_ == other.i_; }
+    bool operator!=(const Iterator& other) const { return i_ != other.i_; }
+
+    SlotHandle handle() const { return {i_, pool_->slot(i_).generation}; }
+
+   private:
+    friend class Iterator<!kConst>;
+
+    Pool* pool_;
+    uint32_t i_;
+  };
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  SlotPool() = default;
+  ~SlotPool() { clear(); }
+
+  // Elements must not move, so neither must the pool
+  SlotPool(const SlotPool&) = delete;
+  SlotPool& operator=(const SlotPool&) = delete;
+
+  template <typename... Args>
+  SlotHandle Emplace(Args&&... args) {
+    if (free_head_ == SlotHandle::kInvalidIndex) {
+      AddChunk();
+    }
+    auto i = free_head_;
+    auto& s = slot(i);
+    new (s.storage) T(std::forward<Args>(args)...);
+    free_head_ = s.next_free;
+    s.occupied = true;
+    size_++;
+    return {i, s.generation};
+  }
+
+  // Returns nullptr if the element of the handle has been erased
+  T* Get(SlotHandle handle) { return const_cast<T*>(std::as_const(*this).Get(handle)); }
+  const T* Get(SlotHandle handle) const {
+    if (handle.index >= num_slots()) {
+      return nullptr;
+    }
+    auto& s = slot(handle.index);
+    return s.occupied && s.generation == handle.generation ? s.value() : nullptr;
+  }
+
+  // Returns end() if the element of the handle has been erased
+  iterator Find(SlotHandle handle) { return Get(handle) == nullptr ? end() : iterator(this, handle.index); }
+  const_iterator Find(SlotHandle handle) const {
+    return Get(handle) == nullptr ? end() : const_iterator(this, handle.index);
+  }
+
+  void Erase(SlotHandle handle) {
+    if (Get(handle) != nullptr) {
+      EraseSlot(handle.index);
+    }
+  }
+  void Erase(const_iterator it) { EraseSlot(it.handle().index); }
+
+  void clear() {
+    for (uint32_t i = 0; i < num_slots(); i++) {
+      if (slot(i).occupied) {
+        EraseSlot(i);
+      }
+    }
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return iterator(this, NextOccupied(0)); }
+  iterator end() { return iterator(this, num_slots()); }
+  const_iterator begin() const { return const_iterator(this, NextOccupied(0)); }
+  const_iterator end() const { return const_iterator(this, num_slots()); }
+
+ private:
+  uint32_t num_slots() const { return chunks_.size() * kChunkSize; }
+  Slot& slot(uint32_t i) { return chunks_[i / kChunkSize][i % kChunkSize]; }
+  const Slot& slot(uint32_t i) const { return const_cast<SlotPool*>(this)->slot(i); }
+
+  uint32_t NextOccupied(uint32_t i) const {
+    while (i < num_slots() && !slot(i).occupied) {
+      i++;
+    }
+    return i;
+  }
+
+  void AddChunk() {
+    auto first = num_slots();
+    chunks_.push_back(std::make_unique<Slot[]>(kChunkSize));
+    // Hand out the slots of the new chunk in index order
+    for (uint32_t i = kChunkSize; i-- > 0;) {
+      slot(first + i).next_free = free_head_;
+      free_head_ = first + i;
+    }
+  }
+
+  void EraseSlot(uint32_t i) {
+    auto& s = slot(i);
+    s.value()->~T();
+    s.occupied = false;
+    s.generation++;
+    // The most recently freed slot is reused first while it is still in the cache
+    s.next_free = free_head_;
+    free_head_ = i;
+    size_--;
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> chunks_;
+  uint32_t free_head_ = SlotHandle::kInvalidIndex;
+  size_t size_ = 0;
+};
+
+/**
+ * A map from integer keys to values stored in a SlotPool. The interface follows the subset
+ * of std::unordered_map that the scheduler uses, and iterators expose the handles of their
+ * entries. Pointers to values stay valid until their entries are erased.
+ */
+template <typename Key, typename T>
+class SlotMap {
+  static_assert(std::is_integral_v<Key>, "Keys are hashed as integers");
+
+  static constexpr size_t kMinIndexCapacity = 16;
+
+  struct IndexEntry {
+    Key key;
+    SlotHandle handle;
+  };
+
+ public:
+  using value_type = std::pair<const Key, T>;
+  using iterator = typename SlotPool<value_type>::iterator;
+  using const_iterator = typename SlotPool<value_type>::const_iterator;
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key key, Args&&... args) {
+    if (auto pos = FindPosition(key); pos.has_value()) {
+      return {pool_.Find(index_[*pos].handle), false};
+    }
+    if ((pool_.size() + 1) * 2 > index_.size()) {
+      Rehash(std::max(index_.size() * 2, kMinIndexCapacity));
+    }
+    auto handle = pool_.Emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    auto pos = Hash(key);
+    while (index_[pos].handle.is_valid()) {
+      pos = (pos + 1) & (index_.size() - 1);
+    }
+    index_[pos] = {key, handle};
+    return {pool_.Find(handle), true};
+  }
+
+  iterator find(Key key) {
+    auto pos = FindPosition(key);
+    return pos.has_value() ? pool_.Find(index_[*pos].handle) : pool_.end();
+  }
+  const_iterator find(Key key) const {
+    auto pos = FindPosition(key);
+    return pos.has_value() ? pool_.Find(index_[*pos].handle) : pool_.end();
+  }
+
+  size_t count(Key key) const { return FindPosition(key).has_value() ? 1 : 0; }
+
+  T& at(Key key) {
+    auto it = find(key);
+    if (it == end()) {
+      throw std::out_of_range("Key is not in the slot map");
+    }
+    return it->second;
+  }
+
+  // Returns nullptr if the entry of the handle has been erased
+  T* Get(SlotHandle handle) {
+    auto entry = pool_.Get(handle);
+    return entry == nullptr ? nullptr : &entry->second;
+  }
+
+  size_t erase(Key key) {
+    auto pos = FindPosition(key);
+    if (!pos.has_value()) {
+      return 0;
+    }
+    pool_.Erase(index_[*pos].handle);
+    EraseFromIndex(*pos);
+    return 1;
+  }
+  // The key is read from the slot of the handle and its index entry is found by comparing handles,
+  // so the key is never compared. Does nothing if the entry of the handle has been erased
+  void erase(SlotHandle handle) {
+    auto entry = pool_.Get(handle);
+    if (entry == nullptr) {
+      return;
+    }
+    auto pos = Hash(entry->first);
+    while (index_[pos].handle != handle) {
+      pos = (pos + 1) & (index_.size() - 1);
+    }
+    pool_.Erase(handle);
+    EraseFromIndex(pos);
+  }
+  void erase(const_iterator it) { erase(it.handle()); }
+
+  // Only sizes the index. The pool grows one chunk at a time as it fills up
+  void reserve(size_t num_entries) {
+    size_t capacity = kMinIndexCapacity;
+    while (capacity < num_entries * 2) {
+      capacity *= 2;
+    }
+    if (capacity > index_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  size_t size() const { return pool_.size(); }
+  bool empty() const { return pool_.empty(); }
+
+  iterator begin() { return pool_.begin(); }
+  iterator end() { return pool_.end(); }
+  const_iterator begin() const { return pool_.begin(); }
+  const_iterator end() const { return pool_.end(); }
+
+ private:
+  // Fibonacci hashing keeps the high bits of the product, which depend on all bits of the key
+  size_t Hash(Key key) const { return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift_; }
+
+  std::optional<size_t> FindPosition(Key key) const {
+    if (index_.empty()) {
+      return std::nullopt;
+    }
+    for (auto pos = Hash(key); index_[pos].handle.is_valid(); pos = (pos + 1) & (index_.size() - 1)) {
+      if (index_[pos].key == key) {
+        return pos;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Shifts the following entries of the probe sequence back instead of leaving a tombstone
+  void EraseFromIndex(size_t pos) {
+    auto mask = index_.size() - 1;
+    for (auto next = (pos + 1) & mask; index_[next].handle.is_valid(); next = (next + 1) & mask) {
+      auto home = Hash(index_[next].key);
+      // The entry can fill the hole if the hole is between its home and its current position
+      if (((next - home) & mask) >= ((next - pos) & mask)) {
+        index_[pos] = index_[next];
+        pos = next;
+      }
+    }
+    index_[pos].handle = SlotHandle{};
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<IndexEntry> old_index(capacity);
+    old_index.swap(index_);
+    shift_ = 64;
+    for (auto c = capacity; c > 1; c >>= 1) {
+      shift_--;
+    }
+    for (const auto& entry : old_index) {
+      if (entry.handle.is_valid()) {
+        auto pos = Hash(entry.key);
+        while (index_[pos].handle.is_valid()) {
+          pos = (pos + 1) & (capacity - 1);
+        }
+        index_[pos] = entry;
+      }
+    }
+  }
+
+  SlotPool<value_type> pool_;
+  std::vector<IndexEntry> index_;
+  int shift_ = 64;
+};
+
+}  // namespace slog
@@ -0,0 +1,107 @@
+/**
+ * spsc_queue.h
+ *
+ * A bounded lock-free queue between exactly one producer thread and one consumer thread.
+ * Elements live in a power-of-2 ring indexed by two ever-increasing positions: the tail is
+ * only written by the producer and the head only by the consumer, each on its own cache
+ * line, and each side keeps a cached copy of the other's position so that it only touches
+ * the other's cache line when the ring looks full or empty.
+ *
+ * The queue also owns an eventfd so that the consumer can sleep in a poll until there is
+ * something to pop. The producer only signals it when it pushes into a queue that it sees
+ * empty, so a busy consumer is never woken up by a syscall. A fence on both sides makes sure
+ * that either the producer sees the queue empty and signals, or the consumer sees the new
+ * element before it goes back to poll.
+ */
+#pragma once
+
+#include <glog/logging.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace slog {
+
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(size_t capacity) {
+    capacity_ = 1;
+    while (capacity_ < capacity) {
+      capacity_ <<= 1;
+    }
+    elems_ = std::make_unique<T[]>(capacity_);
+    fd_ = eventfd(0, EFD_NONBLOCK);
+    CHECK_GE(fd_, 0) << "Failed to create an eventfd";
+  }
+
+  ~SpscQueue() { close(fd_); }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /* Producer side */
+
+  // Returns false if the queue is full
+  bool TryPush(const T& e) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == capacity_) {
+        return false;
+      }
+    }
+    elems_[tail & (capacity_ - 1)] = e;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (head_.load(std::memory_order_relaxed) == tail) {
+      uint64_t one = 1;
+      CHECK_EQ(write(fd_, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one))) << "Failed to signal the eventfd";
+    }
+    return true;
+  }
+
+  /* Consumer side */
+
+  // Returns false if the queue is empty
+  bool TryPop(T& e) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        // Pairs with the fence of the producer before it checks whether to signal
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_) {
+          return false;
+        }
+      }
+    }
+    e = elems_[head & (capacity_ - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Becomes readable when an element is pushed into the empty queue. The consumer must reset
+  // it before popping, which the Poller does for the eventfds that it waits on
+  int fd() const { return fd_; }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  std::unique_ptr<T[]> elems_;
+  size_t capacity_;
+  int fd_;
+
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  uint64_t cached_head_ = 0;
+
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t cached_tail_ = 0;
+};
+
+}  // namespace slog
@@ -0,0 +1,55 @@
+/**
+ * work_stealing_queue.h
+ *
+ * A FIFO queue that one owner thread pushes into and that any thread may pop from. The owner
+ * pops its own elements in order and idle threads steal from the same end, so a stolen element
+ * is always the one that has waited the longest behind whatever the owner is busy with.
+ *
+ * The elements are only ever touched for a few instructions at a time, so the queue is guarded
+ * by a spin latch. The size is kept in an atomic so that a thief can skip an empty queue
+ * without taking its latch.
+ */
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "common/spin_latch.h"
+
+namespace slog {
+
+template <typename T>
+class WorkStealingQueue {
+ public:
+  void Push(const T& e) {
+    std::lock_guard<SpinLatch> guard(latch_);
+    elems_.push_back(e);
+    size_.store(elems_.size(), std::memory_order_relaxed);
+  }
+
+  // Returns false if the queue is empty
+  bool TryPop(T& e) {
+    if (size_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    std::lock_guard<SpinLatch> guard(latch_);
+    if (elems_.empty()) {
+      return false;
+    }
+    e = elems_.front();
+    elems_.pop_front();
+    size_.store(elems_.size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  // May be stale by the time it returns unless called by the owner with no thieves around
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  SpinLatch latch_;
+  std::deque<T> elems_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace slog
@@ -13,10 +13,10 @@ void Execution::ApplyWrites(const Transaction& txn, const SharderPtr& sharder,
     Record new_record;
     new_record.SetMetadata(value.metadata());
     new_record.SetValue(value.new_value());
-    storage->Write(key, new_record);
+    storage->Write(key, std::move(new_record), txn.internal().version());
   }
   for (const auto& key : txn.deleted_keys()) {
-    storage->Delete(key);
+    storage->Delete(key, txn.internal().version());
   }
 }
 
@@ -17,13 +17,10 @@ DeliverTxn::DeliverTxn(const StorageAdapterPtr& storage_adapter, int w_id, int d
 bool DeliverTxn::Read() {
   order_.Select({a_w_id_, a_d_id_, a_no_o_id_}, {OrderSchema::Column::C_ID});
 
-  auto ol_id = MakeInt8Scalar();
-  for (int i = 1; i <= kLinePerOrder; i++) {
-    ol_id->value = i;
-    auto res = order_line_.Select({a_w_id_, a_d_id_, a_no_o_id_, ol_id}, {OrderLineSchema::Column::AMOUNT});
-    if (!res.empty()) {
-      sum_o_amount_->value += UncheckedCast<Int32Scalar>(res[0])->value;
-    }
+  auto order_lines =
+      order_line_.Scan({a_w_id_, a_d_id_, a_no_o_id_}, 1, kLinePerOrder + 1, {OrderLineSchema::Column::AMOUNT});
+  for (const auto& res : order_lines) {
+    sum_o_amount_->value += UncheckedCast<Int32Scalar>(res[0])->value;
   }
   auto res = customer_.Select({a_w_id_, a_d_id_, a_c_id_},
                               {CustomerSchema::Column::BALANCE, CustomerSchema::Column::DELIVERY_CNT});
@@ -14,14 +14,10 @@ OrderStatusTxn::OrderStatusTxn(const StorageAdapterPtr& storage_adapter, int w_i
 bool OrderStatusTxn::Read() {
   customer_.Select({a_w_id_, a_d_id_, a_c_id_}, {CustomerSchema::Column::FULL_NAME, CustomerSchema::Column::BALANCE});
   order_.Select({a_w_id_, a_d_id_, a_o_id_}, {OrderSchema::Column::ENTRY_D, OrderSchema::Column::CARRIER_ID});
-  auto ol_number = MakeInt8Scalar();
-  for (int i = 1; i <= kLinePerOrder; i++) {
-    ol_number->value = i;
-    order_line_.Select(
-        {a_w_id_, a_d_id_, a_o_id_, ol_number},
-        {OrderLineSchema::Column::I_ID, OrderLineSchema::Column::SUPPLY_W_ID, OrderLineSchema::Column::QUANTITY,
-         OrderLineSchema::Column::AMOUNT, OrderLineSchema::Column::DELIVERY_D});
-  }
+  order_line_.Scan({a_w_id_, a_d_id_, a_o_id_}, 1, kLinePerOrder + 1,
+                   {OrderLineSchema::Column::I_ID, OrderLineSchema::Column::SUPPLY_W_ID,
+                    OrderLineSchema::Column::QUANTITY, OrderLineSchema::Column::AMOUNT,
+                    OrderLineSchema::Column::DELIVERY_D});
 
   return true;
 }
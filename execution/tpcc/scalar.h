@@ -2,6 +2,8 @@
 
 #include <glog/logging.h>
 
+#include <cstring>
+
 #include "execution/tpcc/types.h"
 
 namespace slog {
@@ -76,16 +78,24 @@ inline std::shared_ptr<FixedTextScalar> MakeFixedTextScalar() {
   return MakeFixedTextScalar(FixedTextType<0>::Get(), "");
 }
 
+// data may point into a storage key or value, which are not aligned for T
+template <typename T>
+inline T LoadUnaligned(const void* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
 inline ScalarPtr MakeScalar(const std::shared_ptr<DataType>& type, const void* data) {
   switch (type->name()) {
     case DataTypeName::INT8:
-      return MakeInt8Scalar(*reinterpret_cast<const Int8Type::CType*>(data));
+      return MakeInt8Scalar(LoadUnaligned<Int8Type::CType>(data));
     case DataTypeName::INT16:
-      return MakeInt16Scalar(*reinterpret_cast<const Int16Type::CType*>(data));
+      return MakeInt16Scalar(LoadUnaligned<Int16Type::CType>(data));
     case DataTypeName::INT32:
-      return MakeInt32Scalar(*reinterpret_cast<const Int32Type::CType*>(data));
+      return MakeInt32Scalar(LoadUnaligned<Int32Type::CType>(data));
     case DataTypeName::INT64:
-      return MakeInt64Scalar(*reinterpret_cast<const Int64Type::CType*>(data));
+      return MakeInt64Scalar(LoadUnaligned<Int64Type::CType>(data));
     case DataTypeName::FIXED_TEXT:
       return MakeFixedTextScalar(type, {static_cast<const char*>(data), type->size()});
   }
@@ -101,6 +111,39 @@ inline ScalarPtr MakeScalar(const std::shared_ptr<DataType>& type, const char* d
   return MakeFixedTextScalar(type, std::string{data});
 }
 
+// Makes a scalar of an integer type from a value that is in the range of that type
+inline ScalarPtr MakeIntegerScalar(const std::shared_ptr<DataType>& type, int64_t value) {
+  switch (type->name()) {
+    case DataTypeName::INT8:
+      return MakeInt8Scalar(static_cast<Int8Type::CType>(value));
+    case DataTypeName::INT16:
+      return MakeInt16Scalar(static_cast<Int16Type::CType>(value));
+    case DataTypeName::INT32:
+      return MakeInt32Scalar(static_cast<Int32Type::CType>(value));
+    case DataTypeName::INT64:
+      return MakeInt64Scalar(static_cast<Int64Type::CType>(value));
+    default:
+      LOG(FATAL) << "Not an integer type: " << type->to_string();
+  }
+  return nullptr;
+}
+
+inline int64_t IntegerValue(const ScalarPtr& scalar) {
+  switch (scalar->type->name()) {
+    case DataTypeName::INT8:
+      return static_cast<const Int8Scalar&>(*scalar).value;
+    case DataTypeName::INT16:
+      return static_cast<const Int16Scalar&>(*scalar).value;
+    case DataTypeName::INT32:
+      return static_cast<const Int32Scalar&>(*scalar).value;
+    case DataTypeName::INT64:
+      return static_cast<const Int64Scalar&>(*scalar).value;
+    default:
+      LOG(FATAL) << "Not an integer type: " << scalar->type->to_string();
+  }
+  return 0;
+}
+
 template <typename T>
 inline std::shared_ptr<T> UncheckedCast(const ScalarPtr& from) {
   return std::static_pointer_cast<T>(from);
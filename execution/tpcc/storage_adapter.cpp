@@ -2,30 +2,103 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace slog {
 namespace tpcc {
 
+namespace {
+
+// Returns the smallest key that is larger than all keys starting with prefix, or an
+// empty string if there is no such key
+std::string PrefixEnd(const std::string& prefix) {
+  auto end = prefix;
+  while (!end.empty() && static_cast<unsigned char>(end.back()) == 0xFF) {
+    end.pop_back();
+  }
+  if (!end.empty()) {
+    end.back()++;
+  }
+  return end;
+}
+
+}  // namespace
+
 KVStorageAdapter::KVStorageAdapter(const std::shared_ptr<Storage>& storage,
                                    const std::shared_ptr<MetadataInitializer>& metadata_initializer)
-    : storage_(storage), metadata_initializer_(metadata_initializer) {}
+    : storage_(storage), metadata_initializer_(metadata_initializer), bulk_loading_(false), bulk_load_id_(0) {}
 
 const std::string* KVStorageAdapter::Read(const std::string& key) {
-  Record r;
-  auto ok = storage_->Read(key, r);
+  auto ok = storage_->ReadView(key, [this](std::string_view value, const Metadata&) { buffer_.emplace_back(value); });
   if (!ok) {
     return nullptr;
   }
-  buffer_.push_back(r.to_string());
   return &buffer_.back();
 };
 
+void KVStorageAdapter::Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) {
+  auto end = PrefixEnd(prefix);
+  CHECK(!end.empty()) << "Unbounded scans are not supported";
+  auto scanned = storage_->Scan(prefix, end, [&fn](const Key& key, std::string_view value, const Metadata&) {
+    fn(key, std::string(value));
+  });
+  if (scanned) {
+    return;
+  }
+  // Fall back to point reads if the storage is not ordered
+  std::vector<const std::string*> sorted_keys;
+  for (const auto& key : keys) {
+    sorted_keys.push_back(&key);
+  }
+  std::sort(sorted_keys.begin(), sorted_keys.end(), [](auto a, auto b) { return *a < *b; });
+  for (auto key : sorted_keys) {
+    storage_->ReadView(*key, [&fn, key](std::string_view value, const Metadata&) { fn(*key, std::string(value)); });
+  }
+}
+
 bool KVStorageAdapter::Insert(const std::string& key, std::string&& value) {
   Record r(std::move(value));
   r.SetMetadata(metadata_initializer_->Compute(key));
+  if (bulk_loading_) {
+    bulk_loader_->Add(ThreadBuffer(), Key(key), std::move(r));
+    return true;
+  }
   storage_->Write(key, std::move(r));
   return true;
 }
 
+void KVStorageAdapter::BeginBulkLoad() {
+  static std::atomic<uint64_t> last_bulk_load_id = 0;
+  bulk_loading_ = true;
+  bulk_loader_ = std::make_unique<BulkLoader>(*storage_);
+  bulk_load_id_ = ++last_bulk_load_id;
+}
+
+void KVStorageAdapter::EndBulkLoad() {
+  bulk_loading_ = false;
+  for (auto& buffer : bulk_buffers_) {
+    bulk_loader_->Flush(*buffer);
+  }
+  LOG(INFO) << "Bulk-loaded " << bulk_loader_->num_loaded() << " records";
+  bulk_buffers_.clear();
+  bulk_loader_.reset();
+}
+
+BulkLoader::Buffer& KVStorageAdapter::ThreadBuffer() {
+  // The buffer of the calling thread is cached along with the id of its bulk load so that
+  // it is never used by a later bulk load or by another adapter
+  thread_local uint64_t cached_bulk_load_id = 0;
+  thread_local BulkLoader::Buffer* cached_buffer = nullptr;
+  if (cached_bulk_load_id != bulk_load_id_) {
+    std::lock_guard<std::mutex> guard(bulk_mut_);
+    bulk_buffers_.push_back(std::make_unique<BulkLoader::Buffer>());
+    cached_buffer = bulk_buffers_.back().get();
+    cached_bulk_load_id = bulk_load_id_;
+  }
+  return *cached_buffer;
+}
+
 TxnStorageAdapter::TxnStorageAdapter(Transaction& txn) : txn_(txn) {
   for (int i = 0; i < txn.keys_size(); i++) {
     key_index_.emplace(txn.keys(i).key(), i);
@@ -45,6 +118,27 @@ const std::string* TxnStorageAdapter::Read(const std::string& key) {
   return &txn_.keys(it->second).value_entry().value();
 }
 
+void TxnStorageAdapter::Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) {
+  CheckIndexSize();
+  // Only the keys declared by the txn are visible. Since keys lists every key that the scan
+  // can return, adding the declared ones to the ordered index is enough to scan the range
+  for (const auto& key : keys) {
+    if (key_index_.count(key) > 0) {
+      scanned_keys_.insert(key);
+    }
+  }
+  for (auto it = scanned_keys_.lower_bound(prefix); it != scanned_keys_.end(); it++) {
+    if (it->compare(0, prefix.size(), prefix) != 0) {
+      break;
+    }
+    // Declared keys that do not exist in the storage have an empty value
+    const auto& value = txn_.keys(key_index_.at(*it)).value_entry().value();
+    if (!value.empty()) {
+      fn(*it, value);
+    }
+  }
+}
+
 bool TxnStorageAdapter::Insert(const std::string& key, std::string&& value) {
   CheckIndexSize();
   auto it = key_index_.find(key);
@@ -85,8 +179,9 @@ bool TxnStorageAdapter::Delete(std::string&& key) {
     key_index_[txn_.keys(i).key()] = i;
   }
   txn_.mutable_keys()->RemoveLast();
-  txn_.mutable_deleted_keys()->Add(std::move(key));
   key_index_.erase(it);
+  scanned_keys_.erase(key);
+  txn_.mutable_deleted_keys()->Add(std::move(key));
   return true;
 }
 
@@ -97,6 +192,12 @@ const std::string* TxnKeyGenStorageAdapter::Read(const std::string& key) {
   return nullptr;
 }
 
+void TxnKeyGenStorageAdapter::Scan(const std::string&, const std::vector<std::string>& keys, const ScanFn&) {
+  for (const auto& key : keys) {
+    NewReadKey(key);
+  }
+}
+
 bool TxnKeyGenStorageAdapter::Insert(const std::string& key, std::string&&) {
   NewWriteKey(key);
   return false;
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
 #include "common/types.h"
 #include "proto/transaction.pb.h"
+#include "storage/bulk_loader.h"
 #include "storage/metadata_initializer.h"
 #include "storage/storage.h"
 
@@ -10,8 +15,13 @@ namespace tpcc {
 
 class StorageAdapter {
  public:
+  using ScanFn = std::function<void(const std::string& key, const std::string& value)>;
+
   virtual ~StorageAdapter() = default;
   virtual const std::string* Read(const std::string& key) = 0;
+  // Calls fn in key order on every existing key that starts with prefix. keys must list all
+  // keys that the scan can possibly return so that they can be declared ahead of execution
+  virtual void Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) = 0;
   // Returns true if insertion succeeds
   virtual bool Insert(const std::string& key, std::string&& value) = 0;
   // Returns true if key exists before updating
@@ -27,22 +37,38 @@ class KVStorageAdapter : public StorageAdapter {
                    const std::shared_ptr<MetadataInitializer>& metadata_initializer);
   // This Read method is leaky. Only used for testing
   const std::string* Read(const std::string&) override;
+  void Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) override;
   bool Insert(const std::string& key, std::string&& value) override;
   bool Update(const std::string&, std::function<void(std::string&)>&&) override {
     throw std::runtime_error("Update is unimplemented in KVStorageAdapter");
   }
   bool Delete(std::string&&) override { throw std::runtime_error("Delete is unimplemented in KVStorageAdapter"); }
 
+  // Between these two calls, inserted records are buffered then bulk-loaded into the storage
+  // a chunk at a time. Inserts may come from multiple threads, each with its own buffer
+  void BeginBulkLoad();
+  void EndBulkLoad();
+
  private:
+  BulkLoader::Buffer& ThreadBuffer();
+
   std::shared_ptr<Storage> storage_;
   std::shared_ptr<MetadataInitializer> metadata_initializer_;
   std::vector<std::string> buffer_;
+
+  bool bulk_loading_;
+  std::unique_ptr<BulkLoader> bulk_loader_;
+  // Identifies the current bulk load among those of all adapters
+  uint64_t bulk_load_id_;
+  std::mutex bulk_mut_;
+  std::vector<std::unique_ptr<BulkLoader::Buffer>> bulk_buffers_;
 };
 
 class TxnStorageAdapter : public StorageAdapter {
  public:
   TxnStorageAdapter(Transaction& txn);
   const std::string* Read(const std::string& key) override;
+  void Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) override;
   bool Insert(const std::string& key, std::string&& value) override;
   bool Update(const std::string& key, std::function<void(std::string&)>&& update_fn) override;
   bool Delete(std::string&& key) override;
@@ -51,6 +77,8 @@ class TxnStorageAdapter : public StorageAdapter {
   void CheckIndexSize();
   Transaction& txn_;
   std::unordered_map<std::string, int> key_index_;
+  // Declared keys of the ranges scanned so far, in key order. Txns that do not scan never fill it
+  std::set<std::string> scanned_keys_;
 };
 
 class TxnKeyGenStorageAdapter : public StorageAdapter {
@@ -58,6 +86,7 @@ class TxnKeyGenStorageAdapter : public StorageAdapter {
   TxnKeyGenStorageAdapter(Transaction& txn);
 
   const std::string* Read(const std::string& key) override;
+  void Scan(const std::string& prefix, const std::vector<std::string>& keys, const ScanFn& fn) override;
   bool Insert(const std::string& key, std::string&& value) override;
   bool Update(const std::string& key, std::function<void(std::string&)>&& update_fn) override;
   bool Delete(std::string&& key) override;
@@ -41,8 +41,11 @@ class Table {
     if (storage_value == nullptr) {
       return {};
     }
+    return DecodeGrouped(pkey, storage_value->data(), columns);
+  }
 
-    auto encoded_columns = storage_value->data();
+  std::vector<ScalarPtr> DecodeGrouped(const std::vector<ScalarPtr>& pkey, const char* encoded_columns,
+                                       const std::vector<Column>& columns) {
     std::vector<ScalarPtr> result;
     result.reserve(columns.size());
 
@@ -106,6 +109,44 @@ class Table {
   }
 
  public:
+  /**
+   * Selects the rows whose primary key starts with pkey_prefix, which contains all but the last
+   * primary key column, and whose last primary key column is in [begin, end). The rows are
+   * returned in key order of the storage. Only supported for tables with grouped columns.
+   *
+   * Every key in the range is declared to the txn but only the existing rows are read, with a
+   * single range scan if the storage supports it.
+   */
+  std::vector<std::vector<ScalarPtr>> Scan(const std::vector<ScalarPtr>& pkey_prefix, int64_t begin, int64_t end,
+                                           const std::vector<Column>& columns = {}) {
+    CHECK(kGroupedColumns) << "Scan is only supported for tables with grouped columns";
+    CHECK_EQ(pkey_prefix.size(), kPKeySize - 1) << "Prefix must contain all but the last primary key column";
+
+    const auto& last_type = Schema::ColumnTypes[kPKeySize - 1];
+    auto pkey = pkey_prefix;
+    pkey.push_back(nullptr);
+    std::vector<std::string> storage_keys;
+    for (auto i = begin; i < end; i++) {
+      pkey.back() = MakeIntegerScalar(last_type, i);
+      storage_keys.push_back(MakeStorageKey(pkey));
+    }
+    auto prefix = MakeStorageKey(pkey_prefix, kPKeySize - 1);
+
+    std::vector<std::vector<ScalarPtr>> rows;
+    storage_adapter_->Scan(prefix, storage_keys, [&](const std::string& key, const std::string& value) {
+      // The last primary key column is encoded at the end of the storage key
+      if (key.size() != prefix.size() + last_type->size()) {
+        return;
+      }
+      pkey.back() = MakeScalar(last_type, reinterpret_cast<const void*>(key.data() + prefix.size()));
+      auto v = IntegerValue(pkey.back());
+      if (v >= begin && v < end) {
+        rows.push_back(DecodeGrouped(pkey, value.data(), columns));
+      }
+    });
+    return rows;
+  }
+
   bool Update(const std::vector<ScalarPtr>& pkey, const std::vector<Column>& columns,
               const std::vector<ScalarPtr>& values) {
     CHECK_EQ(columns.size(), values.size()) << "Number of values does not match number of columns";
@@ -240,10 +281,14 @@ class Table {
     return keys;
   }
 
-  inline static std::string MakeStorageKey(const std::vector<ScalarPtr>& values) {
-    CHECK_GE(values.size(), kPKeySize) << "Number of values needs to be equal or larger than primary key size";
+  /**
+   * If num_pkey_columns is less than the primary key size, the result is the prefix shared by the
+   * storage keys of all rows starting with these primary key columns
+   */
+  inline static std::string MakeStorageKey(const std::vector<ScalarPtr>& values, size_t num_pkey_columns = kPKeySize) {
+    CHECK_GE(values.size(), num_pkey_columns) << "Number of values needs to be equal or larger than primary key size";
     size_t storage_key_size = sizeof(TableId);
-    for (size_t i = 0; i < kPKeySize; i++) {
+    for (size_t i = 0; i < num_pkey_columns; i++) {
       ValidateType(values[i], static_cast<Column>(i));
       storage_key_size += values[i]->type->size();
     }
@@ -254,7 +299,7 @@ class Table {
     storage_key.append(reinterpret_cast<const char*>(values[0]->data()), values[0]->type->size());
     // Table id
     storage_key.append(reinterpret_cast<const char*>(&Schema::kId), sizeof(TableId));
-    for (size_t i = 1; i < kPKeySize; i++) {
+    for (size_t i = 1; i < num_pkey_columns; i++) {
       storage_key.append(reinterpret_cast<const char*>(values[i]->data()), values[i]->type->size());
     }
 
@@ -50,6 +50,8 @@ class NetworkedModule : public Module {
 
   void AddCustomSocket(zmq::socket_t&& new_socket);
   zmq::socket_t& GetCustomSocket(size_t i);
+  // Wakes up the module when the eventfd is signaled, which then calls OnCustomSocket
+  void AddCustomEventFd(int fd);
 
   inline static EnvelopePtr NewEnvelope() { return std::make_unique<internal::Envelope>(); }
   void Send(const internal::Envelope& env, MachineId to_machine_id, Channel to_channel);
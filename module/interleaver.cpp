@@ -268,14 +268,18 @@ void Interleaver::EmitBatch(BatchPtr&& batch) {
   VLOG(1) << "Processing batch " << batch->id() << " from global log";
 
   auto transactions = Unbatch(batch.get());
+  if (transactions.empty()) {
+    return;
+  }
+
+  // The whole batch is sent at once so that the scheduler can acquire the locks of its txns together
+  auto env = NewEnvelope();
+  auto forward_txns = env->mutable_request()->mutable_forward_txns();
   for (auto txn : transactions) {
     RECORD(txn->mutable_internal(), TransactionEvent::EXIT_INTERLEAVER);
-
-    auto env = NewEnvelope();
-    auto forward_txn = env->mutable_request()->mutable_forward_txn();
-    forward_txn->set_allocated_txn(txn);
-    Send(move(env), kSchedulerChannel);
+    forward_txns->mutable_txns()->AddAllocated(txn);
   }
+  Send(move(env), kSchedulerChannel);
 }
 
 }  // namespace slog
\ No newline at end of file
@@ -16,12 +16,63 @@ namespace slog {
 using internal::Request;
 using internal::Response;
 
+namespace {
+// Number of low bits of a version that order the txns dispatched at the same log position
+constexpr int kVersionSeqBits = 20;
+}  // namespace
+
 Scheduler::Scheduler(const shared_ptr<Broker>& broker, const shared_ptr<Storage>& storage,
                      const MetricsRepositoryManagerPtr& metrics_manager, std::chrono::milliseconds poll_timeout)
     : NetworkedModule(broker, {kSchedulerChannel, false /* recv_raw */}, metrics_manager, poll_timeout),
+      storage_(storage),
+      prefetch_(config()->storage_type() == internal::StorageType::TIERED),
+      track_versions_(config()->storage_type() == internal::StorageType::VERSIONED),
+      version_log_position_(0),
+      version_seq_(0),
+      last_version_(0),
+      applied_version_(0),
+      worker_dispatcher_(config(), config()->num_workers()),
+      last_storage_stats_time_(std::chrono::steady_clock::now()),
+      last_storage_num_reads_(0),
+      last_storage_num_writes_(0),
       global_log_counter_(0) {
   for (size_t i = 0; i < config()->num_workers(); i++) {
-    workers_.push_back(MakeRunnerFor<Worker>(i, broker, storage, metrics_manager, poll_timeout));
+    worker_queues_.push_back(std::make_shared<WorkerQueues>());
+  }
+  if (config()->work_stealing()) {
+    stealing_group_ = std::make_shared<WorkStealingGroup>(worker_queues_);
+  }
+  for (size_t i = 0; i < worker_queues_.size(); i++) {
+    workers_.push_back(
+        MakeRunnerFor<Worker>(i, worker_queues_[i], stealing_group_, broker, storage, metrics_manager, poll_timeout));
+  }
+  dispatch_backlogs_.resize(worker_queues_.size());
+
+  auto num_lock_manager_shards = config()->num_lock_manager_shards();
+#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
+  // The remaster manager sends txns to the lock manager at any time, which needs a single lock manager
+  if (num_lock_manager_shards > 1) {
+    LOG(WARNING) << "Lock manager shards are not available with the SIMPLE and PER_KEY remaster protocols";
+    num_lock_manager_shards = 1;
+  }
+#endif
+  if (num_lock_manager_shards == 1) {
+    lock_manager_ = std::make_unique<LockManager>();
+  } else {
+    for (uint32_t i = 0; i < num_lock_manager_shards; i++) {
+      lock_manager_shard_stats_.push_back(std::make_shared<LockShardStats>());
+      lock_manager_shards_.push_back(MakeRunnerFor<LockManagerShard>(
+          context(), LockShard(num_lock_manager_shards, i), lock_manager_shard_stats_[i], poll_timeout));
+    }
+  }
+
+  if (config()->numa_dispatch()) {
+    numa_storage_ = std::dynamic_pointer_cast<NumaStorage>(storage);
+    if (numa_storage_ == nullptr) {
+      LOG(WARNING) << "NUMA dispatch is only available with the NUMA storage type";
+    } else if (numa_storage_->topology().num_nodes() == 1) {
+      numa_storage_ = nullptr;
+    }
   }
 
 #if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
@@ -32,21 +83,47 @@ Scheduler::Scheduler(const shared_ptr<Broker>& broker, const shared_ptr<Storage>
 
 void Scheduler::Initialize() {
   auto cpus = config()->cpu_pinnings(ModuleId::WORKER);
-  size_t i = 0;
-  for (auto& worker : workers_) {
+  if (numa_storage_ != nullptr) {
+    workers_of_node_.resize(numa_storage_->topology().num_nodes());
+    next_worker_of_node_.resize(workers_of_node_.size(), 0);
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
     std::optional<uint32_t> cpu = {};
     if (i < cpus.size()) {
-      cpu = cpus[i++];
+      cpu = cpus[i];
+    }
+    if (numa_storage_ != nullptr) {
+      const auto& topology = numa_storage_->topology();
+      int node;
+      if (cpu.has_value()) {
+        node = topology.NodeOfCpu(cpu.value());
+      } else {
+        // Spread the workers without a pinning over the nodes
+        node = i % topology.num_nodes();
+        const auto& node_cpus = topology.cpus(node);
+        cpu = node_cpus[i / topology.num_nodes() % node_cpus.size()];
+      }
+      workers_of_node_[node].push_back(i);
     }
-    worker->StartInNewThread(cpu);
+    workers_[i]->StartInNewThread(cpu);
+
+    AddCustomEventFd(worker_queues_[i]->finished_txns.fd());
   }
 
-  zmq::socket_t worker_socket(*context(), ZMQ_DEALER);
-  worker_socket.set(zmq::sockopt::rcvhwm, 0);
-  worker_socket.set(zmq::sockopt::sndhwm, 0);
-  worker_socket.bind(MakeInProcChannelAddress(kWorkerChannel));
+  auto lock_manager_cpus = config()->cpu_pinnings(ModuleId::LOCKMANAGER);
+  for (size_t i = 0; i < lock_manager_shards_.size(); i++) {
+    std::optional<uint32_t> cpu = {};
+    if (i < lock_manager_cpus.size()) {
+      cpu = lock_manager_cpus[i];
+    }
+    lock_manager_shards_[i]->StartInNewThread(cpu);
 
-  AddCustomSocket(move(worker_socket));
+    zmq::socket_t shard_socket(*context(), ZMQ_DEALER);
+    shard_socket.set(zmq::sockopt::rcvhwm, 0);
+    shard_socket.set(zmq::sockopt::sndhwm, 0);
+    shard_socket.bind(MakeLockManagerShardAddress(i));
+    AddCustomSocket(move(shard_socket));
+  }
 }
 
 void Scheduler::OnInternalRequestReceived(EnvelopePtr&& env) {
@@ -54,6 +131,9 @@ void Scheduler::OnInternalRequestReceived(EnvelopePtr&& env) {
     case Request::kForwardTxn:
       ProcessTransaction(move(env));
       break;
+    case Request::kForwardTxns:
+      ProcessTransactions(move(env));
+      break;
     case Request::kStats:
       ProcessStatsRequest(env->request().stats());
       break;
@@ -63,47 +143,120 @@ void Scheduler::OnInternalRequestReceived(EnvelopePtr&& env) {
   }
 }
 
-// Handle responses from the workers
+// Handle responses from the workers and the lock manager shards
 bool Scheduler::OnCustomSocket() {
-  auto& worker_socket = GetCustomSocket(0);
   bool has_msg = false;
-  zmq::message_t msg;
-  while (worker_socket.recv(msg, zmq::recv_flags::dontwait)) {
+  vector<TxnHolder*> finished_holders;
+  vector<TxnId> finished_txns;
+  for (size_t i = 0; i < worker_queues_.size(); i++) {
+    for (SlotHandle handle; worker_queues_[i]->finished_txns.TryPop(handle);) {
+      auto txn_holder = active_txns_.Get(handle);
+      CHECK(txn_holder != nullptr) << "Finished txn is not active";
+      finished_holders.push_back(txn_holder);
+      finished_txns.push_back(txn_holder->txn_id());
+      // A stolen txn finishes on another worker than the one that it was dispatched to
+      worker_dispatcher_.OnFinished(txn_holder->worker());
+    }
+  }
+
+  if (!finished_txns.empty()) {
     has_msg = true;
-    auto txn_id = *msg.data<TxnId>();
-    // Release locks held by this txn then dispatch the txns that become ready thanks to this release.
-    auto unblocked_txns = lock_manager_.ReleaseLocks(txn_id);
-    for (auto unblocked_txn : unblocked_txns) {
-      Dispatch(unblocked_txn, false);
+    // Release locks held by these txns then dispatch the txns that become ready thanks to this release.
+    ReleaseLocks(finished_txns);
+    for (auto txn_holder : finished_holders) {
+      ProcessFinishedTxn(*txn_holder);
     }
+  }
 
-    VLOG(2) << "Released locks of txn " << txn_id;
+  zmq::message_t msg;
+  for (size_t i = 0; i < lock_manager_shards_.size(); i++) {
+    auto& shard_socket = GetCustomSocket(i);
+    while (shard_socket.recv(msg, zmq::recv_flags::dontwait)) {
+      has_msg = true;
+      auto is_fast = LockShardMessageOp(msg) == LockShardOp::ACQUIRE;
+      for (auto txn_id : LockShardMessageItems<TxnId>(msg)) {
+        ProcessReadyInLockShard(txn_id, is_fast);
+      }
+    }
+  }
 
-    auto it = active_txns_.find(txn_id);
-    CHECK(it != active_txns_.end());
-    auto& txn_holder = it->second;
+  for (size_t i = 0; i < dispatch_backlogs_.size(); i++) {
+    auto& backlog = dispatch_backlogs_[i];
+    while (!backlog.empty() && worker_queues_[i]->txns.TryPush(backlog.front())) {
+      backlog.pop_front();
+    }
+    // Keep looping without waiting for a new event until the backlog is pushed
+    has_msg |= !backlog.empty();
+  }
+
+  // Idle lock table entries are collected a few at a time so that no iteration stalls on it
+  if (lock_manager_ != nullptr) {
+    lock_manager_->CollectGarbage(kLockTableGCBatchSize);
+  }
+
+  return has_msg;
+}
+
+void Scheduler::ProcessFinishedTxn(TxnHolder& txn_holder) {
+  if (track_versions_) {
+    AdvanceAppliedVersion(txn_holder.version());
+  }
 
 #if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
-    auto remaster_result = txn_holder.remaster_result();
-    // If a remaster transaction, trigger any unblocked txns
-    if (remaster_result.has_value()) {
-      ProcessRemasterResult(remaster_manager_.RemasterOccured(remaster_result->first, remaster_result->second));
-    }
+  auto remaster_result = txn_holder.remaster_result();
+  // If a remaster transaction, trigger any unblocked txns
+  if (remaster_result.has_value()) {
+    ProcessRemasterResult(remaster_manager_.RemasterOccured(remaster_result->first, remaster_result->second));
+  }
 #endif /* defined(REMASTER_PROTOCOL_SIMPLE) || \
           defined(REMASTER_PROTOCOL_PER_KEY) */
 
-    txn_holder.SetDone();
+  txn_holder.SetDone();
 
-    if (txn_holder.is_ready_for_gc()) {
-      active_txns_.erase(it);
-    }
+  if (txn_holder.is_ready_for_gc()) {
+    active_txns_.erase(txn_holder.handle());
   }
-
-  return has_msg;
 }
 
 void Scheduler::ProcessTransaction(EnvelopePtr&& env) {
   auto txn = env->mutable_request()->mutable_forward_txn()->release_txn();
+  if (!AdmitTransaction(txn)) {
+    return;
+  }
+
+#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
+  SendToRemasterManager(*txn);
+#else
+  SendToLockManager(*txn);
+#endif
+}
+
+void Scheduler::ProcessTransactions(EnvelopePtr&& env) {
+  auto forward_txns = env->mutable_request()->mutable_forward_txns();
+  vector<Transaction*> txns(forward_txns->txns_size());
+  forward_txns->mutable_txns()->ExtractSubrange(0, txns.size(), txns.data());
+
+  vector<Transaction*> lockable_txns;
+  lockable_txns.reserve(txns.size());
+  for (auto txn : txns) {
+    if (!AdmitTransaction(txn)) {
+      continue;
+    }
+#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
+    // The remaster manager can send txns to the lock manager at any time, so the locks
+    // are acquired one txn at a time to keep them in the order of the log
+    SendToRemasterManager(*txn);
+#else
+    lockable_txns.push_back(txn);
+#endif
+  }
+
+  if (!lockable_txns.empty()) {
+    SendToLockManager(lockable_txns);
+  }
+}
+
+bool Scheduler::AdmitTransaction(Transaction* txn) {
   auto txn_id = txn->internal().id();
   auto ins = active_txns_.try_emplace(txn_id, config(), txn);
   auto holder_it = ins.first;
@@ -112,6 +265,8 @@ void Scheduler::ProcessTransaction(EnvelopePtr&& env) {
   global_log_counter_++;
 
   if (ins.second) {
+    holder.SetHandle(holder_it.handle());
+
     RECORD(holder.txn().mutable_internal(), TransactionEvent::ENTER_SCHEDULER);
 
     VLOG(2) << "Accepted " << ENUM_NAME(txn->internal().type(), TransactionType) << " transaction (" << txn_id << ", "
@@ -119,7 +274,7 @@ void Scheduler::ProcessTransaction(EnvelopePtr&& env) {
   } else {
     if (!holder.AddLockOnlyTxn(txn)) {
       LOG(ERROR) << "Already received txn: (" << txn_id << ", " << txn->internal().home() << ")";
-      return;
+      return false;
     }
 
     RECORD(holder.txn().mutable_internal(), TransactionEvent::ENTER_SCHEDULER_LO);
@@ -135,14 +290,14 @@ void Scheduler::ProcessTransaction(EnvelopePtr&& env) {
     if (holder.is_ready_for_gc()) {
       active_txns_.erase(holder_it);
     }
-    return;
+    return false;
   }
 
-#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
-  SendToRemasterManager(*txn);
-#else
-  SendToLockManager(*txn);
-#endif
+  if (prefetch_) {
+    Prefetch(*txn);
+  }
+
+  return true;
 }
 
 #if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
@@ -185,6 +340,15 @@ void Scheduler::ProcessRemasterResult(RemasterOccurredResult result) {
 #endif /* defined(REMASTER_PROTOCOL_SIMPLE) || \
           defined(REMASTER_PROTOCOL_PER_KEY) */
 
+void Scheduler::Prefetch(const Transaction& txn) {
+  std::vector<const Key*> keys;
+  keys.reserve(txn.keys_size());
+  for (const auto& kv : txn.keys()) {
+    keys.push_back(&kv.key());
+  }
+  storage_->Prefetch(keys);
+}
+
 void Scheduler::SendToLockManager(Transaction& txn) {
   auto txn_id = txn.internal().id();
 
@@ -192,9 +356,14 @@ void Scheduler::SendToLockManager(Transaction& txn) {
 
   RECORD(txn.mutable_internal(), TransactionEvent::ENTER_LOCK_MANAGER);
 
-  switch (lock_manager_.AcquireLocks(txn)) {
+  if (lock_manager_ == nullptr) {
+    SendToLockManager(vector<Transaction*>{&txn});
+    return;
+  }
+
+  switch (lock_manager_->AcquireLocks(txn)) {
     case AcquireLocksResult::ACQUIRED:
-      Dispatch(txn_id, true);
+      Dispatch(HandleOf(txn_id), true);
       break;
     case AcquireLocksResult::ABORT:
       TriggerPreDispatchAbort(txn_id);
@@ -208,9 +377,70 @@ void Scheduler::SendToLockManager(Transaction& txn) {
   }
 }
 
-void Scheduler::Dispatch(TxnId txn_id, bool is_fast) {
+void Scheduler::SendToLockManager(const vector<Transaction*>& txns) {
+  VLOG(2) << "Trying to acquire locks of " << txns.size() << " txns";
+
+#ifdef ENABLE_TXN_EVENT_RECORDING
+  for (auto txn : txns) {
+    RECORD(txn->mutable_internal(), TransactionEvent::ENTER_LOCK_MANAGER);
+  }
+#endif
+
+  if (lock_manager_ == nullptr) {
+    SendToLockManagerShards(MakeLockShardMessage(LockShardOp::ACQUIRE, txns));
+    return;
+  }
+
+  for (auto txn_id : lock_manager_->AcquireLocksBatch(txns)) {
+    Dispatch(HandleOf(txn_id), true);
+  }
+}
+
+void Scheduler::ReleaseLocks(const vector<TxnId>& txn_ids) {
+  if (lock_manager_ == nullptr) {
+    SendToLockManagerShards(MakeLockShardMessage(LockShardOp::RELEASE, txn_ids));
+    return;
+  }
+
+  for (auto txn_id : txn_ids) {
+    auto unblocked_txns = lock_manager_->ReleaseLocks(txn_id);
+    for (auto unblocked_txn : unblocked_txns) {
+      Dispatch(HandleOf(unblocked_txn), false);
+    }
+    VLOG(2) << "Released locks of txn " << txn_id;
+  }
+}
+
+void Scheduler::SendToLockManagerShards(zmq::message_t&& msg) {
+  for (size_t i = 0; i < lock_manager_shards_.size(); i++) {
+    // The copies share the same buffer
+    zmq::message_t copied;
+    copied.copy(msg);
+    GetCustomSocket(i).send(copied, zmq::send_flags::none);
+  }
+}
+
+void Scheduler::ProcessReadyInLockShard(TxnId txn_id, bool is_fast) {
   auto it = active_txns_.find(txn_id);
+  // A txn aborted before being dispatched releases its locks without waiting for the other shards
+  if (it == active_txns_.end() || it->second.is_aborting()) {
+    return;
+  }
   auto& txn_holder = it->second;
+  txn_holder.AddReadyLockShard(is_fast);
+  if (txn_holder.num_ready_lock_shards() == lock_manager_shards_.size()) {
+    Dispatch(txn_holder.handle(), !txn_holder.waited_for_lock_shard());
+  }
+}
+
+SlotHandle Scheduler::HandleOf(TxnId txn_id) {
+  auto it = active_txns_.find(txn_id);
+  DCHECK(it != active_txns_.end()) << "Txn " << txn_id << " is not active";
+  return it->second.handle();
+}
+
+void Scheduler::Dispatch(SlotHandle handle, bool is_fast) {
+  auto& txn_holder = *active_txns_.Get(handle);
 
   if (is_fast) {
     RECORD(txn_holder.txn().mutable_internal(), TransactionEvent::DISPATCHED_FAST);
@@ -220,11 +450,67 @@ void Scheduler::Dispatch(TxnId txn_id, bool is_fast) {
 
   txn_holder.IncNumDispatches();
 
-  zmq::message_t msg(sizeof(TxnHolder*));
-  *msg.data<TxnHolder*>() = &txn_holder;
-  GetCustomSocket(0).send(msg, zmq::send_flags::none);
+  if (track_versions_ && txn_holder.version() == 0) {
+    AssignVersion(txn_holder);
+  }
+
+  auto worker = SelectWorker(txn_holder.txn());
+  txn_holder.SetWorker(worker);
+  worker_dispatcher_.OnDispatched(worker);
+  if (stealing_group_ != nullptr) {
+    worker_queues_[worker]->ready_txns.Push(&txn_holder);
+    stealing_group_->Signal();
+  } else if (auto& backlog = dispatch_backlogs_[worker];
+             !backlog.empty() || !worker_queues_[worker]->txns.TryPush(&txn_holder)) {
+    backlog.push_back(&txn_holder);
+  }
+
+  VLOG(2) << "Dispatched txn " << txn_holder.txn_id();
+}
+
+size_t Scheduler::SelectWorker(const Transaction& txn) {
+  if (numa_storage_ != nullptr) {
+    std::vector<int> keys_of_node(workers_of_node_.size(), 0);
+    for (const auto& kv : txn.keys()) {
+      keys_of_node[numa_storage_->NodeOf(kv.key())]++;
+    }
+    auto node = std::max_element(keys_of_node.begin(), keys_of_node.end()) - keys_of_node.begin();
+    // Fall back to any worker if the node has none
+    if (const auto& workers = workers_of_node_[node]; !workers.empty()) {
+      return workers[next_worker_of_node_[node]++ % workers.size()];
+    }
+  }
+  return worker_dispatcher_.Select(txn);
+}
+
+/**
+ * Versions are assigned at dispatch time instead of being the log positions of the txns because
+ * a txn is only dispatched once it holds all of its locks, so conflicting txns are stamped in the
+ * order in which they write. The log positions of the lock-only txns of a multi-home txn do not
+ * always follow that order. A version keeps the current log position in its high bits and counts
+ * the txns dispatched at the same log position, e.g. after a lock release, in its low bits.
+ */
+void Scheduler::AssignVersion(TxnHolder& txn_holder) {
+  if (global_log_counter_ != version_log_position_) {
+    version_log_position_ = global_log_counter_;
+    version_seq_ = 0;
+  }
+  version_seq_++;
+  CHECK_LT(version_seq_, 1LL << kVersionSeqBits) << "Too many txns dispatched at log position " << global_log_counter_;
+  last_version_ = (version_log_position_ << kVersionSeqBits) | version_seq_;
+  txn_holder.SetVersion(last_version_);
+  inflight_versions_.insert(last_version_);
+}
 
-  VLOG(2) << "Dispatched txn " << txn_id;
+void Scheduler::AdvanceAppliedVersion(int64_t finished_version) {
+  inflight_versions_.erase(finished_version);
+  // Every version below the oldest in-flight one has been applied and versions
+  // assigned from now on are higher than the last assigned one
+  auto applied_version = inflight_versions_.empty() ? last_version_ : *inflight_versions_.begin() - 1;
+  if (applied_version > applied_version_) {
+    applied_version_ = applied_version;
+    storage_->SetAppliedVersion(applied_version);
+  }
 }
 
 // Disable pre-dispatch abort when DDR is used. Removing this method is sufficient to disable the
@@ -258,14 +544,11 @@ void Scheduler::TriggerPreDispatchAbort(TxnId txn_id) {
 
   // Release locks held by this txn. Enqueue the txns that
   // become ready thanks to this release.
-  auto unblocked_txns = lock_manager_.ReleaseLocks(txn_id);
-  for (auto unblocked_txn : unblocked_txns) {
-    Dispatch(unblocked_txn, false);
-  }
+  ReleaseLocks({txn_id});
 
   // Let a worker handle notifying other partitions and send back to the server.
   txn.set_status(TransactionStatus::ABORTED);
-  Dispatch(txn_id, false);
+  Dispatch(txn_holder.handle(), false);
 }
 #endif /* LOCK_MANAGER_DDR */
 
@@ -283,7 +566,15 @@ void Scheduler::TriggerPreDispatchAbort(TxnId txn_id) {
  *      },
  *      ...
  *    ],
- *    ...<stats from lock manager>...
+ *    worker_queue_depths: [
+ *      [<worker>, <number of txns in flight>, <number of txns waiting for room in the queue>],
+ *      ...
+ *    ],
+ *    num_rebalanced_dispatches: <number of txns sent to the least loaded worker instead of the worker of their key>,
+ *    num_stolen_txns: <number of txns run by another worker than their own, only with work stealing>,
+ *    num_lock_manager_shards: <int>,
+ *    ...<stats from lock manager, or the level 0 stats totaled over the lock manager shards>...
+ *    ...<stats from storage, if it keeps any>...
  * }
  */
 void Scheduler::ProcessStatsRequest(const internal::StatsRequest& stats_request) {
@@ -322,8 +613,50 @@ void Scheduler::ProcessStatsRequest(const internal::StatsRequest& stats_request)
     stats.AddMember(StringRef(ALL_TXNS), txns, alloc);
   }
 
-  // Add stats from the lock manager
-  lock_manager_.GetStats(stats, level);
+  rapidjson::Value worker_queue_depths(rapidjson::kArrayType);
+  for (size_t i = 0; i < workers_.size(); i++) {
+    rapidjson::Value entry(rapidjson::kArrayType);
+    entry.PushBack(i, alloc)
+        .PushBack(worker_dispatcher_.num_inflight(i), alloc)
+        .PushBack(dispatch_backlogs_[i].size(), alloc);
+    worker_queue_depths.PushBack(entry, alloc);
+  }
+  stats.AddMember(StringRef(WORKER_QUEUE_DEPTHS), worker_queue_depths, alloc);
+  stats.AddMember(StringRef(NUM_REBALANCED_DISPATCHES), worker_dispatcher_.num_rebalanced(), alloc);
+  if (stealing_group_ != nullptr) {
+    stats.AddMember(StringRef(NUM_STOLEN_TXNS), stealing_group_->num_stolen(), alloc);
+  }
+  uint64_t num_remote_read_results = 0, num_remote_read_messages = 0;
+  for (const auto& queues : worker_queues_) {
+    num_remote_read_results += queues->num_remote_read_results.load(std::memory_order_relaxed);
+    num_remote_read_messages += queues->num_remote_read_messages.load(std::memory_order_relaxed);
+  }
+  stats.AddMember(StringRef(NUM_REMOTE_READ_RESULTS), num_remote_read_results, alloc);
+  stats.AddMember(StringRef(NUM_REMOTE_READ_MESSAGES), num_remote_read_messages, alloc);
+
+  // Add stats from the lock manager. The lock manager shards keep their state in their own threads
+  // so only the totals that they publish are reported for them
+  stats.AddMember(StringRef(NUM_LOCK_MANAGER_SHARDS), std::max<size_t>(lock_manager_shards_.size(), 1), alloc);
+  if (lock_manager_ != nullptr) {
+    lock_manager_->GetStats(stats, level);
+  } else {
+    uint64_t num_txns_waiting_for_lock = 0, num_locked_keys = 0, lock_table_size = 0;
+    for (const auto& shard_stats : lock_manager_shard_stats_) {
+      // Every shard keeps track of every txn, so the txns are not added up across the shards
+      num_txns_waiting_for_lock =
+          std::max(num_txns_waiting_for_lock, shard_stats->num_txns_waiting_for_lock.load(std::memory_order_relaxed));
+      num_locked_keys += shard_stats->num_locked_keys.load(std::memory_order_relaxed);
+      lock_table_size += shard_stats->lock_table_size.load(std::memory_order_relaxed);
+    }
+    auto lock_manager_type = lock_manager_shard_stats_.front()->lock_manager_type.load(std::memory_order_relaxed);
+    stats.AddMember(StringRef(LOCK_MANAGER_TYPE), lock_manager_type, alloc);
+    stats.AddMember(StringRef(NUM_TXNS_WAITING_FOR_LOCK), num_txns_waiting_for_lock, alloc);
+    stats.AddMember(StringRef(NUM_LOCKED_KEYS), num_locked_keys, alloc);
+    stats.AddMember(StringRef(LOCK_TABLE_SIZE), lock_table_size, alloc);
+  }
+
+  // Add stats from the storage
+  AddStorageStats(stats, level);
 
   // Write JSON object to a buffer and send back to the server
   rapidjson::StringBuffer buf;
@@ -335,4 +668,83 @@ void Scheduler::ProcessStatsRequest(const internal::StatsRequest& stats_request)
   env->mutable_response()->mutable_stats()->set_stats_json(buf.GetString());
   Send(move(env), kServerChannel);
 }
+
+/**
+ * {
+ *    storage_num_nodes: <number of entries in the hash maps>,
+ *    storage_bytes: <int>,
+ *    storage_max_segment_bytes: <int>,
+ *    storage_num_rehashes: <int>,
+ *    storage_rehash_ns: <int>,
+ *    storage_num_latch_waits: <int>,
+ *    storage_latch_wait_ns: <int>,
+ *    storage_num_reads: <int>,
+ *    storage_num_writes: <int>,
+ *    storage_reads_per_sec: <reads per second since the previous stats request>,
+ *    storage_writes_per_sec: <writes per second since the previous stats request>,
+ *    storage_segments (lvl >= 1): [
+ *      [<segment index>, <num nodes>, <num buckets>, <bytes>, <num rehashes>, <rehash ns>,
+ *       <num latch waits>, <latch wait ns>],
+ *      ...
+ *    ]
+ * }
+ */
+void Scheduler::AddStorageStats(rapidjson::Document& stats, uint32_t level) {
+  using rapidjson::StringRef;
+
+  StorageStats storage_stats;
+  if (!storage_->GetStats(storage_stats)) {
+    return;
+  }
+
+  SegmentStats total;
+  size_t max_segment_bytes = 0;
+  for (const auto& segment : storage_stats.segments) {
+    total += segment;
+    max_segment_bytes = std::max(max_segment_bytes, segment.bytes);
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_sec = std::chrono::duration<double>(now - last_storage_stats_time_).count();
+  double reads_per_sec = (storage_stats.num_reads - last_storage_num_reads_) / elapsed_sec;
+  double writes_per_sec = (storage_stats.num_writes - last_storage_num_writes_) / elapsed_sec;
+  last_storage_stats_time_ = now;
+  last_storage_num_reads_ = storage_stats.num_reads;
+  last_storage_num_writes_ = storage_stats.num_writes;
+
+  auto& alloc = stats.GetAllocator();
+  stats.AddMember(StringRef(STORAGE_NUM_NODES), total.num_nodes, alloc)
+      .AddMember(StringRef(STORAGE_BYTES), total.bytes, alloc)
+      .AddMember(StringRef(STORAGE_MAX_SEGMENT_BYTES), max_segment_bytes, alloc)
+      .AddMember(StringRef(STORAGE_NUM_REHASHES), total.num_rehashes, alloc)
+      .AddMember(StringRef(STORAGE_REHASH_NS), total.rehash_ns, alloc)
+      .AddMember(StringRef(STORAGE_NUM_LATCH_WAITS), total.num_latch_waits, alloc)
+      .AddMember(StringRef(STORAGE_LATCH_WAIT_NS), total.latch_wait_ns, alloc)
+      .AddMember(StringRef(STORAGE_NUM_READS), storage_stats.num_reads, alloc)
+      .AddMember(StringRef(STORAGE_NUM_WRITES), storage_stats.num_writes, alloc)
+      .AddMember(StringRef(STORAGE_READS_PER_SEC), reads_per_sec, alloc)
+      .AddMember(StringRef(STORAGE_WRITES_PER_SEC), writes_per_sec, alloc);
+
+  if (level >= 1) {
+    rapidjson::Value segments(rapidjson::kArrayType);
+    for (size_t i = 0; i < storage_stats.segments.size(); i++) {
+      const auto& segment = storage_stats.segments[i];
+      if (segment.num_buckets == 0) {
+        continue;
+      }
+      rapidjson::Value entry(rapidjson::kArrayType);
+      entry.PushBack(i, alloc)
+          .PushBack(segment.num_nodes, alloc)
+          .PushBack(segment.num_buckets, alloc)
+          .PushBack(segment.bytes, alloc)
+          .PushBack(segment.num_rehashes, alloc)
+          .PushBack(segment.rehash_ns, alloc)
+          .PushBack(segment.num_latch_waits, alloc)
+          .PushBack(segment.latch_wait_ns, alloc);
+      segments.PushBack(move(entry), alloc);
+    }
+    stats.AddMember(StringRef(STORAGE_SEGMENTS), move(segments), alloc);
+  }
+}
+
 }  // namespace slog
\ No newline at end of file
@@ -2,18 +2,24 @@
 
 #include <glog/logging.h>
 
-#include <unordered_map>
+#include <deque>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
 #include "common/configuration.h"
+#include "common/json_utils.h"
 #include "common/metrics.h"
 #include "common/types.h"
 #include "connection/broker.h"
 #include "connection/sender.h"
 #include "data_structure/batch_log.h"
+#include "data_structure/slot_pool.h"
+#include "module/scheduler_components/lock_manager_shard.h"
 #include "module/scheduler_components/txn_holder.h"
 #include "module/scheduler_components/worker.h"
+#include "module/scheduler_components/worker_dispatcher.h"
+#include "storage/numa_storage.h"
 #include "storage/storage.h"
 
 #if defined(REMASTER_PROTOCOL_SIMPLE)
@@ -30,14 +36,6 @@
 #error "COUNTERLESS remaster protocol is not compatible with OLD lock manager"
 #endif
 
-#if defined(LOCK_MANAGER_OLD)
-#include "module/scheduler_components/old_lock_manager.h"
-#elif defined(LOCK_MANAGER_DDR)
-#include "module/scheduler_components/ddr_lock_manager.h"
-#else
-#include "module/scheduler_components/rma_lock_manager.h"
-#endif
-
 namespace slog {
 
 class Scheduler : public NetworkedModule {
@@ -58,7 +56,13 @@ class Scheduler : public NetworkedModule {
 
  private:
   void ProcessTransaction(EnvelopePtr&& env);
+  // Processes all txns of a batch from the interleaver, acquiring their locks at once
+  void ProcessTransactions(EnvelopePtr&& env);
+  // Adds a txn or lock-only txn to the active txns. Returns false if it must not go any further
+  bool AdmitTransaction(Transaction* txn);
+  void ProcessFinishedTxn(TxnHolder& txn_holder);
   void ProcessStatsRequest(const internal::StatsRequest& stats_request);
+  void AddStorageStats(rapidjson::Document& stats, uint32_t level);
 
 #if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY)
   // Send single-home and lock-only transactions for counter checking
@@ -67,11 +71,30 @@ class Scheduler : public NetworkedModule {
   void ProcessRemasterResult(RemasterOccurredResult result);
 #endif
 
+  // Ask the storage to load the records of txn while it waits for its locks
+  void Prefetch(const Transaction& txn);
+
   // Send all transactions for locks
   void SendToLockManager(Transaction& txn);
-
+  void SendToLockManager(const std::vector<Transaction*>& txns);
+  // Release the locks of finished or aborted txns and dispatch the txns that get all of their locks
+  void ReleaseLocks(const std::vector<TxnId>& txn_ids);
+  // Send the same message to every lock manager shard
+  void SendToLockManagerShards(zmq::message_t&& msg);
+  // Dispatch a txn once all lock manager shards have found it holding its locks
+  void ProcessReadyInLockShard(TxnId txn_id, bool is_fast);
+
+  // Looks up the handle of an active txn whose id comes from the lock manager
+  SlotHandle HandleOf(TxnId txn_id);
   // Send txn to worker
-  void Dispatch(TxnId txn_id, bool is_fast);
+  void Dispatch(SlotHandle handle, bool is_fast);
+  // Returns the index of the worker that will run txn
+  size_t SelectWorker(const Transaction& txn);
+
+  // Stamp a txn that is about to be dispatched with the next version
+  void AssignVersion(TxnHolder& txn_holder);
+  // Publish the new applied version to the storage once a dispatched txn is done
+  void AdvanceAppliedVersion(int64_t finished_version);
 
   /**
    * Aborts
@@ -93,20 +116,46 @@ class Scheduler : public NetworkedModule {
   PerKeyRemasterManager remaster_manager_;
 #endif
 
-#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY) || \
-    (defined(LOCK_MANAGER_OLD) && !defined(REMASTER_PROTOCOL_COUNTERLESS))
-  OldLockManager lock_manager_;
-#elif defined(LOCK_MANAGER_DDR)
-  DDRLockManager lock_manager_;
-#else
-  RMALockManager lock_manager_;
-#endif
-
-  std::unordered_map<TxnId, TxnHolder> active_txns_;
-
-  // This must be defined at the end so that the workers exit before any resources
-  // in the scheduler is destroyed
+  // Only set if the locks are managed in the scheduler thread instead of the lock manager shards
+  std::unique_ptr<LockManager> lock_manager_;
+
+  std::shared_ptr<Storage> storage_;
+  // Only prefetch if the storage might have to load the records from disk
+  bool prefetch_;
+
+  // Versions are only tracked if the storage keeps multiple versions of the records
+  bool track_versions_;
+  int64_t version_log_position_;
+  int64_t version_seq_;
+  int64_t last_version_;
+  int64_t applied_version_;
+  std::set<int64_t> inflight_versions_;
+
+  // Workers hand back the handles of the finished txns, which skip the lookup by txn id
+  SlotMap<TxnId, TxnHolder> active_txns_;
+
+  // Only set if txns are dispatched to the workers of the NUMA node that owns most of their keys
+  std::shared_ptr<NumaStorage> numa_storage_;
+  std::vector<std::vector<size_t>> workers_of_node_;
+  std::vector<size_t> next_worker_of_node_;
+  WorkerDispatcher worker_dispatcher_;
+
+  std::vector<std::shared_ptr<WorkerQueues>> worker_queues_;
+  // Only set if work stealing is enabled
+  std::shared_ptr<WorkStealingGroup> stealing_group_;
+  // Txns that did not fit in the queue to each worker, in dispatch order
+  std::vector<std::deque<TxnHolder*>> dispatch_backlogs_;
+
+  // Used to compute the rate of storage operations between two stats requests
+  std::chrono::steady_clock::time_point last_storage_stats_time_;
+  uint64_t last_storage_num_reads_;
+  uint64_t last_storage_num_writes_;
+
+  // These must be defined at the end so that the workers and lock manager shards exit before
+  // any resources in the scheduler is destroyed
   std::vector<std::unique_ptr<ModuleRunner>> workers_;
+  std::vector<std::unique_ptr<ModuleRunner>> lock_manager_shards_;
+  std::vector<std::shared_ptr<LockShardStats>> lock_manager_shard_stats_;
 
   int64_t global_log_counter_;
 };
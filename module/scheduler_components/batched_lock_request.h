@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common/types.h"
+#include "module/scheduler_components/key_interner.h"
+
+namespace slog {
+
+/**
+ * A lock request made by a txn of a batch passed to AcquireLocksBatch
+ */
+template <typename LockKey>
+struct BatchedLockRequest {
+  BatchedLockRequest(LockKey key, size_t txn_index, KeyType type) : key(key), txn_index(txn_index), type(type) {}
+
+  LockKey key;
+  // Bucket of the key in the lock table
+  size_t bucket = 0;
+  // Position of the requesting txn in the batch
+  size_t txn_index;
+  KeyType type;
+};
+
+inline const Key& LockTableKey(const Key* key) { return *key; }
+inline KeyId LockTableKey(KeyId key) { return key; }
+
+/**
+ * Sorts the requests by the bucket of their key in the lock table, then by key, so that the lock
+ * table is visited in bucket order with a single lookup per key. Requests of the same key keep
+ * the order of their txns in the batch. Since the state of a lock only depends on the order of
+ * its own requests, applying them in this order gives the same result as acquiring the locks txn
+ * by txn. The lock table is grown first so that inserting the new keys does not move the buckets
+ */
+template <typename LockKey, typename LockTable>
+void SortByBucket(std::vector<BatchedLockRequest<LockKey>>& requests, LockTable& lock_table) {
+  lock_table.reserve(lock_table.size() + requests.size());
+  for (auto& request : requests) {
+    request.bucket = lock_table.bucket(LockTableKey(request.key));
+  }
+  std::stable_sort(requests.begin(), requests.end(), [](const auto& a, const auto& b) {
+    if (a.bucket != b.bucket) {
+      return a.bucket < b.bucket;
+    }
+    return LockTableKey(a.key) < LockTableKey(b.key);
+  });
+}
+
+}  // namespace slog
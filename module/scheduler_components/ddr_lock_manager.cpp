@@ -2,6 +2,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 using std::make_pair;
 using std::move;
 
@@ -26,9 +28,10 @@ vector<TxnId> LockQueueTail::AcquireWriteLock(TxnId txn_id) {
   return deps;
 }
 
-DDRLockManager::DDRLockManager() {
-  lock_table_.reserve(25000000);
-  txn_info_.reserve(1000000);
+DDRLockManager::DDRLockManager(const LockShard& shard, size_t max_idle_entries)
+    : shard_(shard), key_interner_(max_idle_entries), idle_candidates_(max_idle_entries) {
+  lock_table_.reserve(25000000 / shard.num_shards());
+  txn_info_.reserve(kLockManagerInitialNumTxns);
 }
 
 AcquireLocksResult DDRLockManager::AcquireLocks(const Transaction& txn) {
@@ -48,36 +51,111 @@ AcquireLocksResult DDRLockManager::AcquireLocks(const Transaction& txn) {
       continue;
     }
     ++num_relevant_locks;
+    if (!shard_.Contains(kv.key())) {
+      continue;
+    }
+
+    auto key_id = key_interner_.Intern(kv.key(), home);
+    auto& lock_queue_tail = GetOrCreateLockQueueTail(key_id);
+    AcquireLock(lock_queue_tail, txn_id, kv.value_entry().type(), blocking_txns);
+    ins.first->second.keys.push_back(key_id);
+  }
+
+  auto& txn_info = ins.first->second;
+  txn_info.unarrived_lock_requests -= num_relevant_locks;
+  AddWaitedByEdges(txn_id, txn_info, blocking_txns);
+
+  if (txn_info.is_ready()) {
+    return AcquireLocksResult::ACQUIRED;
+  }
+  return AcquireLocksResult::WAITING;
+}
 
-    auto key_replica = MakeKeyReplica(kv.key(), home);
-    auto& lock_queue_tail = lock_table_[key_replica];
+vector<TxnId> DDRLockManager::AcquireLocksBatch(const vector<Transaction*>& txns) {
+  vector<TxnInfo*> txn_infos;
+  txn_infos.reserve(txns.size());
+  vector<int> num_relevant_locks(txns.size(), 0);
+  vector<BatchedLockRequest<KeyId>> requests;
+  for (size_t i = 0; i < txns.size(); i++) {
+    const auto& txn = *txns[i];
+    auto home = txn.internal().home();
+    auto is_remaster = txn.program_case() == Transaction::kRemaster;
+    auto num_required_locks = is_remaster ? 2 : txn.keys_size();
+    txn_infos.push_back(&txn_info_.try_emplace(txn.internal().id(), num_required_locks).first->second);
 
-    switch (kv.value_entry().type()) {
-      case KeyType::READ: {
-        auto b_txn = lock_queue_tail.AcquireReadLock(txn_id);
-        if (b_txn.has_value()) {
-          blocking_txns.push_back(b_txn.value());
-        }
-        break;
+    for (const auto& kv : txn.keys()) {
+      if (!is_remaster && static_cast<int>(kv.value_entry().metadata().master()) != home) {
+        continue;
       }
-      case KeyType::WRITE: {
-        auto b_txns = lock_queue_tail.AcquireWriteLock(txn_id);
-        blocking_txns.insert(blocking_txns.end(), b_txns.begin(), b_txns.end());
-        break;
+      ++num_relevant_locks[i];
+      if (!shard_.Contains(kv.key())) {
+        continue;
       }
-      default:
-        LOG(FATAL) << "Invalid lock mode";
+      requests.emplace_back(key_interner_.Intern(kv.key(), home), i, kv.value_entry().type());
     }
   }
 
+  SortByBucket(requests, lock_table_);
+
+  // A txn is only blocked by txns requesting the same lock before it, which have all been
+  // added to txn_info_ above, so the edges can be added after the whole batch is applied
+  vector<vector<TxnId>> blocking_txns(txns.size());
+  for (size_t start = 0, end; start < requests.size(); start = end) {
+    auto key_id = requests[start].key;
+    auto& lock_queue_tail = GetOrCreateLockQueueTail(key_id);
+    for (end = start; end < requests.size() && requests[end].key == key_id; end++) {
+      auto txn_index = requests[end].txn_index;
+      AcquireLock(lock_queue_tail, txns[txn_index]->internal().id(), requests[end].type, blocking_txns[txn_index]);
+      txn_infos[txn_index]->keys.push_back(key_id);
+    }
+  }
+
+  for (size_t i = 0; i < txns.size(); i++) {
+    txn_infos[i]->unarrived_lock_requests -= num_relevant_locks[i];
+    AddWaitedByEdges(txns[i]->internal().id(), *txn_infos[i], blocking_txns[i]);
+  }
+
+  vector<TxnId> result;
+  for (size_t i = 0; i < txns.size(); i++) {
+    if (txn_infos[i]->is_ready()) {
+      result.push_back(txns[i]->internal().id());
+    }
+  }
+
+  // The lock-only txns of a multi-home txn might be in the same batch
+  std::sort(result.begin(), result.end());
+  auto last = std::unique(result.begin(), result.end());
+  result.erase(last, result.end());
+
+  return result;
+}
+
+void DDRLockManager::AcquireLock(LockQueueTail& lock_queue_tail, TxnId txn_id, KeyType type,
+                                 vector<TxnId>& blocking_txns) {
+  switch (type) {
+    case KeyType::READ: {
+      auto b_txn = lock_queue_tail.AcquireReadLock(txn_id);
+      if (b_txn.has_value()) {
+        blocking_txns.push_back(b_txn.value());
+      }
+      break;
+    }
+    case KeyType::WRITE: {
+      auto b_txns = lock_queue_tail.AcquireWriteLock(txn_id);
+      blocking_txns.insert(blocking_txns.end(), b_txns.begin(), b_txns.end());
+      break;
+    }
+    default:
+      LOG(FATAL) << "Invalid lock mode";
+  }
+}
+
+void DDRLockManager::AddWaitedByEdges(TxnId txn_id, TxnInfo& txn_info, vector<TxnId>& blocking_txns) {
   // Deduplicate the blocking txns list. We throw away this list eventually
   // so there is no need to erase the extra values at the tail
   std::sort(blocking_txns.begin(), blocking_txns.end());
   auto last = std::unique(blocking_txns.begin(), blocking_txns.end());
 
-  auto& txn_info = ins.first->second;
-  txn_info.unarrived_lock_requests -= num_relevant_locks;
-
   // Add current txn to the waited_by list of each blocking txn
   for (auto b_txn = blocking_txns.begin(); b_txn != last; b_txn++) {
     if (*b_txn == txn_id) {
@@ -97,11 +175,6 @@ AcquireLocksResult DDRLockManager::AcquireLocks(const Transaction& txn) {
     txn_info.waiting_for_cnt++;
     b_txn_info->second.waited_by.push_back(txn_id);
   }
-
-  if (txn_info.is_ready()) {
-    return AcquireLocksResult::ACQUIRED;
-  }
-  return AcquireLocksResult::WAITING;
 }
 
 vector<TxnId> DDRLockManager::ReleaseLocks(TxnId txn_id) {
@@ -129,10 +202,45 @@ vector<TxnId> DDRLockManager::ReleaseLocks(TxnId txn_id) {
       result.push_back(blocked_txn_id);
     }
   }
+  // The lock queue tails that this txn is in might have become idle
+  idle_candidates_.Add(txn_info.keys.begin(), txn_info.keys.end());
   txn_info_.erase(txn_id);
   return result;
 }
 
+LockQueueTail& DDRLockManager::GetOrCreateLockQueueTail(KeyId key_id) {
+  auto ins = lock_table_.try_emplace(key_id);
+  if (ins.second) {
+    key_interner_.Retain(key_id);
+  }
+  return ins.first->second;
+}
+
+bool DDRLockManager::IsIdle(const LockQueueTail& lock_queue_tail) const {
+  auto write_lock_requester = lock_queue_tail.write_lock_requester();
+  if (write_lock_requester.has_value() && txn_info_.count(write_lock_requester.value())) {
+    return false;
+  }
+  for (auto txn_id : lock_queue_tail.read_lock_requesters()) {
+    if (txn_info_.count(txn_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t DDRLockManager::CollectGarbage(size_t max_entries) {
+  // An entry that is not idle is queued again when one of its requesters releases its locks
+  auto is_idle = [this](const LockQueueTail& lock_queue_tail) { return IsIdle(lock_queue_tail); };
+  return idle_candidates_.Collect(lock_table_, key_interner_, is_idle, max_entries);
+}
+
+void DDRLockManager::PublishStats(LockShardStats& stats) const {
+  stats.lock_manager_type.store(1, std::memory_order_relaxed);
+  stats.num_txns_waiting_for_lock.store(txn_info_.size(), std::memory_order_relaxed);
+  stats.lock_table_size.store(lock_table_.size(), std::memory_order_relaxed);
+}
+
 /**
  * {
  *    lock_manager_type: 1,
@@ -141,6 +249,7 @@ vector<TxnId> DDRLockManager::ReleaseLocks(TxnId txn_id) {
  *      [<txn id>, [<waited by txn id>, ...]],
  *      ...
  *    ],
+ *    lock_table_size: <number of entries in the lock table>,
  *    lock_table (lvl >= 2): [
  *      [
  *        <key>,
@@ -169,12 +278,14 @@ void DDRLockManager::GetStats(rapidjson::Document& stats, uint32_t level) const
     stats.AddMember(StringRef(WAITED_BY_GRAPH), move(waited_by_graph), alloc);
   }
 
+  stats.AddMember(StringRef(LOCK_TABLE_SIZE), lock_table_.size(), alloc);
+
   if (level >= 2) {
     // Collect data from lock tables
     rapidjson::Value lock_table(rapidjson::kArrayType);
-    for (const auto& [key, lock_state] : lock_table_) {
+    for (const auto& [key_id, lock_state] : lock_table_) {
       rapidjson::Value entry(rapidjson::kArrayType);
-      rapidjson::Value key_json(key.c_str(), alloc);
+      rapidjson::Value key_json(key_interner_.ToKeyReplica(key_id).c_str(), alloc);
       entry.PushBack(key_json, alloc)
           .PushBack(lock_state.write_lock_requester().value_or(0), alloc)
           .PushBack(ToJsonArray(lock_state.read_lock_requesters(), alloc), alloc);
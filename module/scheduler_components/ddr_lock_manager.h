@@ -16,6 +16,11 @@
 #include "common/constants.h"
 #include "common/json_utils.h"
 #include "common/types.h"
+#include "data_structure/slot_pool.h"
+#include "module/scheduler_components/batched_lock_request.h"
+#include "module/scheduler_components/key_interner.h"
+#include "module/scheduler_components/lock_shard.h"
+#include "module/scheduler_components/lock_table_gc.h"
 #include "module/scheduler_components/txn_holder.h"
 
 using std::list;
@@ -66,11 +71,18 @@ class LockQueueTail {
  * master metadata. The masters are checked in the worker, so if two
  * transactions hold separate locks for the same key, then one has an
  * incorrect master and will be aborted. Remaster transactions request the
- * locks for both <key, old replica> and <key, new replica>.
+ * locks for both <key, old replica> and <key, new replica>. The tuples
+ * are interned into integer ids when a txn requests its locks.
  */
 class DDRLockManager {
  public:
-  DDRLockManager();
+  /**
+   * @param shard            Keys whose locks are managed by this lock manager. The locks of the
+   *                         other keys are counted as acquired.
+   * @param max_idle_entries Number of idle lock table entries that are kept around before
+   *                         they start being collected
+   */
+  DDRLockManager(const LockShard& shard = {}, size_t max_idle_entries = kMaxIdleLockTableEntries);
 
   /**
    * Tries to acquire all locks for a given transaction. If not
@@ -83,6 +95,18 @@ class DDRLockManager {
    */
   AcquireLocksResult AcquireLocks(const Transaction& txn);
 
+  /**
+   * Acquires the locks of a batch of transactions with the same result as calling
+   * AcquireLocks on each of them in order. The lock requests of the whole batch are
+   * grouped by key and applied in the order of the lock table buckets, so each key
+   * is looked up once per batch.
+   *
+   * @param txns Transactions whose locks are acquired, in log order.
+   * @return     IDs of the transactions that have acquired all of their locks,
+   *             without duplicates.
+   */
+  vector<TxnId> AcquireLocksBatch(const vector<Transaction*>& txns);
+
   /**
    * Releases all locks that a transaction is holding or waiting for.
    *
@@ -93,6 +117,21 @@ class DDRLockManager {
    */
   vector<TxnId> ReleaseLocks(TxnId txn_id);
 
+  /**
+   * Removes the entries of keys whose requesters have all left the lock manager from the
+   * lock table. Only the entries touched by a release are checked. See IdleLockTableEntries
+   * for when and how many.
+   *
+   * @param max_entries Maximum number of entries to check
+   * @return            Number of removed entries
+   */
+  size_t CollectGarbage(size_t max_entries);
+
+  /**
+   * Publishes the statistics that GetStats reports at level 0 for a reader in another thread
+   */
+  void PublishStats(LockShardStats& stats) const;
+
   /**
    * Gets current statistics of the lock manager
    *
@@ -104,13 +143,28 @@ class DDRLockManager {
   struct TxnInfo {
     TxnInfo(int unarrived) : unarrived_lock_requests(unarrived), waiting_for_cnt(0) {}
     vector<TxnId> waited_by;
+    // Keys of the lock queue tails that this txn has been added to
+    vector<KeyId> keys;
     int unarrived_lock_requests;
     int waiting_for_cnt;
 
     bool is_ready() const { return waiting_for_cnt == 0 && unarrived_lock_requests == 0; }
   };
-  unordered_map<TxnId, TxnInfo> txn_info_;
-  unordered_map<KeyReplica, LockQueueTail> lock_table_;
+
+  // Appends the txns that txn_id has to wait for after requesting the lock
+  static void AcquireLock(LockQueueTail& lock_queue_tail, TxnId txn_id, KeyType type, vector<TxnId>& blocking_txns);
+  // Adds txn_id to the waited_by list of each blocking txn that is still in the lock manager
+  void AddWaitedByEdges(TxnId txn_id, TxnInfo& txn_info, vector<TxnId>& blocking_txns);
+  LockQueueTail& GetOrCreateLockQueueTail(KeyId key_id);
+  // Returns true if none of the txns in the lock queue tail is in the lock manager anymore
+  bool IsIdle(const LockQueueTail& lock_queue_tail) const;
+
+  LockShard shard_;
+  KeyInterner key_interner_;
+  SlotMap<TxnId, TxnInfo> txn_info_;
+  unordered_map<KeyId, LockQueueTail> lock_table_;
+  // Keys of the lock table entries that might have become idle after a release
+  IdleLockTableEntries idle_candidates_;
 };
 
 }  // namespace slog
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "module/scheduler_components/key_interner.h"
+
+#include <glog/logging.h>
+
+namespace slog {
+
+KeyInterner::KeyInterner(size_t expected_num_keys) {
+  index_of_key_.reserve(expected_num_keys);
+  keys_.reserve(expected_num_keys);
+  num_refs_.reserve(expected_num_keys);
+}
+
+KeyId KeyInterner::Intern(const Key& key, uint32_t master) {
+  DCHECK_LT(master, 1U << kMasterBits) << "Master does not fit in a key id";
+  auto ins = index_of_key_.try_emplace(key, free_indices_.empty() ? keys_.size() : free_indices_.back());
+  if (ins.second) {
+    auto index = ins.first->second;
+    if (index == keys_.size()) {
+      keys_.push_back(&ins.first->first);
+      num_refs_.push_back(0);
+    } else {
+      free_indices_.pop_back();
+      keys_[index] = &ins.first->first;
+    }
+  }
+  return (ins.first->second << kMasterBits) | master;
+}
+
+void KeyInterner::Release(KeyId id) {
+  auto index = id >> kMasterBits;
+  DCHECK_GT(num_refs_[index], 0U) << "Releasing an id that is not retained: " << ToKeyReplica(id);
+  if (--num_refs_[index] == 0) {
+    index_of_key_.erase(*keys_[index]);
+    keys_[index] = nullptr;
+    free_indices_.push_back(index);
+  }
+}
+
+}  // namespace slog
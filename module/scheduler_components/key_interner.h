@@ -0,0 +1,51 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/types.h"
+
+namespace slog {
+
+using KeyId = uint64_t;
+
+/**
+ * Maps the tuple <key, master> that the remaster-aware lock managers lock on to a 64-bit id,
+ * so that the key string is hashed once per txn and the lock tables are keyed by integers.
+ * Each distinct key gets a dense index, and the id of a tuple is that index followed by the
+ * master in the low kMasterBits bits.
+ *
+ * A lock manager retains the id of every entry in its lock table. Once all ids of a key are
+ * released, the key is forgotten and its index is reused for the next new key, so that the
+ * interner does not grow past the lock table.
+ */
+class KeyInterner {
+ public:
+  static constexpr int kMasterBits = 16;
+
+  KeyInterner(size_t expected_num_keys = 0);
+
+  // Returns the id of <key, master>, assigning a new index to key if it has not been seen before
+  KeyId Intern(const Key& key, uint32_t master);
+
+  void Retain(KeyId id) { num_refs_[id >> kMasterBits]++; }
+  // Forgets the key of id if none of its ids is retained anymore
+  void Release(KeyId id);
+
+  const Key& key(KeyId id) const { return *keys_[id >> kMasterBits]; }
+  uint32_t master(KeyId id) const { return id & ((1 << kMasterBits) - 1); }
+  // Number of distinct keys
+  size_t size() const { return index_of_key_.size(); }
+
+  /* For debugging */
+  KeyReplica ToKeyReplica(KeyId id) const { return MakeKeyReplica(key(id), master(id)); }
+
+ private:
+  std::unordered_map<Key, uint64_t> index_of_key_;
+  // Points to the keys of index_of_key_, whose nodes never move
+  std::vector<const Key*> keys_;
+  std::vector<uint32_t> num_refs_;
+  std::vector<uint64_t> free_indices_;
+};
+
+}  // namespace slog
@@ -0,0 +1,53 @@
+#include "module/scheduler_components/lock_manager_shard.h"
+
+#include <glog/logging.h>
+
+namespace slog {
+
+LockManagerShard::LockManagerShard(const std::shared_ptr<zmq::context_t>& context, const LockShard& shard,
+                                   const std::shared_ptr<LockShardStats>& stats, std::chrono::milliseconds poll_timeout)
+    : context_(context), shard_(shard.shard()), lock_manager_(shard), stats_(stats), poller_(poll_timeout) {}
+
+void LockManagerShard::SetUp() {
+  socket_ = zmq::socket_t(*context_, ZMQ_DEALER);
+  socket_.set(zmq::sockopt::rcvhwm, 0);
+  socket_.set(zmq::sockopt::sndhwm, 0);
+  socket_.connect(MakeLockManagerShardAddress(shard_));
+  poller_.PushSocket(socket_);
+  lock_manager_.PublishStats(*stats_);
+}
+
+bool LockManagerShard::Loop() {
+  if (poller_.NextEvent()) {
+    zmq::message_t msg;
+    while (socket_.recv(msg, zmq::recv_flags::dontwait)) {
+      ProcessMessage(msg);
+    }
+  }
+  lock_manager_.CollectGarbage(kLockTableGCBatchSize);
+  lock_manager_.PublishStats(*stats_);
+  return false;
+}
+
+void LockManagerShard::ProcessMessage(const zmq::message_t& msg) {
+  auto op = LockShardMessageOp(msg);
+  std::vector<TxnId> ready_txns;
+  switch (op) {
+    case LockShardOp::ACQUIRE:
+      ready_txns = lock_manager_.AcquireLocksBatch(LockShardMessageItems<Transaction*>(msg));
+      break;
+    case LockShardOp::RELEASE:
+      for (auto txn_id : LockShardMessageItems<TxnId>(msg)) {
+        auto unblocked_txns = lock_manager_.ReleaseLocks(txn_id);
+        ready_txns.insert(ready_txns.end(), unblocked_txns.begin(), unblocked_txns.end());
+      }
+      break;
+    default:
+      LOG(FATAL) << "Invalid lock shard operation";
+  }
+  if (!ready_txns.empty()) {
+    socket_.send(MakeLockShardMessage(op, ready_txns), zmq::send_flags::none);
+  }
+}
+
+}  // namespace slog
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+
+#include "common/constants.h"
+#include "common/types.h"
+#include "connection/poller.h"
+#include "module/base/module.h"
+#include "module/scheduler_components/lock_shard.h"
+
+#if defined(LOCK_MANAGER_OLD)
+#include "module/scheduler_components/old_lock_manager.h"
+#elif defined(LOCK_MANAGER_DDR)
+#include "module/scheduler_components/ddr_lock_manager.h"
+#elif defined(LOCK_MANAGER_VLL)
+#include "module/scheduler_components/vll_lock_manager.h"
+#else
+#include "module/scheduler_components/rma_lock_manager.h"
+#endif
+
+namespace slog {
+
+#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY) || \
+    (defined(LOCK_MANAGER_OLD) && !defined(REMASTER_PROTOCOL_COUNTERLESS))
+using LockManager = OldLockManager;
+#elif defined(LOCK_MANAGER_DDR)
+using LockManager = DDRLockManager;
+#elif defined(LOCK_MANAGER_VLL)
+using LockManager = VLLLockManager;
+#else
+using LockManager = RMALockManager;
+#endif
+
+// Address of the socket on which the scheduler exchanges lock requests with a lock manager shard
+inline std::string MakeLockManagerShardAddress(int shard) {
+  return "inproc://lock_manager_shard_" + std::to_string(shard);
+}
+
+/**
+ * A message between the scheduler and a lock manager shard is an operation followed by an array:
+ *  - ACQUIRE from the scheduler: pointers to the txns whose locks are acquired, in log order
+ *  - RELEASE from the scheduler: ids of the txns whose locks are released, in order
+ * The shard replies to both with the same operation followed by the ids of the txns that now
+ * hold all of their locks in the shard. No reply is sent if there is no such txn.
+ */
+enum class LockShardOp : uint64_t { ACQUIRE, RELEASE };
+
+template <typename T>
+zmq::message_t MakeLockShardMessage(LockShardOp op, const std::vector<T>& items) {
+  zmq::message_t msg(sizeof(LockShardOp) + items.size() * sizeof(T));
+  *msg.data<LockShardOp>() = op;
+  std::copy(items.begin(), items.end(), reinterpret_cast<T*>(msg.data<char>() + sizeof(LockShardOp)));
+  return msg;
+}
+
+inline LockShardOp LockShardMessageOp(const zmq::message_t& msg) { return *msg.data<LockShardOp>(); }
+
+template <typename T>
+std::vector<T> LockShardMessageItems(const zmq::message_t& msg) {
+  auto begin = reinterpret_cast<const T*>(msg.data<char>() + sizeof(LockShardOp));
+  return std::vector<T>(begin, begin + (msg.size() - sizeof(LockShardOp)) / sizeof(T));
+}
+
+/**
+ * Runs the lock manager of one shard of the lock table in its own thread. Every shard receives
+ * all txns in the same order and locks the keys of its shard, so a txn holds all of its locks
+ * once every shard has reported it. The txns are only read by the shards, and only the fields
+ * that the scheduler does not modify before the txns are dispatched. The statistics of the lock
+ * manager are published into stats after every iteration for the scheduler to report.
+ */
+class LockManagerShard : public Module {
+ public:
+  LockManagerShard(const std::shared_ptr<zmq::context_t>& context, const LockShard& shard,
+                   const std::shared_ptr<LockShardStats>& stats,
+                   std::chrono::milliseconds poll_timeout = kModuleTimeout);
+
+  std::string name() const override { return "LockManager-" + std::to_string(shard_); }
+
+  void SetUp() final;
+  bool Loop() final;
+
+ private:
+  void ProcessMessage(const zmq::message_t& msg);
+
+  std::shared_ptr<zmq::context_t> context_;
+  uint32_t shard_;
+  LockManager lock_manager_;
+  std::shared_ptr<LockShardStats> stats_;
+  zmq::socket_t socket_;
+  Poller poller_;
+};
+
+}  // namespace slog
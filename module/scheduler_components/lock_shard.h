@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include "common/types.h"
+
+namespace slog {
+
+/**
+ * The subset of keys whose locks are managed by one lock manager when the lock table is split
+ * across several lock manager threads. Keys are assigned to the shards by hash. A lock manager
+ * still keeps track of every txn that it sees, counting the locks in other shards as acquired,
+ * so that each shard finds every txn ready exactly once
+ */
+class LockShard {
+ public:
+  LockShard(uint32_t num_shards = 1, uint32_t shard = 0) : num_shards_(num_shards), shard_(shard) {}
+
+  static uint32_t Of(const Key& key, uint32_t num_shards) {
+    // The lock tables also hash the keys, so the hash is mixed before being reduced to avoid
+    // using the same bits for choosing the shard and the bucket
+    uint64_t hash = std::hash<Key>{}(key) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) % num_shards;
+  }
+
+  bool Contains(const Key& key) const { return num_shards_ == 1 || Of(key, num_shards_) == shard_; }
+
+  uint32_t num_shards() const { return num_shards_; }
+  uint32_t shard() const { return shard_; }
+
+ private:
+  uint32_t num_shards_;
+  uint32_t shard_;
+};
+
+/**
+ * The statistics that a lock manager running in its own thread publishes for the scheduler,
+ * which reports them. Each field is only written by the thread of the lock manager and is read
+ * with relaxed loads, so different fields may be from slightly different moments
+ */
+struct LockShardStats {
+  std::atomic<int> lock_manager_type = 0;
+  std::atomic<uint64_t> num_txns_waiting_for_lock = 0;
+  std::atomic<uint64_t> num_locked_keys = 0;
+  std::atomic<uint64_t> lock_table_size = 0;
+};
+
+}  // namespace slog
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+
+#include "common/constants.h"
+#include "module/scheduler_components/key_interner.h"
+
+namespace slog {
+
+/**
+ * Keys whose lock table entries might have become idle, oldest first, and the incremental
+ * collection of those entries that the lock managers share. Idle entries are kept around until
+ * they outnumber max_idle_entries, so that keys that are locked again soon do not have to be
+ * added back. Above that, each collection checks a few candidates so that it can run at every
+ * iteration of the scheduler, but never fewer than were added since the previous collection,
+ * so that the candidates cannot outgrow the limit by more than one batch of releases.
+ */
+class IdleLockTableEntries {
+ public:
+  explicit IdleLockTableEntries(size_t max_idle_entries = kMaxIdleLockTableEntries)
+      : max_idle_entries_(max_idle_entries) {}
+
+  // A key may be added again after it is locked and released again. Its duplicates are skipped
+  // when collected
+  void Add(KeyId key_id) {
+    candidates_.push_back(key_id);
+    num_added_++;
+  }
+
+  template <typename It>
+  void Add(It first, It last) {
+    candidates_.insert(candidates_.end(), first, last);
+    num_added_ += std::distance(first, last);
+  }
+
+  /**
+   * Checks the oldest candidates while there are more than max_idle_entries of them, removing
+   * the entries that are idle from the lock table and releasing their ids.
+   *
+   * @param lock_table  Lock table keyed by the ids interned in key_interner
+   * @param is_idle     Tells whether a lock table entry can be removed
+   * @param max_entries Number of candidates to check, or the number of candidates added since
+   *                    the previous call if that is larger
+   * @return            Number of removed entries
+   */
+  template <typename LockTable, typename IsIdle>
+  size_t Collect(LockTable& lock_table, KeyInterner& key_interner, IsIdle&& is_idle, size_t max_entries) {
+    auto num_checks = std::max(max_entries, num_added_);
+    num_added_ = 0;
+    size_t num_removed = 0;
+    for (; num_checks > 0 && candidates_.size() > max_idle_entries_; num_checks--) {
+      auto key_id = candidates_.front();
+      candidates_.pop_front();
+      auto it = lock_table.find(key_id);
+      if (it != lock_table.end() && is_idle(it->second)) {
+        lock_table.erase(it);
+        key_interner.Release(key_id);
+        num_removed++;
+      }
+    }
+    return num_removed;
+  }
+
+  size_t size() const { return candidates_.size(); }
+
+ private:
+  size_t max_idle_entries_;
+  std::deque<KeyId> candidates_;
+  size_t num_added_ = 0;
+};
+
+}  // namespace slog
@@ -4,29 +4,40 @@
 
 #include <algorithm>
 
-using std::make_pair;
 using std::move;
 
 namespace slog {
 
+namespace {
+bool AcquireLock(OldLockState& lock_state, TxnId txn_id, KeyType type) {
+  switch (type) {
+    case KeyType::READ:
+      return lock_state.AcquireReadLock(txn_id);
+    case KeyType::WRITE:
+      return lock_state.AcquireWriteLock(txn_id);
+    default:
+      LOG(FATAL) << "Invalid lock mode";
+      return false;
+  }
+}
+}  // namespace
+
 bool OldLockState::AcquireReadLock(TxnId txn_id) {
   switch (mode) {
     case LockMode::UNLOCKED:
-      holders_.insert(txn_id);
+      holders_.push_back(txn_id);
       mode = LockMode::READ;
       return true;
     case LockMode::READ:
-      if (waiters_.empty()) {
-        holders_.insert(txn_id);
+      if (waiter_queue_.empty()) {
+        holders_.push_back(txn_id);
         return true;
       } else {
-        waiters_.insert(txn_id);
-        waiter_queue_.push_back(make_pair(txn_id, LockMode::READ));
+        waiter_queue_.push_back({txn_id, LockMode::READ});
         return false;
       }
     case LockMode::WRITE:
-      waiters_.insert(txn_id);
-      waiter_queue_.push_back(make_pair(txn_id, LockMode::READ));
+      waiter_queue_.push_back({txn_id, LockMode::READ});
       return false;
     default:
       return false;
@@ -36,35 +47,33 @@ bool OldLockState::AcquireReadLock(TxnId txn_id) {
 bool OldLockState::AcquireWriteLock(TxnId txn_id) {
   switch (mode) {
     case LockMode::UNLOCKED:
-      holders_.insert(txn_id);
+      holders_.push_back(txn_id);
       mode = LockMode::WRITE;
       return true;
     case LockMode::READ:
     case LockMode::WRITE:
-      waiters_.insert(txn_id);
-      waiter_queue_.push_back(make_pair(txn_id, LockMode::WRITE));
+      waiter_queue_.push_back({txn_id, LockMode::WRITE});
       return false;
     default:
       return false;
   }
 }
 
-bool OldLockState::Contains(TxnId txn_id) { return holders_.count(txn_id) > 0 || waiters_.count(txn_id) > 0; }
+bool OldLockState::Contains(TxnId txn_id) {
+  return std::find(holders_.begin(), holders_.end(), txn_id) != holders_.end() ||
+         std::find_if(waiter_queue_.begin(), waiter_queue_.end(),
+                      [txn_id](const Waiter& waiter) { return waiter.txn_id == txn_id; }) != waiter_queue_.end();
+}
 
-unordered_set<TxnId> OldLockState::Release(TxnId txn_id) {
+vector<TxnId> OldLockState::Release(TxnId txn_id) {
   // If the transaction is not among the lock holders, find and remove it in
   // the queue of waiters
-  if (holders_.count(txn_id) == 0) {
-    waiter_queue_.erase(std::remove_if(waiter_queue_.begin(), waiter_queue_.end(),
-                                       [txn_id](auto& pair) { return pair.first == txn_id; }),
-                        waiter_queue_.end());
-    waiters_.erase(txn_id);
+  if (holders_.EraseIf([txn_id](TxnId holder) { return holder == txn_id; }) == 0) {
+    waiter_queue_.EraseIf([txn_id](const Waiter& waiter) { return waiter.txn_id == txn_id; });
     // No new transaction get the lock
     return {};
   }
 
-  holders_.erase(txn_id);
-
   // If there are still holders for this lock, do nothing
   if (!holders_.empty()) {
     // No new transaction get the lock
@@ -73,32 +82,29 @@ unordered_set<TxnId> OldLockState::Release(TxnId txn_id) {
 
   // If all holders release the lock but there is no waiter, the current state is
   // changed to unlocked
-  if (waiters_.empty()) {
+  if (waiter_queue_.empty()) {
     mode = LockMode::UNLOCKED;
     // No new transaction get the lock
     return {};
   }
 
   auto front = waiter_queue_.front();
-  if (front.second == LockMode::READ) {
+  if (front.mode == LockMode::READ) {
     // Gives the READ lock to all read transactions at the head of the queue
     do {
-      auto txn_id = waiter_queue_.front().first;
-      holders_.insert(txn_id);
-      waiters_.erase(txn_id);
+      holders_.push_back(waiter_queue_.front().txn_id);
       waiter_queue_.pop_front();
-    } while (!waiter_queue_.empty() && waiter_queue_.front().second == LockMode::READ);
+    } while (!waiter_queue_.empty() && waiter_queue_.front().mode == LockMode::READ);
 
     mode = LockMode::READ;
 
-  } else if (front.second == LockMode::WRITE) {
+  } else if (front.mode == LockMode::WRITE) {
     // Give the WRITE lock to a single transaction at the head of the queue
-    holders_.insert(front.first);
-    waiters_.erase(front.first);
+    holders_.push_back(front.txn_id);
     waiter_queue_.pop_front();
     mode = LockMode::WRITE;
   }
-  return holders_;
+  return vector<TxnId>(holders_.begin(), holders_.end());
 }
 
 AcquireLocksResult OldLockManager::AcquireLocks(const Transaction& txn) {
@@ -114,6 +120,10 @@ AcquireLocksResult OldLockManager::AcquireLocks(const Transaction& txn) {
     if (static_cast<int>(value.metadata().master()) != txn.internal().home()) {
       continue;
     }
+    if (!shard_.Contains(key)) {
+      txn_info.num_waiting_for--;
+      continue;
+    }
 
     txn_info.keys.push_back(key);
 
@@ -122,20 +132,8 @@ AcquireLocksResult OldLockManager::AcquireLocks(const Transaction& txn) {
     DCHECK(!lock_state.Contains(txn_id)) << "Txn requested lock twice: " << txn_id << ", " << key;
 
     auto before_mode = lock_state.mode;
-    switch (value.type()) {
-      case KeyType::READ:
-        if (lock_state.AcquireReadLock(txn_id)) {
-          txn_info.num_waiting_for--;
-        }
-        break;
-      case KeyType::WRITE:
-        if (lock_state.AcquireWriteLock(txn_id)) {
-          txn_info.num_waiting_for--;
-        }
-        break;
-      default:
-        LOG(FATAL) << "Invalid lock mode";
-        break;
+    if (AcquireLock(lock_state, txn_id, value.type())) {
+      txn_info.num_waiting_for--;
     }
     if (before_mode == LockMode::UNLOCKED && lock_state.mode != before_mode) {
       num_locked_keys_++;
@@ -148,6 +146,65 @@ AcquireLocksResult OldLockManager::AcquireLocks(const Transaction& txn) {
   return AcquireLocksResult::WAITING;
 }
 
+vector<TxnId> OldLockManager::AcquireLocksBatch(const vector<Transaction*>& txns) {
+  vector<TxnInfo*> txn_infos;
+  txn_infos.reserve(txns.size());
+  vector<BatchedLockRequest<const Key*>> requests;
+  for (size_t i = 0; i < txns.size(); i++) {
+    const auto& txn = *txns[i];
+    auto& txn_info = txn_info_.try_emplace(txn.internal().id(), txn.keys_size()).first->second;
+    txn_infos.push_back(&txn_info);
+
+    for (const auto& kv : txn.keys()) {
+      // Skip keys that does not belong to the assigned home
+      if (static_cast<int>(kv.value_entry().metadata().master()) != txn.internal().home()) {
+        continue;
+      }
+      if (!shard_.Contains(kv.key())) {
+        txn_info.num_waiting_for--;
+        continue;
+      }
+      txn_info.keys.push_back(kv.key());
+      requests.emplace_back(&kv.key(), i, kv.value_entry().type());
+    }
+  }
+
+  SortByBucket(requests, lock_table_);
+
+  for (size_t start = 0, end; start < requests.size(); start = end) {
+    const auto& key = *requests[start].key;
+    auto& lock_state = lock_table_[key];
+    auto before_mode = lock_state.mode;
+    for (end = start; end < requests.size() && *requests[end].key == key; end++) {
+      auto txn_index = requests[end].txn_index;
+      auto txn_id = txns[txn_index]->internal().id();
+
+      DCHECK(!lock_state.Contains(txn_id)) << "Txn requested lock twice: " << txn_id << ", " << key;
+
+      if (AcquireLock(lock_state, txn_id, requests[end].type)) {
+        txn_infos[txn_index]->num_waiting_for--;
+      }
+    }
+    if (before_mode == LockMode::UNLOCKED && lock_state.mode != before_mode) {
+      num_locked_keys_++;
+    }
+  }
+
+  vector<TxnId> result;
+  for (size_t i = 0; i < txns.size(); i++) {
+    if (txn_infos[i]->is_ready()) {
+      result.push_back(txns[i]->internal().id());
+    }
+  }
+
+  // The lock-only txns of a multi-home txn might be in the same batch
+  std::sort(result.begin(), result.end());
+  auto last = std::unique(result.begin(), result.end());
+  result.erase(last, result.end());
+
+  return result;
+}
+
 vector<TxnId> OldLockManager::ReleaseLocks(TxnId txn_id) {
   vector<TxnId> result;
   auto info_it = txn_info_.find(txn_id);
@@ -193,6 +250,13 @@ vector<TxnId> OldLockManager::ReleaseLocks(TxnId txn_id) {
   return result;
 }
 
+void OldLockManager::PublishStats(LockShardStats& stats) const {
+  stats.lock_manager_type.store(0, std::memory_order_relaxed);
+  stats.num_txns_waiting_for_lock.store(txn_info_.size(), std::memory_order_relaxed);
+  stats.num_locked_keys.store(num_locked_keys_, std::memory_order_relaxed);
+  stats.lock_table_size.store(lock_table_.size(), std::memory_order_relaxed);
+}
+
 /**
  * {
  *    lock_manager_type: 0,
@@ -202,6 +266,7 @@ vector<TxnId> OldLockManager::ReleaseLocks(TxnId txn_id) {
  *      ...
  *    ],
  *    num_locked_keys: <number of keys locked>,
+ *    lock_table_size: <number of entries in the lock table>,
  *    lock_table (lvl >= 2): [
  *      [
  *        <key>,
@@ -229,6 +294,7 @@ void OldLockManager::GetStats(rapidjson::Document& stats, uint32_t level) const
   }
 
   stats.AddMember(StringRef(NUM_LOCKED_KEYS), num_locked_keys_, alloc);
+  stats.AddMember(StringRef(LOCK_TABLE_SIZE), lock_table_.size(), alloc);
   if (level >= 2) {
     // Collect data from lock tables
     rapidjson::Value lock_table(rapidjson::kArrayType);
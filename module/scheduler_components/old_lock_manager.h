@@ -14,6 +14,10 @@
 #include "common/constants.h"
 #include "common/json_utils.h"
 #include "common/types.h"
+#include "data_structure/ring_buffer.h"
+#include "data_structure/slot_pool.h"
+#include "module/scheduler_components/batched_lock_request.h"
+#include "module/scheduler_components/lock_shard.h"
 #include "module/scheduler_components/txn_holder.h"
 
 using std::list;
@@ -28,27 +32,32 @@ namespace slog {
 /**
  * An object of this class represents the locking state of a key.
  * It contains the IDs of transactions that are holding and waiting
- * the lock and the mode of the lock.
+ * the lock and the mode of the lock. The holders and waiters of a key
+ * with little contention are stored inline.
  */
 class OldLockState {
  public:
+  struct Waiter {
+    TxnId txn_id;
+    LockMode mode;
+  };
+
   bool AcquireReadLock(TxnId txn_id);
   bool AcquireWriteLock(TxnId txn_id);
-  unordered_set<TxnId> Release(TxnId txn_id);
+  vector<TxnId> Release(TxnId txn_id);
   bool Contains(TxnId txn_id);
 
   LockMode mode = LockMode::UNLOCKED;
 
   /* For debugging */
-  const unordered_set<TxnId>& GetHolders() const { return holders_; }
+  const RingBuffer<TxnId, 2>& GetHolders() const { return holders_; }
 
   /* For debugging */
-  const list<pair<TxnId, LockMode>>& GetWaiters() const { return waiter_queue_; }
+  const RingBuffer<Waiter, 2>& GetWaiters() const { return waiter_queue_; }
 
  private:
-  unordered_set<TxnId> holders_;
-  unordered_set<TxnId> waiters_;
-  list<pair<TxnId, LockMode>> waiter_queue_;
+  RingBuffer<TxnId, 2> holders_;
+  RingBuffer<Waiter, 2> waiter_queue_;
 };
 
 /**
@@ -58,6 +67,12 @@ class OldLockState {
  */
 class OldLockManager {
  public:
+  /**
+   * @param shard Keys whose locks are managed by this lock manager. The locks of the
+   *              other keys are counted as acquired.
+   */
+  OldLockManager(const LockShard& shard = {}) : shard_(shard) {}
+
   /**
    * Tries to acquire all locks for a given transaction. If not
    * all locks are acquired, the transaction is queued up to wait
@@ -69,6 +84,18 @@ class OldLockManager {
    */
   AcquireLocksResult AcquireLocks(const Transaction& txn);
 
+  /**
+   * Acquires the locks of a batch of transactions with the same result as calling
+   * AcquireLocks on each of them in order. The lock requests of the whole batch are
+   * grouped by key and applied in the order of the lock table buckets, so each key
+   * is looked up once per batch.
+   *
+   * @param txns Transactions whose locks are acquired, in log order.
+   * @return     IDs of the transactions that have acquired all of their locks,
+   *             without duplicates.
+   */
+  vector<TxnId> AcquireLocksBatch(const vector<Transaction*>& txns);
+
   /**
    * Releases all locks that a transaction is holding or waiting for.
    *
@@ -79,6 +106,17 @@ class OldLockManager {
    */
   vector<TxnId> ReleaseLocks(TxnId txn_id);
 
+  /**
+   * Does nothing. The entries of unlocked keys are already removed on release once
+   * the lock table grows over kLockTableSizeLimit.
+   */
+  size_t CollectGarbage(size_t) { return 0; }
+
+  /**
+   * Publishes the statistics that GetStats reports at level 0 for a reader in another thread
+   */
+  void PublishStats(LockShardStats& stats) const;
+
   /**
    * Gets current statistics of the lock manager
    *
@@ -95,7 +133,8 @@ class OldLockManager {
     int num_waiting_for;
     std::vector<Key> keys;
   };
-  unordered_map<TxnId, TxnInfo> txn_info_;
+  LockShard shard_;
+  SlotMap<TxnId, TxnInfo> txn_info_;
   unordered_map<Key, OldLockState> lock_table_;
   uint32_t num_locked_keys_ = 0;
 };
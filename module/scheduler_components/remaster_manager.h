@@ -3,6 +3,7 @@
 #include <glog/logging.h>
 
 #include <list>
+#include <vector>
 
 #include "common/types.h"
 #include "module/scheduler_components/txn_holder.h"
@@ -67,29 +68,35 @@ class RemasterManager {
    */
   static VerifyMasterResult CheckCounters(const Transaction& txn, bool filter_by_home,
                                           const shared_ptr<const Storage>& storage) {
-    auto waiting = false;
+    std::vector<const KeyValueEntry*> entries;
+    std::vector<const Key*> keys;
     for (const auto& kv : txn.keys()) {
-      const auto& key = kv.key();
-      const auto& value = kv.value_entry();
-      if (filter_by_home && static_cast<int>(value.metadata().master()) != txn.internal().home()) {
+      if (filter_by_home && static_cast<int>(kv.value_entry().metadata().master()) != txn.internal().home()) {
         continue;
       }
-      // Get current counter from storage
-      uint32_t storage_counter = 0;  // default to 0 for a new key
-      Record record;
-      bool found = storage->Read(key, record);
-      if (found) {
-        storage_counter = record.metadata().counter;
-      }
+      entries.push_back(&kv);
+      keys.push_back(&kv.key());
+    }
+
+    // Get current counters from storage. Default to 0 for a new key
+    std::vector<Metadata> storage_metadata(keys.size());
+    storage->MultiRead(keys, [&storage_metadata](size_t i, std::string_view, const Metadata& metadata) {
+      storage_metadata[i] = metadata;
+    });
+
+    auto waiting = false;
+    for (size_t i = 0; i < entries.size(); i++) {
+      const auto& value = entries[i]->value_entry();
+      auto storage_counter = storage_metadata[i].counter;
 
       if (value.metadata().counter() < storage_counter) {
         return VerifyMasterResult::ABORT;
       } else if (value.metadata().counter() > storage_counter) {
         waiting = true;
       } else {
-        CHECK(value.metadata().master() == record.metadata().master)
-            << "Masters don't match for same key \"" << key << "\". In txn: " << value.metadata().master()
-            << ". In storage: " << record.metadata().master;
+        CHECK(value.metadata().master() == storage_metadata[i].master)
+            << "Masters don't match for same key \"" << *keys[i] << "\". In txn: " << value.metadata().master()
+            << ". In storage: " << storage_metadata[i].master;
       }
     }
 
@@ -4,11 +4,24 @@
 
 #include <algorithm>
 
-using std::make_pair;
 using std::move;
 
 namespace slog {
 
+namespace {
+bool AcquireLock(LockState& lock_state, TxnId txn_id, KeyType type) {
+  switch (type) {
+    case KeyType::READ:
+      return lock_state.AcquireReadLock(txn_id);
+    case KeyType::WRITE:
+      return lock_state.AcquireWriteLock(txn_id);
+    default:
+      LOG(FATAL) << "Invalid lock mode";
+      return false;
+  }
+}
+}  // namespace
+
 bool LockState::AcquireReadLock(TxnId txn_id) {
   switch (mode) {
     case LockMode::UNLOCKED:
@@ -20,11 +33,11 @@ bool LockState::AcquireReadLock(TxnId txn_id) {
         holders_.push_back(txn_id);
         return true;
       } else {
-        waiter_queue_.push_back(make_pair(txn_id, LockMode::READ));
+        waiter_queue_.push_back({txn_id, LockMode::READ});
         return false;
       }
     case LockMode::WRITE:
-      waiter_queue_.push_back(make_pair(txn_id, LockMode::READ));
+      waiter_queue_.push_back({txn_id, LockMode::READ});
       return false;
     default:
       return false;
@@ -39,7 +52,7 @@ bool LockState::AcquireWriteLock(TxnId txn_id) {
       return true;
     case LockMode::READ:
     case LockMode::WRITE:
-      waiter_queue_.push_back(make_pair(txn_id, LockMode::WRITE));
+      waiter_queue_.push_back({txn_id, LockMode::WRITE});
       return false;
     default:
       return false;
@@ -49,23 +62,18 @@ bool LockState::AcquireWriteLock(TxnId txn_id) {
 bool LockState::Contains(TxnId txn_id) {
   return std::find(holders_.begin(), holders_.end(), txn_id) != holders_.end() ||
          std::find_if(waiter_queue_.begin(), waiter_queue_.end(),
-                      [txn_id](auto& pair) { return pair.first == txn_id; }) != waiter_queue_.end();
+                      [txn_id](const Waiter& waiter) { return waiter.txn_id == txn_id; }) != waiter_queue_.end();
 }
 
 vector<TxnId> LockState::Release(TxnId txn_id) {
   // If the transaction is not among the lock holders, find and remove it in
   // the queue of waiters
-  auto it = std::find(holders_.begin(), holders_.end(), txn_id);
-  if (it == holders_.end()) {
-    waiter_queue_.erase(std::remove_if(waiter_queue_.begin(), waiter_queue_.end(),
-                                       [txn_id](auto& pair) { return pair.first == txn_id; }),
-                        waiter_queue_.end());
+  if (holders_.EraseIf([txn_id](TxnId holder) { return holder == txn_id; }) == 0) {
+    waiter_queue_.EraseIf([txn_id](const Waiter& waiter) { return waiter.txn_id == txn_id; });
     // No new transaction get the lock
     return {};
   }
 
-  holders_.erase(it);
-
   // If there are still holders for this lock, do nothing
   if (!holders_.empty()) {
     // No new transaction gets the lock
@@ -81,28 +89,28 @@ vector<TxnId> LockState::Release(TxnId txn_id) {
   }
 
   auto front = waiter_queue_.front();
-  if (front.second == LockMode::READ) {
+  if (front.mode == LockMode::READ) {
     // Gives the READ lock to all read transactions at the head of the queue
     do {
-      auto txn_id = waiter_queue_.front().first;
-      holders_.push_back(txn_id);
+      holders_.push_back(waiter_queue_.front().txn_id);
       waiter_queue_.pop_front();
-    } while (!waiter_queue_.empty() && waiter_queue_.front().second == LockMode::READ);
+    } while (!waiter_queue_.empty() && waiter_queue_.front().mode == LockMode::READ);
 
     mode = LockMode::READ;
 
-  } else if (front.second == LockMode::WRITE) {
+  } else if (front.mode == LockMode::WRITE) {
     // Give the WRITE lock to a single transaction at the head of the queue
-    holders_.push_back(front.first);
+    holders_.push_back(front.txn_id);
     waiter_queue_.pop_front();
     mode = LockMode::WRITE;
   }
-  return holders_;
+  return vector<TxnId>(holders_.begin(), holders_.end());
 }
 
-RMALockManager::RMALockManager() {
-  lock_table_.reserve(25000000);
-  txn_info_.reserve(1000000);
+RMALockManager::RMALockManager(const LockShard& shard, size_t max_idle_entries)
+    : shard_(shard), key_interner_(max_idle_entries), idle_candidates_(max_idle_entries) {
+  lock_table_.reserve(25000000 / shard.num_shards());
+  txn_info_.reserve(kLockManagerInitialNumTxns);
 }
 
 AcquireLocksResult RMALockManager::AcquireLocks(const Transaction& txn) {
@@ -122,28 +130,22 @@ AcquireLocksResult RMALockManager::AcquireLocks(const Transaction& txn) {
     if (!is_remaster && static_cast<int>(kv.value_entry().metadata().master()) != home) {
       continue;
     }
+    if (!shard_.Contains(kv.key())) {
+      txn_info.num_waiting_for--;
+      continue;
+    }
 
-    auto key_replica = MakeKeyReplica(kv.key(), home);
-    txn_info.keys.push_back(key_replica);
+    auto key_id = key_interner_.Intern(kv.key(), home);
+    txn_info.keys.push_back(key_id);
 
-    auto& lock_state = lock_table_[key_replica];
+    auto& lock_state = GetOrCreateLockState(key_id);
 
-    DCHECK(!lock_state.Contains(txn_id)) << "Txn requested lock twice: " << txn_id << ", " << key_replica;
+    DCHECK(!lock_state.Contains(txn_id)) << "Txn requested lock twice: " << txn_id << ", "
+                                         << key_interner_.ToKeyReplica(key_id);
 
     auto before_mode = lock_state.mode;
-    switch (kv.value_entry().type()) {
-      case KeyType::READ:
-        if (lock_state.AcquireReadLock(txn_id)) {
-          txn_info.num_waiting_for--;
-        }
-        break;
-      case KeyType::WRITE:
-        if (lock_state.AcquireWriteLock(txn_id)) {
-          txn_info.num_waiting_for--;
-        }
-        break;
-      default:
-        LOG(FATAL) << "Invalid lock mode";
+    if (AcquireLock(lock_state, txn_id, kv.value_entry().type())) {
+      txn_info.num_waiting_for--;
     }
     if (before_mode == LockMode::UNLOCKED && lock_state.mode != before_mode) {
       num_locked_keys_++;
@@ -156,6 +158,69 @@ AcquireLocksResult RMALockManager::AcquireLocks(const Transaction& txn) {
   return AcquireLocksResult::WAITING;
 }
 
+vector<TxnId> RMALockManager::AcquireLocksBatch(const vector<Transaction*>& txns) {
+  vector<TxnInfo*> txn_infos;
+  txn_infos.reserve(txns.size());
+  vector<BatchedLockRequest<KeyId>> requests;
+  for (size_t i = 0; i < txns.size(); i++) {
+    const auto& txn = *txns[i];
+    auto home = txn.internal().home();
+    auto is_remaster = txn.program_case() == Transaction::kRemaster;
+    auto num_required_locks = is_remaster ? 2 : txn.keys_size();
+    auto& txn_info = txn_info_.try_emplace(txn.internal().id(), num_required_locks).first->second;
+    txn_infos.push_back(&txn_info);
+
+    for (const auto& kv : txn.keys()) {
+      if (!is_remaster && static_cast<int>(kv.value_entry().metadata().master()) != home) {
+        continue;
+      }
+      if (!shard_.Contains(kv.key())) {
+        txn_info.num_waiting_for--;
+        continue;
+      }
+      auto key_id = key_interner_.Intern(kv.key(), home);
+      txn_info.keys.push_back(key_id);
+      requests.emplace_back(key_id, i, kv.value_entry().type());
+    }
+  }
+
+  SortByBucket(requests, lock_table_);
+
+  for (size_t start = 0, end; start < requests.size(); start = end) {
+    auto key_id = requests[start].key;
+    auto& lock_state = GetOrCreateLockState(key_id);
+    auto before_mode = lock_state.mode;
+    for (end = start; end < requests.size() && requests[end].key == key_id; end++) {
+      auto txn_index = requests[end].txn_index;
+      auto txn_id = txns[txn_index]->internal().id();
+
+      DCHECK(!lock_state.Contains(txn_id)) << "Txn requested lock twice: " << txn_id << ", "
+                                           << key_interner_.ToKeyReplica(key_id);
+
+      if (AcquireLock(lock_state, txn_id, requests[end].type)) {
+        txn_infos[txn_index]->num_waiting_for--;
+      }
+    }
+    if (before_mode == LockMode::UNLOCKED && lock_state.mode != before_mode) {
+      num_locked_keys_++;
+    }
+  }
+
+  vector<TxnId> result;
+  for (size_t i = 0; i < txns.size(); i++) {
+    if (txn_infos[i]->is_ready()) {
+      result.push_back(txns[i]->internal().id());
+    }
+  }
+
+  // The lock-only txns of a multi-home txn might be in the same batch
+  std::sort(result.begin(), result.end());
+  auto last = std::unique(result.begin(), result.end());
+  result.erase(last, result.end());
+
+  return result;
+}
+
 vector<TxnId> RMALockManager::ReleaseLocks(TxnId txn_id) {
   vector<TxnId> result;
   auto info_it = txn_info_.find(txn_id);
@@ -163,20 +228,17 @@ vector<TxnId> RMALockManager::ReleaseLocks(TxnId txn_id) {
     return result;
   }
   auto& info = info_it->second;
-  for (const auto& key_replica : info.keys) {
-    auto lock_state_it = lock_table_.find(key_replica);
+  for (auto key_id : info.keys) {
+    auto lock_state_it = lock_table_.find(key_id);
     if (lock_state_it == lock_table_.end()) {
       continue;
     }
     auto& lock_state = lock_state_it->second;
     auto old_mode = lock_state.mode;
     auto new_grantees = lock_state.Release(txn_id);
-    // Prevent the lock table from growing too big
-    // TODO: automatically delete remastered keys
-    if (lock_state.mode == LockMode::UNLOCKED) {
-      if (old_mode != LockMode::UNLOCKED) {
-        num_locked_keys_--;
-      }
+    if (lock_state.mode == LockMode::UNLOCKED && old_mode != LockMode::UNLOCKED) {
+      num_locked_keys_--;
+      idle_candidates_.Add(key_id);
     }
 
     for (auto new_txn : new_grantees) {
@@ -199,6 +261,26 @@ vector<TxnId> RMALockManager::ReleaseLocks(TxnId txn_id) {
   return result;
 }
 
+size_t RMALockManager::CollectGarbage(size_t max_entries) {
+  auto is_idle = [](const LockState& lock_state) { return lock_state.mode == LockMode::UNLOCKED; };
+  return idle_candidates_.Collect(lock_table_, key_interner_, is_idle, max_entries);
+}
+
+LockState& RMALockManager::GetOrCreateLockState(KeyId key_id) {
+  auto ins = lock_table_.try_emplace(key_id);
+  if (ins.second) {
+    key_interner_.Retain(key_id);
+  }
+  return ins.first->second;
+}
+
+void RMALockManager::PublishStats(LockShardStats& stats) const {
+  stats.lock_manager_type.store(0, std::memory_order_relaxed);
+  stats.num_txns_waiting_for_lock.store(txn_info_.size(), std::memory_order_relaxed);
+  stats.num_locked_keys.store(num_locked_keys_, std::memory_order_relaxed);
+  stats.lock_table_size.store(lock_table_.size(), std::memory_order_relaxed);
+}
+
 /**
  * {
  *    lock_manager_type: 0,
@@ -208,6 +290,7 @@ vector<TxnId> RMALockManager::ReleaseLocks(TxnId txn_id) {
  *      ...
  *    ],
  *    num_locked_keys: <number of keys locked>,
+ *    lock_table_size: <number of entries in the lock table>,
  *    lock_table (lvl >= 2): [
  *      [
  *        <key>,
@@ -235,15 +318,16 @@ void RMALockManager::GetStats(rapidjson::Document& stats, uint32_t level) const
   }
 
   stats.AddMember(StringRef(NUM_LOCKED_KEYS), num_locked_keys_, alloc);
+  stats.AddMember(StringRef(LOCK_TABLE_SIZE), lock_table_.size(), alloc);
   if (level >= 2) {
     // Collect data from lock tables
     rapidjson::Value lock_table(rapidjson::kArrayType);
-    for (const auto& [key, lock_state] : lock_table_) {
+    for (const auto& [key_id, lock_state] : lock_table_) {
       if (lock_state.mode == LockMode::UNLOCKED) {
         continue;
       }
       rapidjson::Value entry(rapidjson::kArrayType);
-      rapidjson::Value key_json(key.c_str(), alloc);
+      rapidjson::Value key_json(key_interner_.ToKeyReplica(key_id).c_str(), alloc);
       entry.PushBack(key_json, alloc)
           .PushBack(static_cast<uint32_t>(lock_state.mode), alloc)
           .PushBack(ToJsonArray(lock_state.GetHolders(), alloc), alloc)
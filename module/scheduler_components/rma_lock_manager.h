@@ -15,6 +15,12 @@
 #include "common/constants.h"
 #include "common/json_utils.h"
 #include "common/types.h"
+#include "data_structure/ring_buffer.h"
+#include "data_structure/slot_pool.h"
+#include "module/scheduler_components/batched_lock_request.h"
+#include "module/scheduler_components/key_interner.h"
+#include "module/scheduler_components/lock_shard.h"
+#include "module/scheduler_components/lock_table_gc.h"
 #include "module/scheduler_components/txn_holder.h"
 
 using std::list;
@@ -29,10 +35,16 @@ namespace slog {
 /**
  * An object of this class represents the locking state of a key.
  * It contains the IDs of transactions that are holding and waiting
- * the lock and the mode of the lock.
+ * the lock and the mode of the lock. The holders and waiters of a key
+ * with little contention are stored inline.
  */
 class LockState {
  public:
+  struct Waiter {
+    TxnId txn_id;
+    LockMode mode;
+  };
+
   bool AcquireReadLock(TxnId txn_id);
   bool AcquireWriteLock(TxnId txn_id);
   vector<TxnId> Release(TxnId txn_id);
@@ -41,14 +53,14 @@ class LockState {
   LockMode mode = LockMode::UNLOCKED;
 
   /* For debugging */
-  const vector<TxnId>& GetHolders() const { return holders_; }
+  const RingBuffer<TxnId, 2>& GetHolders() const { return holders_; }
 
   /* For debugging */
-  const list<pair<TxnId, LockMode>>& GetWaiters() const { return waiter_queue_; }
+  const RingBuffer<Waiter, 2>& GetWaiters() const { return waiter_queue_; }
 
  private:
-  vector<TxnId> holders_;
-  list<pair<TxnId, LockMode>> waiter_queue_;
+  RingBuffer<TxnId, 2> holders_;
+  RingBuffer<Waiter, 2> waiter_queue_;
 };
 
 /**
@@ -64,11 +76,18 @@ class LockState {
  * master metadata. The masters are checked in the worker, so if two
  * transactions hold separate locks for the same key, then one has an
  * incorrect master and will be aborted. Remaster transactions request the
- * locks for both <key, old replica> and <key, new replica>.
+ * locks for both <key, old replica> and <key, new replica>. The tuples
+ * are interned into integer ids when a txn requests its locks.
  */
 class RMALockManager {
  public:
-  RMALockManager();
+  /**
+   * @param shard            Keys whose locks are managed by this lock manager. The locks of the
+   *                         other keys are counted as acquired.
+   * @param max_idle_entries Number of idle lock table entries that are kept around before
+   *                         they start being collected
+   */
+  RMALockManager(const LockShard& shard = {}, size_t max_idle_entries = kMaxIdleLockTableEntries);
 
   /**
    * Tries to acquire all locks for a given transaction. If not
@@ -81,6 +100,18 @@ class RMALockManager {
    */
   AcquireLocksResult AcquireLocks(const Transaction& txn);
 
+  /**
+   * Acquires the locks of a batch of transactions with the same result as calling
+   * AcquireLocks on each of them in order. The lock requests of the whole batch are
+   * grouped by key and applied in the order of the lock table buckets, so each key
+   * is looked up once per batch.
+   *
+   * @param txns Transactions whose locks are acquired, in log order.
+   * @return     IDs of the transactions that have acquired all of their locks,
+   *             without duplicates.
+   */
+  vector<TxnId> AcquireLocksBatch(const vector<Transaction*>& txns);
+
   /**
    * Releases all locks that a transaction is holding or waiting for.
    *
@@ -90,6 +121,20 @@ class RMALockManager {
    */
   vector<TxnId> ReleaseLocks(TxnId txn_id);
 
+  /**
+   * Removes the entries of keys that are no longer locked from the lock table. See
+   * IdleLockTableEntries for when and how many are checked.
+   *
+   * @param max_entries Maximum number of entries to check
+   * @return            Number of removed entries
+   */
+  size_t CollectGarbage(size_t max_entries);
+
+  /**
+   * Publishes the statistics that GetStats reports at level 0 for a reader in another thread
+   */
+  void PublishStats(LockShardStats& stats) const;
+
   /**
    * Gets current statistics of the lock manager
    *
@@ -104,10 +149,17 @@ class RMALockManager {
     bool is_ready() const { return num_waiting_for == 0; }
 
     int num_waiting_for;
-    std::vector<Key> keys;
+    std::vector<KeyId> keys;
   };
-  unordered_map<TxnId, TxnInfo> txn_info_;
-  unordered_map<KeyReplica, LockState> lock_table_;
+
+  LockState& GetOrCreateLockState(KeyId key_id);
+
+  LockShard shard_;
+  KeyInterner key_interner_;
+  SlotMap<TxnId, TxnInfo> txn_info_;
+  unordered_map<KeyId, LockState> lock_table_;
+  // Keys that became unlocked, oldest first. A key might have been locked again since then
+  IdleLockTableEntries idle_candidates_;
   uint32_t num_locked_keys_ = 0;
 };
 
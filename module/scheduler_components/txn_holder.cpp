@@ -11,7 +11,11 @@ TxnHolder::TxnHolder(const ConfigurationPtr& config, Transaction* txn)
       done_(false),
       num_lo_txns_(0),
       expected_num_lo_txns_(txn->internal().involved_replicas_size()),
-      num_dispatches_(0) {
+      num_dispatches_(0),
+      worker_(0),
+      num_ready_lock_shards_(0),
+      waited_for_lock_shard_(false),
+      version_(0) {
   lo_txns_[main_txn_idx_].reset(txn);
   ++num_lo_txns_;
 }
@@ -8,6 +8,7 @@
 #include "common/configuration.h"
 #include "common/proto_utils.h"
 #include "common/types.h"
+#include "data_structure/slot_pool.h"
 #include "proto/transaction.pb.h"
 
 namespace slog {
@@ -41,6 +42,30 @@ class TxnHolder {
   void IncNumDispatches() { num_dispatches_++; }
   int num_dispatches() const { return num_dispatches_; }
 
+  // Worker that the txn was last dispatched to. With work stealing, it might run on another worker
+  void SetWorker(size_t worker) { worker_ = worker; }
+  size_t worker() const { return worker_; }
+
+  // Handle of the holder in the active txns of the scheduler
+  void SetHandle(SlotHandle handle) { handle_ = handle; }
+  SlotHandle handle() const { return handle_; }
+
+  // Called when a lock manager shard finds that the txn holds all of its locks in the shard.
+  // is_fast is false if the txn had to wait for another txn to release its locks
+  void AddReadyLockShard(bool is_fast) {
+    num_ready_lock_shards_++;
+    waited_for_lock_shard_ |= !is_fast;
+  }
+  uint32_t num_ready_lock_shards() const { return num_ready_lock_shards_; }
+  bool waited_for_lock_shard() const { return waited_for_lock_shard_; }
+
+  // Version stamped on the writes of this txn. Zero if no version was assigned
+  void SetVersion(int64_t version) {
+    version_ = version;
+    txn().mutable_internal()->set_version(version);
+  }
+  int64_t version() const { return version_; }
+
   bool is_ready_for_gc() const { return done_ && num_lo_txns_ == expected_num_lo_txns_; }
   int num_lock_only_txns() const { return num_lo_txns_; }
   int expected_num_lock_only_txns() const { return expected_num_lo_txns_; }
@@ -55,6 +80,11 @@ class TxnHolder {
   int num_lo_txns_;
   int expected_num_lo_txns_;
   int num_dispatches_;
+  size_t worker_;
+  SlotHandle handle_;
+  uint32_t num_ready_lock_shards_;
+  bool waited_for_lock_shard_;
+  int64_t version_;
 };
 
 }  // namespace slog
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "module/scheduler_components/vll_lock_manager.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+using std::move;
+
+namespace slog {
+
+VLLLockManager::VLLLockManager(const LockShard& shard, size_t max_idle_entries)
+    : shard_(shard), key_interner_(max_idle_entries), idle_candidates_(max_idle_entries) {
+  lock_table_.reserve(max_idle_entries);
+  txn_info_.reserve(kLockManagerInitialNumTxns);
+}
+
+bool VLLLockManager::RequestLock(LockCounters& counters, KeyType type) {
+  if (counters.num_exclusive == 0 && counters.num_shared == 0) {
+    num_locked_keys_++;
+  }
+  switch (type) {
+    case KeyType::READ:
+      counters.num_shared++;
+      return counters.num_exclusive == 0;
+    case KeyType::WRITE:
+      counters.num_exclusive++;
+      return counters.num_exclusive == 1 && counters.num_shared == 0;
+    default:
+      LOG(FATAL) << "Invalid lock mode";
+      return false;
+  }
+}
+
+AcquireLocksResult VLLLockManager::AcquireLocks(const Transaction& txn) {
+  auto txn_id = txn.internal().id();
+  auto home = txn.internal().home();
+  auto is_remaster = txn.program_case() == Transaction::kRemaster;
+
+  // A remaster txn only has one key K but it acquires locks on (K, RO) and (K, RN)
+  // where RO and RN are the old and new region respectively.
+  auto num_required_locks = is_remaster ? 2 : txn.keys_size();
+  auto& txn_info = txn_info_.try_emplace(txn_id, num_required_locks).first->second;
+
+  LockRequest request{txn_id, {}, false};
+  for (const auto& kv : txn.keys()) {
+    // Skip keys that does not belong to the assigned home. Remaster txn is an exception where
+    // it is allowed that the metadata on the txn does not match its assigned home
+    if (!is_remaster && static_cast<int>(kv.value_entry().metadata().master()) != home) {
+      continue;
+    }
+    if (!shard_.Contains(kv.key())) {
+      txn_info.num_waiting_for--;
+      continue;
+    }
+    auto key_id = key_interner_.Intern(kv.key(), home);
+    auto& counters = GetOrCreateLockCounters(key_id);
+    auto type = kv.value_entry().type();
+    request.keys.push_back({&counters, type, key_id});
+    // Every key is counted even after the request is known to be blocked
+    request.blocked |= !RequestLock(counters, type);
+  }
+
+  if (!request.keys.empty()) {
+    if (request.blocked) {
+      num_blocked_requests_++;
+    } else {
+      txn_info.num_waiting_for -= request.keys.size();
+    }
+    txn_info.requests.push_back(txn_queue_.insert(txn_queue_.end(), move(request)));
+  }
+
+  if (txn_info.is_ready()) {
+    return AcquireLocksResult::ACQUIRED;
+  }
+  return AcquireLocksResult::WAITING;
+}
+
+vector<TxnId> VLLLockManager::AcquireLocksBatch(const vector<Transaction*>& txns) {
+  vector<TxnId> result;
+  for (auto txn : txns) {
+    if (AcquireLocks(*txn) == AcquireLocksResult::ACQUIRED) {
+      result.push_back(txn->internal().id());
+    }
+  }
+
+  // The lock-only txns of a multi-home txn might be in the same batch
+  std::sort(result.begin(), result.end());
+  auto last = std::unique(result.begin(), result.end());
+  result.erase(last, result.end());
+
+  return result;
+}
+
+vector<TxnId> VLLLockManager::ReleaseLocks(TxnId txn_id) {
+  vector<TxnId> result;
+  auto info_it = txn_info_.find(txn_id);
+  if (info_it == txn_info_.end()) {
+    return result;
+  }
+
+  // A blocked request can only be unblocked by the release of a key that is still requested
+  bool has_contended_key = false;
+  for (auto request_it : info_it->second.requests) {
+    for (auto [counters, type, key_id] : request_it->keys) {
+      if (type == KeyType::READ) {
+        counters->num_shared--;
+      } else {
+        counters->num_exclusive--;
+      }
+      if (counters->num_exclusive == 0 && counters->num_shared == 0) {
+        num_locked_keys_--;
+        idle_candidates_.Add(key_id);
+      } else {
+        has_contended_key = true;
+      }
+    }
+    if (request_it->blocked) {
+      num_blocked_requests_--;
+    }
+    txn_queue_.erase(request_it);
+  }
+
+  txn_info_.erase(info_it);
+
+  if (has_contended_key && num_blocked_requests_ > 0) {
+    RunSCA(result);
+  }
+
+  // Deduplicate the result
+  std::sort(result.begin(), result.end());
+  auto last = std::unique(result.begin(), result.end());
+  result.erase(last, result.end());
+
+  return result;
+}
+
+void VLLLockManager::RunSCA(vector<TxnId>& ready_txns) {
+  sca_round_++;
+  auto num_remaining_blocked = num_blocked_requests_;
+  for (auto& request : txn_queue_) {
+    if (request.blocked) {
+      bool conflicted = false;
+      for (auto [counters, type, _] : request.keys) {
+        if (counters->sca_round == sca_round_ &&
+            (counters->sca_mode == LockMode::WRITE || type == KeyType::WRITE)) {
+          conflicted = true;
+          break;
+        }
+      }
+      if (!conflicted) {
+        request.blocked = false;
+        num_blocked_requests_--;
+        auto& txn_info = txn_info_.at(request.txn_id);
+        txn_info.num_waiting_for -= request.keys.size();
+        if (txn_info.is_ready()) {
+          ready_txns.push_back(request.txn_id);
+        }
+      }
+      // No request behind the last blocked one needs to be checked
+      if (--num_remaining_blocked == 0) {
+        break;
+      }
+    }
+    for (auto [counters, type, _] : request.keys) {
+      if (counters->sca_round != sca_round_) {
+        counters->sca_round = sca_round_;
+        counters->sca_mode = LockMode::READ;
+      }
+      if (type == KeyType::WRITE) {
+        counters->sca_mode = LockMode::WRITE;
+      }
+    }
+  }
+}
+
+VLLLockManager::LockCounters& VLLLockManager::GetOrCreateLockCounters(KeyId key_id) {
+  auto ins = lock_table_.try_emplace(key_id);
+  if (ins.second) {
+    key_interner_.Retain(key_id);
+  }
+  return ins.first->second;
+}
+
+size_t VLLLockManager::CollectGarbage(size_t max_entries) {
+  auto is_idle = [](const LockCounters& counters) { return counters.num_exclusive == 0 && counters.num_shared == 0; };
+  return idle_candidates_.Collect(lock_table_, key_interner_, is_idle, max_entries);
+}
+
+void VLLLockManager::PublishStats(LockShardStats& stats) const {
+  stats.lock_manager_type.store(2, std::memory_order_relaxed);
+  stats.num_txns_waiting_for_lock.store(txn_info_.size(), std::memory_order_relaxed);
+  stats.num_locked_keys.store(num_locked_keys_, std::memory_order_relaxed);
+  stats.lock_table_size.store(lock_table_.size(), std::memory_order_relaxed);
+}
+
+/**
+ * {
+ *    lock_manager_type: 2,
+ *    num_txns_waiting_for_lock: <int>,
+ *    num_waiting_for_per_txn (lvl >= 1): [
+ *      [<txn id>, <number of locks waited>],
+ *      ...
+ *    ],
+ *    num_locked_keys: <number of keys locked>,
+ *    lock_table_size: <number of entries in the lock table>,
+ *    lock_table (lvl >= 2): [
+ *      [
+ *        <key>,
+ *        <number of exclusive requests>,
+ *        <number of shared requests>
+ *      ],
+ *      ...
+ *    ],
+ * }
+ */
+void VLLLockManager::GetStats(rapidjson::Document& stats, uint32_t level) const {
+  using rapidjson::StringRef;
+
+  auto& alloc = stats.GetAllocator();
+  stats.AddMember(StringRef(LOCK_MANAGER_TYPE), 2, alloc);
+  stats.AddMember(StringRef(NUM_TXNS_WAITING_FOR_LOCK), txn_info_.size(), alloc);
+
+  if (level >= 1) {
+    // Collect number of locks waited per txn
+    stats.AddMember(StringRef(NUM_WAITING_FOR_PER_TXN),
+                    ToJsonArrayOfKeyValue(
+                        txn_info_, [](const auto& info) { return info.num_waiting_for; }, alloc),
+                    alloc);
+  }
+
+  stats.AddMember(StringRef(NUM_LOCKED_KEYS), num_locked_keys_, alloc);
+  stats.AddMember(StringRef(LOCK_TABLE_SIZE), lock_table_.size(), alloc);
+  if (level >= 2) {
+    // Collect data from lock tables
+    rapidjson::Value lock_table(rapidjson::kArrayType);
+    for (const auto& [key_id, counters] : lock_table_) {
+      if (counters.num_exclusive == 0 && counters.num_shared == 0) {
+        continue;
+      }
+      rapidjson::Value entry(rapidjson::kArrayType);
+      rapidjson::Value key_json(key_interner_.ToKeyReplica(key_id).c_str(), alloc);
+      entry.PushBack(key_json, alloc).PushBack(counters.num_exclusive, alloc).PushBack(counters.num_shared, alloc);
+      lock_table.PushBack(move(entry), alloc);
+    }
+    stats.AddMember(StringRef(LOCK_TABLE), move(lock_table), alloc);
+  }
+}
+
+}  // namespace slog
@@ -0,0 +1,163 @@
+#pragma once
+
+// Prevent mixing with other versions
+#ifdef LOCK_MANAGER
+#error "Only one lock manager can be included"
+#endif
+#define LOCK_MANAGER
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "common/configuration.h"
+#include "common/constants.h"
+#include "common/json_utils.h"
+#include "common/types.h"
+#include "data_structure/slot_pool.h"
+#include "module/scheduler_components/key_interner.h"
+#include "module/scheduler_components/lock_shard.h"
+#include "module/scheduler_components/lock_table_gc.h"
+#include "module/scheduler_components/txn_holder.h"
+
+using std::list;
+using std::pair;
+using std::unordered_map;
+using std::vector;
+
+namespace slog {
+
+/**
+ * This is a deterministic lock manager which grants locks for transactions
+ * in the order that they request. If transaction X, appears before
+ * transaction Y in the log, X always gets all locks before Y.
+ *
+ * VLL stands for Very Lightweight Locking. Instead of a queue of txns per key,
+ * each key only has a count of the exclusive and shared lock requests on it. The
+ * lock requests of each lock-only txn are kept, in the order that they arrive, in a
+ * single queue. A request that is the only one on its keys at the time it arrives
+ * is granted right away. Otherwise it is blocked until a selective contention analysis
+ * (SCA) of the queue finds that no request ahead of it conflicts with it. The SCA only
+ * runs when a release leaves a blocked request behind on one of the released keys, and
+ * it stops as soon as it has visited every blocked request.
+ *
+ * Remastering:
+ * Locks are taken on the tuple <key, replica>, like the RMA lock manager. Remaster
+ * transactions request the locks for both <key, old replica> and <key, new replica>.
+ */
+class VLLLockManager {
+ public:
+  /**
+   * @param shard            Keys whose locks are managed by this lock manager. The locks of the
+   *                         other keys are counted as acquired.
+   * @param max_idle_entries Number of idle lock table entries that are kept around before
+   *                         they start being collected
+   */
+  VLLLockManager(const LockShard& shard = {}, size_t max_idle_entries = kMaxIdleLockTableEntries);
+
+  /**
+   * Tries to acquire all locks for a given transaction. If not
+   * all locks are acquired, the transaction is queued up to wait
+   * for the txns ahead of it to release.
+   *
+   * @param txn The transaction whose locks are acquired.
+   * @return    true if all locks are acquired, false if not and
+   *            the transaction is queued up.
+   */
+  AcquireLocksResult AcquireLocks(const Transaction& txn);
+
+  /**
+   * Acquires the locks of a batch of transactions with the same result as calling
+   * AcquireLocks on each of them in order. Taking a lock is a counter increment, so
+   * unlike the other lock managers, the requests are not grouped by key.
+   *
+   * @param txns Transactions whose locks are acquired, in log order.
+   * @return     IDs of the transactions that have acquired all of their locks,
+   *             without duplicates.
+   */
+  vector<TxnId> AcquireLocksBatch(const vector<Transaction*>& txns);
+
+  /**
+   * Releases all locks that a transaction is holding or waiting for.
+   *
+   * @param txn_id Id of transaction whose locks are released.
+   * @return       A set of IDs of transactions that are able to obtain
+   *               all of their locks thanks to this release.
+   */
+  vector<TxnId> ReleaseLocks(TxnId txn_id);
+
+  /**
+   * Removes the entries of keys that are no longer requested from the lock table. See
+   * IdleLockTableEntries for when and how many are checked.
+   *
+   * @param max_entries Maximum number of entries to check
+   * @return            Number of removed entries
+   */
+  size_t CollectGarbage(size_t max_entries);
+
+  /**
+   * Publishes the statistics that GetStats reports at level 0 for a reader in another thread
+   */
+  void PublishStats(LockShardStats& stats) const;
+
+  /**
+   * Gets current statistics of the lock manager
+   *
+   * @param stats A JSON object where the statistics are stored into
+   */
+  void GetStats(rapidjson::Document& stats, uint32_t level) const;
+
+ private:
+  struct LockCounters {
+    uint32_t num_exclusive = 0;
+    uint32_t num_shared = 0;
+    // Strongest mode requested on the key by the requests that the SCA numbered sca_round has
+    // visited so far. The marks of earlier rounds are stale, so they never need to be cleared
+    uint64_t sca_round = 0;
+    LockMode sca_mode = LockMode::UNLOCKED;
+  };
+
+  // The counters are pointed to directly since the nodes of the lock table never move. The
+  // key id is only needed to find the entry again once the key is no longer requested
+  struct KeyRequest {
+    LockCounters* counters;
+    KeyType type;
+    KeyId key_id;
+  };
+
+  // Lock requests of one lock-only txn
+  struct LockRequest {
+    TxnId txn_id;
+    vector<KeyRequest> keys;
+    bool blocked;
+  };
+
+  struct TxnInfo {
+    TxnInfo(int num_keys) : num_waiting_for(num_keys) {}
+
+    bool is_ready() const { return num_waiting_for == 0; }
+
+    int num_waiting_for;
+    vector<list<LockRequest>::iterator> requests;
+  };
+
+  // Returns true if the request is granted
+  bool RequestLock(LockCounters& counters, KeyType type);
+  // Unblocks the blocked requests that no request ahead in the queue conflicts with. Appends
+  // the txns that become ready to ready_txns
+  void RunSCA(vector<TxnId>& ready_txns);
+  LockCounters& GetOrCreateLockCounters(KeyId key_id);
+
+  LockShard shard_;
+  KeyInterner key_interner_;
+  SlotMap<TxnId, TxnInfo> txn_info_;
+  unordered_map<KeyId, LockCounters> lock_table_;
+  list<LockRequest> txn_queue_;
+  // Keys that stopped being requested, oldest first. A key might be requested again since then
+  IdleLockTableEntries idle_candidates_;
+  uint32_t num_blocked_requests_ = 0;
+  uint32_t num_locked_keys_ = 0;
+  uint64_t sca_round_ = 0;
+};
+
+}  // namespace slog
@@ -5,6 +5,8 @@
 #endif /* defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY) */
 
 #include <glog/logging.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include <thread>
 
@@ -14,14 +16,69 @@
 namespace slog {
 
 using std::make_unique;
+using std::vector;
 
 using internal::Envelope;
 using internal::Request;
 using internal::Response;
 
-Worker::Worker(int id, const std::shared_ptr<Broker>& broker, const shared_ptr<Storage>& storage,
-               const MetricsRepositoryManagerPtr& metrics_manager, std::chrono::milliseconds poll_timeout)
-    : NetworkedModule(broker, kMaxChannel + id, metrics_manager, poll_timeout), storage_(storage) {
+WorkStealingGroup::WorkStealingGroup(const std::vector<std::shared_ptr<WorkerQueues>>& queues)
+    : queues_(queues), signaled_(false), num_stolen_(0) {
+  fd_ = eventfd(0, EFD_NONBLOCK);
+  CHECK_GE(fd_, 0) << "Failed to create an eventfd";
+}
+
+WorkStealingGroup::~WorkStealingGroup() { close(fd_); }
+
+void WorkStealingGroup::Signal() {
+  // Pairs with the fence in TryPop so that either the pushed txn is found there or the eventfd
+  // is signaled again
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!signaled_.load(std::memory_order_relaxed) && !signaled_.exchange(true)) {
+    uint64_t one = 1;
+    CHECK_EQ(write(fd_, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one))) << "Failed to signal the eventfd";
+  }
+}
+
+bool WorkStealingGroup::TryPop(size_t worker, TxnHolder*& txn_holder) {
+  if (signaled_.load(std::memory_order_relaxed)) {
+    signaled_.store(false, std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool popped = queues_[worker]->ready_txns.TryPop(txn_holder);
+  for (size_t i = 1; i < queues_.size() && !popped; i++) {
+    if (queues_[(worker + i) % queues_.size()]->ready_txns.TryPop(txn_holder)) {
+      popped = true;
+      num_stolen_.fetch_add(1, std::memory_order_relaxed);
+      VLOG(3) << "Worker " << worker << " stole txn " << txn_holder->txn_id();
+    }
+  }
+  // The caller is about to run the popped txn, which may take long. The signal that woke it up
+  // may have been for more than one txn, so wake up another worker for the ones left behind
+  if (popped && HasReadyTxns()) {
+    Signal();
+  }
+  return popped;
+}
+
+bool WorkStealingGroup::HasReadyTxns() const {
+  for (const auto& queues : queues_) {
+    if (queues->ready_txns.size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Worker::Worker(int id, const std::shared_ptr<WorkerQueues>& queues,
+               const std::shared_ptr<WorkStealingGroup>& stealing_group, const std::shared_ptr<Broker>& broker,
+               const std::shared_ptr<Storage>& storage, const MetricsRepositoryManagerPtr& metrics_manager,
+               std::chrono::milliseconds poll_timeout)
+    : NetworkedModule(broker, kMaxChannel + id, metrics_manager, poll_timeout),
+      id_(id),
+      queues_(queues),
+      stealing_group_(stealing_group),
+      storage_(storage) {
   switch (config()->execution_type()) {
     case internal::ExecutionType::KEY_VALUE:
       execution_ = make_unique<KeyValueExecution>(Sharder::MakeSharder(config()), storage);
@@ -33,15 +90,17 @@ Worker::Worker(int id, const std::shared_ptr<Broker>& broker, const shared_ptr<S
       execution_ = make_unique<NoopExecution>();
       break;
   }
+  if (config()->batch_remote_reads()) {
+    remote_read_batches_.resize(config()->num_partitions());
+  }
 }
 
 void Worker::Initialize() {
-  zmq::socket_t sched_socket(*context(), ZMQ_DEALER);
-  sched_socket.set(zmq::sockopt::rcvhwm, 0);
-  sched_socket.set(zmq::sockopt::sndhwm, 0);
-  sched_socket.connect(MakeInProcChannelAddress(kWorkerChannel));
-
-  AddCustomSocket(std::move(sched_socket));
+  if (stealing_group_ == nullptr) {
+    AddCustomEventFd(queues_->txns.fd());
+  } else {
+    AddCustomEventFd(stealing_group_->fd());
+  }
 }
 
 void Worker::OnInternalRequestReceived(EnvelopePtr&& env) {
@@ -50,15 +109,15 @@ void Worker::OnInternalRequestReceived(EnvelopePtr&& env) {
   }
   auto& read_result = env->request().remote_read_result();
   auto txn_id = read_result.txn_id();
-  auto state_it = txn_states_.find(txn_id);
-  if (state_it == txn_states_.end()) {
+  auto waiter_it = remote_read_waiters_.find(txn_id);
+  if (waiter_it == remote_read_waiters_.end()) {
     VLOG(1) << "Transaction " << txn_id << " does not exist for remote read result";
     return;
   }
 
   VLOG(2) << "Got remote read result for txn " << txn_id;
 
-  auto& state = state_it->second;
+  auto& state = *txn_states_.Get(waiter_it->second);
   auto& txn = state.txn_holder->txn();
 
   if (txn.status() != TransactionStatus::ABORTED) {
@@ -81,12 +140,13 @@ void Worker::OnInternalRequestReceived(EnvelopePtr&& env) {
   if (state.remote_reads_waiting_on == 0) {
     if (state.phase == TransactionState::Phase::WAIT_REMOTE_READ) {
       state.phase = TransactionState::Phase::EXECUTE;
+      remote_read_waiters_.erase(waiter_it);
 
       // Remove the redirection at broker for this txn
       auto redirect_env = NewEnvelope();
       redirect_env->mutable_request()->mutable_broker_redirect()->set_tag(txn_id);
       redirect_env->mutable_request()->mutable_broker_redirect()->set_stop(true);
-      Send(move(redirect_env), Broker::MakeChannel(config()->broker_ports_size() - 1));
+      Send(move(redirect_env), Broker::RedirectionChannel(config()));
 
       VLOG(3) << "Execute txn " << txn_id << " after receving all remote read results";
     } else {
@@ -94,42 +154,57 @@ void Worker::OnInternalRequestReceived(EnvelopePtr&& env) {
     }
   }
 
-  AdvanceTransaction(txn_id);
+  AdvanceTransaction(state);
 }
 
 bool Worker::OnCustomSocket() {
-  auto& sched_socket = GetCustomSocket(0);
+  while (!finished_txns_backlog_.empty() && queues_->finished_txns.TryPush(finished_txns_backlog_.front())) {
+    finished_txns_backlog_.pop_front();
+  }
+
+  bool has_txn = false;
+  TxnHolder* txn_holder;
+  if (stealing_group_ == nullptr) {
+    while (queues_->txns.TryPop(txn_holder)) {
+      has_txn = true;
+      StartTransaction(txn_holder);
+    }
+  } else if (stealing_group_->TryPop(id_, txn_holder)) {
+    has_txn = true;
+    StartTransaction(txn_holder);
+  }
 
-  zmq::message_t msg;
-  if (!sched_socket.recv(msg, zmq::recv_flags::dontwait)) {
-    return false;
+  // Send the remote reads of the txns started above together. Holding them any longer would delay
+  // the same txns at the other partitions
+  if (has_txn && !remote_read_batches_.empty()) {
+    FlushRemoteReadResults();
   }
 
-  auto txn_holder = *msg.data<TxnHolder*>();
+  // Keep looping without waiting for a new event until the backlog is pushed
+  return has_txn || !finished_txns_backlog_.empty();
+}
+
+void Worker::StartTransaction(TxnHolder* txn_holder) {
   auto& txn = txn_holder->txn();
   auto txn_id = txn.internal().id();
 
   RECORD(txn.mutable_internal(), TransactionEvent::ENTER_WORKER);
 
   // Create a state for the new transaction
-  auto [iter, ok] = txn_states_.try_emplace(txn_id, txn_holder);
-
-  DCHECK(ok) << "Transaction " << txn_id << " has already been dispatched to this worker";
-
-  iter->second.phase = TransactionState::Phase::READ_LOCAL_STORAGE;
+  auto handle = txn_states_.Emplace(txn_holder);
+  auto& state = *txn_states_.Get(handle);
+  state.handle = handle;
+  state.phase = TransactionState::Phase::READ_LOCAL_STORAGE;
 
   VLOG(3) << "Initialized state for txn " << txn_id;
 
-  AdvanceTransaction(txn_id);
-
-  return true;
+  AdvanceTransaction(state);
 }
 
-void Worker::AdvanceTransaction(TxnId txn_id) {
-  auto& state = TxnState(txn_id);
+void Worker::AdvanceTransaction(TransactionState& state) {
   switch (state.phase) {
     case TransactionState::Phase::READ_LOCAL_STORAGE:
-      ReadLocalStorage(txn_id);
+      ReadLocalStorage(state);
       [[fallthrough]];
     case TransactionState::Phase::WAIT_REMOTE_READ:
       if (state.phase == TransactionState::Phase::WAIT_REMOTE_READ) {
@@ -139,19 +214,19 @@ void Worker::AdvanceTransaction(TxnId txn_id) {
       [[fallthrough]];
     case TransactionState::Phase::EXECUTE:
       if (state.phase == TransactionState::Phase::EXECUTE) {
-        Execute(txn_id);
+        Execute(state);
       }
       [[fallthrough]];
     case TransactionState::Phase::FINISH:
-      Finish(txn_id);
+      Finish(state);
       // Never fallthrough after this point because Finish and PreAbort
       // has already destroyed the state object
       break;
   }
 }
 
-void Worker::ReadLocalStorage(TxnId txn_id) {
-  auto& state = TxnState(txn_id);
+void Worker::ReadLocalStorage(TransactionState& state) {
+  auto txn_id = state.txn_holder->txn_id();
   auto txn_holder = state.txn_holder;
   auto& txn = txn_holder->txn();
 
@@ -178,27 +253,43 @@ void Worker::ReadLocalStorage(TxnId txn_id) {
 
     // We don't need to check if keys are in partition here since the assumption is that
     // the out-of-partition keys have already been removed
-    for (auto& kv : *(txn.mutable_keys())) {
-      const auto& key = kv.key();
-      auto value = kv.mutable_value_entry();
-      if (Record record; storage_->Read(key, record)) {
-        // Check whether the stored master metadata matches with the information
-        // stored in the transaction
-        if (value->metadata().master() != record.metadata().master) {
-          txn.set_status(TransactionStatus::ABORTED);
-          txn.set_abort_reason("Outdated master");
-          break;
-        }
-        value->set_value(record.to_string());
-      } else if (txn.program_case() == Transaction::kRemaster) {
+    auto keys = txn.mutable_keys();
+    vector<const Key*> read_keys;
+    read_keys.reserve(keys->size());
+    for (const auto& kv : *keys) {
+      read_keys.push_back(&kv.key());
+    }
+    // All keys are read in one batch so that the storage can look up the keys of the same
+    // segment together. The master checks are then done in key order
+    vector<bool> found(read_keys.size(), false);
+    vector<bool> outdated_master(read_keys.size(), false);
+    storage_->MultiRead(read_keys, [&](size_t i, std::string_view data, const Metadata& metadata) {
+      found[i] = true;
+      auto value = keys->Mutable(i)->mutable_value_entry();
+      // Check whether the stored master metadata matches with the information
+      // stored in the transaction
+      if (value->metadata().master() != metadata.master) {
+        outdated_master[i] = true;
+        return;
+      }
+      value->set_value(data.data(), data.size());
+    });
+    for (size_t i = 0; i < read_keys.size(); i++) {
+      if (outdated_master[i]) {
         txn.set_status(TransactionStatus::ABORTED);
-        txn.set_abort_reason("Remaster non-existent key " + key);
+        txn.set_abort_reason("Outdated master");
+        break;
+      } else if (!found[i] && txn.program_case() == Transaction::kRemaster) {
+        txn.set_status(TransactionStatus::ABORTED);
+        txn.set_abort_reason("Remaster non-existent key " + *read_keys[i]);
         break;
       }
     }
   }
 
-  NotifyOtherPartitions(txn_id);
+  RECORD(txn.mutable_internal(), TransactionEvent::EXIT_READ_LOCAL_STORAGE);
+
+  NotifyOtherPartitions(state);
 
   // Set the number of remote reads that this partition needs to wait for
   state.remote_reads_waiting_on = 0;
@@ -216,15 +307,18 @@ void Worker::ReadLocalStorage(TxnId txn_id) {
     auto redirect_env = NewEnvelope();
     redirect_env->mutable_request()->mutable_broker_redirect()->set_tag(txn_id);
     redirect_env->mutable_request()->mutable_broker_redirect()->set_channel(channel());
-    Send(move(redirect_env), Broker::MakeChannel(config()->broker_ports_size() - 1));
+    Send(move(redirect_env), Broker::RedirectionChannel(config()));
+
+    auto ok = remote_read_waiters_.try_emplace(txn_id, state.handle).second;
+    DCHECK(ok) << "Transaction " << txn_id << " has already been dispatched to this worker";
 
     VLOG(3) << "Defer executing txn " << txn_id << " until having enough remote reads";
     state.phase = TransactionState::Phase::WAIT_REMOTE_READ;
   }
 }
 
-void Worker::Execute(TxnId txn_id) {
-  auto& state = TxnState(txn_id);
+void Worker::Execute(TransactionState& state) {
+  auto txn_id = state.txn_holder->txn_id();
   auto& txn = state.txn_holder->txn();
 
   switch (txn.program_case()) {
@@ -248,7 +342,7 @@ void Worker::Execute(TxnId txn_id) {
       storage_->Read(key, record);
       auto new_counter = it->value_entry().metadata().counter() + 1;
       record.SetMetadata(Metadata(txn.remaster().new_master(), new_counter));
-      storage_->Write(key, record);
+      storage_->Write(key, std::move(record), txn.internal().version());
 
       state.txn_holder->SetRemasterResult(key, new_counter);
       break;
@@ -259,8 +353,8 @@ void Worker::Execute(TxnId txn_id) {
   state.phase = TransactionState::Phase::FINISH;
 }
 
-void Worker::Finish(TxnId txn_id) {
-  auto& state = TxnState(txn_id);
+void Worker::Finish(TransactionState& state) {
+  auto txn_id = state.txn_holder->txn_id();
   auto txn = state.txn_holder->FinalizeAndRelease();
 
   RECORD(txn->mutable_internal(), TransactionEvent::EXIT_WORKER);
@@ -286,18 +380,19 @@ void Worker::Finish(TxnId txn_id) {
   }
 
   // Notify the scheduler that we're done
-  zmq::message_t msg(sizeof(TxnId));
-  *msg.data<TxnId>() = txn_id;
-  GetCustomSocket(0).send(msg, zmq::send_flags::none);
+  auto handle = state.txn_holder->handle();
+  if (!finished_txns_backlog_.empty() || !queues_->finished_txns.TryPush(handle)) {
+    finished_txns_backlog_.push_back(handle);
+  }
 
-  // Done with this txn. Remove it from the state map
-  txn_states_.erase(txn_id);
+  // Done with this txn. Remove its state
+  txn_states_.Erase(state.handle);
 
   VLOG(3) << "Finished with txn " << txn_id;
 }
 
-void Worker::NotifyOtherPartitions(TxnId txn_id) {
-  auto& state = TxnState(txn_id);
+void Worker::NotifyOtherPartitions(TransactionState& state) {
+  auto txn_id = state.txn_holder->txn_id();
   auto txn_holder = state.txn_holder;
   auto& txn = txn_holder->txn();
 
@@ -323,6 +418,15 @@ void Worker::NotifyOtherPartitions(TxnId txn_id) {
     }
   }
 
+  if (!remote_read_batches_.empty()) {
+    for (auto p : txn.internal().active_partitions()) {
+      if (p != local_partition) {
+        remote_read_batches_[p].add_results()->CopyFrom(*rrr);
+      }
+    }
+    return;
+  }
+
   vector<MachineId> destinations;
   for (auto p : txn.internal().active_partitions()) {
     if (p != local_partition) {
@@ -330,12 +434,36 @@ void Worker::NotifyOtherPartitions(TxnId txn_id) {
     }
   }
   Send(env, destinations, txn_id);
+
+  queues_->num_remote_read_results.fetch_add(destinations.size(), std::memory_order_relaxed);
+  queues_->num_remote_read_messages.fetch_add(destinations.size(), std::memory_order_relaxed);
 }
 
-TransactionState& Worker::TxnState(TxnId txn_id) {
-  auto state_it = txn_states_.find(txn_id);
-  DCHECK(state_it != txn_states_.end());
-  return state_it->second;
+void Worker::FlushRemoteReadResults() {
+  auto local_replica = config()->local_replica();
+  for (uint32_t p = 0; p < remote_read_batches_.size(); p++) {
+    auto& batch = remote_read_batches_[p];
+    if (batch.results().empty()) {
+      continue;
+    }
+
+    auto destination = config()->MakeMachineId(local_replica, p);
+    auto num_results = batch.results_size();
+    Envelope env;
+    if (num_results == 1) {
+      // A lone result is sent to the worker of its txn directly, skipping the demultiplexing at the broker
+      auto txn_id = batch.results(0).txn_id();
+      env.mutable_request()->mutable_remote_read_result()->Swap(batch.mutable_results(0));
+      Send(env, destination, txn_id);
+    } else {
+      env.mutable_request()->mutable_remote_read_results()->Swap(&batch);
+      Send(env, destination, Broker::RedirectionChannel(config()));
+    }
+    batch.Clear();
+
+    queues_->num_remote_read_results.fetch_add(num_results, std::memory_order_relaxed);
+    queues_->num_remote_read_messages.fetch_add(1, std::memory_order_relaxed);
+  }
 }
 
 }  // namespace slog
\ No newline at end of file
@@ -1,14 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <functional>
 #include <optional>
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <zmq.hpp>
 
 #include "common/configuration.h"
+#include "common/constants.h"
 #include "common/metrics.h"
 #include "common/types.h"
+#include "connection/zmq_utils.h"
+#include "data_structure/slot_pool.h"
+#include "data_structure/spsc_queue.h"
+#include "data_structure/work_stealing_queue.h"
 #include "execution/execution.h"
 #include "module/base/networked_module.h"
 #include "module/scheduler_components/txn_holder.h"
@@ -18,12 +25,66 @@
 
 namespace slog {
 
+/**
+ * Queues through which the scheduler hands txns to a worker and the worker hands back the
+ * handles of the finished txns. Either side keeps what does not fit in a full queue in a backlog
+ * and pushes it later, so neither ever blocks on the other. The worker also counts here what it
+ * sends to other partitions so that the scheduler can report it.
+ */
+struct WorkerQueues {
+  WorkerQueues() : txns(kWorkerQueueCapacity), finished_txns(kWorkerQueueCapacity) {}
+
+  SpscQueue<TxnHolder*> txns;
+  SpscQueue<SlotHandle> finished_txns;
+  // Replaces the txns queue above when work stealing is enabled
+  WorkStealingQueue<TxnHolder*> ready_txns;
+
+  std::atomic<uint64_t> num_remote_read_results = 0;
+  std::atomic<uint64_t> num_remote_read_messages = 0;
+};
+
+/**
+ * Lets idle workers run the txns that are waiting behind a slow txn on another worker. With
+ * work stealing, the scheduler pushes each txn into the ready queue of its worker, where any
+ * worker can take it until it starts, and wakes up the idle workers through a shared eventfd.
+ * Only txns that have not started can be stolen, so a txn waiting for remote reads stays on
+ * the worker that the broker redirects its remote reads to.
+ */
+class WorkStealingGroup {
+ public:
+  explicit WorkStealingGroup(const std::vector<std::shared_ptr<WorkerQueues>>& queues);
+  ~WorkStealingGroup();
+
+  WorkStealingGroup(const WorkStealingGroup&) = delete;
+  WorkStealingGroup& operator=(const WorkStealingGroup&) = delete;
+
+  // Called after pushing into a ready queue. Does not signal the eventfd again until a worker
+  // has looked for txns since the last signal
+  void Signal();
+  // Pops the oldest ready txn of the worker, or steals one from the next workers if it has none.
+  // Signals the eventfd again if other txns are still ready
+  bool TryPop(size_t worker, TxnHolder*& txn_holder);
+
+  int fd() const { return fd_; }
+  uint64_t num_stolen() const { return num_stolen_.load(std::memory_order_relaxed); }
+
+ private:
+  bool HasReadyTxns() const;
+
+  std::vector<std::shared_ptr<WorkerQueues>> queues_;
+  int fd_;
+  std::atomic<bool> signaled_;
+  std::atomic<uint64_t> num_stolen_;
+};
+
 struct TransactionState {
   enum class Phase { READ_LOCAL_STORAGE, WAIT_REMOTE_READ, EXECUTE, FINISH };
 
   TransactionState(TxnHolder* txn_holder)
       : txn_holder(txn_holder), remote_reads_waiting_on(0), phase(Phase::READ_LOCAL_STORAGE) {}
   TxnHolder* txn_holder;
+  // Handle of this state in the txn states of the worker
+  SlotHandle handle;
   uint32_t remote_reads_waiting_on;
   Phase phase;
 };
@@ -36,8 +97,10 @@ struct TransactionState {
  */
 class Worker : public NetworkedModule {
  public:
-  Worker(int id, const std::shared_ptr<Broker>& broker, const std::shared_ptr<Storage>& storage,
-         const MetricsRepositoryManagerPtr& metrics_manager,
+  // stealing_group is null if work stealing is disabled
+  Worker(int id, const std::shared_ptr<WorkerQueues>& queues,
+         const std::shared_ptr<WorkStealingGroup>& stealing_group, const std::shared_ptr<Broker>& broker,
+         const std::shared_ptr<Storage>& storage, const MetricsRepositoryManagerPtr& metrics_manager,
          std::chrono::milliseconds poll_timeout_ms = kModuleTimeout);
 
   std::string name() const override { return "Worker-" + std::to_string(channel()); }
@@ -51,41 +114,55 @@ class Worker : public NetworkedModule {
   void OnInternalRequestReceived(EnvelopePtr&& env) final;
 
   /**
-   * Receives new transaction from the scheduler
+   * Receives new transactions from the scheduler. With work stealing, starts one transaction
+   * per call so that the rest can be stolen while it runs
    */
   bool OnCustomSocket() final;
 
  private:
+  // Creates the state of a txn that has just arrived at this worker and advances it
+  void StartTransaction(TxnHolder* txn_holder);
+
   /**
    * Drives most of the phase transition of a transaction
    */
-  void AdvanceTransaction(TxnId txn_id);
+  void AdvanceTransaction(TransactionState& state);
 
   /**
    * Checks master metadata information and reads local data to the transaction
    * buffer, then broadcast local data to other partitions
    */
-  void ReadLocalStorage(TxnId txn_id);
+  void ReadLocalStorage(TransactionState& state);
 
   /**
    * Executes the code inside the transaction
    */
-  void Execute(TxnId txn_id);
+  void Execute(TransactionState& state);
 
   /**
    * Returns the result back to the scheduler and cleans up the transaction state
    */
-  void Finish(TxnId txn_id);
+  void Finish(TransactionState& state);
 
-  void NotifyOtherPartitions(TxnId txn_id);
+  void NotifyOtherPartitions(TransactionState& state);
 
-  // Precondition: txn_id must exists in txn states table
-  TransactionState& TxnState(TxnId txn_id);
+  // Sends the remote read results buffered for each partition in one message
+  void FlushRemoteReadResults();
 
+  int id_;
+  std::shared_ptr<WorkerQueues> queues_;
+  std::shared_ptr<WorkStealingGroup> stealing_group_;
+  // Handles of the finished txns that did not fit in the queue to the scheduler
+  std::deque<SlotHandle> finished_txns_backlog_;
   std::shared_ptr<Storage> storage_;
   std::unique_ptr<Execution> execution_;
 
-  std::unordered_map<TxnId, TransactionState> txn_states_;
+  SlotPool<TransactionState> txn_states_;
+  // Only the txns waiting for remote reads are looked up by id
+  SlotMap<TxnId, SlotHandle> remote_read_waiters_;
+
+  // Indexed by partition. Only used if remote reads are batched
+  std::vector<internal::RemoteReadResults> remote_read_batches_;
 };
 
 }  // namespace slog
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "module/scheduler_components/worker_dispatcher.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <charconv>
+#include <functional>
+
+namespace slog {
+
+WorkerDispatcher::WorkerDispatcher(const ConfigurationPtr& config, size_t num_workers)
+    : policy_(config->dispatch_policy()),
+      sharder_(Sharder::MakeSharder(config)),
+      keys_per_worker_(0),
+      num_inflight_(num_workers, 0),
+      next_worker_(0),
+      num_rebalanced_(0) {
+  if (policy_ == internal::DispatchPolicy::KEY_RANGE) {
+    if (config->proto_config().has_simple_partitioning()) {
+      auto num_partitions = config->num_partitions();
+      auto num_local_keys = (config->proto_config().simple_partitioning().num_records() + num_partitions - 1) /
+                            num_partitions;
+      auto num_ranges = std::max<size_t>(num_workers, 1);
+      keys_per_worker_ = std::max<uint64_t>((num_local_keys + num_ranges - 1) / num_ranges, 1);
+    } else {
+      LOG(WARNING) << "KEY_RANGE dispatch is only available with simple partitioning. Using KEY_HASH instead";
+      policy_ = internal::DispatchPolicy::KEY_HASH;
+    }
+  }
+}
+
+size_t WorkerDispatcher::Select(const Transaction& txn) {
+  auto num_workers = num_inflight_.size();
+  const Key* key = nullptr;
+  if (policy_ != internal::DispatchPolicy::ROUND_ROBIN) {
+    key = DominantKey(txn);
+  }
+  if (key == nullptr) {
+    return next_worker_++ % num_workers;
+  }
+
+  auto worker = WorkerOfKey(*key);
+  auto least_loaded = std::min_element(num_inflight_.begin(), num_inflight_.end()) - num_inflight_.begin();
+  if (num_inflight_[worker] >= num_inflight_[least_loaded] + kDispatchImbalanceThreshold) {
+    num_rebalanced_++;
+    return least_loaded;
+  }
+  return worker;
+}
+
+const Key* WorkerDispatcher::DominantKey(const Transaction& txn) const {
+  const Key* first_local_key = nullptr;
+  for (const auto& kv : txn.keys()) {
+    if (!sharder_->is_local_key(kv.key())) {
+      continue;
+    }
+    if (kv.value_entry().type() == KeyType::WRITE) {
+      return &kv.key();
+    }
+    if (first_local_key == nullptr) {
+      first_local_key = &kv.key();
+    }
+  }
+  return first_local_key;
+}
+
+size_t WorkerDispatcher::WorkerOfKey(const Key& key) const {
+  auto num_workers = num_inflight_.size();
+  if (policy_ == internal::DispatchPolicy::KEY_RANGE) {
+    // With simple partitioning, the local keys are the numbers congruent to the local partition.
+    // A key that is not a number falls through to the hash
+    uint64_t key_num;
+    auto end = key.data() + key.size();
+    auto [ptr, ec] = std::from_chars(key.data(), end, key_num);
+    if (ec == std::errc() && ptr == end) {
+      auto local_index = key_num / sharder_->num_partitions();
+      return std::min<uint64_t>(local_index / keys_per_worker_, num_workers - 1);
+    }
+  }
+  // Mixed the same way as for choosing a lock manager shard so that the low bits of a weak
+  // hash do not decide the worker
+  uint64_t hash = std::hash<Key>{}(key) * 0x9E3779B97F4A7C15ULL;
+  return (hash >> 32) % num_workers;
+}
+
+}  // namespace slog
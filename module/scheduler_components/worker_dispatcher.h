@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "common/configuration.h"
+#include "common/constants.h"
+#include "common/sharder.h"
+#include "common/types.h"
+#include "proto/transaction.pb.h"
+
+namespace slog {
+
+/**
+ * Picks the worker that a dispatched txn runs on, following the dispatch policy of the
+ * configuration, and keeps track of the number of txns in flight at each worker. With
+ * the key-affinity policies, a txn goes to the least loaded worker instead of the worker
+ * of its dominant key when that worker has kDispatchImbalanceThreshold more txns in
+ * flight, so that a few hot keys cannot pile up all txns on a single worker.
+ */
+class WorkerDispatcher {
+ public:
+  WorkerDispatcher(const ConfigurationPtr& config, size_t num_workers);
+
+  // Returns the worker that txn should run on
+  size_t Select(const Transaction& txn);
+
+  void OnDispatched(size_t worker) { num_inflight_[worker]++; }
+  void OnFinished(size_t worker) { num_inflight_[worker]--; }
+
+  // Number of txns dispatched to the worker that have not finished yet
+  uint32_t num_inflight(size_t worker) const { return num_inflight_[worker]; }
+  // Number of txns sent to the least loaded worker instead of the worker of their key
+  uint64_t num_rebalanced() const { return num_rebalanced_; }
+
+ private:
+  // Returns nullptr if the txn has no key
+  const Key* DominantKey(const Transaction& txn) const;
+  size_t WorkerOfKey(const Key& key) const;
+
+  internal::DispatchPolicy policy_;
+  SharderPtr sharder_;
+  // Number of keys in the range of each worker. Only used with the KEY_RANGE policy
+  uint64_t keys_per_worker_;
+  std::vector<uint32_t> num_inflight_;
+  size_t next_worker_;
+  uint64_t num_rebalanced_;
+};
+
+}  // namespace slog
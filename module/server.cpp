@@ -48,9 +48,16 @@ Transaction* Server::FinishedTransaction::ReleaseTxn() {
   return req_->mutable_request()->mutable_finished_subtxn()->release_txn();
 }
 
-Server::Server(const std::shared_ptr<Broker>& broker, const MetricsRepositoryManagerPtr& metrics_manager,
-               std::chrono::milliseconds poll_timeout)
-    : NetworkedModule(broker, kServerChannel, metrics_manager, poll_timeout), txn_id_counter_(0) {}
+Server::Server(const std::shared_ptr<Broker>& broker, const std::shared_ptr<VersionedStorage>& snapshot_storage,
+               const MetricsRepositoryManagerPtr& metrics_manager, std::chrono::milliseconds poll_timeout)
+    : NetworkedModule(broker, kServerChannel, metrics_manager, poll_timeout),
+      txn_id_counter_(0),
+      sharder_(Sharder::MakeSharder(config())) {
+  if (snapshot_storage != nullptr) {
+    snapshot_reader_queues_ = std::make_shared<SnapshotReaderQueues>();
+    snapshot_reader_ = MakeRunnerFor<SnapshotReader>(snapshot_reader_queues_, config(), snapshot_storage, poll_timeout);
+  }
+}
 
 /***********************************************
                 Initialization
@@ -76,6 +83,11 @@ void Server::Initialize() {
   }
 
   AddCustomSocket(move(client_socket));
+
+  if (snapshot_reader_ != nullptr) {
+    snapshot_reader_->StartInNewThread();
+    AddCustomEventFd(snapshot_reader_queues_->finished_txns.fd());
+  }
 }
 
 /***********************************************
@@ -83,11 +95,26 @@ void Server::Initialize() {
 ***********************************************/
 
 bool Server::OnCustomSocket() {
+  bool has_msg = false;
+  if (snapshot_reader_ != nullptr) {
+    Transaction* txn;
+    while (snapshot_reader_queues_->finished_txns.TryPop(txn)) {
+      SendTxnToClient(txn);
+      has_msg = true;
+    }
+    auto& backlog = snapshot_reader_backlog_;
+    while (!backlog.empty() && snapshot_reader_queues_->txns.TryPush(backlog.front())) {
+      backlog.pop_front();
+    }
+    // Keep looping without waiting for a new event until the backlog is pushed
+    has_msg |= !backlog.empty();
+  }
+
   auto& socket = GetCustomSocket(0);
 
   zmq::message_t identity;
   if (!socket.recv(identity, zmq::recv_flags::dontwait)) {
-    return false;
+    return has_msg;
   }
   if (!identity.more()) {
     LOG(ERROR) << "Invalid message from client: Only identity part is found";
@@ -120,6 +147,11 @@ bool Server::OnCustomSocket() {
         break;
       }
 
+      if (snapshot_reader_ != nullptr && IsLocalReadOnly(*txn)) {
+        SendToSnapshotReader(txn);
+        break;
+      }
+
       RECORD(txn_internal, TransactionEvent::EXIT_SERVER_TO_FORWARDER);
 
       // Send to forwarder
@@ -227,6 +259,8 @@ void Server::ProcessStatsRequest(const internal::StatsRequest& stats_request) {
   stats.AddMember(StringRef(TXN_ID_COUNTER), txn_id_counter_, alloc);
   stats.AddMember(StringRef(NUM_PENDING_RESPONSES), pending_responses_.size(), alloc);
   stats.AddMember(StringRef(NUM_PARTIALLY_FINISHED_TXNS), finished_txns_.size(), alloc);
+  stats.AddMember(StringRef(NUM_SNAPSHOT_READ_TXNS),
+                  snapshot_reader_ != nullptr ? snapshot_reader_queues_->num_read_txns.load() : 0, alloc);
   if (level >= 1) {
     stats.AddMember(StringRef(PENDING_RESPONSES),
                     ToJsonArrayOfKeyValue(
@@ -268,6 +302,25 @@ void Server::OnInternalResponseReceived(EnvelopePtr&& env) {
                     Helpers
 ***********************************************/
 
+bool Server::IsLocalReadOnly(const Transaction& txn) const {
+  if (txn.program_case() != Transaction::kCode) {
+    return false;
+  }
+  for (const auto& kv : txn.keys()) {
+    if (kv.value_entry().type() != KeyType::READ || !sharder_->is_local_key(kv.key())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Server::SendToSnapshotReader(Transaction* txn) {
+  auto& backlog = snapshot_reader_backlog_;
+  if (!backlog.empty() || !snapshot_reader_queues_->txns.TryPush(txn)) {
+    backlog.push_back(txn);
+  }
+}
+
 void Server::SendTxnToClient(Transaction* txn) {
   RECORD(txn->mutable_internal(), TransactionEvent::EXIT_SERVER_TO_CLIENT);
 
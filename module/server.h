@@ -3,6 +3,7 @@
 #include <glog/logging.h>
 
 #include <chrono>
+#include <deque>
 #include <set>
 #include <thread>
 #include <unordered_map>
@@ -13,10 +14,13 @@
 #include "common/configuration.h"
 #include "common/proto_utils.h"
 #include "common/types.h"
+#include "common/sharder.h"
 #include "connection/broker.h"
 #include "module/base/networked_module.h"
+#include "module/snapshot_reader.h"
 #include "proto/api.pb.h"
 #include "storage/lookup_master_index.h"
+#include "storage/versioned_storage.h"
 
 namespace slog {
 
@@ -28,11 +32,16 @@ namespace slog {
  * OUTPUT: For external TransactionRequest, it forwards the txn internally
  *         to appropriate modules and waits for internal responses before
  *         responding back to the client with an external TransactionResponse.
+ *
+ * If a versioned storage is given, read-only txns whose keys are all in the local
+ * partition are handed to a SnapshotReader, which executes them right away on a
+ * snapshot of the storage at its applied version, without taking any lock or going
+ * through the log.
  */
 class Server : public NetworkedModule {
  public:
-  Server(const std::shared_ptr<Broker>& broker, const MetricsRepositoryManagerPtr& metrics_manager,
-         std::chrono::milliseconds poll_timeout = kModuleTimeout);
+  Server(const std::shared_ptr<Broker>& broker, const std::shared_ptr<VersionedStorage>& snapshot_storage,
+         const MetricsRepositoryManagerPtr& metrics_manager, std::chrono::milliseconds poll_timeout = kModuleTimeout);
 
   std::string name() const override { return "Server"; }
 
@@ -56,6 +65,9 @@ class Server : public NetworkedModule {
   void ProcessFinishedSubtxn(EnvelopePtr&& req);
   void ProcessStatsRequest(const internal::StatsRequest& stats_request);
 
+  bool IsLocalReadOnly(const Transaction& txn) const;
+  void SendToSnapshotReader(Transaction* txn);
+
   void SendTxnToClient(Transaction* txn);
   void SendResponseToClient(TxnId txn_id, api::Response&& res);
 
@@ -63,6 +75,11 @@ class Server : public NetworkedModule {
 
   TxnId txn_id_counter_;
 
+  SharderPtr sharder_;
+  std::shared_ptr<SnapshotReaderQueues> snapshot_reader_queues_;
+  std::unique_ptr<ModuleRunner> snapshot_reader_;
+  std::deque<Transaction*> snapshot_reader_backlog_;
+
   struct PendingResponse {
     zmq::message_t identity;
     uint32_t stream_id;
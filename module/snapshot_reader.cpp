@@ -0,0 +1,67 @@
+#include "module/snapshot_reader.h"
+
+#include <glog/logging.h>
+
+#include "common/sharder.h"
+
+namespace slog {
+
+SnapshotReader::SnapshotReader(const std::shared_ptr<SnapshotReaderQueues>& queues, const ConfigurationPtr& config,
+                               const std::shared_ptr<VersionedStorage>& storage, std::chrono::milliseconds poll_timeout)
+    : queues_(queues), storage_(storage), poller_(poll_timeout) {
+  auto sharder = Sharder::MakeSharder(config);
+  switch (config->execution_type()) {
+    case internal::ExecutionType::KEY_VALUE:
+      execution_ = std::make_unique<KeyValueExecution>(sharder, storage_);
+      break;
+    case internal::ExecutionType::TPC_C:
+      execution_ = std::make_unique<TPCCExecution>(sharder, storage_);
+      break;
+    default:
+      execution_ = std::make_unique<NoopExecution>();
+      break;
+  }
+}
+
+void SnapshotReader::SetUp() { poller_.PushEventFd(queues_->txns.fd()); }
+
+bool SnapshotReader::Loop() {
+  // Keep looping without waiting for a new event until the backlog is pushed
+  if (!poller_.NextEvent(!backlog_.empty() /* dont_wait */)) {
+    return false;
+  }
+
+  while (!backlog_.empty() && queues_->finished_txns.TryPush(backlog_.front())) {
+    backlog_.pop_front();
+  }
+
+  Transaction* txn;
+  while (queues_->txns.TryPop(txn)) {
+    Execute(*txn);
+    if (!backlog_.empty() || !queues_->finished_txns.TryPush(txn)) {
+      backlog_.push_back(txn);
+    }
+  }
+  return false;
+}
+
+/**
+ * The snapshot is taken at the applied version of the local scheduler, so it may not
+ * include the txns that have just been sent back to their clients yet
+ */
+void SnapshotReader::Execute(Transaction& txn) {
+  VersionedStorage::Snapshot snapshot(*storage_);
+  for (auto& kv : *txn.mutable_keys()) {
+    auto value = kv.mutable_value_entry();
+    snapshot.ReadView(kv.key(), [value](std::string_view data, const Metadata& metadata) {
+      value->set_value(data.data(), data.size());
+      value->mutable_metadata()->set_master(metadata.master);
+      value->mutable_metadata()->set_counter(metadata.counter);
+    });
+  }
+  txn.mutable_internal()->set_version(snapshot.version());
+  execution_->Execute(txn);
+  queues_->num_read_txns.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace slog
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "common/configuration.h"
+#include "common/constants.h"
+#include "connection/poller.h"
+#include "data_structure/spsc_queue.h"
+#include "execution/execution.h"
+#include "module/base/module.h"
+#include "proto/transaction.pb.h"
+#include "storage/versioned_storage.h"
+
+namespace slog {
+
+/**
+ * Queues through which the server hands read-only txns to the snapshot reader and the reader
+ * hands them back once they are executed. Like the queues between the scheduler and the
+ * workers, either side keeps what does not fit in a full queue in a backlog.
+ */
+struct SnapshotReaderQueues {
+  SnapshotReaderQueues() : txns(kWorkerQueueCapacity), finished_txns(kWorkerQueueCapacity) {}
+
+  SpscQueue<Transaction*> txns;
+  SpscQueue<Transaction*> finished_txns;
+
+  std::atomic<uint64_t> num_read_txns = 0;
+};
+
+/**
+ * Executes the read-only txns that the server sends to it on a snapshot of the versioned
+ * storage at its applied version, in its own thread so that a long read does not hold up
+ * the server.
+ */
+class SnapshotReader : public Module {
+ public:
+  SnapshotReader(const std::shared_ptr<SnapshotReaderQueues>& queues, const ConfigurationPtr& config,
+                 const std::shared_ptr<VersionedStorage>& storage,
+                 std::chrono::milliseconds poll_timeout = kModuleTimeout);
+
+  std::string name() const override { return "SnapshotReader"; }
+
+  void SetUp() final;
+  bool Loop() final;
+
+ private:
+  void Execute(Transaction& txn);
+
+  std::shared_ptr<SnapshotReaderQueues> queues_;
+  std::shared_ptr<VersionedStorage> storage_;
+  std::unique_ptr<Execution> execution_;
+  std::deque<Transaction*> backlog_;
+  Poller poller_;
+};
+
+}  // namespace slog
@@ -147,6 +147,7 @@ void PrintServerStats(const rapidjson::Document& stats, uint32_t level) {
     TRUNCATED_FOR_EACH(txn_id, stats[PARTIALLY_FINISHED_TXNS].GetArray()) { cout << txn_id.GetUint() << " "; }
     cout << "\n";
   }
+  cout << "Read-only txns served from a snapshot: " << stats[NUM_SNAPSHOT_READ_TXNS].GetUint64() << "\n";
   cout << endl;
 }
 
@@ -231,38 +232,20 @@ string LockModeStr(LockMode mode) {
   return "<error>";
 }
 
-void PrintSchedulerStats(const rapidjson::Document& stats, uint32_t level) {
-  cout << "Number of active txns: " << stats[NUM_ALL_TXNS].GetUint() << "\n";
-  cout << "\nACTIVE TRANSACTIONS\n\n";
-  if (level == 0) {
-    TRUNCATED_FOR_EACH(txn_id, stats[ALL_TXNS].GetArray()) { cout << txn_id.GetUint() << " "; }
-  } else if (level >= 1) {
-    TRUNCATED_FOR_EACH(txn, stats[ALL_TXNS].GetArray()) {
-      cout << "\t";
-      cout << TXN_ID << ": " << txn[TXN_ID].GetUint() << ", ";
-      cout << TXN_DONE << ": " << txn[TXN_DONE].GetBool() << ", ";
-      cout << TXN_ABORTING << ": " << txn[TXN_ABORTING].GetBool() << ", ";
-      cout << TXN_NUM_LO << ": " << txn[TXN_NUM_LO].GetInt() << ", ";
-      cout << TXN_EXPECTED_NUM_LO << ": " << txn[TXN_EXPECTED_NUM_LO].GetInt() << ", ";
-      cout << TXN_NUM_DISPATCHES << ": " << txn[TXN_NUM_DISPATCHES].GetInt() << ", ";
-      cout << TXN_MULTI_HOME << ": " << txn[TXN_MULTI_HOME].GetBool() << ", ";
-      cout << TXN_MULTI_PARTITION << ": " << txn[TXN_MULTI_PARTITION].GetBool() << "\n";
-    }
-  }
-
-  cout << "\n";
+void PrintLockManagerStats(const rapidjson::Document& stats, uint32_t level) {
   cout << "Waiting txns: " << stats[NUM_TXNS_WAITING_FOR_LOCK].GetUint() << "\n";
 
-  // 0: OLD or RMA. 1: DDR
+  // 0: OLD or RMA. 1: DDR. 2: VLL
   auto lock_man_type = stats[LOCK_MANAGER_TYPE].GetInt();
 
-  if (lock_man_type == 0) {
+  if (lock_man_type != 1) {
     cout << "Locked keys: " << stats[NUM_LOCKED_KEYS].GetUint() << "\n";
   }
+  cout << "Lock table size: " << stats[LOCK_TABLE_SIZE].GetUint64() << "\n";
 
   if (level >= 1) {
     cout << "\n\nTRANSACTION DEPENDENCIES\n\n";
-    if (lock_man_type == 0) {
+    if (lock_man_type != 1) {
       cout << setw(10) << "Txn" << setw(18) << "# waiting for"
            << "\n";
       TRUNCATED_FOR_EACH(it, stats[NUM_WAITING_FOR_PER_TXN].GetArray()) {
@@ -301,6 +284,10 @@ void PrintSchedulerStats(const rapidjson::Document& stats, uint32_t level) {
           cout << "(" << txn_and_mode[0].GetUint() << ", "
                << LockModeStr(static_cast<LockMode>(txn_and_mode[1].GetUint())) << ") ";
         }
+      } else if (lock_man_type == 2) {
+        cout << "Key: " << entry[0].GetString() << "\n";
+        cout << "\tExclusive requests: " << entry[1].GetUint() << "\n";
+        cout << "\tShared requests: " << entry[2].GetUint();
       } else {
         cout << "Key: " << entry[0].GetString() << "\n";
         cout << "\tWrite: " << entry[1].GetUint() << "\n";
@@ -310,6 +297,80 @@ void PrintSchedulerStats(const rapidjson::Document& stats, uint32_t level) {
       cout << "\n";
     }
   }
+}
+
+void PrintSchedulerStats(const rapidjson::Document& stats, uint32_t level) {
+  cout << "Number of active txns: " << stats[NUM_ALL_TXNS].GetUint() << "\n";
+  cout << "\nACTIVE TRANSACTIONS\n\n";
+  if (level == 0) {
+    TRUNCATED_FOR_EACH(txn_id, stats[ALL_TXNS].GetArray()) { cout << txn_id.GetUint() << " "; }
+  } else if (level >= 1) {
+    TRUNCATED_FOR_EACH(txn, stats[ALL_TXNS].GetArray()) {
+      cout << "\t";
+      cout << TXN_ID << ": " << txn[TXN_ID].GetUint() << ", ";
+      cout << TXN_DONE << ": " << txn[TXN_DONE].GetBool() << ", ";
+      cout << TXN_ABORTING << ": " << txn[TXN_ABORTING].GetBool() << ", ";
+      cout << TXN_NUM_LO << ": " << txn[TXN_NUM_LO].GetInt() << ", ";
+      cout << TXN_EXPECTED_NUM_LO << ": " << txn[TXN_EXPECTED_NUM_LO].GetInt() << ", ";
+      cout << TXN_NUM_DISPATCHES << ": " << txn[TXN_NUM_DISPATCHES].GetInt() << ", ";
+      cout << TXN_MULTI_HOME << ": " << txn[TXN_MULTI_HOME].GetBool() << ", ";
+      cout << TXN_MULTI_PARTITION << ": " << txn[TXN_MULTI_PARTITION].GetBool() << "\n";
+    }
+  }
+
+  cout << "\nWORKERS\n\n";
+  cout << setw(10) << "Worker" << setw(12) << "In flight" << setw(12) << "Backlog"
+       << "\n";
+  for (const auto& entry : stats[WORKER_QUEUE_DEPTHS].GetArray()) {
+    const auto& depths = entry.GetArray();
+    cout << setw(10) << depths[0].GetUint() << setw(12) << depths[1].GetUint() << setw(12) << depths[2].GetUint()
+         << "\n";
+  }
+  cout << "Txns sent to the least loaded worker: " << stats[NUM_REBALANCED_DISPATCHES].GetUint64() << "\n";
+  if (stats.HasMember(NUM_STOLEN_TXNS)) {
+    cout << "Txns stolen by idle workers: " << stats[NUM_STOLEN_TXNS].GetUint64() << "\n";
+  }
+  cout << "Remote read results sent: " << stats[NUM_REMOTE_READ_RESULTS].GetUint64() << " in "
+       << stats[NUM_REMOTE_READ_MESSAGES].GetUint64() << " messages\n";
+
+  cout << "\n";
+  auto num_lock_manager_shards = stats[NUM_LOCK_MANAGER_SHARDS].GetUint();
+  if (num_lock_manager_shards == 1) {
+    PrintLockManagerStats(stats, level);
+  } else {
+    // Lock manager shards only report totals
+    cout << "Locks are managed by " << num_lock_manager_shards << " lock manager shards\n";
+    PrintLockManagerStats(stats, 0);
+  }
+
+  // Only storages made of hash maps keep stats
+  if (stats.HasMember(STORAGE_NUM_NODES)) {
+    cout << "\n\nSTORAGE\n\n";
+    cout << "Nodes: " << stats[STORAGE_NUM_NODES].GetUint64() << "\n";
+    cout << "Bytes: " << stats[STORAGE_BYTES].GetUint64() << "\n";
+    cout << "Largest segment bytes: " << stats[STORAGE_MAX_SEGMENT_BYTES].GetUint64() << "\n";
+    cout << "Rehashes: " << stats[STORAGE_NUM_REHASHES].GetUint64() << " ("
+         << stats[STORAGE_REHASH_NS].GetUint64() / 1000000.0 << " ms)\n";
+    cout << "Latch waits: " << stats[STORAGE_NUM_LATCH_WAITS].GetUint64() << " ("
+         << stats[STORAGE_LATCH_WAIT_NS].GetUint64() / 1000000.0 << " ms)\n";
+    cout << "Reads: " << stats[STORAGE_NUM_READS].GetUint64() << " (" << stats[STORAGE_READS_PER_SEC].GetDouble()
+         << " per sec since last stats request)\n";
+    cout << "Writes: " << stats[STORAGE_NUM_WRITES].GetUint64() << " (" << stats[STORAGE_WRITES_PER_SEC].GetDouble()
+         << " per sec since last stats request)\n";
+
+    if (level >= 1) {
+      cout << "\n\nSTORAGE SEGMENTS\n\n";
+      cout << setw(8) << "Segment" << setw(12) << "Nodes" << setw(12) << "Buckets" << setw(14) << "Bytes"
+           << setw(10) << "Rehashes" << setw(14) << "Rehash ns" << setw(12) << "Waits" << setw(14) << "Wait ns"
+           << "\n";
+      TRUNCATED_FOR_EACH(it, stats[STORAGE_SEGMENTS].GetArray()) {
+        const auto& entry = it.GetArray();
+        cout << setw(8) << entry[0].GetUint64() << setw(12) << entry[1].GetUint64() << setw(12) << entry[2].GetUint64()
+             << setw(14) << entry[3].GetUint64() << setw(10) << entry[4].GetUint64() << setw(14)
+             << entry[5].GetUint64() << setw(12) << entry[6].GetUint64() << setw(14) << entry[7].GetUint64() << "\n";
+      }
+    }
+  }
   cout << endl;
 }
 
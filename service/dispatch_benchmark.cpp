@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "common/proto_utils.h"
+#include "common/string_utils.h"
+#include "data_structure/spsc_queue.h"
+#include "data_structure/work_stealing_queue.h"
+#include "module/scheduler_components/worker_dispatcher.h"
+#include "service/service_utils.h"
+#include "storage/mem_only_storage.h"
+
+DEFINE_uint32(txns, 1000000, "Number of transactions per contention level and policy");
+DEFINE_uint32(workers, 3, "Number of workers");
+DEFINE_uint32(records, 1000000, "Number of records");
+DEFINE_uint32(record_size, 100, "Size of a record in bytes");
+DEFINE_string(hot_records, "100000,100,10",
+              "Comma-separated list of numbers of hot records. Each is a contention level, where every txn "
+              "writes one hot record and fewer hot records means more contention");
+DEFINE_uint32(keys_per_txn, 10, "Number of keys accessed by each txn");
+DEFINE_uint32(write_pct, 50, "Percent of the cold keys that are written");
+DEFINE_uint32(inflight, 100, "Number of txns that have been dispatched and not finished yet");
+DEFINE_string(policies, "round_robin,key_hash,key_range",
+              "Comma-separated list of dispatch policies. Choose from (round_robin, key_hash and key_range)");
+DEFINE_string(work_stealing, "off", "Comma-separated list of work stealing modes to run each policy with (off and on)");
+DEFINE_uint32(long_txn_pct, 0, "Percent of txns that sleep for long_txn_ms, like a txn with the SLEEP procedure");
+DEFINE_uint32(long_txn_ms, 1, "Time that a long txn sleeps for");
+DEFINE_uint32(partitions, 1, "Number of partitions. The workers run the txns of partition 0 and count the remote reads "
+              "that they would send to the other partitions");
+DEFINE_uint32(multi_partition_pct, 0, "Percent of txns that also access one of the other partitions");
+
+using namespace slog;
+using namespace std::chrono;
+
+using std::string;
+using std::vector;
+
+vector<Transaction*> MakeTransactions(uint32_t hot_records) {
+  std::mt19937 rg(0);
+  std::uniform_int_distribution<uint32_t> hot_dis(0, hot_records - 1);
+  std::uniform_int_distribution<uint32_t> cold_dis(hot_records, FLAGS_records - 1);
+  std::uniform_int_distribution<uint32_t> pct_dis(0, 99);
+
+  vector<Transaction*> txns;
+  txns.reserve(FLAGS_txns);
+  for (uint32_t i = 0; i < FLAGS_txns; i++) {
+    // The hot key is the first written key so it is the dominant key of the txn
+    vector<KeyMetadata> keys{{std::to_string(hot_dis(rg)), KeyType::WRITE, 0}};
+    for (uint32_t k = 1; k < FLAGS_keys_per_txn; k++) {
+      auto key = std::to_string(cold_dis(rg));
+      auto type = pct_dis(rg) < FLAGS_write_pct ? KeyType::WRITE : KeyType::READ;
+      if (std::none_of(keys.begin(), keys.end(), [&key](const auto& m) { return m.key == key; })) {
+        keys.emplace_back(key, type, 0);
+      }
+    }
+    auto txn = MakeTransaction(keys);
+    txn->mutable_internal()->set_id(i + 1);
+    if (FLAGS_partitions > 1 && pct_dis(rg) < FLAGS_multi_partition_pct) {
+      txn->mutable_internal()->add_active_partitions(0);
+      txn->mutable_internal()->add_active_partitions(1 + rg() % (FLAGS_partitions - 1));
+    }
+    if (pct_dis(rg) < FLAGS_long_txn_pct) {
+      auto sleep = txn->mutable_code()->add_procedures();
+      sleep->add_args("SLEEP");
+      sleep->add_args(std::to_string(FLAGS_long_txn_ms));
+    }
+    txns.push_back(txn);
+  }
+  return txns;
+}
+
+internal::DispatchPolicy ParsePolicy(const string& policy) {
+  if (policy == "round_robin") {
+    return internal::DispatchPolicy::ROUND_ROBIN;
+  } else if (policy == "key_hash") {
+    return internal::DispatchPolicy::KEY_HASH;
+  } else if (policy == "key_range") {
+    return internal::DispatchPolicy::KEY_RANGE;
+  }
+  LOG(FATAL) << "Unknown dispatch policy: " << policy;
+  return internal::DispatchPolicy::ROUND_ROBIN;
+}
+
+ConfigurationPtr MakeConfiguration(internal::DispatchPolicy policy) {
+  string address("/tmp/test_dispatch_benchmark");
+  internal::Configuration config_proto;
+  config_proto.set_protocol("ipc");
+  config_proto.add_broker_ports(0);
+  config_proto.set_server_port(5000);
+  config_proto.set_sequencer_port(5001);
+  config_proto.set_forwarder_port(5002);
+  config_proto.set_num_partitions(1);
+  config_proto.mutable_simple_partitioning()->set_num_records(FLAGS_records);
+  config_proto.mutable_simple_partitioning()->set_record_size_bytes(FLAGS_record_size);
+  config_proto.add_replicas()->add_addresses(address);
+  config_proto.set_num_workers(FLAGS_workers);
+  config_proto.set_dispatch_policy(policy);
+  return std::make_shared<Configuration>(config_proto, address);
+}
+
+struct WorkerQueue {
+  WorkerQueue() : txns(kWorkerQueueCapacity), finished_txns(kWorkerQueueCapacity) {}
+  SpscQueue<Transaction*> txns;
+  SpscQueue<Transaction*> finished_txns;
+  // Replaces the txns queue above with work stealing
+  WorkStealingQueue<Transaction*> ready_txns;
+};
+
+struct RunResult {
+  double throughput;
+  // Percent of txns sent to the least loaded worker instead of the worker of their key
+  double rebalanced_pct;
+  // Number of txns run by the busiest worker over the average number of txns per worker
+  double max_load;
+  // Percent of txns run by another worker than the one that they were dispatched to
+  double stolen_pct;
+  // Messages per second to send the remote reads to the other partitions, one per result or one per
+  // partition for all txns that a worker starts in one go
+  double remote_read_results_rate;
+  double remote_read_messages_rate;
+};
+
+void ExecuteTransaction(Storage& storage, const Transaction& txn, string& value) {
+  size_t bytes_read = 0;
+  for (const auto& kv : txn.keys()) {
+    storage.ReadView(kv.key(), [&bytes_read](std::string_view v, const Metadata&) { bytes_read += v.size(); });
+    if (kv.value_entry().type() == KeyType::WRITE) {
+      value[0] = static_cast<char>(bytes_read);
+      storage.Write(kv.key(), Record(value));
+    }
+  }
+  for (const auto& p : txn.code().procedures()) {
+    if (p.args_size() == 2 && p.args(0) == "SLEEP") {
+      std::this_thread::sleep_for(milliseconds(std::stoi(p.args(1))));
+    }
+  }
+}
+
+/**
+ * Dispatches the txns from the main thread like the scheduler does, keeping FLAGS_inflight
+ * txns dispatched and not finished. Each worker reads the keys of its txns and writes the
+ * written keys to the storage. No locks are taken, so txns with the same key may run at the
+ * same time on different workers and contend on the records instead of waiting for each other.
+ * With work stealing, a worker without txns of its own runs the oldest txn queued at the next
+ * workers, like the workers of the scheduler do. The remote reads of a multi-partition txn are
+ * only counted, both as one message per result and as one message per partition for all txns
+ * that a worker starts in one go, which is how a worker batches them.
+ */
+RunResult Run(Storage& storage, const vector<Transaction*>& txns, internal::DispatchPolicy policy, bool stealing) {
+  WorkerDispatcher dispatcher(MakeConfiguration(policy), FLAGS_workers);
+  vector<std::unique_ptr<WorkerQueue>> queues;
+  for (uint32_t i = 0; i < FLAGS_workers; i++) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  vector<uint64_t> num_txns(FLAGS_workers, 0);
+
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> num_stolen = 0;
+  std::atomic<uint64_t> num_remote_read_results = 0;
+  std::atomic<uint64_t> num_remote_read_messages = 0;
+  vector<std::thread> workers;
+  for (uint32_t i = 0; i < FLAGS_workers; i++) {
+    workers.emplace_back([&, i] {
+      auto& queue = *queues[i];
+      string value(FLAGS_record_size, 'y');
+      // Number of remote read results for each partition since the last flush
+      vector<uint32_t> remote_reads(FLAGS_partitions, 0);
+      auto run_txn = [&](Transaction* txn) {
+        ExecuteTransaction(storage, *txn, value);
+        for (auto p : txn->internal().active_partitions()) {
+          if (p != 0) {
+            remote_reads[p]++;
+          }
+        }
+        while (!queue.finished_txns.TryPush(txn)) {
+        }
+      };
+      Transaction* txn;
+      while (!done.load(std::memory_order_relaxed)) {
+        // Like a worker, start all txns queued without stealing, or one txn at a time with stealing
+        bool has_txn = false;
+        if (!stealing) {
+          while (queue.txns.TryPop(txn)) {
+            has_txn = true;
+            run_txn(txn);
+          }
+        } else if (queue.ready_txns.TryPop(txn)) {
+          has_txn = true;
+          run_txn(txn);
+        } else {
+          for (uint32_t j = 1; j < FLAGS_workers && !has_txn; j++) {
+            has_txn = queues[(i + j) % FLAGS_workers]->ready_txns.TryPop(txn);
+          }
+          num_stolen += has_txn;
+          if (has_txn) {
+            run_txn(txn);
+          }
+        }
+        if (!has_txn) {
+          std::this_thread::yield();
+          continue;
+        }
+        for (auto& n : remote_reads) {
+          if (n > 0) {
+            num_remote_read_results += n;
+            num_remote_read_messages++;
+            n = 0;
+          }
+        }
+      }
+    });
+  }
+
+  // Indexed by txn id, which starts at 1
+  vector<size_t> dispatched_to(txns.size() + 1);
+  size_t next_txn = 0, num_inflight = 0, num_finished = 0;
+  auto start_time = steady_clock::now();
+  while (num_finished < txns.size()) {
+    for (; next_txn < txns.size() && num_inflight < FLAGS_inflight; next_txn++, num_inflight++) {
+      auto worker = dispatcher.Select(*txns[next_txn]);
+      if (stealing) {
+        queues[worker]->ready_txns.Push(txns[next_txn]);
+      } else {
+        while (!queues[worker]->txns.TryPush(txns[next_txn])) {
+        }
+      }
+      dispatcher.OnDispatched(worker);
+      dispatched_to[txns[next_txn]->internal().id()] = worker;
+    }
+    for (uint32_t i = 0; i < FLAGS_workers; i++) {
+      Transaction* txn;
+      while (queues[i]->finished_txns.TryPop(txn)) {
+        // A stolen txn finishes on another worker than the one that it was dispatched to
+        dispatcher.OnFinished(dispatched_to[txn->internal().id()]);
+        num_txns[i]++;
+        num_inflight--;
+        num_finished++;
+      }
+    }
+  }
+  auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start_time).count();
+
+  done = true;
+  for (auto& t : workers) {
+    t.join();
+  }
+
+  auto max_txns = *std::max_element(num_txns.begin(), num_txns.end());
+  return {txns.size() / elapsed,
+          100.0 * dispatcher.num_rebalanced() / txns.size(),
+          static_cast<double>(max_txns) * FLAGS_workers / txns.size(),
+          100.0 * num_stolen / txns.size(),
+          num_remote_read_results / elapsed,
+          num_remote_read_messages / elapsed};
+}
+
+int main(int argc, char* argv[]) {
+  InitializeService(&argc, &argv);
+
+  CHECK_GT(FLAGS_workers, 0U) << "There must be at least one worker";
+  // Otherwise the main thread could spin on a full queue of a worker that spins on a full queue of finished txns
+  CHECK_LE(FLAGS_inflight, kWorkerQueueCapacity) << "Too many txns in flight: " << FLAGS_inflight;
+  CHECK_LE(FLAGS_write_pct, 100U) << "Invalid write percentage: " << FLAGS_write_pct;
+  CHECK_GT(FLAGS_partitions, 0U) << "There must be at least one partition";
+
+  MemOnlyStorage storage;
+  string value(FLAGS_record_size, 'x');
+  for (uint32_t key = 0; key < FLAGS_records; key++) {
+    storage.Write(std::to_string(key), Record(value));
+  }
+
+  for (const auto& hot : Split(FLAGS_hot_records, ",")) {
+    auto hot_records = std::stoul(hot);
+    CHECK(hot_records > 0 && hot_records < FLAGS_records) << "Invalid number of hot records: " << hot_records;
+
+    auto txns = MakeTransactions(hot_records);
+    for (const auto& policy : Split(FLAGS_policies, ",")) {
+      for (const auto& mode : Split(FLAGS_work_stealing, ",")) {
+        CHECK(mode == "off" || mode == "on") << "Unknown work stealing mode: " << mode;
+        auto result = Run(storage, txns, ParsePolicy(policy), mode == "on");
+        LOG(INFO) << "[" << policy << ", stealing " << mode << "] hot_records = " << hot_records
+                  << ", workers = " << FLAGS_workers << ", long_txn_pct = " << FLAGS_long_txn_pct
+                  << ", throughput = " << std::fixed << std::setprecision(0) << result.throughput
+                  << " txns/s, rebalanced = " << std::setprecision(1) << result.rebalanced_pct
+                  << "%, stolen = " << result.stolen_pct << "%, max load = " << std::setprecision(2)
+                  << result.max_load;
+        if (result.remote_read_results_rate > 0) {
+          LOG(INFO) << "Remote reads: " << std::fixed << std::setprecision(0) << result.remote_read_results_rate
+                    << " results/s, " << result.remote_read_messages_rate << " messages/s when batched ("
+                    << std::setprecision(1)
+                    << 100.0 * (1 - result.remote_read_messages_rate / result.remote_read_results_rate)
+                    << "% fewer)";
+        }
+      }
+    }
+
+    for (auto txn : txns) {
+      delete txn;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/string_utils.h"
+#include "data_structure/concurrent_hash_map.h"
+#include "service/service_utils.h"
+
+DEFINE_string(readers, "1,2,4", "Comma-separated list of numbers of reader threads. Each is a separate run");
+DEFINE_uint32(keys, 10000, "Number of keys in the map");
+DEFINE_uint32(duration, 1, "Duration of each run in seconds");
+
+using namespace slog;
+using namespace std::chrono;
+
+using std::string;
+using std::vector;
+
+struct RunResult {
+  double read_throughput;
+  double write_throughput;
+};
+
+/**
+ * Measures the read throughput of num_readers readers while one writer keeps updating random
+ * keys of the map. Each value is prefixed with its key so that the readers can detect torn or
+ * misplaced reads.
+ */
+RunResult Run(uint32_t num_readers) {
+  ConcurrentHashMap<uint32_t, string> map;
+  for (uint32_t i = 0; i < FLAGS_keys; i++) {
+    map.InsertOrUpdate(i, std::to_string(i) + ":0");
+  }
+
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> total_reads = 0;
+  uint64_t total_writes = 0;
+
+  std::thread writer([&] {
+    std::mt19937 rg(0);
+    for (uint64_t n = 1; !done.load(std::memory_order_relaxed); n++) {
+      auto k = rg() % FLAGS_keys;
+      map.InsertOrUpdate(k, std::to_string(k) + ":" + std::to_string(n));
+      total_writes++;
+    }
+  });
+
+  vector<std::thread> readers;
+  for (uint32_t i = 0; i < num_readers; i++) {
+    readers.emplace_back([&, seed = i + 1] {
+      std::mt19937 rg(seed);
+      uint64_t reads = 0;
+      string result;
+      while (!done.load(std::memory_order_relaxed)) {
+        auto k = rg() % FLAGS_keys;
+        CHECK(map.Get(result, k)) << "Key not found: " << k;
+        CHECK_EQ(result.substr(0, result.find(':')), std::to_string(k)) << "Torn or misplaced read";
+        reads++;
+      }
+      total_reads += reads;
+    });
+  }
+
+  std::this_thread::sleep_for(seconds(FLAGS_duration));
+  done = true;
+  writer.join();
+  for (auto& r : readers) {
+    r.join();
+  }
+
+  return {static_cast<double>(total_reads) / FLAGS_duration, static_cast<double>(total_writes) / FLAGS_duration};
+}
+
+int main(int argc, char* argv[]) {
+  InitializeService(&argc, &argv);
+
+  CHECK_GT(FLAGS_keys, 0U) << "There must be at least one key";
+
+  for (const auto& readers : Split(FLAGS_readers, ",")) {
+    auto num_readers = std::stoul(readers);
+    auto result = Run(num_readers);
+    LOG(INFO) << num_readers << " reader(s) + 1 writer, keys = " << FLAGS_keys << ", throughput = " << std::fixed
+              << std::setprecision(0) << result.read_throughput << " reads/s, " << result.write_throughput
+              << " writes/s";
+  }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "common/proto_utils.h"
+#include "common/string_utils.h"
+#include "module/scheduler_components/lock_manager_shard.h"
+#include "service/service_utils.h"
+
+DEFINE_uint32(txns, 1000000, "Number of transactions per contention level");
+DEFINE_uint32(records, 1000000, "Number of records");
+DEFINE_string(hot_records, "100000,1000,100,10",
+              "Comma-separated list of numbers of hot records. Each is a contention level, where every txn "
+              "accesses one hot record and fewer hot records means more contention");
+DEFINE_uint32(keys_per_txn, 10, "Number of keys accessed by each txn");
+DEFINE_uint32(write_pct, 50, "Percent of keys that are written");
+DEFINE_uint32(inflight, 100, "Number of txns that have requested their locks and not released them yet");
+
+using namespace slog;
+using namespace std::chrono;
+
+using std::vector;
+
+#if defined(REMASTER_PROTOCOL_SIMPLE) || defined(REMASTER_PROTOCOL_PER_KEY) || \
+    (defined(LOCK_MANAGER_OLD) && !defined(REMASTER_PROTOCOL_COUNTERLESS))
+const char kLockManagerName[] = "OLD";
+#elif defined(LOCK_MANAGER_DDR)
+const char kLockManagerName[] = "DDR";
+#elif defined(LOCK_MANAGER_VLL)
+const char kLockManagerName[] = "VLL";
+#else
+const char kLockManagerName[] = "RMA";
+#endif
+
+vector<Transaction*> MakeTransactions(uint32_t hot_records) {
+  std::mt19937 rg(0);
+  std::uniform_int_distribution<uint32_t> hot_dis(0, hot_records - 1);
+  std::uniform_int_distribution<uint32_t> cold_dis(hot_records, FLAGS_records - 1);
+  std::uniform_int_distribution<uint32_t> pct_dis(0, 99);
+
+  vector<Transaction*> txns;
+  txns.reserve(FLAGS_txns);
+  for (uint32_t i = 0; i < FLAGS_txns; i++) {
+    vector<KeyMetadata> keys;
+    for (uint32_t k = 0; k < FLAGS_keys_per_txn; k++) {
+      auto key = std::to_string(k == 0 ? hot_dis(rg) : cold_dis(rg));
+      auto type = pct_dis(rg) < FLAGS_write_pct ? KeyType::WRITE : KeyType::READ;
+      // A txn never requests the same lock twice
+      if (std::none_of(keys.begin(), keys.end(), [&key](const auto& m) { return m.key == key; })) {
+        keys.emplace_back(key, type, 0);
+      }
+    }
+    auto txn = MakeTransaction(keys);
+    txn->mutable_internal()->set_id(i + 1);
+    txn->mutable_internal()->set_home(0);
+    txns.push_back(txn);
+  }
+  return txns;
+}
+
+struct RunResult {
+  double throughput;
+  // Percent of txns that did not get all locks on request
+  double blocked_pct;
+  // Number of lock table entries left at the end, which stays flat as long as the idle
+  // entries are collected
+  uint64_t lock_table_size;
+};
+
+/**
+ * Requests the locks of the txns in log order, keeping FLAGS_inflight txns between requesting
+ * their locks and releasing them. The txns release their locks in the order that they get them.
+ * Like the scheduler, all txns that hold their locks at an iteration release them together and
+ * the lock table is garbage collected once per iteration.
+ */
+RunResult Run(const vector<Transaction*>& txns) {
+  LockManager lock_manager;
+  std::deque<TxnId> ready_txns;
+  size_t next_txn = 0, num_inflight = 0, num_blocked = 0;
+
+  auto start_time = steady_clock::now();
+  for (size_t num_released = 0; num_released < txns.size();) {
+    for (; next_txn < txns.size() && num_inflight < FLAGS_inflight; next_txn++, num_inflight++) {
+      if (lock_manager.AcquireLocks(*txns[next_txn]) == AcquireLocksResult::ACQUIRED) {
+        ready_txns.push_back(txns[next_txn]->internal().id());
+      } else {
+        num_blocked++;
+      }
+    }
+    // The oldest txn that has not released its locks always holds all of them
+    CHECK(!ready_txns.empty()) << "No txn holds all of its locks";
+    // The txns unblocked by this batch are released in the next one
+    for (auto batch_size = ready_txns.size(); batch_size > 0; batch_size--, num_released++, num_inflight--) {
+      auto txn_id = ready_txns.front();
+      ready_txns.pop_front();
+      for (auto unblocked_txn_id : lock_manager.ReleaseLocks(txn_id)) {
+        ready_txns.push_back(unblocked_txn_id);
+      }
+    }
+    lock_manager.CollectGarbage(kLockTableGCBatchSize);
+  }
+  auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start_time).count();
+
+  rapidjson::Document stats;
+  stats.SetObject();
+  lock_manager.GetStats(stats, 0);
+
+  return {txns.size() / elapsed, 100.0 * num_blocked / txns.size(), stats[LOCK_TABLE_SIZE].GetUint64()};
+}
+
+int main(int argc, char* argv[]) {
+  InitializeService(&argc, &argv);
+
+  CHECK_LE(FLAGS_write_pct, 100U) << "Invalid write percentage: " << FLAGS_write_pct;
+
+  for (const auto& hot : Split(FLAGS_hot_records, ",")) {
+    auto hot_records = std::stoul(hot);
+    CHECK(hot_records > 0 && hot_records < FLAGS_records) << "Invalid number of hot records: " << hot_records;
+
+    auto txns = MakeTransactions(hot_records);
+    auto result = Run(txns);
+    LOG(INFO) << "[" << kLockManagerName << "] hot_records = " << hot_records
+              << ", keys_per_txn = " << FLAGS_keys_per_txn << ", write_pct = " << FLAGS_write_pct
+              << ", throughput = " << std::fixed << std::setprecision(0) << result.throughput
+              << " txns/s, blocked = " << std::setprecision(1) << result.blocked_pct
+              << "%, lock table size = " << result.lock_table_size;
+
+    for (auto txn : txns) {
+      delete txn;
+    }
+  }
+
+  return 0;
+}
@@ -1,7 +1,9 @@
 #include <chrono>
+#include <random>
 
 #include "common/configuration.h"
 #include "common/csv_writer.h"
+#include "common/slab_allocator.h"
 #include "common/string_utils.h"
 #include "connection/broker.h"
 #include "module/scheduler.h"
@@ -11,12 +13,19 @@
 
 DEFINE_uint32(txns, 100, "Number of transactions");
 DEFINE_uint32(workers, 3, "Number of workers");
+DEFINE_uint32(lock_manager_shards, 1, "Number of threads that the lock table is split across");
+DEFINE_uint32(batch_size, 1, "Number of transactions sent to the scheduler in one message, like a batch of the log");
 DEFINE_uint32(records, 100000, "Number of records");
 DEFINE_uint32(record_size, 100, "Size of a record in bytes");
 DEFINE_string(params, "hot=0,hot_records=0", "Basic workload params");
 DEFINE_double(sample, 10, "Percent of sampled transactions to be written to result files");
 DEFINE_string(out_dir, ".", "Directory containing output data");
 DEFINE_string(execution, "key_value", "Execution type. Choose from (noop and key_value)");
+DEFINE_string(dispatch, "round_robin",
+              "Policy for dispatching txns to workers. Choose from (round_robin, key_hash and key_range)");
+DEFINE_bool(work_stealing, false, "Let idle workers steal the txns queued at other workers");
+DEFINE_uint32(long_txn_pct, 0, "Percent of transactions that sleep for long_txn_ms before committing");
+DEFINE_uint32(long_txn_ms, 10, "Time that a long transaction sleeps for");
 
 using namespace slog;
 using namespace std::chrono;
@@ -47,6 +56,7 @@ int main(int argc, char* argv[]) {
   config_proto.mutable_simple_partitioning()->set_record_size_bytes(FLAGS_record_size);
   config_proto.add_replicas()->add_addresses(address);
   config_proto.set_num_workers(FLAGS_workers);
+  config_proto.set_num_lock_manager_shards(FLAGS_lock_manager_shards);
   if (FLAGS_execution == "noop") {
     config_proto.set_execution_type(internal::ExecutionType::NOOP);
   } else if (FLAGS_execution == "key_value") {
@@ -54,6 +64,16 @@ int main(int argc, char* argv[]) {
   } else {
     LOG(FATAL) << "Unknown commands type: " << FLAGS_execution;
   }
+  if (FLAGS_dispatch == "round_robin") {
+    config_proto.set_dispatch_policy(internal::DispatchPolicy::ROUND_ROBIN);
+  } else if (FLAGS_dispatch == "key_hash") {
+    config_proto.set_dispatch_policy(internal::DispatchPolicy::KEY_HASH);
+  } else if (FLAGS_dispatch == "key_range") {
+    config_proto.set_dispatch_policy(internal::DispatchPolicy::KEY_RANGE);
+  } else {
+    LOG(FATAL) << "Unknown dispatch policy: " << FLAGS_dispatch;
+  }
+  config_proto.set_work_stealing(FLAGS_work_stealing);
 
   auto config = make_shared<Configuration>(config_proto, address);
   auto storage = make_shared<slog::MemOnlyStorage>();
@@ -70,8 +90,15 @@ int main(int argc, char* argv[]) {
   BasicWorkload workload(config, 0, "", FLAGS_params);
   vector<Transaction*> transactions;
   LOG(INFO) << "Generating " << FLAGS_txns << " transactions";
+  std::mt19937 long_txn_rg(0);
+  std::uniform_int_distribution<uint32_t> pct_dis(0, 99);
   for (size_t i = 0; i < FLAGS_txns; i++) {
     auto txn = workload.NextTransaction().first;
+    if (pct_dis(long_txn_rg) < FLAGS_long_txn_pct) {
+      auto sleep = txn->mutable_code()->add_procedures();
+      sleep->add_args("SLEEP");
+      sleep->add_args(std::to_string(FLAGS_long_txn_ms));
+    }
     txn->mutable_internal()->add_involved_replicas(0);
     txn->mutable_internal()->add_involved_partitions(0);
     txn->mutable_internal()->set_coordinating_server(0);
@@ -88,11 +115,20 @@ int main(int argc, char* argv[]) {
   LOG(INFO) << "Sending all transactions through the scheduler";
   std::unordered_map<TxnId, TxnInfo::TimePoint> sent_at;
   Sender sender(config, broker->context());
-  for (auto txn : transactions) {
+  auto batch_size = std::max(FLAGS_batch_size, 1U);
+  for (size_t i = 0; i < transactions.size(); i += batch_size) {
     auto env = std::make_unique<internal::Envelope>();
-    env->mutable_request()->mutable_forward_txn()->set_allocated_txn(txn);
+    auto end = std::min(i + batch_size, transactions.size());
+    for (size_t j = i; j < end; j++) {
+      auto txn = transactions[j];
+      sent_at[txn->internal().id()] = std::chrono::system_clock::now();
+      if (batch_size == 1) {
+        env->mutable_request()->mutable_forward_txn()->set_allocated_txn(txn);
+      } else {
+        env->mutable_request()->mutable_forward_txns()->mutable_txns()->AddAllocated(txn);
+      }
+    }
     sender.Send(std::move(env), kSchedulerChannel);
-    sent_at[txn->internal().id()] = std::chrono::system_clock::now();
   }
 
   // Receive the results
@@ -114,6 +150,11 @@ int main(int argc, char* argv[]) {
     LOG(INFO) << "Avg. Throughput: " << std::fixed << std::setprecision(3) << avg_throughput << " txn/s";
   }
 
+  auto alloc_stats = SlabAllocator::GetStats();
+  LOG(INFO) << "Record payload allocations: " << alloc_stats.slab_allocations << " from slabs, "
+            << alloc_stats.large_allocations << " large. System allocations: " << alloc_stats.system_allocations()
+            << " (" << alloc_stats.slabs << " slabs of " << SlabAllocator::kSlabSize << " bytes)";
+
   // Sample a subset of the result
   std::mt19937 rg(0);
   std::shuffle(results.begin(), results.end(), rg);
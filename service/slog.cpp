@@ -1,5 +1,6 @@
-#include <fcntl.h>
+#include <unistd.h>
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -22,14 +23,28 @@
 #include "proto/internal.pb.h"
 #include "proto/offline_data.pb.h"
 #include "service/service_utils.h"
+#include "storage/bulk_loader.h"
+#include "storage/checkpoint.h"
+#include "storage/flat_storage.h"
 #include "storage/mem_only_storage.h"
 #include "storage/metadata_initializer.h"
+#include "storage/numa_storage.h"
+#include "storage/ordered_storage.h"
+#include "storage/tiered_storage.h"
+#include "storage/versioned_storage.h"
 #include "version.h"
 
 DEFINE_string(config, "slog.conf", "Path to the configuration file");
 DEFINE_string(address, "", "Address of the local machine");
 DEFINE_string(data_dir, "", "Directory containing intial data");
-DEFINE_uint32(data_threads, 3, "Number of threads used to generate initial data");
+DEFINE_uint32(data_threads, 3, "Number of threads used to generate or load initial data");
+DEFINE_string(checkpoint, "",
+              "Path to a checkpoint file. If the file exists, initial data is loaded from it. Otherwise, "
+              "initial data is generated or loaded as usual then written to it");
+DEFINE_string(tiered_storage_file, "/tmp/slog_tiered_storage",
+              "Path of the file holding the evicted records if the storage type is TIERED. A unique suffix is "
+              "appended to it");
+DEFINE_uint64(storage_memory_mb, 1024, "Memory budget for the records in MB if the storage type is TIERED");
 
 using slog::Broker;
 using slog::ConfigurationPtr;
@@ -40,6 +55,32 @@ using slog::Record;
 
 using std::make_shared;
 
+/**
+ * The initial data of a machine depends on its partition and replica, and on the partitioning
+ * parameters that it is generated with, or on the data directory that it is loaded from
+ */
+slog::CheckpointFingerprint MakeCheckpointFingerprint(const ConfigurationPtr& config) {
+  const auto& proto_config = config->proto_config();
+  string data_params = std::to_string(config->num_replicas()) + ":" + std::to_string(proto_config.partitioning_case());
+  switch (proto_config.partitioning_case()) {
+    case slog::internal::Configuration::kSimplePartitioning:
+      data_params += proto_config.simple_partitioning().SerializeAsString();
+      break;
+    case slog::internal::Configuration::kTpccPartitioning:
+      data_params += proto_config.tpcc_partitioning().SerializeAsString();
+      break;
+    default:
+      data_params += proto_config.hash_partitioning().SerializeAsString() + FLAGS_data_dir;
+      break;
+  }
+  // 64-bit FNV-1a
+  uint64_t hash = 0xcbf29ce484222325;
+  for (unsigned char c : data_params) {
+    hash = (hash ^ c) * 0x100000001b3;
+  }
+  return {config->num_partitions(), config->local_partition(), config->local_replica(), hash};
+}
+
 void LoadData(slog::Storage& storage, const ConfigurationPtr& config, const string& data_dir) {
   if (data_dir.empty()) {
     LOG(INFO) << "No initial data directory specified. Starting with an empty storage.";
@@ -48,25 +89,13 @@ void LoadData(slog::Storage& storage, const ConfigurationPtr& config, const stri
 
   auto data_file = data_dir + "/" + std::to_string(config->local_partition()) + ".dat";
 
-  auto fd = open(data_file.c_str(), O_RDONLY);
-  if (fd < 0) {
-    LOG(ERROR) << "Error while loading \"" << data_file << "\": " << strerror(errno)
-               << ". Starting with an empty storage.";
-    return;
-  }
-
-  slog::OfflineDataReader reader(fd);
-  LOG(INFO) << "Loading " << reader.GetNumDatums() << " datums...";
-
   auto sharder = slog::Sharder::MakeSharder(config);
 
-  VLOG(1) << "First 10 datums are: ";
-  int c = 10;
-  while (reader.HasNextDatum()) {
-    auto datum = reader.GetNextDatum();
-    if (c > 0) {
-      VLOG(1) << datum.key() << " " << datum.record() << " " << datum.master();
-      c--;
+  // Datums are parsed and written to the storage by multiple threads if the data file is in the chunked format
+  std::atomic<int> num_logged = 0;
+  auto LoadFn = [&](const slog::Datum& datum) {
+    if (num_logged < 10 && num_logged++ < 10) {
+      VLOG(1) << "Datum: " << datum.key() << " " << datum.record() << " " << datum.master();
     }
 
     CHECK(sharder->is_local_key(datum.key()))
@@ -75,13 +104,26 @@ void LoadData(slog::Storage& storage, const ConfigurationPtr& config, const stri
     CHECK_LT(datum.master(), config->num_replicas()) << "Master number exceeds number of replicas";
 
     // Write to storage
-    Record record(datum.record(), datum.master());
-    storage.Write(datum.key(), record);
+    storage.Write(datum.key(), Record(datum.record(), datum.master()));
+  };
+  if (!slog::ReadOfflineData(data_file, FLAGS_data_threads, LoadFn)) {
+    LOG(ERROR) << "Error while loading \"" << data_file << "\". Starting with an empty storage.";
+    // Remove the datums that were loaded before the error
+    std::vector<Key> keys;
+    storage.ForEach([&keys](const Key& key, std::string_view, const Metadata&) { keys.push_back(key); });
+    for (const auto& key : keys) {
+      storage.Delete(key);
+    }
   }
-  close(fd);
 }
 
+/**
+ * If numa_storage is set, each thread only generates the records of one NUMA node and runs on
+ * that node so that the records are allocated there. The threads of a node split the whole key
+ * range between them
+ */
 void GenerateSimpleData(std::shared_ptr<slog::Storage> storage,
+                        const std::shared_ptr<slog::NumaStorage>& numa_storage,
                         const std::shared_ptr<slog::MetadataInitializer>& metadata_initializer,
                         const ConfigurationPtr& config) {
   auto simple_partitioning = config->proto_config().simple_partitioning();
@@ -92,32 +134,54 @@ void GenerateSimpleData(std::shared_ptr<slog::Storage> storage,
   // Create a value of specified size by repeating the character 'a'
   string value(simple_partitioning.record_size_bytes(), 'a');
 
-  LOG(INFO) << "Generating ~" << num_records / num_partitions << " records using " << FLAGS_data_threads << " threads. "
+  uint32_t num_nodes = numa_storage != nullptr ? numa_storage->topology().num_nodes() : 1;
+  uint32_t num_threads = std::max(FLAGS_data_threads, num_nodes);
+
+  LOG(INFO) << "Generating ~" << num_records / num_partitions << " records using " << num_threads << " threads. "
             << "Record size = " << simple_partitioning.record_size_bytes() << " bytes";
 
+  // Records are generated in parallel into separate buffers, which are bulk-loaded into the storage whenever
+  // they are full so that the whole data is never held twice in memory
+  storage->Reserve(num_records / num_partitions + 1);
+  slog::BulkLoader loader(*storage);
   std::atomic<uint64_t> counter = 0;
   std::atomic<size_t> num_done = 0;
-  auto GenerateFn = [&](uint64_t from_key, uint64_t to_key) {
-    for (uint64_t key = from_key; key < to_key; key += num_partitions) {
+  auto GenerateFn = [&](int node, uint64_t from_key, uint64_t to_key) {
+    slog::BulkLoader::Buffer buffer;
+    for (uint64_t i = from_key; i < to_key; i += num_partitions) {
+      auto key = std::to_string(i);
+      if (num_nodes > 1 && numa_storage->NodeOf(key) != node) {
+        continue;
+      }
       Record record(value);
-      record.SetMetadata(metadata_initializer->Compute(std::to_string(key)));
-      storage->Write(std::to_string(key), record);
+      record.SetMetadata(metadata_initializer->Compute(key));
+      loader.Add(buffer, std::move(key), std::move(record));
       counter++;
     }
+    loader.Flush(buffer);
     num_done++;
   };
   std::vector<std::thread> threads;
-  uint64_t range = num_records / FLAGS_data_threads + 1;
-  for (uint32_t i = 0; i < FLAGS_data_threads; i++) {
-    uint64_t range_start = i * range;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    int node = i % num_nodes;
+    uint32_t num_node_threads = (num_threads - node + num_nodes - 1) / num_nodes;
+    uint64_t range = num_records / num_node_threads + 1;
+    uint64_t range_start = i / num_nodes * range;
     uint64_t partition_of_range_start = range_start % num_partitions;
     uint64_t distance_to_next_in_partition_key =
         (partition - partition_of_range_start + num_partitions) % num_partitions;
     uint64_t from_key = range_start + distance_to_next_in_partition_key;
-    uint64_t to_key = std::min((i + 1) * range, num_records);
-    threads.emplace_back(GenerateFn, from_key, to_key);
+    uint64_t to_key = std::min((i / num_nodes + 1) * range, num_records);
+    if (numa_storage != nullptr) {
+      threads.push_back(slog::StartOnNode(numa_storage->topology(), node,
+                                          [&GenerateFn, node, from_key, to_key] {
+                                            GenerateFn(node, from_key, to_key);
+                                          }));
+    } else {
+      threads.emplace_back(GenerateFn, node, from_key, to_key);
+    }
   }
-  while (num_done < FLAGS_data_threads) {
+  while (num_done < num_threads) {
     std::this_thread::sleep_for(std::chrono::seconds(5));
     LOG(INFO) << "Generated " << counter.load() << " records";
   }
@@ -131,8 +195,10 @@ void GenerateTPCCData(std::shared_ptr<slog::Storage> storage,
                       const ConfigurationPtr& config) {
   auto tpcc_partitioning = config->proto_config().tpcc_partitioning();
   auto storage_adapter = std::make_shared<slog::tpcc::KVStorageAdapter>(storage, metadata_initializer);
+  storage_adapter->BeginBulkLoad();
   slog::tpcc::LoadTables(storage_adapter, tpcc_partitioning.warehouses(), config->num_replicas(),
                          config->num_partitions(), config->local_partition(), FLAGS_data_threads);
+  storage_adapter->EndBulkLoad();
 }
 
 int main(int argc, char* argv[]) {
@@ -166,6 +232,7 @@ int main(int argc, char* argv[]) {
   }
   LOG(INFO) << "Replication order: " << os.str();
   LOG(INFO) << "Execution type: " << ENUM_NAME(config->execution_type(), slog::internal::ExecutionType);
+  LOG(INFO) << "Storage type: " << ENUM_NAME(config->storage_type(), slog::internal::StorageType);
   if (config->return_dummy_txn()) {
     LOG(WARNING) << "Dummy transactions will be returned";
   }
@@ -173,24 +240,75 @@ int main(int argc, char* argv[]) {
   auto broker = Broker::New(config);
 
   // Create and initialize storage layer
-  auto storage = make_shared<slog::MemOnlyStorage>();
+  std::shared_ptr<slog::Storage> storage;
+  std::shared_ptr<slog::LookupMasterIndex> lookup_master_index;
+  // Only set if read-only txns can be served from a snapshot
+  std::shared_ptr<slog::VersionedStorage> versioned_storage;
+  // Only set if the storage is split by NUMA node
+  std::shared_ptr<slog::NumaStorage> numa_storage;
+  if (config->storage_type() == slog::internal::StorageType::FLAT) {
+    auto flat_storage = make_shared<slog::FlatStorage>();
+    storage = flat_storage;
+    lookup_master_index = flat_storage;
+  } else if (config->storage_type() == slog::internal::StorageType::ORDERED) {
+    auto ordered_storage = make_shared<slog::OrderedStorage>();
+    storage = ordered_storage;
+    lookup_master_index = ordered_storage;
+  } else if (config->storage_type() == slog::internal::StorageType::VERSIONED) {
+    versioned_storage = make_shared<slog::VersionedStorage>();
+    storage = versioned_storage;
+    lookup_master_index = versioned_storage;
+  } else if (config->storage_type() == slog::internal::StorageType::TIERED) {
+    auto tiered_storage =
+        make_shared<slog::TieredStorage>(FLAGS_tiered_storage_file, FLAGS_storage_memory_mb * 1024 * 1024);
+    storage = tiered_storage;
+    lookup_master_index = tiered_storage;
+  } else if (config->storage_type() == slog::internal::StorageType::NUMA) {
+    numa_storage = make_shared<slog::NumaStorage>();
+    storage = numa_storage;
+    lookup_master_index = numa_storage;
+    LOG(INFO) << "Storage split over " << numa_storage->topology().num_nodes() << " NUMA node(s)";
+  } else {
+    auto mem_only_storage = make_shared<slog::MemOnlyStorage>();
+    storage = mem_only_storage;
+    lookup_master_index = mem_only_storage;
+  }
+  // Initial data is loaded from the checkpoint if there is one
+  bool from_checkpoint = !FLAGS_checkpoint.empty() && access(FLAGS_checkpoint.c_str(), F_OK) == 0;
+  auto data_start_time = std::chrono::steady_clock::now();
+  if (from_checkpoint) {
+    CHECK(slog::LoadCheckpoint(*storage, MakeCheckpointFingerprint(config), FLAGS_checkpoint, FLAGS_data_threads))
+        << "Cannot load checkpoint \"" << FLAGS_checkpoint << "\"";
+  }
   std::shared_ptr<slog::MetadataInitializer> metadata_initializer;
   switch (config->proto_config().partitioning_case()) {
     case slog::internal::Configuration::kSimplePartitioning:
       metadata_initializer =
           make_shared<slog::SimpleMetadataInitializer>(config->num_replicas(), config->num_partitions());
-      GenerateSimpleData(storage, metadata_initializer, config);
+      if (!from_checkpoint) {
+        GenerateSimpleData(storage, numa_storage, metadata_initializer, config);
+      }
       break;
     case slog::internal::Configuration::kTpccPartitioning:
       metadata_initializer =
           make_shared<slog::tpcc::TPCCMetadataInitializer>(config->num_replicas(), config->num_partitions());
-      GenerateTPCCData(storage, metadata_initializer, config);
+      if (!from_checkpoint) {
+        GenerateTPCCData(storage, metadata_initializer, config);
+      }
       break;
     default:
       metadata_initializer = make_shared<slog::ConstantMetadataInitializer>(0);
-      LoadData(*storage, config, FLAGS_data_dir);
+      if (!from_checkpoint) {
+        LoadData(*storage, config, FLAGS_data_dir);
+      }
       break;
   }
+  auto data_time = std::chrono::steady_clock::now() - data_start_time;
+  LOG(INFO) << "Initial data ready in " << std::chrono::duration_cast<std::chrono::milliseconds>(data_time).count()
+            << " ms";
+  if (!FLAGS_checkpoint.empty() && !from_checkpoint) {
+    slog::WriteCheckpoint(*storage, MakeCheckpointFingerprint(config), FLAGS_checkpoint);
+  }
 
   auto config_name = FLAGS_config;
   if (auto pos = config_name.rfind('/'); pos != std::string::npos) {
@@ -200,13 +318,13 @@ int main(int argc, char* argv[]) {
 
   vector<pair<unique_ptr<slog::ModuleRunner>, slog::ModuleId>> modules;
   // clang-format off
-  modules.emplace_back(MakeRunnerFor<slog::Server>(broker, metrics_manager),
+  modules.emplace_back(MakeRunnerFor<slog::Server>(broker, versioned_storage, metrics_manager),
                        slog::ModuleId::SERVER);
   modules.emplace_back(MakeRunnerFor<slog::MultiHomeOrderer>(broker, metrics_manager),
                        slog::ModuleId::MHORDERER);
   modules.emplace_back(MakeRunnerFor<slog::LocalPaxos>(broker),
                        slog::ModuleId::LOCALPAXOS);
-  modules.emplace_back(MakeRunnerFor<slog::Forwarder>(broker->context(), broker->config(), storage,
+  modules.emplace_back(MakeRunnerFor<slog::Forwarder>(broker->context(), broker->config(), lookup_master_index,
                                                       metadata_initializer, metrics_manager),
                        slog::ModuleId::FORWARDER);
   modules.emplace_back(MakeRunnerFor<slog::Sequencer>(broker->context(), broker->config(), metrics_manager),
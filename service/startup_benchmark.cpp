@@ -0,0 +1,214 @@
+#include <fcntl.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/offline_data_reader.h"
+#include "execution/tpcc/load_tables.h"
+#include "execution/tpcc/metadata_initializer.h"
+#include "proto/offline_data.pb.h"
+#include "service/service_utils.h"
+#include "storage/bulk_loader.h"
+#include "storage/checkpoint.h"
+#include "storage/flat_storage.h"
+#include "storage/mem_only_storage.h"
+#include "storage/ordered_storage.h"
+
+DEFINE_string(storage, "mem_only", "Type of storage. Choose from (mem_only, flat, and ordered)");
+DEFINE_uint64(records, 10000000, "Number of records");
+DEFINE_uint32(record_size, 100, "Size of a record in bytes");
+DEFINE_uint32(threads, 3, "Number of threads used to generate and load data");
+DEFINE_string(dir, "/tmp", "Directory for the data file and the checkpoint");
+DEFINE_uint32(tpcc_warehouses, 4, "Number of TPC-C warehouses to load. Set to 0 to skip TPC-C");
+
+using namespace slog;
+using namespace std::chrono;
+
+using std::string;
+
+std::unique_ptr<Storage> MakeStorage() {
+  if (FLAGS_storage == "mem_only") {
+    return std::make_unique<MemOnlyStorage>();
+  } else if (FLAGS_storage == "flat") {
+    return std::make_unique<FlatStorage>();
+  } else if (FLAGS_storage == "ordered") {
+    return std::make_unique<OrderedStorage>();
+  }
+  LOG(FATAL) << "Unknown storage type: " << FLAGS_storage;
+  return nullptr;
+}
+
+template <typename Fn>
+milliseconds Time(Fn&& fn) {
+  auto start_time = steady_clock::now();
+  fn();
+  return duration_cast<milliseconds>(steady_clock::now() - start_time);
+}
+
+// Same as GenerateSimpleData in slog.cpp with a single partition. If bulk is false, the
+// records are written one by one instead of being bulk-loaded
+void Generate(Storage& storage, bool bulk) {
+  string value(FLAGS_record_size, 'a');
+  if (bulk) {
+    storage.Reserve(FLAGS_records);
+  }
+  BulkLoader loader(storage);
+  auto GenerateFn = [&](uint64_t from_key, uint64_t to_key) {
+    BulkLoader::Buffer buffer;
+    for (uint64_t key = from_key; key < to_key; key++) {
+      if (bulk) {
+        loader.Add(buffer, std::to_string(key), Record(value));
+      } else {
+        storage.Write(std::to_string(key), Record(value));
+      }
+    }
+    loader.Flush(buffer);
+  };
+  std::vector<std::thread> threads;
+  uint64_t range = FLAGS_records / FLAGS_threads + 1;
+  for (uint32_t i = 0; i < FLAGS_threads; i++) {
+    threads.emplace_back(GenerateFn, i * range, std::min((i + 1) * range, FLAGS_records));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Same as GenerateTPCCData in slog.cpp with a single partition
+void GenerateTPCC(const std::shared_ptr<Storage>& storage, bool bulk) {
+  auto metadata_initializer = std::make_shared<tpcc::TPCCMetadataInitializer>(1, 1);
+  auto storage_adapter = std::make_shared<tpcc::KVStorageAdapter>(storage, metadata_initializer);
+  if (bulk) {
+    storage_adapter->BeginBulkLoad();
+  }
+  tpcc::LoadTables(storage_adapter, FLAGS_tpcc_warehouses, 1, 1, 0, FLAGS_threads);
+  if (bulk) {
+    storage_adapter->EndBulkLoad();
+  }
+}
+
+// Writes the storage in the original .dat format
+void WriteLegacyDataFile(const Storage& storage, const string& path) {
+  auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  CHECK_GE(fd, 0) << "Cannot open " << path;
+  {
+    google::protobuf::io::FileOutputStream raw_output(fd);
+    google::protobuf::io::CodedOutputStream coded_output(&raw_output);
+    coded_output.WriteVarint32(FLAGS_records);
+    Datum datum;
+    string buf;
+    storage.ForEach([&](const Key& key, std::string_view value, const Metadata& metadata) {
+      datum.set_key(key);
+      datum.set_record(value.data(), value.size());
+      datum.set_master(metadata.master);
+      datum.SerializeToString(&buf);
+      coded_output.WriteVarint32(buf.size());
+      coded_output.WriteString(buf);
+    });
+  }
+  close(fd);
+}
+
+// Writes the storage in the chunked .dat format
+void WriteChunkedDataFile(const Storage& storage, const string& path) {
+  OfflineDataWriter writer(path);
+  Datum datum;
+  storage.ForEach([&](const Key& key, std::string_view value, const Metadata& metadata) {
+    datum.set_key(key);
+    datum.set_record(value.data(), value.size());
+    datum.set_master(metadata.master);
+    writer.AddDatum(datum);
+  });
+  CHECK(writer.Finish()) << "Cannot write " << path;
+}
+
+// Same as LoadData in slog.cpp
+void LoadDataFile(Storage& storage, const string& path) {
+  CHECK(ReadOfflineData(path, FLAGS_threads, [&storage](const Datum& datum) {
+    storage.Write(datum.key(), Record(datum.record(), datum.master()));
+  }));
+}
+
+/**
+ * Compares the ways a node can get its initial data at startup: generating it with and without
+ * bulk loading, loading it from a .dat file in either format, and loading it from a checkpoint.
+ * TPC-C data is also generated with and without bulk loading
+ */
+int main(int argc, char* argv[]) {
+  InitializeService(&argc, &argv);
+
+  auto legacy_data_path = FLAGS_dir + "/startup_benchmark_legacy.dat";
+  auto chunked_data_path = FLAGS_dir + "/startup_benchmark_chunked.dat";
+  auto checkpoint_path = FLAGS_dir + "/startup_benchmark.ckpt";
+  CheckpointFingerprint checkpoint_fingerprint{1, 0, 0, FLAGS_records};
+
+  {
+    auto storage = MakeStorage();
+    auto generate_time = Time([&] { Generate(*storage, false); });
+    LOG(INFO) << "Generate " << FLAGS_records << " records (" << FLAGS_threads
+              << " threads): " << generate_time.count() << " ms";
+  }
+
+  {
+    auto storage = MakeStorage();
+    auto generate_time = Time([&] { Generate(*storage, true); });
+    LOG(INFO) << "Generate and bulk-load " << FLAGS_records << " records (" << FLAGS_threads
+              << " threads): " << generate_time.count() << " ms";
+
+    auto write_legacy_data_time = Time([&] { WriteLegacyDataFile(*storage, legacy_data_path); });
+    LOG(INFO) << "Write legacy .dat file: " << write_legacy_data_time.count() << " ms";
+
+    auto write_chunked_data_time = Time([&] { WriteChunkedDataFile(*storage, chunked_data_path); });
+    LOG(INFO) << "Write chunked .dat file: " << write_chunked_data_time.count() << " ms";
+
+    auto write_checkpoint_time =
+        Time([&] { CHECK(WriteCheckpoint(*storage, checkpoint_fingerprint, checkpoint_path)); });
+    LOG(INFO) << "Write checkpoint: " << write_checkpoint_time.count() << " ms";
+  }
+
+  {
+    auto storage = MakeStorage();
+    auto load_legacy_data_time = Time([&] { LoadDataFile(*storage, legacy_data_path); });
+    LOG(INFO) << "Load legacy .dat file: " << load_legacy_data_time.count() << " ms";
+  }
+
+  {
+    auto storage = MakeStorage();
+    auto load_chunked_data_time = Time([&] { LoadDataFile(*storage, chunked_data_path); });
+    LOG(INFO) << "Load chunked .dat file (" << FLAGS_threads << " threads): " << load_chunked_data_time.count()
+              << " ms";
+  }
+
+  {
+    auto storage = MakeStorage();
+    auto load_checkpoint_time =
+        Time([&] { CHECK(LoadCheckpoint(*storage, checkpoint_fingerprint, checkpoint_path, FLAGS_threads)); });
+    LOG(INFO) << "Load checkpoint (" << FLAGS_threads << " threads): " << load_checkpoint_time.count() << " ms";
+  }
+
+  if (FLAGS_tpcc_warehouses > 0) {
+    {
+      std::shared_ptr<Storage> storage = MakeStorage();
+      auto tpcc_time = Time([&] { GenerateTPCC(storage, false); });
+      LOG(INFO) << "Generate " << FLAGS_tpcc_warehouses << " TPC-C warehouses (" << FLAGS_threads
+                << " threads): " << tpcc_time.count() << " ms";
+    }
+    {
+      std::shared_ptr<Storage> storage = MakeStorage();
+      auto tpcc_time = Time([&] { GenerateTPCC(storage, true); });
+      LOG(INFO) << "Generate and bulk-load " << FLAGS_tpcc_warehouses << " TPC-C warehouses (" << FLAGS_threads
+                << " threads): " << tpcc_time.count() << " ms";
+    }
+  }
+
+  unlink(legacy_data_path.c_str());
+  unlink(chunked_data_path.c_str());
+  unlink(checkpoint_path.c_str());
+
+  return 0;
+}
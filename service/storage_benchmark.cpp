@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "common/numa.h"
+#include "common/string_utils.h"
+#include "service/service_utils.h"
+#include "storage/flat_storage.h"
+#include "storage/lookup_master_index.h"
+#include "storage/mem_only_storage.h"
+#include "storage/numa_storage.h"
+#include "storage/ordered_storage.h"
+#include "storage/tiered_storage.h"
+#include "storage/versioned_storage.h"
+#include "workload/workload.h"
+
+DEFINE_string(storage, "mem_only,flat",
+              "Comma-separated list of storages. Choose from (mem_only, flat, ordered, versioned, tiered, and numa)");
+DEFINE_string(mode, "read_update",
+              "Choose from (read_update, lookup_master, multi_read, snapshot_read, zipf, and numa)");
+DEFINE_string(read_pct, "50,95,100", "Comma-separated list of read percentages. Each corresponds to a read/update mix");
+DEFINE_uint32(records, 1000000, "Number of records");
+DEFINE_uint32(record_size, 100, "Size of a record in bytes");
+DEFINE_uint32(keys_per_txn, 10, "Number of keys read by each txn in multi_read and snapshot_read modes");
+DEFINE_uint32(threads, 4, "Number of threads accessing the storage");
+DEFINE_uint32(duration, 5, "Duration of each run in seconds");
+DEFINE_double(zipf, 0.99, "Zipf coefficient of the key distribution in zipf mode");
+DEFINE_uint32(prefetch_distance, 8,
+              "Number of txns that each thread prefetches ahead of the txn that it runs in zipf mode");
+DEFINE_uint64(memory_budget_mb, 64, "Memory budget of the tiered storage in MB");
+DEFINE_string(tiered_storage_file, "/tmp/storage_benchmark_tiered",
+              "File holding the records evicted by the tiered storage");
+
+using namespace slog;
+using namespace std::chrono;
+
+using std::string;
+using std::vector;
+
+struct StorageUnderTest {
+  std::shared_ptr<Storage> storage;
+  std::shared_ptr<LookupMasterIndex> lookup_master_index;
+  // Only set for the versioned storage
+  std::shared_ptr<VersionedStorage> versioned_storage;
+  // Only set for the tiered storage
+  std::shared_ptr<TieredStorage> tiered_storage;
+  // Only set for the numa storage
+  std::shared_ptr<NumaStorage> numa_storage;
+};
+
+StorageUnderTest MakeStorage(const string& type) {
+  if (type == "mem_only") {
+    auto storage = std::make_shared<MemOnlyStorage>();
+    return {storage, storage};
+  } else if (type == "flat") {
+    auto storage = std::make_shared<FlatStorage>();
+    return {storage, storage};
+  } else if (type == "ordered") {
+    auto storage = std::make_shared<OrderedStorage>();
+    return {storage, storage};
+  } else if (type == "versioned") {
+    auto storage = std::make_shared<VersionedStorage>();
+    return {storage, storage, storage};
+  } else if (type == "tiered") {
+    auto storage = std::make_shared<TieredStorage>(FLAGS_tiered_storage_file, FLAGS_memory_budget_mb * 1024 * 1024);
+    return {storage, storage, nullptr, storage};
+  } else if (type == "numa") {
+    auto storage = std::make_shared<NumaStorage>();
+    return {storage, storage, nullptr, nullptr, storage};
+  }
+  LOG(FATAL) << "Unknown storage type: " << type;
+  return {};
+}
+
+void LoadRecords(Storage& storage) {
+  string value(FLAGS_record_size, 'x');
+  for (uint32_t key = 0; key < FLAGS_records; key++) {
+    storage.Write(std::to_string(key), Record(value));
+  }
+}
+
+// Generates the records of each node on that node then bulk-loads them, like slog does with the NUMA storage
+void LoadRecordsOnNodes(NumaStorage& storage) {
+  const auto& topology = storage.topology();
+  string value(FLAGS_record_size, 'x');
+  vector<vector<std::pair<Key, Record>>> batches(topology.num_nodes());
+  vector<std::thread> threads;
+  for (size_t node = 0; node < topology.num_nodes(); node++) {
+    threads.push_back(StartOnNode(topology, node, [&, node] {
+      for (uint32_t key = 0; key < FLAGS_records; key++) {
+        if (storage.NodeOf(std::to_string(key)) == static_cast<int>(node)) {
+          batches[node].emplace_back(std::to_string(key), Record(value));
+        }
+      }
+    }));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  storage.Reserve(FLAGS_records);
+  for (auto& batch : batches) {
+    storage.BulkLoad(std::move(batch), FLAGS_threads);
+  }
+}
+
+/**
+ * Runs op from FLAGS_threads threads for FLAGS_duration seconds. op is given a
+ * random number generator. Returns the number of operations per second. If topology
+ * is given, the threads are spread over its NUMA nodes.
+ */
+template <typename Op>
+double Run(const Op& op, const NumaTopology* topology = nullptr) {
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> total_ops = 0;
+
+  auto Operate = [&](uint32_t seed) {
+    std::mt19937 rg(seed);
+    uint64_t ops = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      op(rg);
+      ops++;
+    }
+    total_ops += ops;
+  };
+
+  vector<std::thread> threads;
+  for (uint32_t i = 0; i < FLAGS_threads; i++) {
+    if (topology != nullptr) {
+      threads.push_back(StartOnNode(*topology, i % topology->num_nodes(), [&Operate, i] { Operate(i); }));
+    } else {
+      threads.emplace_back(Operate, i);
+    }
+  }
+  std::this_thread::sleep_for(seconds(FLAGS_duration));
+  done = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  return static_cast<double>(total_ops) / FLAGS_duration;
+}
+
+/**
+ * YCSB-like workload where each operation either reads or updates a uniformly random key
+ */
+double RunReadUpdate(Storage& storage, uint32_t read_pct) {
+  string value(FLAGS_record_size, 'y');
+  return Run([&](std::mt19937& rg) {
+    std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+    std::uniform_int_distribution<uint32_t> pct_dist(0, 99);
+    // Each thread reads into and writes from its own record
+    thread_local Record record;
+    auto key = std::to_string(key_dist(rg));
+    if (pct_dist(rg) < read_pct) {
+      CHECK(storage.Read(key, record));
+    } else {
+      record.SetValue(value);
+      storage.Write(key, record);
+    }
+  });
+}
+
+/**
+ * Looks up the master of uniformly random keys like the Forwarder does for each key of a txn.
+ * The "record" variant reads the master from a full copy of the record, which is how the
+ * lookup was done before there was a separate master metadata index.
+ */
+double RunLookupMaster(const StorageUnderTest& sut, bool via_record) {
+  return Run([&](std::mt19937& rg) {
+    std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+    auto key = std::to_string(key_dist(rg));
+    Metadata metadata;
+    if (via_record) {
+      Record record;
+      CHECK(sut.storage->Read(key, record));
+      metadata = record.metadata();
+    } else {
+      CHECK(sut.lookup_master_index->GetMasterMetadata(key, metadata));
+    }
+  });
+}
+
+/**
+ * Reads FLAGS_keys_per_txn random keys at a time like the read phase of a worker, either one key
+ * at a time or in a single MultiRead batch. Returns the number of txns per second.
+ */
+double RunMultiRead(const Storage& storage, bool batched) {
+  return Run([&](std::mt19937& rg) {
+    std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+    vector<Key> keys(FLAGS_keys_per_txn);
+    for (auto& key : keys) {
+      key = std::to_string(key_dist(rg));
+    }
+    size_t bytes = 0;
+    auto Consume = [&bytes](std::string_view value, const Metadata&) { bytes += value.size(); };
+    if (batched) {
+      vector<const Key*> key_ptrs;
+      for (const auto& key : keys) {
+        key_ptrs.push_back(&key);
+      }
+      storage.MultiRead(key_ptrs, [&](size_t, std::string_view value, const Metadata& m) { Consume(value, m); });
+    } else {
+      for (const auto& key : keys) {
+        storage.ReadView(key, Consume);
+      }
+    }
+    CHECK_EQ(bytes, keys.size() * FLAGS_record_size);
+  });
+}
+
+struct SnapshotReadResult {
+  double write_throughput;
+  double avg_read_latency_us;
+  double p99_read_latency_us;
+};
+
+/**
+ * FLAGS_threads writers keep updating random keys with increasing versions like the workers
+ * do, while a reader runs read-only txns of FLAGS_keys_per_txn keys. With the versioned storage,
+ * a txn reads from a snapshot at the applied version like the read-only fast path of the Server.
+ * Other storages read the latest records without any consistency guarantee, which is the cost
+ * of the read path without versioning.
+ */
+SnapshotReadResult RunSnapshotRead(const StorageUnderTest& sut) {
+  auto& storage = *sut.storage;
+  std::atomic<bool> done = false;
+  std::atomic<int64_t> next_version = 1;
+  std::atomic<uint64_t> total_writes = 0;
+  // Version being written by each writer, or max if the writer is between two writes
+  vector<std::atomic<int64_t>> writing(FLAGS_threads);
+  for (auto& v : writing) {
+    v = std::numeric_limits<int64_t>::max();
+  }
+
+  auto Write = [&](uint32_t i) {
+    std::mt19937 rg(i);
+    std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+    Record record(string(FLAGS_record_size, 'y'));
+    uint64_t writes = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      writing[i] = next_version++;
+      storage.Write(std::to_string(key_dist(rg)), record, writing[i]);
+      writing[i] = std::numeric_limits<int64_t>::max();
+      writes++;
+    }
+    total_writes += writes;
+  };
+
+  // Plays the part of the scheduler: everything below the oldest version being written is applied
+  auto Publish = [&]() {
+    while (!done.load(std::memory_order_relaxed)) {
+      auto applied = next_version.load() - 1;
+      for (const auto& v : writing) {
+        applied = std::min(applied, v.load() - 1);
+      }
+      storage.SetAppliedVersion(applied);
+      std::this_thread::yield();
+    }
+  };
+
+  vector<std::thread> threads;
+  for (uint32_t i = 0; i < FLAGS_threads; i++) {
+    threads.emplace_back(Write, i);
+  }
+  threads.emplace_back(Publish);
+
+  std::mt19937 rg(FLAGS_threads);
+  std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+  vector<double> latencies;
+  auto end_time = steady_clock::now() + seconds(FLAGS_duration);
+  while (steady_clock::now() < end_time) {
+    vector<Key> keys(FLAGS_keys_per_txn);
+    for (auto& key : keys) {
+      key = std::to_string(key_dist(rg));
+    }
+    size_t bytes = 0;
+    auto Consume = [&bytes](std::string_view value, const Metadata&) { bytes += value.size(); };
+    auto start_time = steady_clock::now();
+    if (sut.versioned_storage != nullptr) {
+      VersionedStorage::Snapshot snapshot(*sut.versioned_storage);
+      for (const auto& key : keys) {
+        snapshot.ReadView(key, Consume);
+      }
+    } else {
+      for (const auto& key : keys) {
+        storage.ReadView(key, Consume);
+      }
+    }
+    latencies.push_back(duration<double, std::micro>(steady_clock::now() - start_time).count());
+    CHECK_EQ(bytes, keys.size() * FLAGS_record_size);
+  }
+  done = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0;
+  for (auto l : latencies) {
+    sum += l;
+  }
+  return {static_cast<double>(total_writes) / FLAGS_duration, sum / latencies.size(),
+          latencies[latencies.size() * 99 / 100]};
+}
+
+/**
+ * Each txn reads FLAGS_keys_per_txn keys drawn from a Zipfian distribution and updates the first
+ * one. Each thread keeps FLAGS_prefetch_distance txns in flight and, if prefetch is true, hands
+ * their keys to Storage::Prefetch when they are created, like the scheduler does while txns wait
+ * for their locks. Returns the number of txns per second.
+ */
+double RunZipf(Storage& storage, const std::discrete_distribution<>& zipf_dist, bool prefetch) {
+  Record update(string(FLAGS_record_size, 'z'));
+  return Run([&](std::mt19937& rg) {
+    // Each Run starts new threads so these are fresh for every run
+    thread_local auto key_dist = zipf_dist;
+    thread_local std::deque<vector<Key>> pending;
+
+    auto& keys = pending.emplace_back(FLAGS_keys_per_txn);
+    for (auto& key : keys) {
+      key = std::to_string(key_dist(rg));
+    }
+    if (prefetch) {
+      vector<const Key*> key_ptrs;
+      for (const auto& key : keys) {
+        key_ptrs.push_back(&key);
+      }
+      storage.Prefetch(key_ptrs);
+    }
+    if (pending.size() <= FLAGS_prefetch_distance) {
+      return;
+    }
+
+    size_t bytes = 0;
+    for (const auto& key : pending.front()) {
+      storage.ReadView(key, [&bytes](std::string_view value, const Metadata&) { bytes += value.size(); });
+    }
+    CHECK_EQ(bytes, pending.front().size() * FLAGS_record_size);
+    storage.Write(pending.front().front(), update);
+    pending.pop_front();
+  });
+}
+
+struct NumaResult {
+  double throughput;
+  // Negative if the node of the records cannot be found
+  double remote_ratio;
+};
+
+/**
+ * Reads uniformly random keys from threads spread over the NUMA nodes and samples the node of
+ * the memory holding the values read to find the ratio of remote accesses. With affinity, each
+ * thread only reads the keys owned by its node in the NUMA storage, like the workers do when
+ * txns are dispatched to the node that owns their keys.
+ */
+NumaResult RunNuma(const StorageUnderTest& sut, const NumaTopology& topology, bool affinity) {
+  const uint64_t kSampleInterval = 16;
+  std::atomic<uint64_t> num_sampled = 0;
+  std::atomic<uint64_t> num_remote = 0;
+  auto throughput = Run(
+      [&](std::mt19937& rg) {
+        std::uniform_int_distribution<uint32_t> key_dist(0, FLAGS_records - 1);
+        // Each Run starts new threads so these are fresh for every run
+        thread_local int node = topology.CurrentNode();
+        thread_local uint64_t num_reads = 0;
+        auto key = std::to_string(key_dist(rg));
+        while (affinity && sut.numa_storage->NodeOf(key) != node) {
+          key = std::to_string(key_dist(rg));
+        }
+        bool sample = num_reads++ % kSampleInterval == 0;
+        CHECK(sut.storage->ReadView(key, [&](std::string_view value, const Metadata&) {
+          if (sample) {
+            if (auto kernel_node = NodeOfAddress(value.data()); kernel_node >= 0) {
+              num_sampled++;
+              num_remote += topology.NodeOfKernelNode(kernel_node) != node;
+            }
+          }
+        }));
+      },
+      &topology);
+  return {throughput, num_sampled > 0 ? static_cast<double>(num_remote) / num_sampled : -1};
+}
+
+int main(int argc, char* argv[]) {
+  InitializeService(&argc, &argv);
+
+  auto storage_types = Split(FLAGS_storage, ",");
+  auto read_pcts = Split(FLAGS_read_pct, ",");
+
+  for (const auto& type : storage_types) {
+    auto sut = MakeStorage(type);
+
+    auto start_time = steady_clock::now();
+    if (sut.numa_storage != nullptr) {
+      LoadRecordsOnNodes(*sut.numa_storage);
+    } else {
+      LoadRecords(*sut.storage);
+    }
+    auto load_time = duration_cast<milliseconds>(steady_clock::now() - start_time);
+    LOG(INFO) << "[" << type << "] Loaded " << FLAGS_records << " records in " << load_time.count() << " ms";
+
+    if (FLAGS_mode == "read_update") {
+      for (const auto& pct : read_pcts) {
+        auto read_pct = std::stoul(pct);
+        CHECK_LE(read_pct, 100U) << "Invalid read percentage: " << read_pct;
+        auto throughput = RunReadUpdate(*sut.storage, read_pct);
+        LOG(INFO) << "[" << type << "] read_pct = " << read_pct << ", threads = " << FLAGS_threads
+                  << ", throughput = " << std::fixed << std::setprecision(0) << throughput << " ops/s";
+      }
+    } else if (FLAGS_mode == "lookup_master") {
+      for (bool via_record : {true, false}) {
+        auto throughput = RunLookupMaster(sut, via_record);
+        LOG(INFO) << "[" << type << "] lookup master via " << (via_record ? "record" : "index")
+                  << ", threads = " << FLAGS_threads << ", throughput = " << std::fixed << std::setprecision(0)
+                  << throughput << " lookups/s";
+      }
+    } else if (FLAGS_mode == "multi_read") {
+      for (bool batched : {false, true}) {
+        auto throughput = RunMultiRead(*sut.storage, batched);
+        LOG(INFO) << "[" << type << "] " << (batched ? "MultiRead" : "ReadView per key")
+                  << ", keys_per_txn = " << FLAGS_keys_per_txn << ", threads = " << FLAGS_threads
+                  << ", latency = " << std::fixed << std::setprecision(3) << FLAGS_threads * 1e6 / throughput
+                  << " us/txn";
+      }
+    } else if (FLAGS_mode == "snapshot_read") {
+      auto result = RunSnapshotRead(sut);
+      LOG(INFO) << "[" << type << "] writers = " << FLAGS_threads << ", write throughput = " << std::fixed
+                << std::setprecision(0) << result.write_throughput << " writes/s, keys_per_txn = " << FLAGS_keys_per_txn
+                << ", read-only latency = " << std::setprecision(3) << result.avg_read_latency_us << " us/txn (p99 "
+                << result.p99_read_latency_us << " us)";
+    } else if (FLAGS_mode == "zipf") {
+      auto zipf_dist = zipf_distribution(FLAGS_zipf, FLAGS_records);
+      for (bool prefetch : {false, true}) {
+        // Only the tiered storage does anything on prefetch
+        if (prefetch && sut.tiered_storage == nullptr) {
+          continue;
+        }
+        auto& tiered = sut.tiered_storage;
+        uint64_t faults = tiered ? tiered->num_faults() : 0;
+        uint64_t prefetched = tiered ? tiered->num_prefetched() : 0;
+        uint64_t evictions = tiered ? tiered->num_evictions() : 0;
+        auto throughput = RunZipf(*sut.storage, zipf_dist, prefetch);
+        LOG(INFO) << "[" << type << "] zipf = " << FLAGS_zipf << ", prefetch = " << prefetch
+                  << ", keys_per_txn = " << FLAGS_keys_per_txn << ", threads = " << FLAGS_threads
+                  << ", throughput = " << std::fixed << std::setprecision(0) << throughput << " txns/s";
+        if (tiered) {
+          LOG(INFO) << "[" << type << "] memory budget = " << FLAGS_memory_budget_mb
+                    << " MB, in memory = " << tiered->bytes_in_memory() / (1024 * 1024)
+                    << " MB, file = " << tiered->file_size() / (1024 * 1024)
+                    << " MB, faults = " << tiered->num_faults() - faults
+                    << ", prefetched = " << tiered->num_prefetched() - prefetched
+                    << ", evictions = " << tiered->num_evictions() - evictions;
+        }
+      }
+    } else if (FLAGS_mode == "numa") {
+      auto topology = sut.numa_storage != nullptr ? sut.numa_storage->topology() : NumaTopology::Detect();
+      for (bool affinity : {false, true}) {
+        if (affinity && sut.numa_storage == nullptr) {
+          continue;
+        }
+        auto result = RunNuma(sut, topology, affinity);
+        std::ostringstream remote_ratio;
+        if (result.remote_ratio < 0) {
+          remote_ratio << "unknown";
+        } else {
+          remote_ratio << std::fixed << std::setprecision(1) << result.remote_ratio * 100 << "%";
+        }
+        LOG(INFO) << "[" << type << "] nodes = " << topology.num_nodes() << ", affinity = " << affinity
+                  << ", threads = " << FLAGS_threads << ", throughput = " << std::fixed << std::setprecision(0)
+                  << result.throughput << " reads/s, remote accesses = " << remote_ratio.str();
+      }
+    } else {
+      LOG(FATAL) << "Unknown mode: " << FLAGS_mode;
+    }
+  }
+
+  return 0;
+}
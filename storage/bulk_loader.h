@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/constants.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Bulk-loads the initial data that multiple threads generate into a storage, one bounded chunk
+ * at a time. Each thread fills its own buffer without synchronization. A buffer is split by the
+ * bulk-load groups of the storage and the records of a group are loaded once they make up a
+ * kBulkLoadGroups-th of a chunk, so the records held outside of the storage never exceed one
+ * chunk per thread. Records of different groups share no state in the storage, so threads load
+ * the records of different groups concurrently and only wait for each other on the same group.
+ */
+class BulkLoader {
+ public:
+  class Buffer {
+    friend class BulkLoader;
+    std::vector<std::vector<std::pair<Key, Record>>> groups_;
+  };
+
+  explicit BulkLoader(Storage& storage, size_t chunk_size = kBulkLoadChunkSize)
+      : storage_(storage),
+        group_chunk_size_(std::max<size_t>(chunk_size / kBulkLoadGroups, 1)),
+        group_muts_(kBulkLoadGroups),
+        num_loaded_(0) {}
+
+  void Add(Buffer& buffer, Key&& key, Record&& record) {
+    if (buffer.groups_.empty()) {
+      buffer.groups_.resize(kBulkLoadGroups);
+    }
+    auto group = storage_.BulkLoadGroupOf(key, kBulkLoadGroups);
+    auto& records = buffer.groups_[group];
+    records.emplace_back(std::move(key), std::move(record));
+    if (records.size() >= group_chunk_size_) {
+      Load(group, records);
+    }
+  }
+
+  // Loads what is left in the buffer. Must be called on every buffer once its thread is done
+  void Flush(Buffer& buffer) {
+    for (uint32_t group = 0; group < buffer.groups_.size(); group++) {
+      if (!buffer.groups_[group].empty()) {
+        Load(group, buffer.groups_[group]);
+      }
+    }
+  }
+
+  uint64_t num_loaded() const { return num_loaded_.load(); }
+
+ private:
+  void Load(uint32_t group, std::vector<std::pair<Key, Record>>& records) {
+    num_loaded_ += records.size();
+    {
+      std::lock_guard<std::mutex> guard(group_muts_[group]);
+      storage_.BulkLoad(std::move(records), 1);
+    }
+    // The records were moved out but the vector may still hold them
+    records.clear();
+  }
+
+  Storage& storage_;
+  size_t group_chunk_size_;
+  std::vector<std::mutex> group_muts_;
+  std::atomic<uint64_t> num_loaded_;
+};
+
+}  // namespace slog
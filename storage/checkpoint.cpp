@@ -0,0 +1,259 @@
+#include "storage/checkpoint.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace slog {
+
+namespace {
+
+// The headers are copied to and from the file as they are laid out in memory
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Checkpoints need a little-endian host");
+
+constexpr char kMagic[8] = {'S', 'L', 'O', 'G', 'C', 'K', 'P', 'T'};
+constexpr uint32_t kVersion = 2;
+// Number of records per chunk, which is the unit of work when loading in parallel
+constexpr uint64_t kRecordsPerChunk = 64 * 1024;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_chunks;
+  uint64_t num_records;
+  uint64_t index_offset;
+  uint32_t num_partitions;
+  uint32_t partition;
+  uint32_t replica;
+  uint32_t padding;
+  uint64_t data_params_hash;
+};
+
+struct ChunkInfo {
+  uint64_t offset;
+  uint64_t size;
+  uint64_t num_records;
+};
+
+struct RecordHeader {
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t master;
+  uint32_t counter;
+};
+
+class CheckpointWriter {
+ public:
+  CheckpointWriter(FILE* file, const CheckpointFingerprint& fingerprint)
+      : file_(file), fingerprint_(fingerprint), offset_(0), num_records_(0), ok_(true) {}
+
+  bool Begin() {
+    // The header is rewritten with the final counts at the end
+    Header header{};
+    return Append(&header, sizeof(header));
+  }
+
+  void Add(const Key& key, std::string_view value, const Metadata& metadata) {
+    if (chunks_.empty() || chunks_.back().num_records == kRecordsPerChunk) {
+      chunks_.push_back({offset_, 0, 0});
+    }
+    RecordHeader record_header{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size()), metadata.master,
+                               metadata.counter};
+    auto size = sizeof(record_header) + key.size() + value.size();
+    Append(&record_header, sizeof(record_header));
+    Append(key.data(), key.size());
+    Append(value.data(), value.size());
+    chunks_.back().size += size;
+    chunks_.back().num_records++;
+    num_records_++;
+  }
+
+  bool Finish() {
+    Header header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_chunks = chunks_.size();
+    header.num_records = num_records_;
+    header.index_offset = offset_;
+    header.num_partitions = fingerprint_.num_partitions;
+    header.partition = fingerprint_.partition;
+    header.replica = fingerprint_.replica;
+    header.data_params_hash = fingerprint_.data_params_hash;
+    Append(chunks_.data(), chunks_.size() * sizeof(ChunkInfo));
+    if (!ok_ || fseek(file_, 0, SEEK_SET) != 0) {
+      return false;
+    }
+    return fwrite(&header, sizeof(header), 1, file_) == 1;
+  }
+
+  uint64_t num_records() const { return num_records_; }
+
+ private:
+  bool Append(const void* data, size_t size) {
+    if (size > 0 && ok_ && fwrite(data, size, 1, file_) != 1) {
+      ok_ = false;
+    }
+    offset_ += size;
+    return ok_;
+  }
+
+  FILE* file_;
+  CheckpointFingerprint fingerprint_;
+  uint64_t offset_;
+  uint64_t num_records_;
+  std::vector<ChunkInfo> chunks_;
+  bool ok_;
+};
+
+// Returns false if the chunk does not contain exactly the records that the index says it does
+bool LoadChunk(Storage& storage, const char* data, const ChunkInfo& chunk) {
+  const char* pos = data + chunk.offset;
+  const char* end = pos + chunk.size;
+  for (uint64_t i = 0; i < chunk.num_records; i++) {
+    RecordHeader record_header;
+    if (static_cast<size_t>(end - pos) < sizeof(record_header)) {
+      return false;
+    }
+    memcpy(&record_header, pos, sizeof(record_header));
+    pos += sizeof(record_header);
+    if (static_cast<uint64_t>(end - pos) < uint64_t{record_header.key_size} + record_header.value_size) {
+      return false;
+    }
+    Key key(pos, record_header.key_size);
+    pos += record_header.key_size;
+    Record record;
+    record.SetValue(pos, record_header.value_size);
+    record.SetMetadata(Metadata(record_header.master, record_header.counter));
+    pos += record_header.value_size;
+    storage.Write(key, std::move(record));
+  }
+  return pos == end;
+}
+
+}  // namespace
+
+bool WriteCheckpoint(const Storage& storage, const CheckpointFingerprint& fingerprint, const std::string& path) {
+  auto tmp_path = path + ".tmp";
+  auto file = fopen(tmp_path.c_str(), "wb");
+  if (file == nullptr) {
+    LOG(ERROR) << "Cannot open \"" << tmp_path << "\": " << strerror(errno);
+    return false;
+  }
+  std::vector<char> buffer(4 * 1024 * 1024);
+  setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+  CheckpointWriter writer(file, fingerprint);
+  bool ok = writer.Begin();
+  if (ok) {
+    storage.ForEach([&writer](const Key& key, std::string_view value, const Metadata& metadata) {
+      writer.Add(key, value, metadata);
+    });
+    ok = writer.Finish();
+  }
+  ok = fflush(file) == 0 && ok;
+  ok = fsync(fileno(file)) == 0 && ok;
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(ERROR) << "Error while writing checkpoint \"" << path << "\": " << strerror(errno);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  LOG(INFO) << "Wrote " << writer.num_records() << " records to checkpoint \"" << path << "\"";
+  return true;
+}
+
+bool LoadCheckpoint(Storage& storage, const CheckpointFingerprint& fingerprint, const std::string& path,
+                    uint32_t num_threads) {
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open checkpoint \"" << path << "\": " << strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    LOG(ERROR) << "Checkpoint \"" << path << "\" is too small";
+    close(fd);
+    return false;
+  }
+  uint64_t file_size = st.st_size;
+  auto mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG(ERROR) << "Cannot map checkpoint \"" << path << "\": " << strerror(errno);
+    return false;
+  }
+  madvise(mapped, file_size, MADV_WILLNEED);
+  auto data = static_cast<const char*>(mapped);
+
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  bool ok = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+            header.index_offset <= file_size &&
+            (file_size - header.index_offset) / sizeof(ChunkInfo) >= header.num_chunks;
+  std::vector<ChunkInfo> chunks;
+  if (ok) {
+    chunks.resize(header.num_chunks);
+    memcpy(chunks.data(), data + header.index_offset, chunks.size() * sizeof(ChunkInfo));
+    uint64_t num_records = 0;
+    for (const auto& chunk : chunks) {
+      ok &= chunk.offset >= sizeof(Header) && chunk.offset <= header.index_offset &&
+            chunk.size <= header.index_offset - chunk.offset;
+      num_records += chunk.num_records;
+    }
+    ok &= num_records == header.num_records;
+  }
+  if (!ok) {
+    LOG(ERROR) << "Checkpoint \"" << path << "\" is malformed";
+    munmap(mapped, file_size);
+    return false;
+  }
+  CheckpointFingerprint header_fingerprint{header.num_partitions, header.partition, header.replica,
+                                           header.data_params_hash};
+  if (!(header_fingerprint == fingerprint)) {
+    LOG(ERROR) << "Checkpoint \"" << path << "\" holds the data of another partition, replica or data configuration";
+    munmap(mapped, file_size);
+    return false;
+  }
+
+  LOG(INFO) << "Loading " << header.num_records << " records in " << chunks.size() << " chunks from checkpoint \""
+            << path << "\" using " << num_threads << " threads";
+
+  // Threads grab the next unprocessed chunk so that they stay busy until the end
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<bool> malformed = false;
+  auto LoadFn = [&]() {
+    for (auto i = next_chunk++; i < chunks.size() && !malformed; i = next_chunk++) {
+      if (!LoadChunk(storage, data, chunks[i])) {
+        malformed = true;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < std::max(num_threads, 1U); i++) {
+    threads.emplace_back(LoadFn);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  munmap(mapped, file_size);
+
+  if (malformed) {
+    LOG(ERROR) << "Checkpoint \"" << path << "\" is malformed";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace slog
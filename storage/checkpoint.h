@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * A checkpoint is a binary dump of all records of a storage, including their master metadata,
+ * that can be loaded back much faster than regenerating or re-parsing the initial data.
+ *
+ * File layout (all integers are little-endian):
+ *   Header:  magic (8 bytes), version (u32), number of chunks (u32), number of records (u64),
+ *            offset of the chunk index (u64), fingerprint (see CheckpointFingerprint)
+ *   Chunks:  records, each laid out as key size (u32), value size (u32), master (u32),
+ *            counter (u32), key bytes, value bytes
+ *   Index:   for each chunk, its offset (u64), size in bytes (u64) and number of records (u64)
+ *
+ * Records are split into chunks so that a checkpoint can be loaded by multiple threads, each
+ * parsing whole chunks straight out of the memory-mapped file.
+ */
+
+/**
+ * Identifies the data that a checkpoint holds. A checkpoint is only loaded with the same
+ * fingerprint as the one it was written with, so that a machine never starts with the data
+ * of another partition or of a different configuration.
+ */
+struct CheckpointFingerprint {
+  uint32_t num_partitions;
+  uint32_t partition;
+  uint32_t replica;
+  // Hash of the parameters that the initial data was generated or loaded with
+  uint64_t data_params_hash;
+
+  bool operator==(const CheckpointFingerprint& other) const {
+    return num_partitions == other.num_partitions && partition == other.partition && replica == other.replica &&
+           data_params_hash == other.data_params_hash;
+  }
+};
+
+/**
+ * Writes all records of the storage to the given path. The file is first written to a
+ * temporary file which then replaces the given path, so an existing checkpoint is never
+ * left half-written. Returns false if the file cannot be written.
+ */
+bool WriteCheckpoint(const Storage& storage, const CheckpointFingerprint& fingerprint, const std::string& path);
+
+/**
+ * Loads the records of the checkpoint at the given path into the storage using num_threads
+ * threads. Returns false if the file cannot be opened, is malformed or was written with another
+ * fingerprint. The storage is left untouched in the last case, but may contain part of the
+ * records if the file is malformed.
+ */
+bool LoadCheckpoint(Storage& storage, const CheckpointFingerprint& fingerprint, const std::string& path,
+                    uint32_t num_threads);
+
+}  // namespace slog
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "data_structure/flat_hash_map.h"
+#include "storage/lookup_master_index.h"
+#include "storage/master_metadata_index.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Same as MemOnlyStorage but backed by an open-addressing table, which updates
+ * records in place instead of allocating a new node on every write
+ */
+class FlatStorage : public Storage, public LookupMasterIndex {
+ public:
+  bool Read(const Key& key, Record& result) const final { return table_.Get(result, key); }
+
+  bool ReadView(const Key& key, const ReadViewFn& fn) const final {
+    return table_.Visit(key,
+                        [&fn](const Record& rec) { fn(std::string_view(rec.data(), rec.size()), rec.metadata()); });
+  }
+
+  void MultiRead(const std::vector<const Key*>& keys, const MultiReadFn& fn) const final {
+    table_.MultiVisit(
+        keys, [&fn](size_t i, const Record& rec) { fn(i, std::string_view(rec.data(), rec.size()), rec.metadata()); });
+  }
+
+  void ForEach(const ScanFn& fn) const final {
+    table_.ForEach([&fn](const Key& key, const Record& rec) {
+      fn(key, std::string_view(rec.data(), rec.size()), rec.metadata());
+    });
+  }
+
+  bool Write(const Key& key, const Record& record) final {
+    master_index_.Update(key, record.metadata());
+    return table_.InsertOrUpdate(key, record);
+  }
+
+  bool Write(const Key& key, Record&& record) final {
+    master_index_.Update(key, record.metadata());
+    return table_.InsertOrUpdate(key, std::move(record));
+  }
+
+  bool Delete(const Key& key) final {
+    master_index_.Erase(key);
+    return table_.Erase(key);
+  }
+
+  void Reserve(size_t num_records) final {
+    master_index_.Reserve(num_records);
+    table_.Reserve(num_records);
+  }
+
+  void BulkLoad(std::vector<std::pair<Key, Record>>&& records, uint32_t num_threads) final {
+    master_index_.BulkLoad(records, num_threads);
+    table_.BulkInsert(std::move(records), num_threads);
+  }
+
+  uint32_t BulkLoadGroupOf(const Key& key, uint32_t num_groups) const final { return SegmentGroupOf(key, num_groups); }
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final {
+    return master_index_.GetMasterMetadata(key, metadata);
+  }
+
+ private:
+  FlatHashMap<Key, Record> table_;
+  MasterMetadataIndex master_index_;
+};
+
+}  // namespace slog
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "data_structure/concurrent_hash_map.h"
+#include "storage/lookup_master_index.h"
+
+namespace slog {
+
+/**
+ * A compact fingerprint -> (master, counter) map kept next to the records so that looking up
+ * the master of a key never touches the record itself. Lookups do not take any latch.
+ *
+ * Entries are keyed by a 128-bit fingerprint of the key instead of a copy of the key, so each
+ * entry has a fixed size no matter how long the keys are. The fingerprint is the std::hash of
+ * the key, which picks the segment and bucket, plus an independent tag that is compared on every
+ * lookup, update and erase. Two keys with the same std::hash therefore get separate entries; only
+ * keys matching on both hashes would share one, which is far less likely than a hardware fault.
+ *
+ * The owning storage must call Update() and Erase() on every write and delete. Writes to
+ * the same key are assumed to be serialized, which is guaranteed by the lock manager.
+ */
+class MasterMetadataIndex : public LookupMasterIndex {
+ public:
+  void Update(const Key& key, const Metadata& metadata) {
+    auto fingerprint = FingerprintOf(key);
+    // Most writes do not change the metadata so avoid replacing the entry in that case
+    bool unchanged = false;
+    index_.Visit(fingerprint, [&unchanged, &metadata](const Metadata& current) {
+      unchanged = current.master == metadata.master && current.counter == metadata.counter;
+    });
+    if (!unchanged) {
+      index_.InsertOrUpdate(fingerprint, metadata);
+    }
+  }
+
+  void Erase(const Key& key) { index_.Erase(FingerprintOf(key)); }
+
+  void Reserve(size_t num_keys) { index_.Reserve(num_keys); }
+
+  // Indexes the metadata of all records without latching. Must not be called concurrently with any other operation
+  void BulkLoad(const std::vector<std::pair<Key, Record>>& records, uint32_t num_threads) {
+    std::vector<std::pair<Fingerprint, Metadata>> entries;
+    entries.reserve(records.size());
+    for (const auto& [key, record] : records) {
+      entries.emplace_back(FingerprintOf(key), record.metadata());
+    }
+    index_.BulkInsert(std::move(entries), num_threads);
+  }
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final {
+    return index_.Get(metadata, FingerprintOf(key));
+  }
+
+  StorageStats GetStats() const { return index_.GetStats(); }
+
+ private:
+  struct Fingerprint {
+    uint64_t hash;
+    // Verifies that an entry found through hash belongs to the key
+    uint64_t tag;
+
+    bool operator==(const Fingerprint& other) const { return hash == other.hash && tag == other.tag; }
+  };
+
+  // The hash is already well mixed so it is used as is. This also puts a key in the same segment
+  // as in a map that hashes the key itself with std::hash
+  struct FingerprintHash {
+    size_t operator()(const Fingerprint& fingerprint) const { return fingerprint.hash; }
+  };
+
+  static Fingerprint FingerprintOf(const Key& key) {
+    // 64-bit FNV-1a, which is unrelated to the std::hash of strings
+    uint64_t tag = 0xcbf29ce484222325;
+    for (unsigned char c : key) {
+      tag = (tag ^ c) * 0x100000001b3;
+    }
+    return {std::hash<Key>{}(key), tag};
+  }
+
+  ConcurrentHashMap<Fingerprint, Metadata, FingerprintHash> index_;
+};
+
+}  // namespace slog
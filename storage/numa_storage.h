@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/numa.h"
+#include "storage/lookup_master_index.h"
+#include "storage/mem_only_storage.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Storage made of one MemOnlyStorage per NUMA node. Each key belongs to the shard of a node,
+ * whose memory is allocated by threads pinned to that node so that it is placed on the node.
+ * This holds for the tables themselves and for bulk-loaded records. Records written later are
+ * allocated on the node of the writing thread, which is the owning node if txns are dispatched
+ * to workers of the node that owns their keys.
+ *
+ * Bulk-loaded records are moved into the shards so their values stay where they were allocated.
+ * Callers that want them on the right node should create them on that node (see NodeOf).
+ */
+class NumaStorage : public Storage, public LookupMasterIndex {
+ public:
+  explicit NumaStorage(const NumaTopology& topology = NumaTopology::Detect()) : topology_(topology) {
+    shards_.resize(topology_.num_nodes());
+    RunOnEachNode([this](int node) { shards_[node] = std::make_unique<MemOnlyStorage>(); });
+  }
+
+  const NumaTopology& topology() const { return topology_; }
+
+  int NodeOf(const Key& key) const {
+    // The low bits of the hash are used by the hash tables of the shards
+    return (std::hash<Key>{}(key) >> 48) % shards_.size();
+  }
+
+  bool Read(const Key& key, Record& result) const final { return ShardOf(key).Read(key, result); }
+
+  bool ReadView(const Key& key, const ReadViewFn& fn) const final { return ShardOf(key).ReadView(key, fn); }
+
+  void MultiRead(const std::vector<const Key*>& keys, const MultiReadFn& fn) const final {
+    if (shards_.size() == 1) {
+      shards_[0]->MultiRead(keys, fn);
+      return;
+    }
+    std::vector<std::vector<const Key*>> keys_of_node(shards_.size());
+    std::vector<std::vector<size_t>> indices_of_node(shards_.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      auto node = NodeOf(*keys[i]);
+      keys_of_node[node].push_back(keys[i]);
+      indices_of_node[node].push_back(i);
+    }
+    for (size_t node = 0; node < shards_.size(); node++) {
+      if (keys_of_node[node].empty()) {
+        continue;
+      }
+      const auto& indices = indices_of_node[node];
+      shards_[node]->MultiRead(keys_of_node[node], [&fn, &indices](size_t i, std::string_view value,
+                                                                   const Metadata& metadata) {
+        fn(indices[i], value, metadata);
+      });
+    }
+  }
+
+  void ForEach(const ScanFn& fn) const final {
+    for (const auto& shard : shards_) {
+      shard->ForEach(fn);
+    }
+  }
+
+  bool Write(const Key& key, const Record& record) final { return ShardOf(key).Write(key, record); }
+
+  bool Write(const Key& key, Record&& record) final { return ShardOf(key).Write(key, std::move(record)); }
+
+  bool Delete(const Key& key) final { return ShardOf(key).Delete(key); }
+
+  void Reserve(size_t num_records) final {
+    RunOnEachNode([&](int node) { shards_[node]->Reserve(num_records / shards_.size() + 1); });
+  }
+
+  // Each node is loaded by num_threads / number of nodes threads pinned to the node
+  void BulkLoad(std::vector<std::pair<Key, Record>>&& records, uint32_t num_threads) final {
+    std::vector<std::vector<std::pair<Key, Record>>> records_of_node(shards_.size());
+    for (auto& record : records) {
+      records_of_node[NodeOf(record.first)].push_back(std::move(record));
+    }
+    records = {};
+    uint32_t threads_per_node = std::max<uint32_t>(1, num_threads / shards_.size());
+    RunOnEachNode([&](int node) { shards_[node]->BulkLoad(std::move(records_of_node[node]), threads_per_node); });
+  }
+
+  uint32_t BulkLoadGroupOf(const Key& key, uint32_t num_groups) const final { return SegmentGroupOf(key, num_groups); }
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final {
+    return ShardOf(key).GetMasterMetadata(key, metadata);
+  }
+
+  // The segments of the shards are added up by index
+  bool GetStats(StorageStats& stats) const final {
+    for (const auto& shard : shards_) {
+      shard->GetStats(stats);
+    }
+    return true;
+  }
+
+ private:
+  MemOnlyStorage& ShardOf(const Key& key) const { return *shards_[NodeOf(key)]; }
+
+  // Runs fn for all nodes at once, each on a thread of its node
+  template <typename Fn>
+  void RunOnEachNode(Fn&& fn) {
+    std::vector<std::thread> threads;
+    for (size_t node = 0; node < shards_.size(); node++) {
+      threads.push_back(StartOnNode(topology_, node, [&fn, node] { fn(node); }));
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  NumaTopology topology_;
+  std::vector<std::unique_ptr<MemOnlyStorage>> shards_;
+};
+
+}  // namespace slog
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "data_structure/skip_list.h"
+#include "storage/lookup_master_index.h"
+#include "storage/master_metadata_index.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Storage that keeps its records in key order so that they can be scanned by range. Point
+ * operations are slower than in the hash-based storages
+ */
+class OrderedStorage : public Storage, public LookupMasterIndex {
+ public:
+  bool Read(const Key& key, Record& result) const final { return table_.Get(result, key); }
+
+  bool ReadView(const Key& key, const ReadViewFn& fn) const final {
+    return table_.Visit(key,
+                        [&fn](const Record& rec) { fn(std::string_view(rec.data(), rec.size()), rec.metadata()); });
+  }
+
+  bool Scan(const Key& begin, const Key& end, const ScanFn& fn) const final {
+    table_.Scan(begin, end, [&fn](const Key& key, const Record& rec) {
+      fn(key, std::string_view(rec.data(), rec.size()), rec.metadata());
+    });
+    return true;
+  }
+
+  void ForEach(const ScanFn& fn) const final {
+    table_.ForEach([&fn](const Key& key, const Record& rec) {
+      fn(key, std::string_view(rec.data(), rec.size()), rec.metadata());
+    });
+  }
+
+  bool Write(const Key& key, const Record& record) final {
+    master_index_.Update(key, record.metadata());
+    return table_.InsertOrUpdate(key, record);
+  }
+
+  bool Write(const Key& key, Record&& record) final {
+    master_index_.Update(key, record.metadata());
+    return table_.InsertOrUpdate(key, std::move(record));
+  }
+
+  bool Delete(const Key& key) final {
+    master_index_.Erase(key);
+    return table_.Erase(key);
+  }
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final {
+    return master_index_.GetMasterMetadata(key, metadata);
+  }
+
+ private:
+  ConcurrentSkipList<Key, Record> table_;
+  MasterMetadataIndex master_index_;
+};
+
+}  // namespace slog
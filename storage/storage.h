@@ -1,17 +1,83 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "common/types.h"
+#include "storage/storage_stats.h"
 
 namespace slog {
 
 class Storage {
  public:
+  using ReadViewFn = std::function<void(std::string_view value, const Metadata& metadata)>;
+  using MultiReadFn = std::function<void(size_t i, std::string_view value, const Metadata& metadata)>;
+  using ScanFn = std::function<void(const Key& key, std::string_view value, const Metadata& metadata)>;
+
   virtual ~Storage() = default;
   virtual bool Read(const Key& key, Record& result) const = 0;
+  // Calls fn with a view of the stored record without copying it. The view is only valid
+  // during the call. Returns true if key exists
+  virtual bool ReadView(const Key& key, const ReadViewFn& fn) const {
+    Record record;
+    if (!Read(key, record)) {
+      return false;
+    }
+    fn(std::string_view(record.data(), record.size()), record.metadata());
+    return true;
+  }
+  // Calls fn(i, ...) like ReadView for each keys[i] that exists, in no particular order.
+  // Storages can override this to look up keys that share a segment together
+  virtual void MultiRead(const std::vector<const Key*>& keys, const MultiReadFn& fn) const {
+    for (size_t i = 0; i < keys.size(); i++) {
+      ReadView(*keys[i], [&fn, i](std::string_view value, const Metadata& metadata) { fn(i, value, metadata); });
+    }
+  }
+  // Calls fn like ReadView in key order for each record whose key is in [begin, end).
+  // Returns false if the storage does not keep its keys ordered
+  virtual bool Scan(const Key& /* begin */, const Key& /* end */, const ScanFn& /* fn */) const { return false; }
+  // Calls fn on every record in no particular order. Records written during the call may or may not be seen
+  virtual void ForEach(const ScanFn& fn) const = 0;
   // Returns true if key exists
   virtual bool Write(const Key& key, const Record& record) = 0;
   virtual bool Write(const Key& key, Record&& record) { return Write(key, record); };
   virtual bool Delete(const Key& key) = 0;
+  // Same as Write and Delete but also stamped with the version assigned to the writing txn by the scheduler.
+  // Storages that keep a single version of each record ignore the stamp
+  virtual bool Write(const Key& key, const Record& record, int64_t /* version */) { return Write(key, record); }
+  virtual bool Write(const Key& key, Record&& record, int64_t /* version */) { return Write(key, std::move(record)); }
+  virtual bool Delete(const Key& key, int64_t /* version */) { return Delete(key); }
+  // Called by the scheduler once all writes with a version up to the given one have been applied
+  virtual void SetAppliedVersion(int64_t /* version */) {}
+  // Hints that the records of the given keys will be read soon. Must return without waiting for them
+  virtual void Prefetch(const std::vector<const Key*>& /* keys */) {}
+  // Grows the storage so that it can hold num_records records without rehashing
+  virtual void Reserve(size_t /* num_records */) {}
+  // Adds the stats of the storage to stats. Returns false if the storage does not keep any. Can be
+  // called concurrently with any other operation
+  virtual bool GetStats(StorageStats& /* stats */) const { return false; }
+  // Writes all records, moving them out of the vector, using up to num_threads threads. Only meant for
+  // loading the initial data: must not be called concurrently with any other operation, except with
+  // BulkLoads whose records all fall into other bulk-load groups
+  virtual void BulkLoad(std::vector<std::pair<Key, Record>>&& records, uint32_t /* num_threads */) {
+    for (auto& [key, record] : records) {
+      Write(key, std::move(record));
+    }
+  }
+  // Returns the bulk-load group of key among num_groups groups, where num_groups is a power of 2 of at
+  // most 256. Records of different groups share no state in the storage so they can be bulk-loaded
+  // concurrently. Storages that cannot be loaded concurrently put every key in group 0
+  virtual uint32_t BulkLoadGroupOf(const Key& /* key */, uint32_t /* num_groups */) const { return 0; }
+
+ protected:
+  // For storages made of sharded hash maps that hash keys with std::hash. These maps pick the
+  // segment of a key from the lowest 8 bits of its hash, so keys of different groups never share a segment
+  static uint32_t SegmentGroupOf(const Key& key, uint32_t num_groups) {
+    return std::hash<Key>{}(key) & (num_groups - 1);
+  }
 };
 
 }  // namespace slog
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace slog {
+
+struct SegmentStats {
+  size_t num_nodes = 0;
+  size_t num_buckets = 0;
+  // Nodes, bucket array and memory owned by the keys and values
+  size_t bytes = 0;
+  uint64_t num_rehashes = 0;
+  uint64_t rehash_ns = 0;
+  // Number of times a writer found the latch taken and the total time spent waiting for it
+  uint64_t num_latch_waits = 0;
+  uint64_t latch_wait_ns = 0;
+
+  SegmentStats& operator+=(const SegmentStats& other) {
+    num_nodes += other.num_nodes;
+    num_buckets += other.num_buckets;
+    bytes += other.bytes;
+    num_rehashes += other.num_rehashes;
+    rehash_ns += other.rehash_ns;
+    num_latch_waits += other.num_latch_waits;
+    latch_wait_ns += other.latch_wait_ns;
+    return *this;
+  }
+};
+
+/**
+ * Stats of a storage made of sharded tables, filled in by the tables of the storage. The stats of
+ * the tables of a storage are added up
+ */
+struct StorageStats {
+  // Indexed by segment. Segments that have never been touched are all zeros
+  std::vector<SegmentStats> segments;
+  // Bulk inserts are not counted as writes
+  uint64_t num_reads = 0;
+  uint64_t num_writes = 0;
+
+  // Adds up the segments of the same index. The reads and writes of other are only added if count_ops is true
+  void Add(const StorageStats& other, bool count_ops = true) {
+    segments.resize(std::max(segments.size(), other.segments.size()));
+    for (size_t i = 0; i < other.segments.size(); i++) {
+      segments[i] += other.segments[i];
+    }
+    if (count_ops) {
+      num_reads += other.num_reads;
+      num_writes += other.num_writes;
+    }
+  }
+};
+
+}  // namespace slog
@@ -0,0 +1,295 @@
+#include "storage/tiered_storage.h"
+
+#include <glog/logging.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace slog {
+
+TieredStorage::TieredStorage(const std::string& path, size_t memory_budget, uint32_t num_prefetch_threads)
+    : shard_memory_budget_(memory_budget / kNumShards),
+      file_end_(0),
+      num_evictions_(0),
+      num_faults_(0),
+      num_prefetched_(0),
+      stopping_(false) {
+  // A unique suffix keeps processes that are given the same path from sharing the file
+  std::string unique_path = path + ".XXXXXX";
+  fd_ = mkstemp(unique_path.data());
+  if (fd_ < 0) {
+    LOG(FATAL) << "Cannot create a file at \"" << unique_path << "\": " << strerror(errno);
+  }
+  // Nothing in the file is usable without the index so the file does not need to outlive the process
+  unlink(unique_path.c_str());
+
+  for (uint32_t i = 0; i < num_prefetch_threads; i++) {
+    prefetch_threads_.emplace_back(&TieredStorage::RunPrefetcher, this);
+  }
+}
+
+TieredStorage::~TieredStorage() {
+  {
+    std::lock_guard<std::mutex> guard(prefetch_mut_);
+    stopping_ = true;
+  }
+  prefetch_cv_.notify_all();
+  for (auto& t : prefetch_threads_) {
+    t.join();
+  }
+  close(fd_);
+}
+
+bool TieredStorage::Read(const Key& key, Record& result) const {
+  return Access(key, false, [&result](std::string_view value, const Metadata& metadata) {
+    result.SetValue(value.data(), value.size());
+    result.SetMetadata(metadata);
+  });
+}
+
+bool TieredStorage::ReadView(const Key& key, const ReadViewFn& fn) const { return Access(key, false, fn); }
+
+void TieredStorage::ForEach(const ScanFn& fn) const {
+  std::string buf;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mut);
+    for (const auto& [key, entry] : shard.entries) {
+      if (entry.in_memory) {
+        fn(key, std::string_view(entry.record.data(), entry.record.size()), entry.metadata);
+      } else {
+        ReadFromFile(entry.offset, entry.size, buf);
+        fn(key, buf, entry.metadata);
+      }
+    }
+  }
+}
+
+bool TieredStorage::Write(const Key& key, const Record& record) { return WriteImpl(key, record); }
+
+bool TieredStorage::Write(const Key& key, Record&& record) { return WriteImpl(key, std::move(record)); }
+
+template <typename R>
+bool TieredStorage::WriteImpl(const Key& key, R&& record) {
+  auto& shard = ShardOf(key);
+  std::lock_guard<std::mutex> guard(shard.mut);
+  auto [it, inserted] = shard.entries.try_emplace(key);
+  auto entry = &*it;
+  entry->second.metadata = record.metadata();
+  if (entry->second.in_memory) {
+    shard.bytes -= entry->second.record.size();
+    shard.bytes += record.size();
+    entry->second.record = std::forward<R>(record);
+    entry->second.referenced = true;
+    entry->second.dirty = true;
+  } else {
+    // The copy in the file, if any, is outdated
+    Install(shard, entry, Record(std::forward<R>(record)), true);
+  }
+  EvictIfNeeded(shard);
+  return !inserted;
+}
+
+bool TieredStorage::Delete(const Key& key) {
+  auto& shard = ShardOf(key);
+  std::lock_guard<std::mutex> guard(shard.mut);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    return false;
+  }
+  if (it->second.in_memory) {
+    Uninstall(shard, &*it);
+  }
+  shard.entries.erase(it);
+  return true;
+}
+
+void TieredStorage::Reserve(size_t num_records) {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mut);
+    shard.entries.reserve(num_records / kNumShards + 1);
+  }
+}
+
+void TieredStorage::Prefetch(const std::vector<const Key*>& keys) {
+  std::vector<const Key*> evicted;
+  for (auto key : keys) {
+    auto& shard = ShardOf(*key);
+    // The latch may be held by a writer evicting records to the file. Rather than waiting for it, the key
+    // is left to the prefetcher, which does nothing if the record turns out to be in memory
+    std::unique_lock<std::mutex> lock(shard.mut, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      evicted.push_back(key);
+      continue;
+    }
+    auto it = shard.entries.find(*key);
+    if (it != shard.entries.end() && !it->second.in_memory) {
+      evicted.push_back(key);
+    }
+  }
+  if (evicted.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_mut_);
+    for (auto key : evicted) {
+      if (prefetch_queue_.size() >= kMaxPendingPrefetches) {
+        break;
+      }
+      prefetch_queue_.push_back(*key);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+bool TieredStorage::GetMasterMetadata(const Key& key, Metadata& metadata) const {
+  auto& shard = ShardOf(key);
+  std::lock_guard<std::mutex> guard(shard.mut);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    return false;
+  }
+  metadata = it->second.metadata;
+  return true;
+}
+
+size_t TieredStorage::bytes_in_memory() const {
+  size_t bytes = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mut);
+    bytes += shard.bytes;
+  }
+  return bytes;
+}
+
+void TieredStorage::Install(Shard& shard, EntryPtr entry, Record&& record, bool dirty) const {
+  auto& e = entry->second;
+  shard.bytes += record.size();
+  e.record = std::move(record);
+  e.record.SetMetadata(e.metadata);
+  e.in_memory = true;
+  e.referenced = true;
+  e.dirty = dirty;
+  if (shard.free_slots.empty()) {
+    e.clock_slot = shard.clock.size();
+    shard.clock.push_back(entry);
+  } else {
+    e.clock_slot = shard.free_slots.back();
+    shard.free_slots.pop_back();
+    shard.clock[e.clock_slot] = entry;
+  }
+}
+
+void TieredStorage::Uninstall(Shard& shard, EntryPtr entry) const {
+  auto& e = entry->second;
+  shard.bytes -= e.record.size();
+  e.record = Record();
+  e.in_memory = false;
+  shard.clock[e.clock_slot] = nullptr;
+  shard.free_slots.push_back(e.clock_slot);
+}
+
+void TieredStorage::EvictIfNeeded(Shard& shard) const {
+  // Two rounds are enough to clear all reference bits and evict everything if needed
+  for (size_t steps = 2 * shard.clock.size(); shard.bytes > shard_memory_budget_ && steps > 0; steps--) {
+    if (shard.hand >= shard.clock.size()) {
+      shard.hand = 0;
+    }
+    auto entry = shard.clock[shard.hand++];
+    if (entry == nullptr) {
+      continue;
+    }
+    auto& e = entry->second;
+    if (e.referenced) {
+      e.referenced = false;
+      continue;
+    }
+    if (e.dirty) {
+      e.offset = AppendToFile(e.record.data(), e.record.size());
+      e.size = e.record.size();
+    }
+    Uninstall(shard, entry);
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool TieredStorage::Access(const Key& key, bool is_prefetch, const ReadViewFn& fn) const {
+  auto& shard = ShardOf(key);
+  std::unique_lock<std::mutex> lock(shard.mut);
+  thread_local std::string buf;
+  for (;;) {
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+      return false;
+    }
+    auto& e = it->second;
+    if (e.in_memory) {
+      e.referenced = true;
+      fn(std::string_view(e.record.data(), e.record.size()), e.metadata);
+      return true;
+    }
+
+    auto offset = e.offset;
+    auto size = e.size;
+    lock.unlock();
+    ReadFromFile(offset, size, buf);
+    lock.lock();
+
+    // Entries do not move in the map but the record might have been written, deleted or
+    // loaded by someone else while the latch was released
+    it = shard.entries.find(key);
+    if (it == shard.entries.end() || it->second.in_memory || it->second.offset != offset) {
+      continue;
+    }
+    Install(shard, &*it, Record(buf), false);
+    (is_prefetch ? num_prefetched_ : num_faults_).fetch_add(1, std::memory_order_relaxed);
+    fn(buf, it->second.metadata);
+    EvictIfNeeded(shard);
+    return true;
+  }
+}
+
+void TieredStorage::ReadFromFile(uint64_t offset, uint32_t size, std::string& buf) const {
+  buf.resize(size);
+  size_t done = 0;
+  while (done < size) {
+    auto res = pread(fd_, buf.data() + done, size - done, offset + done);
+    if (res <= 0) {
+      LOG(FATAL) << "Cannot read evicted record at offset " << offset << ": " << strerror(errno);
+    }
+    done += res;
+  }
+}
+
+uint64_t TieredStorage::AppendToFile(const char* data, uint32_t size) const {
+  auto offset = file_end_.fetch_add(size, std::memory_order_relaxed);
+  size_t done = 0;
+  while (done < size) {
+    auto res = pwrite(fd_, data + done, size - done, offset + done);
+    if (res < 0) {
+      LOG(FATAL) << "Cannot evict record: " << strerror(errno);
+    }
+    done += res;
+  }
+  return offset;
+}
+
+void TieredStorage::RunPrefetcher() {
+  auto NoOp = [](std::string_view, const Metadata&) {};
+  for (;;) {
+    Key key;
+    {
+      std::unique_lock<std::mutex> lock(prefetch_mut_);
+      prefetch_cv_.wait(lock, [this] { return stopping_ || !prefetch_queue_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      key = std::move(prefetch_queue_.front());
+      prefetch_queue_.pop_front();
+    }
+    Access(key, true, NoOp);
+  }
+}
+
+}  // namespace slog
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/lookup_master_index.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Storage that keeps about memory_budget bytes of records in memory and evicts the others to an
+ * append-only file on local disk. The index of all keys, holding the metadata and the location
+ * in the file of each record, always stays in memory.
+ *
+ * Records are evicted with the CLOCK algorithm: an access sets the reference bit of a record and
+ * the clock hand evicts the first record whose bit is cleared, clearing the bits that it passes.
+ * An evicted record is appended to the file only if it changed since it was last written there.
+ * The space taken by the outdated copies in the file is never reclaimed. The file is created
+ * with a unique suffix appended to the given path and is deleted as soon as it is created, so
+ * it goes away with the process.
+ *
+ * Reading an evicted record loads it back into memory. Prefetch() does the same with background
+ * threads so that the records of a txn are in memory by the time a worker reads them. It never
+ * waits for a latch so that the caller is not held up by a writer evicting records.
+ */
+class TieredStorage : public Storage, public LookupMasterIndex {
+ public:
+  TieredStorage(const std::string& path, size_t memory_budget, uint32_t num_prefetch_threads = 1);
+  ~TieredStorage();
+
+  bool Read(const Key& key, Record& result) const final;
+  bool ReadView(const Key& key, const ReadViewFn& fn) const final;
+  // Evicted records are read from the file without being loaded back into memory
+  void ForEach(const ScanFn& fn) const final;
+  bool Write(const Key& key, const Record& record) final;
+  bool Write(const Key& key, Record&& record) final;
+  bool Delete(const Key& key) final;
+  void Reserve(size_t num_records) final;
+  void Prefetch(const std::vector<const Key*>& keys) final;
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final;
+
+  size_t bytes_in_memory() const;
+  uint64_t num_evictions() const { return num_evictions_.load(std::memory_order_relaxed); }
+  // Number of records loaded back into memory by a read
+  uint64_t num_faults() const { return num_faults_.load(std::memory_order_relaxed); }
+  // Number of records loaded back into memory by a prefetch
+  uint64_t num_prefetched() const { return num_prefetched_.load(std::memory_order_relaxed); }
+  uint64_t file_size() const { return file_end_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr size_t kNumShards = 64;
+  // Prefetch requests beyond this are dropped since they are only hints
+  static constexpr size_t kMaxPendingPrefetches = 100000;
+  static constexpr uint64_t kNotInFile = UINT64_MAX;
+
+  struct Entry {
+    Metadata metadata;
+    // Empty if the record is evicted
+    Record record;
+    bool in_memory = false;
+    bool referenced = false;
+    // True if the record in memory differs from its copy in the file
+    bool dirty = true;
+    uint64_t offset = kNotInFile;
+    uint32_t size = 0;
+    // Position in the clock of the shard if the record is in memory
+    size_t clock_slot = 0;
+  };
+  using EntryPtr = std::pair<const Key, Entry>*;
+
+  struct alignas(64) Shard {
+    std::mutex mut;
+    std::unordered_map<Key, Entry> entries;
+    // Records in memory. Slots of evicted or deleted records are null until they are reused
+    std::vector<EntryPtr> clock;
+    std::vector<size_t> free_slots;
+    size_t hand = 0;
+    size_t bytes = 0;
+  };
+
+  Shard& ShardOf(const Key& key) const { return shards_[std::hash<Key>{}(key) % kNumShards]; }
+
+  // Must hold the latch of the shard
+  void Install(Shard& shard, EntryPtr entry, Record&& record, bool dirty) const;
+  void Uninstall(Shard& shard, EntryPtr entry) const;
+  void EvictIfNeeded(Shard& shard) const;
+  template <typename R>
+  bool WriteImpl(const Key& key, R&& record);
+
+  /**
+   * Calls fn on the record of key, loading it back into memory if it is evicted. The
+   * latch of the shard is not held while reading from the file. Returns false if key
+   * does not exist
+   */
+  bool Access(const Key& key, bool is_prefetch, const ReadViewFn& fn) const;
+
+  void ReadFromFile(uint64_t offset, uint32_t size, std::string& buf) const;
+  uint64_t AppendToFile(const char* data, uint32_t size) const;
+
+  void RunPrefetcher();
+
+  mutable std::array<Shard, kNumShards> shards_;
+  size_t shard_memory_budget_;
+  int fd_;
+  mutable std::atomic<uint64_t> file_end_;
+
+  mutable std::atomic<uint64_t> num_evictions_;
+  mutable std::atomic<uint64_t> num_faults_;
+  mutable std::atomic<uint64_t> num_prefetched_;
+
+  std::mutex prefetch_mut_;
+  std::condition_variable prefetch_cv_;
+  std::deque<Key> prefetch_queue_;
+  bool stopping_;
+  std::vector<std::thread> prefetch_threads_;
+};
+
+}  // namespace slog
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "data_structure/concurrent_hash_map.h"
+#include "storage/lookup_master_index.h"
+#include "storage/master_metadata_index.h"
+#include "storage/storage.h"
+
+namespace slog {
+
+/**
+ * Storage that keeps older versions of the records so that read-only txns can read a consistent
+ * snapshot without taking any lock. Each write is stamped with the version that the scheduler
+ * assigned to its txn, and the scheduler publishes the applied version: all writes up to that
+ * version are complete and no write with a lower or equal version can happen anymore. A snapshot
+ * at the applied version therefore sees a prefix of the order in which txns were serialized.
+ *
+ * The versions of a key form an immutable chain ordered from newest to oldest. A write prepends
+ * a version to the chain and replaces the chain head in the hash map. Versions that no open or
+ * future snapshot can see are trimmed by a background thread every gc_interval. The thread only
+ * visits the keys that were written more than once since they were last trimmed.
+ *
+ * Writes without a version (i.e. loading the initial data) are stamped with version 0.
+ */
+class VersionedStorage : public Storage, public LookupMasterIndex {
+ public:
+  struct Version {
+    Version(int64_t version, bool deleted, const Record& record) : version(version), deleted(deleted), record(record) {}
+    Version(int64_t version, bool deleted, Record&& record)
+        : version(version), deleted(deleted), record(std::move(record)) {}
+
+    int64_t version;
+    // A deleted key leaves a tombstone until its older versions are trimmed
+    bool deleted;
+    Record record;
+    // Must not be modified once the version is reachable by readers, except when the
+    // garbage collector cuts the chain (see Trim)
+    mutable std::shared_ptr<const Version> older;
+
+    // Only the newest version of a key is accounted for in the stats of the hash map
+    friend size_t HeapBytes(const std::shared_ptr<const Version>& version) {
+      return version ? sizeof(Version) + version->record.heap_bytes() : 0;
+    }
+  };
+  using VersionPtr = std::shared_ptr<const Version>;
+
+  /**
+   * A snapshot at the applied version at the time of its creation. The versions that it can
+   * see are not trimmed until it is destroyed
+   */
+  class Snapshot {
+   public:
+    explicit Snapshot(VersionedStorage& storage) : storage_(storage) {
+      std::lock_guard<std::mutex> guard(storage_.snapshots_mut_);
+      version_ = storage_.applied_version_.load(std::memory_order_acquire);
+      storage_.open_snapshots_.insert(version_);
+    }
+
+    ~Snapshot() {
+      std::lock_guard<std::mutex> guard(storage_.snapshots_mut_);
+      storage_.open_snapshots_.erase(storage_.open_snapshots_.find(version_));
+    }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    int64_t version() const { return version_; }
+
+    bool ReadView(const Key& key, const ReadViewFn& fn) const { return storage_.ReadViewAt(key, version_, fn); }
+
+   private:
+    VersionedStorage& storage_;
+    int64_t version_;
+  };
+
+  /**
+   * If gc_interval is zero, old versions are only trimmed by explicit calls to CollectGarbage
+   */
+  explicit VersionedStorage(std::chrono::milliseconds gc_interval = std::chrono::milliseconds(100))
+      : applied_version_(0), gc_interval_(gc_interval), stopping_(false) {
+    if (gc_interval_.count() > 0) {
+      gc_thread_ = std::thread(&VersionedStorage::RunGarbageCollector, this);
+    }
+  }
+
+  ~VersionedStorage() {
+    {
+      std::lock_guard<std::mutex> guard(gc_mut_);
+      stopping_ = true;
+    }
+    gc_cv_.notify_one();
+    if (gc_thread_.joinable()) {
+      gc_thread_.join();
+    }
+  }
+
+  bool Read(const Key& key, Record& result) const final {
+    bool found = false;
+    table_.Visit(key, [&](const VersionPtr& head) {
+      if (!head->deleted) {
+        result = head->record;
+        found = true;
+      }
+    });
+    return found;
+  }
+
+  bool ReadView(const Key& key, const ReadViewFn& fn) const final {
+    return ReadViewAt(key, std::numeric_limits<int64_t>::max(), fn);
+  }
+
+  void MultiRead(const std::vector<const Key*>& keys, const MultiReadFn& fn) const final {
+    table_.MultiVisit(keys, [&fn](size_t i, const VersionPtr& head) {
+      if (!head->deleted) {
+        fn(i, std::string_view(head->record.data(), head->record.size()), head->record.metadata());
+      }
+    });
+  }
+
+  // Calls fn on the newest version of the record of key that is not newer than the given version
+  bool ReadViewAt(const Key& key, int64_t version, const ReadViewFn& fn) const {
+    bool found = false;
+    table_.Visit(key, [&](const VersionPtr& head) {
+      auto v = head.get();
+      while (v != nullptr && v->version > version) {
+        v = v->older.get();
+      }
+      if (v != nullptr && !v->deleted) {
+        fn(std::string_view(v->record.data(), v->record.size()), v->record.metadata());
+        found = true;
+      }
+    });
+    return found;
+  }
+
+  void ForEach(const ScanFn& fn) const final {
+    table_.ForEach([&fn](const Key& key, const VersionPtr& head) {
+      if (!head->deleted) {
+        fn(key, std::string_view(head->record.data(), head->record.size()), head->record.metadata());
+      }
+    });
+  }
+
+  bool Write(const Key& key, const Record& record) final { return Write(key, record, 0); }
+
+  bool Write(const Key& key, Record&& record) final { return Write(key, std::move(record), 0); }
+
+  bool Write(const Key& key, const Record& record, int64_t version) final {
+    master_index_.Update(key, record.metadata());
+    // Build the version outside of the critical section
+    return Prepend(key, std::make_shared<Version>(version, false, record));
+  }
+
+  bool Write(const Key& key, Record&& record, int64_t version) final {
+    master_index_.Update(key, record.metadata());
+    return Prepend(key, std::make_shared<Version>(version, false, std::move(record)));
+  }
+
+  bool Delete(const Key& key) final { return Delete(key, 0); }
+
+  bool Delete(const Key& key, int64_t version) final {
+    master_index_.Erase(key);
+    return Prepend(key, std::make_shared<Version>(version, true, Record()));
+  }
+
+  void SetAppliedVersion(int64_t version) final { applied_version_.store(version, std::memory_order_release); }
+
+  int64_t applied_version() const { return applied_version_.load(std::memory_order_acquire); }
+
+  void Reserve(size_t num_records) final {
+    master_index_.Reserve(num_records);
+    table_.Reserve(num_records);
+  }
+
+  void BulkLoad(std::vector<std::pair<Key, Record>>&& records, uint32_t num_threads) final {
+    master_index_.BulkLoad(records, num_threads);
+    std::vector<std::pair<Key, VersionPtr>> versions;
+    versions.reserve(records.size());
+    for (auto& [key, record] : records) {
+      versions.emplace_back(std::move(key), std::make_shared<const Version>(0, false, std::move(record)));
+    }
+    records = {};
+    table_.BulkInsert(std::move(versions), num_threads);
+  }
+
+  uint32_t BulkLoadGroupOf(const Key& key, uint32_t num_groups) const final { return SegmentGroupOf(key, num_groups); }
+
+  bool GetMasterMetadata(const Key& key, Metadata& metadata) const final {
+    return master_index_.GetMasterMetadata(key, metadata);
+  }
+
+  bool GetStats(StorageStats& stats) const final {
+    stats.Add(table_.GetStats());
+    // The index takes memory but its lookups are not reads of records
+    stats.Add(master_index_.GetStats(), false);
+    return true;
+  }
+
+  /**
+   * Trims the versions that are older than the newest version visible to the oldest open
+   * snapshot, or to a snapshot at the applied version if there is none. Keys whose newest
+   * visible version is a tombstone are erased. Returns the number of trimmed versions
+   */
+  size_t CollectGarbage() {
+    auto horizon = GarbageCollectionHorizon();
+
+    size_t num_trimmed = 0;
+    std::vector<Key> keys;
+    for (auto& candidates : gc_candidates_) {
+      {
+        std::lock_guard<std::mutex> guard(candidates.mut);
+        keys.swap(candidates.keys);
+      }
+      for (const auto& key : keys) {
+        bool still_candidate = false;
+        table_.Compute(key, [&](const VersionPtr* current) -> std::optional<VersionPtr> {
+          if (current == nullptr) {
+            return {};
+          }
+          auto new_head = Trim(*current, horizon, num_trimmed);
+          still_candidate = new_head != nullptr && IsCandidate(new_head);
+          return new_head == nullptr ? std::nullopt : std::optional<VersionPtr>(std::move(new_head));
+        });
+        // The versions above the horizon are trimmed in a later pass
+        if (still_candidate) {
+          AddCandidate(key);
+        }
+      }
+      keys.clear();
+    }
+    return num_trimmed;
+  }
+
+ private:
+  /**
+   * Cuts the chain starting at head after the newest version that a snapshot at horizon can
+   * see. Returns nullptr if that version is a tombstone at the head of the chain, since the
+   * key can then be erased.
+   *
+   * Only the older pointer of the cut version is modified, under the latch of the key. Every
+   * reader reads at or after horizon and stops at that version without loading the pointer,
+   * so the kept versions are shared with the readers instead of being copied
+   */
+  static VersionPtr Trim(const VersionPtr& head, int64_t horizon, size_t& num_trimmed) {
+    auto v = head.get();
+    while (v != nullptr && v->version > horizon) {
+      v = v->older.get();
+    }
+    if (v == nullptr || (v->older == nullptr && !(v == head.get() && v->deleted))) {
+      return head;
+    }
+    for (auto older = v->older.get(); older != nullptr; older = older->older.get()) {
+      num_trimmed++;
+    }
+    if (v == head.get() && v->deleted) {
+      num_trimmed++;
+      return nullptr;
+    }
+    // A tombstone that is kept here is trimmed once a newer version is cut
+    v->older = nullptr;
+    return head;
+  }
+
+  // Returns true if the chain may have versions to trim now or later
+  static bool IsCandidate(const VersionPtr& head) { return head->older != nullptr || head->deleted; }
+
+  void AddCandidate(const Key& key) {
+    auto& candidates = gc_candidates_[std::hash<Key>{}(key) % kNumCandidateShards];
+    std::lock_guard<std::mutex> guard(candidates.mut);
+    candidates.keys.push_back(key);
+  }
+
+  /**
+   * Prepends new_version to the chain of key. Returns true if key existed before.
+   *
+   * A key is queued for garbage collection when its chain becomes a candidate and stays
+   * queued until the garbage collector finds it is not a candidate anymore, so the key is
+   * never queued twice
+   */
+  bool Prepend(const Key& key, std::shared_ptr<Version>&& new_version) {
+    bool existed = false;
+    bool new_candidate = false;
+    table_.Compute(key, [&](const VersionPtr* current) -> std::optional<VersionPtr> {
+      if (current != nullptr) {
+        existed = !(*current)->deleted;
+        // A txn writing the same key more than once only keeps its last write
+        new_version->older = (*current)->version == new_version->version ? (*current)->older : *current;
+      }
+      if (new_version->deleted && new_version->older == nullptr) {
+        return {};
+      }
+      new_candidate = IsCandidate(new_version) && (current == nullptr || !IsCandidate(*current));
+      return std::move(new_version);
+    });
+    if (new_candidate) {
+      AddCandidate(key);
+    }
+    return existed;
+  }
+
+  int64_t GarbageCollectionHorizon() const {
+    std::lock_guard<std::mutex> guard(snapshots_mut_);
+    auto horizon = applied_version_.load(std::memory_order_acquire);
+    if (!open_snapshots_.empty()) {
+      horizon = std::min(horizon, *open_snapshots_.begin());
+    }
+    return horizon;
+  }
+
+  void RunGarbageCollector() {
+    std::unique_lock<std::mutex> lock(gc_mut_);
+    while (!gc_cv_.wait_for(lock, gc_interval_, [this] { return stopping_; })) {
+      lock.unlock();
+      CollectGarbage();
+      lock.lock();
+    }
+  }
+
+  ConcurrentHashMap<Key, VersionPtr> table_;
+  MasterMetadataIndex master_index_;
+
+  std::atomic<int64_t> applied_version_;
+  mutable std::mutex snapshots_mut_;
+  std::multiset<int64_t> open_snapshots_;
+
+  // Keys that may have versions to trim. Sharded to reduce the contention between the writers
+  static constexpr size_t kNumCandidateShards = 64;
+  struct alignas(64) CandidateShard {
+    std::mutex mut;
+    std::vector<Key> keys;
+  };
+  std::array<CandidateShard, kNumCandidateShards> gc_candidates_;
+
+  std::chrono::milliseconds gc_interval_;
+  std::mutex gc_mut_;
+  std::condition_variable gc_cv_;
+  bool stopping_;
+  std::thread gc_thread_;
+};
+
+}  // namespace slog
@@ -0,0 +1,54 @@
+#include "common/numa.h"
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+using namespace slog;
+
+TEST(NumaTest, ParseCpuList) {
+  ASSERT_EQ(ParseCpuList("0"), std::vector<int>({0}));
+  ASSERT_EQ(ParseCpuList("0-3,8,10-11\n"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_TRUE(ParseCpuList("").empty());
+  ASSERT_TRUE(ParseCpuList("0-a").empty());
+}
+
+TEST(NumaTest, DetectFromSysfs) {
+  auto dir = ::testing::TempDir() + "numa_test_" + std::to_string(getpid());
+  mkdir(dir.c_str(), 0755);
+  // Node 1 has no CPU so it is left out and node 2 becomes the second node
+  std::vector<std::pair<std::string, std::string>> nodes = {{"node0", "0-1,4"}, {"node1", ""}, {"node2", "2-3"}};
+  for (const auto& [node, cpu_list] : nodes) {
+    mkdir((dir + "/" + node).c_str(), 0755);
+    std::ofstream(dir + "/" + node + "/cpulist") << cpu_list << "\n";
+  }
+
+  auto topology = NumaTopology::Detect(dir);
+  ASSERT_EQ(topology.num_nodes(), 2U);
+  ASSERT_EQ(topology.cpus(0), std::vector<int>({0, 1, 4}));
+  ASSERT_EQ(topology.cpus(1), std::vector<int>({2, 3}));
+  ASSERT_EQ(topology.NodeOfCpu(4), 0);
+  ASSERT_EQ(topology.NodeOfCpu(3), 1);
+  ASSERT_EQ(topology.kernel_node(0), 0);
+  ASSERT_EQ(topology.kernel_node(1), 2);
+  ASSERT_EQ(topology.NodeOfKernelNode(2), 1);
+  ASSERT_EQ(topology.NodeOfKernelNode(1), -1);
+
+  for (const auto& [node, _] : nodes) {
+    unlink((dir + "/" + node + "/cpulist").c_str());
+    rmdir((dir + "/" + node).c_str());
+  }
+  rmdir(dir.c_str());
+}
+
+TEST(NumaTest, FallBackToSingleNode) {
+  auto topology = NumaTopology::Detect("/nonexistent");
+  ASSERT_EQ(topology.num_nodes(), 1U);
+  ASSERT_FALSE(topology.cpus(0).empty());
+  ASSERT_EQ(topology.CurrentNode(), 0);
+  ASSERT_EQ(topology.kernel_node(0), 0);
+}
+
+TEST(NumaTest, RejectNegativeMemoryNode) { ASSERT_FALSE(PreferMemoryNode(-1)); }
@@ -0,0 +1,103 @@
+#include "common/offline_data_reader.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+using namespace slog;
+
+class OfflineDataReaderTest : public ::testing::Test {
+ protected:
+  void SetUp() { path = ::testing::TempDir() + "offline_data_reader_test_" + std::to_string(getpid()) + ".dat"; }
+
+  void TearDown() { unlink(path.c_str()); }
+
+  static Datum MakeDatum(int i) {
+    Datum datum;
+    datum.set_key("key" + std::to_string(i));
+    datum.set_record(std::string(i % 50, 'a' + i % 26));
+    datum.set_master(i % 3);
+    return datum;
+  }
+
+  // Reads the file at path and checks that it contains exactly the datums made by MakeDatum(0..num_datums - 1)
+  void ReadAndCheck(int num_datums, uint32_t num_threads) {
+    std::mutex mut;
+    std::unordered_map<std::string, Datum> datums;
+    ASSERT_TRUE(ReadOfflineData(path, num_threads, [&](const Datum& datum) {
+      std::lock_guard<std::mutex> guard(mut);
+      datums.emplace(datum.key(), datum);
+    }));
+    ASSERT_EQ(datums.size(), static_cast<size_t>(num_datums));
+    for (int i = 0; i < num_datums; i++) {
+      auto expected = MakeDatum(i);
+      auto it = datums.find(expected.key());
+      ASSERT_NE(it, datums.end()) << "Missing " << expected.key();
+      ASSERT_EQ(it->second.record(), expected.record());
+      ASSERT_EQ(it->second.master(), expected.master());
+    }
+  }
+
+  std::string path;
+};
+
+TEST_F(OfflineDataReaderTest, ReadChunkedFile) {
+  const int kNumDatums = 10000;
+  OfflineDataWriter writer(path, 1000);
+  for (int i = 0; i < kNumDatums; i++) {
+    writer.AddDatum(MakeDatum(i));
+  }
+  ASSERT_TRUE(writer.Finish());
+
+  ReadAndCheck(kNumDatums, 1);
+  ReadAndCheck(kNumDatums, 4);
+}
+
+TEST_F(OfflineDataReaderTest, ReadEmptyChunkedFile) {
+  OfflineDataWriter writer(path);
+  ASSERT_TRUE(writer.Finish());
+
+  ReadAndCheck(0, 4);
+}
+
+TEST_F(OfflineDataReaderTest, ReadLegacyFile) {
+  const int kNumDatums = 1000;
+  {
+    std::ofstream file(path, std::ios::binary);
+    google::protobuf::io::OstreamOutputStream raw_output(&file);
+    google::protobuf::io::CodedOutputStream coded_output(&raw_output);
+    coded_output.WriteVarint32(kNumDatums);
+    for (int i = 0; i < kNumDatums; i++) {
+      auto buf = MakeDatum(i).SerializeAsString();
+      coded_output.WriteVarint32(buf.size());
+      coded_output.WriteString(buf);
+    }
+  }
+
+  ReadAndCheck(kNumDatums, 4);
+}
+
+TEST_F(OfflineDataReaderTest, RejectCorruptChunk) {
+  OfflineDataWriter writer(path, 100);
+  for (int i = 0; i < 1000; i++) {
+    writer.AddDatum(MakeDatum(i));
+  }
+  ASSERT_TRUE(writer.Finish());
+
+  // Overwrite the size of a datum in the middle of the first chunk with an invalid varint
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(200);
+    file.write(std::string(10, '\xff').data(), 10);
+  }
+  ASSERT_FALSE(ReadOfflineData(path, 4, [](const Datum&) {}));
+}
+
+TEST_F(OfflineDataReaderTest, MissingFile) {
+  ASSERT_FALSE(ReadOfflineData(path + ".missing", 4, [](const Datum&) {}));
+}
@@ -0,0 +1,122 @@
+#include "common/slab_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "common/types.h"
+
+using namespace std;
+using namespace slog;
+
+TEST(SlabAllocatorTest, Capacity) {
+  ASSERT_EQ(SlabAllocator::Capacity(1), 16U);
+  ASSERT_EQ(SlabAllocator::Capacity(16), 16U);
+  ASSERT_EQ(SlabAllocator::Capacity(17), 32U);
+  ASSERT_EQ(SlabAllocator::Capacity(100), 128U);
+  ASSERT_EQ(SlabAllocator::Capacity(4096), 4096U);
+  ASSERT_EQ(SlabAllocator::Capacity(4097), 4097U);
+}
+
+TEST(SlabAllocatorTest, ReuseFreedBlocks) {
+  auto capacity = SlabAllocator::Capacity(100);
+  vector<char*> bufs;
+  for (int i = 0; i < 1000; i++) {
+    auto buf = SlabAllocator::Allocate(capacity);
+    memset(buf, i % 128, capacity);
+    bufs.push_back(buf);
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(bufs[i][capacity - 1], i % 128);
+  }
+  auto slabs = SlabAllocator::GetStats().slabs;
+  for (auto buf : bufs) {
+    SlabAllocator::Deallocate(buf, capacity);
+  }
+  // Allocating again must not take more memory from the system
+  for (int i = 0; i < 1000; i++) {
+    bufs[i] = SlabAllocator::Allocate(capacity);
+  }
+  ASSERT_EQ(SlabAllocator::GetStats().slabs, slabs);
+  for (auto buf : bufs) {
+    SlabAllocator::Deallocate(buf, capacity);
+  }
+}
+
+TEST(SlabAllocatorTest, FreeFromOtherThread) {
+  auto capacity = SlabAllocator::Capacity(64);
+  vector<char*> bufs(10000);
+  thread producer([&] {
+    for (auto& buf : bufs) {
+      buf = SlabAllocator::Allocate(capacity);
+    }
+  });
+  producer.join();
+  auto slabs = SlabAllocator::GetStats().slabs;
+  thread consumer([&] {
+    for (auto buf : bufs) {
+      SlabAllocator::Deallocate(buf, capacity);
+    }
+  });
+  consumer.join();
+  // The blocks released by the consumer are available to this thread through the central list
+  for (auto& buf : bufs) {
+    buf = SlabAllocator::Allocate(capacity);
+  }
+  ASSERT_EQ(SlabAllocator::GetStats().slabs, slabs);
+  for (auto buf : bufs) {
+    SlabAllocator::Deallocate(buf, capacity);
+  }
+}
+
+TEST(RecordTest, InlineAndSlabValues) {
+  Record small("small", 1, 2);
+  ASSERT_EQ(small.to_string(), "small");
+  ASSERT_EQ(small.metadata().master, 1U);
+  ASSERT_EQ(small.metadata().counter, 2U);
+
+  string large_value(1000, 'x');
+  Record large(large_value);
+  ASSERT_EQ(large.to_string(), large_value);
+
+  // Copy
+  Record copy(large);
+  ASSERT_EQ(copy.to_string(), large_value);
+  copy = small;
+  ASSERT_EQ(copy.to_string(), "small");
+  ASSERT_EQ(copy.metadata().master, 1U);
+  copy = large;
+  ASSERT_EQ(copy.to_string(), large_value);
+  ASSERT_EQ(large.to_string(), large_value);
+
+  // Move
+  Record moved(move(large));
+  ASSERT_EQ(moved.to_string(), large_value);
+  ASSERT_EQ(large.size(), 0U);
+  moved = move(small);
+  ASSERT_EQ(moved.to_string(), "small");
+
+  // Value that points into the record itself
+  Record self(string(100, 'y'));
+  self.SetValue(self.data(), 10);
+  ASSERT_EQ(self.to_string(), string(10, 'y'));
+
+  Record empty;
+  ASSERT_EQ(empty.to_string(), "");
+  ASSERT_EQ(Record("").to_string(), "");
+}
+
+TEST(RecordTest, CopyReusesBuffer) {
+  Record src(string(100, 'a'));
+  Record dst;
+  dst = src;
+  auto slab_allocations = SlabAllocator::GetStats().slab_allocations;
+  for (int i = 0; i < 100; i++) {
+    src.SetValue(string(100 + i % 20, 'a' + i % 26));
+    dst = src;
+    ASSERT_EQ(dst.to_string(), src.to_string());
+  }
+  // Values stay within the same size class so no new buffer is needed
+  ASSERT_EQ(SlabAllocator::GetStats().slab_allocations, slab_allocations);
+}
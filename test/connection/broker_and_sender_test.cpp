@@ -326,4 +326,65 @@ TEST(BrokerTest, RemoveRedirection) {
   // it should be unlikely due to the sleep.
   this_thread::sleep_for(5ms);
   ASSERT_EQ(RecvEnvelope(pong_socket, true), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(BrokerTest, DemultiplexRemoteReadResults) {
+  const Channel WORKER_1 = 8;
+  const Channel WORKER_2 = 9;
+  const Channel TAG_1 = 11111;
+  const Channel TAG_2 = 22222;
+  ConfigVec configs = MakeTestConfigurations("demux", 1, 2);
+
+  // Initialize the receiving machine
+  auto broker = Broker::New(configs[1], kTestModuleTimeout);
+  auto socket_1 = MakePullSocket(*broker->context(), WORKER_1);
+  auto socket_2 = MakePullSocket(*broker->context(), WORKER_2);
+  broker->AddChannel(WORKER_1);
+  broker->AddChannel(WORKER_2);
+  broker->StartInNewThreads();
+  Sender sender(broker->config(), broker->context());
+
+  // Only the first tag is redirected before the results arrive
+  {
+    auto env = std::make_unique<internal::Envelope>();
+    auto redirect = env->mutable_request()->mutable_broker_redirect();
+    redirect->set_tag(TAG_1);
+    redirect->set_channel(WORKER_1);
+    sender.Send(move(env), kBrokerChannel + 1);
+  }
+
+  // Send the results of both tags in one message from the other machine
+  {
+    Sender remote_sender(configs[0], make_shared<zmq::context_t>(1));
+    Envelope env;
+    auto results = env.mutable_request()->mutable_remote_read_results();
+    results->add_results()->set_txn_id(TAG_1);
+    results->add_results()->set_txn_id(TAG_2);
+    remote_sender.Send(env, configs[0]->MakeMachineId(0, 1), kBrokerChannel + 1);
+  }
+
+  {
+    auto env = RecvEnvelope(socket_1);
+    ASSERT_TRUE(env != nullptr);
+    ASSERT_EQ(env->request().remote_read_result().txn_id(), TAG_1);
+  }
+
+  // The result of the second tag waits at the broker until its redirection is established
+  this_thread::sleep_for(5ms);
+  ASSERT_EQ(RecvEnvelope(socket_2, true), nullptr);
+
+  {
+    auto env = std::make_unique<internal::Envelope>();
+    auto redirect = env->mutable_request()->mutable_broker_redirect();
+    redirect->set_tag(TAG_2);
+    redirect->set_channel(WORKER_2);
+    sender.Send(move(env), kBrokerChannel + 1);
+  }
+
+  {
+    auto env = RecvEnvelope(socket_2);
+    ASSERT_TRUE(env != nullptr);
+    ASSERT_EQ(env->request().remote_read_result().txn_id(), TAG_2);
+  }
+  ASSERT_EQ(RecvEnvelope(socket_1, true), nullptr);
+}
@@ -2,7 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <optional>
 #include <thread>
+#include <vector>
 
 using namespace std;
 using namespace slog;
@@ -161,4 +163,242 @@ TEST(ConcurrentHashMapTest, OneWriterOneEraser) {
       ASSERT_EQ(result, to_string(i));
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(ConcurrentHashMapTest, ReadersDuringRehashAndErase) {
+  int N = 50000;
+  ConcurrentHashMap<string, string> map;
+  // Even keys are never erased so readers must always find them
+  for (int i = 0; i < N; i += 2) {
+    map.InsertOrUpdate(to_string(i), to_string(i));
+  }
+
+  atomic<bool> done = false;
+  auto Writes = [&]() {
+    for (int i = 1; i < N; i += 2) {
+      map.InsertOrUpdate(to_string(i), to_string(i));
+      map.InsertOrUpdate(to_string(i - 1), to_string(i - 1));
+      if (i % 4 == 1) {
+        map.Erase(to_string(i));
+      }
+    }
+    done = true;
+  };
+
+  auto Reads = [&]() {
+    string result;
+    while (!done) {
+      for (int i = 0; i < N; i += 2) {
+        ASSERT_TRUE(map.Get(result, to_string(i))) << "Failed at i = " << i;
+        ASSERT_EQ(result, to_string(i));
+      }
+    }
+  };
+
+  thread w(Writes);
+  thread r1(Reads);
+  thread r2(Reads);
+  w.join();
+  r1.join();
+  r2.join();
+
+  string result;
+  for (int i = 1; i < N; i += 2) {
+    ASSERT_EQ(map.Get(result, to_string(i)), i % 4 != 1) << "Failed at i = " << i;
+  }
+}
+
+TEST(ConcurrentHashMapTest, VisitWithoutCopy) {
+  ConcurrentHashMap<string, string> map;
+  map.InsertOrUpdate("foo", "bar");
+  size_t len = 0;
+  ASSERT_TRUE(map.Visit("foo", [&len](const string& value) { len = value.size(); }));
+  ASSERT_EQ(len, 3U);
+  ASSERT_FALSE(map.Visit("baz", [](const string&) { FAIL(); }));
+}
+
+TEST(ConcurrentHashMapTest, MultiVisit) {
+  ConcurrentHashMap<string, string> map;
+  for (int i = 0; i < 1000; i += 2) {
+    map.InsertOrUpdate(to_string(i), "foo" + to_string(i));
+  }
+
+  vector<string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(to_string(i));
+  }
+  vector<const string*> key_ptrs;
+  for (const auto& key : keys) {
+    key_ptrs.push_back(&key);
+  }
+
+  vector<int> visits(keys.size(), 0);
+  map.MultiVisit(key_ptrs, [&](size_t i, const string& value) {
+    visits[i]++;
+    ASSERT_EQ(value, "foo" + keys[i]);
+  });
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(visits[i], i % 2 == 0 ? 1 : 0) << "Failed at i = " << i;
+  }
+}
+
+TEST(ConcurrentHashMapTest, MultiVisitDuringRehash) {
+  int N = 50000;
+  ConcurrentHashMap<string, string> map;
+  vector<string> keys;
+  vector<const string*> key_ptrs;
+  for (int i = 0; i < 64; i++) {
+    keys.push_back(to_string(i));
+    map.InsertOrUpdate(keys.back(), keys.back());
+  }
+  for (const auto& key : keys) {
+    key_ptrs.push_back(&key);
+  }
+
+  atomic<bool> done = false;
+  auto Writes = [&]() {
+    for (int i = 64; i < N; i++) {
+      map.InsertOrUpdate(to_string(i), to_string(i));
+    }
+    done = true;
+  };
+
+  thread w(Writes);
+  while (!done) {
+    size_t found = 0;
+    map.MultiVisit(key_ptrs, [&](size_t i, const string& value) {
+      ASSERT_EQ(value, keys[i]);
+      found++;
+    });
+    ASSERT_EQ(found, keys.size());
+  }
+  w.join();
+}
+
+TEST(ConcurrentHashMapTest, BulkInsert) {
+  ConcurrentHashMap<string, string> map;
+  map.InsertOrUpdate("0", "old");
+  map.Reserve(10000);
+
+  vector<pair<string, string>> entries;
+  for (int i = 0; i < 10000; i++) {
+    entries.emplace_back(to_string(i), "foo" + to_string(i));
+  }
+  // The last entry of a duplicated key wins
+  entries.emplace_back("1", "bar");
+  map.BulkInsert(std::move(entries), 4);
+
+  string result;
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_TRUE(map.Get(result, to_string(i))) << "Failed at i = " << i;
+    ASSERT_EQ(result, i == 1 ? "bar" : "foo" + to_string(i));
+  }
+
+  // The map is usable as normal afterwards
+  map.InsertOrUpdate("10000", "baz");
+  ASSERT_TRUE(map.Get(result, "10000"));
+  ASSERT_EQ(result, "baz");
+}
+
+TEST(ConcurrentHashMapTest, Compute) {
+  ConcurrentHashMap<string, string> map;
+  // Insert a missing key
+  ASSERT_FALSE(map.Compute("a", [](const string* current) -> optional<string> {
+    EXPECT_EQ(current, nullptr);
+    return "foo";
+  }));
+  // Update based on the current value
+  ASSERT_TRUE(map.Compute("a", [](const string* current) -> optional<string> { return *current + "bar"; }));
+  string result;
+  ASSERT_TRUE(map.Get(result, "a"));
+  ASSERT_EQ(result, "foobar");
+  // Erase
+  ASSERT_TRUE(map.Compute("a", [](const string*) -> optional<string> { return {}; }));
+  ASSERT_FALSE(map.Get(result, "a"));
+  ASSERT_FALSE(map.Compute("a", [](const string*) -> optional<string> { return {}; }));
+}
+
+TEST(ConcurrentHashMapTest, ConcurrentCompute) {
+  ConcurrentHashMap<string, int> map;
+  const int kIncrements = 100000;
+  auto Increment = [&map]() {
+    for (int i = 0; i < kIncrements; i++) {
+      map.Compute("counter", [](const int* current) -> optional<int> { return current ? *current + 1 : 1; });
+    }
+  };
+  thread t1(Increment);
+  thread t2(Increment);
+  t1.join();
+  t2.join();
+  int result;
+  ASSERT_TRUE(map.Get(result, "counter"));
+  ASSERT_EQ(result, 2 * kIncrements);
+}
+
+TEST(ConcurrentHashMapTest, Stats) {
+  ConcurrentHashMap<string, string> map;
+  const string kLongValue(100, 'x');
+  for (int i = 0; i < 1000; i++) {
+    map.InsertOrUpdate(to_string(i), kLongValue);
+  }
+  string result;
+  for (int i = 0; i < 10; i++) {
+    map.Get(result, to_string(i));
+  }
+  map.Visit("0", [](const string&) {});
+  map.MultiVisit({&kLongValue, &kLongValue}, [](size_t, const string&) {});
+  for (int i = 0; i < 100; i++) {
+    map.Erase(to_string(i));
+  }
+
+  auto stats = map.GetStats();
+  ASSERT_EQ(stats.num_reads, 13U);
+  ASSERT_EQ(stats.num_writes, 1100U);
+
+  SegmentStats total;
+  for (const auto& segment : stats.segments) {
+    total += segment;
+  }
+  ASSERT_EQ(total.num_nodes, 900U);
+  // The memory of the long values must be accounted for
+  ASSERT_GE(total.bytes, 900 * kLongValue.size());
+  // Each segment starts with 8 buckets so inserting 1000 keys in 256 segments must rehash
+  ASSERT_GT(total.num_rehashes, 0U);
+  ASSERT_GT(total.rehash_ns, 0U);
+  ASSERT_EQ(total.num_latch_waits, 0U);
+
+  // Erasing the remaining keys gives back the memory of their nodes
+  for (int i = 100; i < 1000; i++) {
+    map.Erase(to_string(i));
+  }
+  SegmentStats empty;
+  for (const auto& segment : map.GetStats().segments) {
+    empty += segment;
+  }
+  ASSERT_EQ(empty.num_nodes, 0U);
+  ASSERT_LT(empty.bytes, total.bytes - 900 * kLongValue.size());
+}
+
+TEST(ConcurrentHashMapTest, StatsCountLatchWaits) {
+  ConcurrentHashMap<int, int> map;
+  const int kWrites = 100000;
+  auto Write = [&map]() {
+    for (int i = 0; i < kWrites; i++) {
+      map.InsertOrUpdate(0, i);
+    }
+  };
+  thread t1(Write);
+  thread t2(Write);
+  t1.join();
+  t2.join();
+
+  auto stats = map.GetStats();
+  ASSERT_EQ(stats.num_writes, 2U * kWrites);
+  SegmentStats total;
+  for (const auto& segment : stats.segments) {
+    total += segment;
+  }
+  ASSERT_EQ(total.num_nodes, 1U);
+  // The writers could have run one after the other, but then no time was spent waiting
+  ASSERT_EQ(total.num_latch_waits == 0, total.latch_wait_ns == 0);
+}
@@ -0,0 +1,208 @@
+#include "data_structure/flat_hash_map.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace slog;
+
+TEST(FlatHashMapTest, SerialBasicOperations) {
+  FlatHashMap<string, string> map;
+  string result;
+  ASSERT_FALSE(map.Get(result, "test"));
+  ASSERT_FALSE(map.Erase("test"));
+
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_FALSE(map.InsertOrUpdate(to_string(i), "foo"));
+  }
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(map.Get(result, to_string(i)));
+    ASSERT_EQ(result, "foo");
+  }
+  ASSERT_TRUE(map.InsertOrUpdate("0", "bar"));
+  ASSERT_TRUE(map.Get(result, "0"));
+  ASSERT_EQ(result, "bar");
+
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(map.Erase(to_string(i)));
+  }
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_FALSE(map.Get(result, to_string(i)));
+  }
+}
+
+TEST(FlatHashMapTest, UpdateDestroysOldValue) {
+  FlatHashMap<string, shared_ptr<string>> map;
+  auto old_value = make_shared<string>("foo");
+  weak_ptr<string> old_ref = old_value;
+  ASSERT_FALSE(map.InsertOrUpdate("test", std::move(old_value)));
+  ASSERT_TRUE(map.InsertOrUpdate("test", make_shared<string>("bar")));
+  ASSERT_TRUE(old_ref.expired());
+  shared_ptr<string> result;
+  ASSERT_TRUE(map.Get(result, "test"));
+  ASSERT_EQ(*result, "bar");
+}
+
+TEST(FlatHashMapTest, TriggerRehash) {
+  FlatHashMap<string, string> map;
+  string result;
+
+  for (size_t i = 0; i < 10000; i++) {
+    ASSERT_FALSE(map.InsertOrUpdate(to_string(i), "foo" + to_string(i)));
+  }
+
+  for (size_t i = 0; i < 10000; i++) {
+    ASSERT_TRUE(map.Get(result, to_string(i))) << "Failed at i = " << i;
+    ASSERT_EQ(result, "foo" + to_string(i)) << "Failed at i = " << i;
+  }
+
+  for (size_t i = 0; i < 10000; i++) {
+    ASSERT_TRUE(map.Erase(to_string(i)));
+  }
+
+  for (size_t i = 0; i < 10000; i++) {
+    ASSERT_FALSE(map.Get(result, to_string(i)));
+  }
+}
+
+TEST(FlatHashMapTest, TombstonesAreReused) {
+  // A single segment makes it easy to fill up the groups
+  flat_hash_map::SegmentT<int, int> segment;
+  int result;
+  // Keep inserting and erasing so that the table is mostly made of tombstones
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_FALSE(segment.InsertOrUpdate(round * 10 + i, i));
+    }
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(segment.Get(result, round * 10 + i));
+      ASSERT_EQ(result, i);
+      ASSERT_TRUE(segment.Erase(round * 10 + i));
+    }
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_FALSE(segment.Get(result, i));
+  }
+}
+
+TEST(FlatHashMapTest, MoveOnlyUpdate) {
+  FlatHashMap<int, unique_ptr<int>> map;
+  ASSERT_FALSE(map.InsertOrUpdate(1, make_unique<int>(1)));
+  ASSERT_TRUE(map.InsertOrUpdate(1, make_unique<int>(2)));
+  int result = 0;
+  ASSERT_TRUE(map.Visit(1, [&result](const unique_ptr<int>& value) { result = *value; }));
+  ASSERT_EQ(result, 2);
+}
+
+TEST(FlatHashMapTest, MultiVisit) {
+  FlatHashMap<string, string> map;
+  for (int i = 0; i < 1000; i += 2) {
+    map.InsertOrUpdate(to_string(i), "foo" + to_string(i));
+  }
+
+  vector<string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(to_string(i));
+  }
+  vector<const string*> key_ptrs;
+  for (const auto& key : keys) {
+    key_ptrs.push_back(&key);
+  }
+
+  vector<int> visits(keys.size(), 0);
+  map.MultiVisit(key_ptrs, [&](size_t i, const string& value) {
+    visits[i]++;
+    ASSERT_EQ(value, "foo" + keys[i]);
+  });
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(visits[i], i % 2 == 0 ? 1 : 0) << "Failed at i = " << i;
+  }
+}
+
+TEST(FlatHashMapTest, BulkInsert) {
+  FlatHashMap<string, string> map;
+  map.InsertOrUpdate("0", "old");
+  map.Reserve(10000);
+
+  vector<pair<string, string>> entries;
+  for (int i = 0; i < 10000; i++) {
+    entries.emplace_back(to_string(i), "foo" + to_string(i));
+  }
+  // The last entry of a duplicated key wins
+  entries.emplace_back("1", "bar");
+  map.BulkInsert(std::move(entries), 4);
+
+  string result;
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_TRUE(map.Get(result, to_string(i))) << "Failed at i = " << i;
+    ASSERT_EQ(result, i == 1 ? "bar" : "foo" + to_string(i));
+  }
+
+  // The map is usable as normal afterwards
+  map.InsertOrUpdate("10000", "baz");
+  ASSERT_TRUE(map.Get(result, "10000"));
+  ASSERT_EQ(result, "baz");
+}
+
+TEST(FlatHashMapTest, TwoReadersOneWriter) {
+  uint32_t N = 500000;
+  string key = "foo";
+  FlatHashMap<string, string> map;
+
+  auto Updates = [&]() {
+    for (size_t i = 0; i < N; i++) {
+      map.InsertOrUpdate(key, to_string(i));
+    }
+  };
+
+  auto Gets = [&]() {
+    int prev = 0;
+    string result;
+    for (size_t i = 0; i < N; i++) {
+      if (map.Get(result, key)) {
+        auto x = stoi(result);
+        ASSERT_GE(x, prev);
+        prev = x;
+      }
+    }
+  };
+
+  thread w(Updates);
+  thread r1(Gets);
+  thread r2(Gets);
+  w.join();
+  r1.join();
+  r2.join();
+}
+
+TEST(FlatHashMapTest, OneWriterOneEraser) {
+  int N = 100000;
+  FlatHashMap<string, string> map;
+
+  auto Updates = [&]() {
+    for (int i = 0; i < N; i++) {
+      map.InsertOrUpdate(to_string(i), to_string(i));
+    }
+  };
+
+  auto Erases = [&]() {
+    for (int i = 0; i < N; i++) {
+      map.Erase(to_string(i));
+    }
+  };
+
+  thread w1(Updates);
+  thread w2(Erases);
+  w1.join();
+  w2.join();
+
+  string result;
+  for (int i = 0; i < N; i++) {
+    if (map.Get(result, to_string(i))) {
+      ASSERT_EQ(result, to_string(i));
+    }
+  }
+}
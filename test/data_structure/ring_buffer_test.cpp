@@ -0,0 +1,72 @@
+#include "data_structure/ring_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace std;
+using namespace slog;
+using testing::ElementsAre;
+
+TEST(RingBufferTest, PushAndPop) {
+  RingBuffer<int, 2> ring;
+  ASSERT_TRUE(ring.empty());
+  ring.push_back(1);
+  ring.push_back(2);
+  ASSERT_EQ(ring.front(), 1);
+  ring.pop_front();
+  // Wrap around the inline storage
+  ring.push_back(3);
+  ASSERT_EQ(ring.capacity(), 2U);
+  ASSERT_THAT(vector<int>(ring.begin(), ring.end()), ElementsAre(2, 3));
+  ring.pop_front();
+  ring.pop_front();
+  ASSERT_TRUE(ring.empty());
+}
+
+TEST(RingBufferTest, OverflowAndShrink) {
+  RingBuffer<int, 2> ring;
+  ring.push_back(0);
+  ring.pop_front();
+  for (int i = 1; i <= 100; i++) {
+    ring.push_back(i);
+  }
+  ASSERT_EQ(ring.size(), 100U);
+  ASSERT_EQ(ring.capacity(), 128U);
+  for (int i = 1; i <= 100; i++) {
+    ASSERT_EQ(ring.front(), i);
+    ring.pop_front();
+  }
+  // The overflow buffer is given back once the ring is empty
+  ASSERT_EQ(ring.capacity(), 2U);
+}
+
+TEST(RingBufferTest, EraseIf) {
+  RingBuffer<int, 4> ring;
+  ring.push_back(0);
+  ring.push_back(0);
+  ring.pop_front();
+  ring.pop_front();
+  for (int i = 1; i <= 6; i++) {
+    ring.push_back(i);
+  }
+  ASSERT_EQ(ring.EraseIf([](int e) { return e % 2 == 0; }), 3U);
+  ASSERT_THAT(vector<int>(ring.begin(), ring.end()), ElementsAre(1, 3, 5));
+  ASSERT_EQ(ring.EraseIf([](int e) { return e == 7; }), 0U);
+  ASSERT_EQ(ring.EraseIf([](int) { return true; }), 3U);
+  ASSERT_TRUE(ring.empty());
+  ASSERT_EQ(ring.capacity(), 4U);
+}
+
+TEST(RingBufferTest, Copy) {
+  RingBuffer<int, 2> ring;
+  for (int i = 1; i <= 5; i++) {
+    ring.push_back(i);
+  }
+  RingBuffer<int, 2> copy(ring);
+  ring.pop_front();
+  ASSERT_THAT(vector<int>(copy.begin(), copy.end()), ElementsAre(1, 2, 3, 4, 5));
+  copy = ring;
+  ASSERT_THAT(vector<int>(copy.begin(), copy.end()), ElementsAre(2, 3, 4, 5));
+}
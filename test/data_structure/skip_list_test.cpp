@@ -0,0 +1,116 @@
+#include "data_structure/skip_list.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace slog;
+
+TEST(ConcurrentSkipListTest, SerialBasicOperations) {
+  ConcurrentSkipList<string, string> list;
+  string result;
+  ASSERT_FALSE(list.Get(result, "test"));
+  ASSERT_FALSE(list.Erase("test"));
+
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_FALSE(list.InsertOrUpdate(to_string(i), "foo"));
+  }
+  ASSERT_EQ(list.size(), 10U);
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(list.Get(result, to_string(i)));
+    ASSERT_EQ(result, "foo");
+  }
+  ASSERT_TRUE(list.InsertOrUpdate("0", "bar"));
+  ASSERT_TRUE(list.Get(result, "0"));
+  ASSERT_EQ(result, "bar");
+
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(list.Erase(to_string(i)));
+  }
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_FALSE(list.Get(result, to_string(i)));
+  }
+  ASSERT_EQ(list.size(), 0U);
+}
+
+TEST(ConcurrentSkipListTest, Scan) {
+  ConcurrentSkipList<int, int> list;
+  // Insert in a shuffled order
+  for (int i = 0; i < 1000; i++) {
+    auto key = (i * 7919) % 1000;
+    list.InsertOrUpdate(key, key * 10);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    list.Erase(i);
+  }
+
+  vector<int> keys;
+  list.Scan(100, 200, [&keys](int key, int value) {
+    ASSERT_EQ(value, key * 10);
+    keys.push_back(key);
+  });
+  vector<int> expected;
+  for (int i = 100; i < 200; i++) {
+    if (i % 3 != 0) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(keys, expected);
+
+  keys.clear();
+  list.Scan(2000, 3000, [&keys](int key, int) { keys.push_back(key); });
+  ASSERT_TRUE(keys.empty());
+}
+
+TEST(ConcurrentSkipListTest, ScansDuringWrites) {
+  int N = 20000;
+  ConcurrentSkipList<int, int> list;
+  // Even keys are never erased so scans must always see all of them in order
+  for (int i = 0; i < N; i += 2) {
+    list.InsertOrUpdate(i, i);
+  }
+
+  atomic<bool> done = false;
+  auto Writes = [&]() {
+    for (int i = 1; i < N; i += 2) {
+      list.InsertOrUpdate(i, i);
+      list.InsertOrUpdate(i - 1, i - 1);
+      if (i % 4 == 1) {
+        list.Erase(i);
+      }
+    }
+    done = true;
+  };
+
+  auto Scans = [&]() {
+    while (!done) {
+      int expected = 0;
+      int prev = -1;
+      list.Scan(0, N, [&](int key, int value) {
+        ASSERT_EQ(key, value);
+        ASSERT_GT(key, prev);
+        prev = key;
+        if (key % 2 == 0) {
+          ASSERT_EQ(key, expected);
+          expected += 2;
+        }
+      });
+      ASSERT_EQ(expected, N);
+    }
+  };
+
+  thread w(Writes);
+  thread r1(Scans);
+  thread r2(Scans);
+  w.join();
+  r1.join();
+  r2.join();
+
+  int result;
+  for (int i = 1; i < N; i += 2) {
+    ASSERT_EQ(list.Get(result, i), i % 4 != 1) << "Failed at i = " << i;
+  }
+}
@@ -0,0 +1,111 @@
+#include "data_structure/slot_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+using namespace slog;
+
+TEST(SlotPoolTest, StaleHandles) {
+  SlotPool<string> pool;
+  auto a = pool.Emplace("a");
+  auto b = pool.Emplace("b");
+  ASSERT_EQ(*pool.Get(a), "a");
+  ASSERT_EQ(*pool.Get(b), "b");
+  ASSERT_EQ(pool.size(), 2U);
+
+  pool.Erase(a);
+  ASSERT_EQ(pool.Get(a), nullptr);
+  ASSERT_EQ(pool.Find(a), pool.end());
+  // The freed slot is reused under a new generation
+  auto c = pool.Emplace("c");
+  ASSERT_EQ(c.index, a.index);
+  ASSERT_NE(c, a);
+  ASSERT_EQ(pool.Get(a), nullptr);
+  ASSERT_EQ(*pool.Get(c), "c");
+  ASSERT_EQ(pool.Get(SlotHandle{}), nullptr);
+}
+
+TEST(SlotPoolTest, PointersAreStable) {
+  SlotPool<int> pool;
+  auto first = pool.Emplace(0);
+  auto first_ptr = pool.Get(first);
+  // Spill over several chunks
+  for (int i = 1; i < 5000; i++) {
+    pool.Emplace(i);
+  }
+  ASSERT_EQ(pool.Get(first), first_ptr);
+
+  int sum = 0;
+  for (auto v : pool) {
+    sum += v;
+  }
+  ASSERT_EQ(sum, 4999 * 5000 / 2);
+}
+
+TEST(SlotMapTest, MatchesUnorderedMap) {
+  SlotMap<uint64_t, int> map;
+  unordered_map<uint64_t, int> expected;
+  mt19937 rg(0);
+  // A small key range so that the same keys are inserted and erased many times
+  uniform_int_distribution<uint64_t> key_dis(0, 2000);
+  for (int i = 0; i < 100000; i++) {
+    auto key = key_dis(rg) * 1000;
+    if (rg() % 2 == 0) {
+      auto [it, inserted] = map.try_emplace(key, i);
+      auto [expected_it, expected_inserted] = expected.try_emplace(key, i);
+      ASSERT_EQ(inserted, expected_inserted);
+      ASSERT_EQ(it->second, expected_it->second);
+      ASSERT_EQ(map.Get(it.handle()), &it->second);
+    } else {
+      ASSERT_EQ(map.erase(key), expected.erase(key));
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+  for (const auto& [key, value] : expected) {
+    auto it = map.find(key);
+    ASSERT_NE(it, map.end());
+    ASSERT_EQ(it->second, value);
+  }
+  size_t num_entries = 0;
+  for (const auto& [key, value] : map) {
+    ASSERT_EQ(expected.at(key), value);
+    num_entries++;
+  }
+  ASSERT_EQ(num_entries, expected.size());
+}
+
+TEST(SlotMapTest, EraseByIterator) {
+  SlotMap<uint64_t, string> map;
+  map.reserve(100);
+  auto handle = map.try_emplace(1, "one").first.handle();
+  map.try_emplace(2, "two");
+  map.erase(map.find(1));
+  ASSERT_EQ(map.count(1), 0U);
+  ASSERT_EQ(map.Get(handle), nullptr);
+  ASSERT_EQ(map.at(2), "two");
+  ASSERT_THROW(map.at(1), out_of_range);
+}
+
+TEST(SlotMapTest, EraseByHandle) {
+  SlotMap<uint64_t, uint64_t> map;
+  vector<SlotHandle> handles;
+  for (uint64_t i = 0; i < 1000; i++) {
+    handles.push_back(map.try_emplace(i, i).first.handle());
+  }
+  for (uint64_t i = 0; i < 1000; i += 2) {
+    map.erase(handles[i]);
+  }
+  // A stale handle is ignored
+  map.erase(handles[0]);
+  ASSERT_EQ(map.size(), 500U);
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(map.count(i), i % 2);
+    if (i % 2) {
+      ASSERT_EQ(*map.Get(handles[i]), i);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#include "data_structure/spsc_queue.h"
+
+#include <gtest/gtest.h>
+#include <poll.h>
+
+#include <thread>
+
+using namespace std;
+using namespace slog;
+
+namespace {
+bool IsSignaled(int fd) {
+  pollfd item{fd, POLLIN, 0};
+  return poll(&item, 1, 0) == 1;
+}
+
+void ResetSignal(int fd) {
+  uint64_t count;
+  ASSERT_EQ(read(fd, &count, sizeof(count)), static_cast<ssize_t>(sizeof(count)));
+}
+}  // namespace
+
+TEST(SpscQueueTest, PushAndPop) {
+  SpscQueue<int> queue(3);
+  ASSERT_EQ(queue.capacity(), 4U);
+  int e;
+  ASSERT_FALSE(queue.TryPop(e));
+  for (int i = 1; i <= 4; i++) {
+    ASSERT_TRUE(queue.TryPush(i));
+  }
+  ASSERT_FALSE(queue.TryPush(5));
+  ASSERT_TRUE(queue.TryPop(e));
+  ASSERT_EQ(e, 1);
+  // Wrap around the ring
+  ASSERT_TRUE(queue.TryPush(5));
+  for (int i = 2; i <= 5; i++) {
+    ASSERT_TRUE(queue.TryPop(e));
+    ASSERT_EQ(e, i);
+  }
+  ASSERT_FALSE(queue.TryPop(e));
+}
+
+TEST(SpscQueueTest, SignalOnlyWhenEmpty) {
+  SpscQueue<int> queue(4);
+  ASSERT_FALSE(IsSignaled(queue.fd()));
+  ASSERT_TRUE(queue.TryPush(1));
+  ASSERT_TRUE(IsSignaled(queue.fd()));
+  ResetSignal(queue.fd());
+
+  // The consumer has not caught up yet so it does not need to be woken up
+  ASSERT_TRUE(queue.TryPush(2));
+  ASSERT_FALSE(IsSignaled(queue.fd()));
+
+  int e;
+  ASSERT_TRUE(queue.TryPop(e));
+  ASSERT_TRUE(queue.TryPop(e));
+  ASSERT_TRUE(queue.TryPush(3));
+  ASSERT_TRUE(IsSignaled(queue.fd()));
+}
+
+TEST(SpscQueueTest, ConcurrentPushAndPop) {
+  const int kNumElems = 100000;
+  SpscQueue<int> queue(64);
+
+  thread producer([&queue] {
+    for (int i = 0; i < kNumElems; i++) {
+      while (!queue.TryPush(i)) {
+      }
+    }
+  });
+
+  // Sleep on the eventfd whenever the queue is empty, which hangs if a wakeup is lost
+  pollfd item{queue.fd(), POLLIN, 0};
+  for (int expected = 0; expected < kNumElems;) {
+    int e;
+    if (queue.TryPop(e)) {
+      ASSERT_EQ(e, expected);
+      expected++;
+    } else {
+      ASSERT_EQ(poll(&item, 1, 10000), 1);
+      uint64_t count;
+      [[maybe_unused]] auto n = read(queue.fd(), &count, sizeof(count));
+    }
+  }
+
+  producer.join();
+}
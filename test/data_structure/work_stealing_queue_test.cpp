@@ -0,0 +1,72 @@
+#include "data_structure/work_stealing_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace slog;
+
+TEST(WorkStealingQueueTest, PushAndPop) {
+  WorkStealingQueue<int> queue;
+  int e;
+  ASSERT_FALSE(queue.TryPop(e));
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+  ASSERT_EQ(queue.size(), 3U);
+  for (int i = 1; i <= 3; i++) {
+    ASSERT_TRUE(queue.TryPop(e));
+    ASSERT_EQ(e, i);
+  }
+  ASSERT_FALSE(queue.TryPop(e));
+  ASSERT_EQ(queue.size(), 0U);
+}
+
+TEST(WorkStealingQueueTest, ConcurrentSteal) {
+  const int kNumElems = 100000;
+  const int kNumThieves = 3;
+  WorkStealingQueue<int> queue;
+  atomic<bool> done = false;
+
+  // Every element must be popped exactly once, by the owner or by one of the thieves
+  vector<vector<int>> popped(kNumThieves + 1);
+  vector<thread> thieves;
+  for (int i = 0; i < kNumThieves; i++) {
+    thieves.emplace_back([&queue, &done, &popped = popped[i]] {
+      int e;
+      while (!done.load() || queue.size() > 0) {
+        if (queue.TryPop(e)) {
+          popped.push_back(e);
+        }
+      }
+    });
+  }
+
+  int e;
+  for (int i = 0; i < kNumElems; i++) {
+    queue.Push(i);
+    if (i % 2 == 0 && queue.TryPop(e)) {
+      popped[kNumThieves].push_back(e);
+    }
+  }
+  done = true;
+  for (auto& t : thieves) {
+    t.join();
+  }
+
+  vector<int> count(kNumElems, 0);
+  for (const auto& elems : popped) {
+    // Each thread sees the elements in the order that they were pushed
+    ASSERT_TRUE(is_sorted(elems.begin(), elems.end()));
+    for (auto elem : elems) {
+      count[elem]++;
+    }
+  }
+  for (int i = 0; i < kNumElems; i++) {
+    ASSERT_EQ(count[i], 1) << "Element " << i;
+  }
+}
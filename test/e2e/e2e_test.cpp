@@ -225,6 +225,50 @@ TEST_F(E2ETestBypassMHOrderer, MultiHomeMultiPartitionTxn) {
   }
 }
 
+class E2ETestVersionedStorage : public E2ETest {
+  internal::Configuration CustomConfig() final {
+    internal::Configuration config;
+    config.set_storage_type(internal::StorageType::VERSIONED);
+    return config;
+  }
+};
+
+TEST_F(E2ETestVersionedStorage, ReadOnlyTxnOnSnapshot) {
+  auto write_txn = MakeTransaction({{"A", KeyType::WRITE}}, {{"SET", "A", "newA"}});
+  test_slogs[0]->SendTxn(write_txn);
+  ASSERT_EQ(test_slogs[0]->RecvTxnResult().status(), TransactionStatus::COMMITTED);
+
+  // The write only becomes visible to snapshots once the scheduler learns that it has been
+  // applied, which may happen after its response is sent
+  string value;
+  for (int i = 0; i < 100 && value != "newA"; i++) {
+    auto read_txn = MakeTransaction({{"A", KeyType::READ}, {"C", KeyType::READ}});
+    test_slogs[0]->SendTxn(read_txn);
+    auto read_resp = test_slogs[0]->RecvTxnResult();
+    ASSERT_EQ(read_resp.status(), TransactionStatus::COMMITTED);
+    // The txn is served without going through the log
+    ASSERT_EQ(read_resp.internal().global_log_positions_size(), 0);
+    ASSERT_EQ(TxnValueEntry(read_resp, "C").value(), "valC");
+    value = TxnValueEntry(read_resp, "A").value();
+    ASSERT_TRUE(value == "valA" || value == "newA") << value;
+    if (value != "newA") {
+      this_thread::sleep_for(10ms);
+    }
+  }
+  ASSERT_EQ(value, "newA");
+}
+
+TEST_F(E2ETestVersionedStorage, MultiPartitionReadOnlyTxn) {
+  // Keys of other partitions cannot be read from the local snapshot so the txn goes through the log
+  auto txn = MakeTransaction({{"A", KeyType::READ}, {"X", KeyType::READ}});
+  test_slogs[0]->SendTxn(txn);
+  auto txn_resp = test_slogs[0]->RecvTxnResult();
+  ASSERT_EQ(txn_resp.status(), TransactionStatus::COMMITTED);
+  ASSERT_GT(txn_resp.internal().global_log_positions_size(), 0);
+  ASSERT_EQ(TxnValueEntry(txn_resp, "A").value(), "valA");
+  ASSERT_EQ(TxnValueEntry(txn_resp, "X").value(), "valX");
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   google::InstallFailureSignalHandler();
@@ -7,6 +7,7 @@
 #include "common/proto_utils.h"
 #include "execution/tpcc/metadata_initializer.h"
 #include "storage/mem_only_storage.h"
+#include "storage/ordered_storage.h"
 
 using namespace std;
 using namespace slog;
@@ -264,4 +265,92 @@ TEST_F(GroupedTableTest, Delete) {
     ASSERT_TRUE(ScalarListsEqual(res, data[i]));
   }
   ASSERT_TRUE(txn_table->Select({data[0].begin(), data[0].begin() + ItemSchema::kPKeySize}).empty());
-}
\ No newline at end of file
+}
+TEST_F(GroupedTableTest, Scan) {
+  auto rows = txn_table->Scan({data[0][0]}, 0, 5000);
+  ASSERT_EQ(rows.size(), 1U);
+  ASSERT_TRUE(ScalarListsEqual(rows[0], data[0]));
+
+  rows = txn_table->Scan({data[1][0]}, 2000, 2001, {ItemSchema::Column::ID, ItemSchema::Column::PRICE});
+  ASSERT_EQ(rows.size(), 1U);
+  ASSERT_TRUE(ScalarListsEqual(rows[0], {data[1][1], data[1][4]}));
+
+  ASSERT_TRUE(txn_table->Scan({data[1][0]}, 0, 2000).empty());
+}
+
+// The parameter tells whether the storage supports range scans
+class ScanTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() {
+    if (GetParam()) {
+      storage = std::make_shared<OrderedStorage>();
+    } else {
+      storage = std::make_shared<MemOnlyStorage>();
+    }
+    auto metadata_initializer = std::make_shared<TPCCMetadataInitializer>(2, 1);
+    auto storage_adapter = std::make_shared<KVStorageAdapter>(storage, metadata_initializer);
+    table = std::make_unique<Table<ItemSchema>>(storage_adapter);
+    for (int w_id = 1; w_id <= 2; w_id++) {
+      for (int id = 1; id <= 5; id++) {
+        table->Insert({MakeInt32Scalar(w_id), MakeInt32Scalar(id), MakeInt32Scalar(id * 10),
+                       MakeFixedTextScalar<24>("name--------------------"), MakeInt32Scalar(id * 100),
+                       MakeFixedTextScalar<50>("data----------------------------------------------")});
+      }
+    }
+  }
+
+  std::shared_ptr<Storage> storage;
+  std::unique_ptr<Table<ItemSchema>> table;
+};
+
+TEST_P(ScanTest, ScanStorage) {
+  auto rows = table->Scan({MakeInt32Scalar(2)}, 2, 5, {ItemSchema::Column::W_ID, ItemSchema::Column::ID,
+                                                       ItemSchema::Column::PRICE});
+  ASSERT_EQ(rows.size(), 3U);
+  for (int i = 0; i < 3; i++) {
+    auto id = i + 2;
+    ASSERT_TRUE(ScalarListsEqual(rows[i], {MakeInt32Scalar(2), MakeInt32Scalar(id), MakeInt32Scalar(id * 100)}));
+  }
+  ASSERT_TRUE(table->Scan({MakeInt32Scalar(3)}, 0, 10).empty());
+}
+
+TEST_P(ScanTest, DeclareKeys) {
+  Transaction txn;
+  auto keygen_adapter = std::make_shared<TxnKeyGenStorageAdapter>(txn);
+  Table<ItemSchema> keygen_table(keygen_adapter);
+  ASSERT_TRUE(keygen_table.Scan({MakeInt32Scalar(1)}, 0, 8).empty());
+  keygen_adapter->Finialize();
+  // All keys in the range are declared, including those that do not exist
+  ASSERT_EQ(txn.keys_size(), 8);
+  for (const auto& kv : txn.keys()) {
+    ASSERT_EQ(kv.value_entry().type(), KeyType::READ);
+  }
+}
+
+TEST_P(ScanTest, ScanTxn) {
+  Transaction txn;
+  // Id 1 and 5 exist but are not declared. Id 7 is declared but does not exist
+  for (int id : {2, 3, 4, 7}) {
+    auto key = Table<ItemSchema>::MakeStorageKey({MakeInt32Scalar(2), MakeInt32Scalar(id)});
+    auto entry = txn.mutable_keys()->Add();
+    entry->set_key(key);
+    entry->mutable_value_entry()->set_type(KeyType::READ);
+    storage->ReadView(key, [entry](std::string_view value, const Metadata&) {
+      entry->mutable_value_entry()->set_value(value.data(), value.size());
+    });
+  }
+  auto txn_adapter = std::make_shared<TxnStorageAdapter>(txn);
+  Table<ItemSchema> txn_table(txn_adapter);
+
+  auto rows = txn_table.Scan({MakeInt32Scalar(2)}, 1, 8, {ItemSchema::Column::ID, ItemSchema::Column::PRICE});
+  ASSERT_EQ(rows.size(), 3U);
+  for (int i = 0; i < 3; i++) {
+    auto id = i + 2;
+    ASSERT_TRUE(ScalarListsEqual(rows[i], {MakeInt32Scalar(id), MakeInt32Scalar(id * 100)}));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllStorages, ScanTest, testing::Values(false, true),
+                         [](const testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Ordered" : "MemOnly";
+                         });
@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include <deque>
 #include <vector>
 
 #include "common/proto_utils.h"
@@ -143,19 +144,29 @@ class InterleaverTest : public ::testing::Test {
     senders_[from]->Send(std::move(copied), to, kLocalLogChannel);
   }
 
+  // Txns of a batch arrive together, so the ones that are not returned yet are kept here
   Transaction* ReceiveTxn(int i) {
-    auto req_env = slogs_[i]->ReceiveFromOutputSocket(kSchedulerChannel);
-    if (req_env == nullptr) {
-      return nullptr;
+    if (received_txns_[i].empty()) {
+      auto req_env = slogs_[i]->ReceiveFromOutputSocket(kSchedulerChannel);
+      if (req_env == nullptr) {
+        return nullptr;
+      }
+      if (req_env->request().type_case() != internal::Request::kForwardTxns) {
+        return nullptr;
+      }
+      auto txns = req_env->mutable_request()->mutable_forward_txns()->mutable_txns();
+      while (!txns->empty()) {
+        received_txns_[i].push_front(txns->ReleaseLast());
+      }
     }
-    if (req_env->request().type_case() != internal::Request::kForwardTxn) {
-      return nullptr;
-    }
-    return req_env->mutable_request()->mutable_forward_txn()->release_txn();
+    auto txn = received_txns_[i].front();
+    received_txns_[i].pop_front();
+    return txn;
   }
 
   unique_ptr<Sender> senders_[4];
   unique_ptr<TestSlog> slogs_[4];
+  deque<Transaction*> received_txns_[4];
 };
 
 internal::Batch* MakeBatch(BatchId batch_id, const vector<Transaction*>& txns, TransactionType batch_type) {
@@ -202,4 +202,106 @@ TEST_F(DDRLockManagerTest, LongChain) {
   ASSERT_THAT(result, ElementsAre(500));
 
   ASSERT_TRUE(lock_manager.ReleaseLocks(holder5.txn_id()).empty());
-}
\ No newline at end of file
+}
+
+TEST_F(DDRLockManagerTest, AcquireLocksBatch) {
+  auto configs = MakeTestConfigurations("locking", 2, 1);
+  auto holder1 = MakeTestTxnHolder(configs[0], 100, {{"A", KeyType::WRITE, 0}, {"B", KeyType::READ, 0}});
+  auto holder2 = MakeTestTxnHolder(configs[0], 200, {{"A", KeyType::READ, 1}, {"B", KeyType::WRITE, 0}});
+  auto holder3 = MakeTestTxnHolder(configs[0], 300, {{"B", KeyType::READ, 0}});
+  auto holder4 = MakeTestTxnHolder(configs[0], 400, {{"C", KeyType::WRITE, 0}});
+
+  auto result = lock_manager.AcquireLocksBatch({&holder1.lock_only_txn(0), &holder2.lock_only_txn(0),
+                                                 &holder2.lock_only_txn(1), &holder3.lock_only_txn(0),
+                                                 &holder4.lock_only_txn(0)});
+  ASSERT_THAT(result, ElementsAre(100, 400));
+
+  result = lock_manager.ReleaseLocks(holder1.txn_id());
+  ASSERT_THAT(result, ElementsAre(200));
+  result = lock_manager.ReleaseLocks(holder2.txn_id());
+  ASSERT_THAT(result, ElementsAre(300));
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder3.txn_id()).empty());
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder4.txn_id()).empty());
+}
+
+TEST_F(DDRLockManagerTest, LockShards) {
+  // Find a key in each shard
+  Key key0 = "A", key1 = "A";
+  while (LockShard::Of(key0, 2) != 0) key0[0]++;
+  while (LockShard::Of(key1, 2) != 1) key1[0]++;
+
+  DDRLockManager lock_manager0(LockShard(2, 0));
+  DDRLockManager lock_manager1(LockShard(2, 1));
+  auto configs = MakeTestConfigurations("locking", 2, 1);
+  auto holder1 = MakeTestTxnHolder(configs[0], 100, {{key0, KeyType::WRITE, 0}, {key1, KeyType::WRITE, 0}});
+  auto holder2 = MakeTestTxnHolder(configs[0], 200, {{key0, KeyType::READ, 0}});
+  auto holder3 = MakeTestTxnHolder(configs[0], 300, {{key1, KeyType::READ, 0}});
+  auto holder4 = MakeTestTxnHolder(configs[0], 400, {{key0, KeyType::READ, 0}, {key1, KeyType::READ, 1}});
+
+  // Each shard finds each txn ready once, counting the locks of the other shard as acquired
+  ASSERT_EQ(lock_manager0.AcquireLocks(holder1.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager0.AcquireLocks(holder2.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_manager0.AcquireLocks(holder3.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager0.AcquireLocks(holder4.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_manager0.AcquireLocks(holder4.lock_only_txn(1)), AcquireLocksResult::WAITING);
+
+  ASSERT_EQ(lock_manager1.AcquireLocks(holder1.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager1.AcquireLocks(holder2.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager1.AcquireLocks(holder3.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_manager1.AcquireLocks(holder4.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_manager1.AcquireLocks(holder4.lock_only_txn(1)), AcquireLocksResult::ACQUIRED);
+
+  ASSERT_THAT(lock_manager0.ReleaseLocks(holder1.txn_id()), UnorderedElementsAre(200, 400));
+  ASSERT_THAT(lock_manager1.ReleaseLocks(holder1.txn_id()), ElementsAre(300));
+}
+
+TEST(DDRLockManagerGCTest, CollectGarbage) {
+  DDRLockManager lock_manager({}, 0);
+  auto configs = MakeTestConfigurations("locking", 1, 1);
+  auto holder1 = MakeTestTxnHolder(configs[0], 100, {{"A", KeyType::WRITE, 0}, {"B", KeyType::READ, 0}});
+  auto holder2 = MakeTestTxnHolder(configs[0], 200, {{"A", KeyType::READ, 0}});
+  auto lock_table_size = [&lock_manager] {
+    rapidjson::Document stats;
+    stats.SetObject();
+    lock_manager.GetStats(stats, 0);
+    return stats[LOCK_TABLE_SIZE].GetUint64();
+  };
+
+  ASSERT_EQ(lock_manager.AcquireLocks(holder1.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager.AcquireLocks(holder2.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_manager.CollectGarbage(10), 0U);
+  ASSERT_THAT(lock_manager.ReleaseLocks(holder1.txn_id()), ElementsAre(200));
+  // A is still locked by holder2
+  ASSERT_EQ(lock_manager.CollectGarbage(10), 1U);
+  ASSERT_EQ(lock_table_size(), 1U);
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder2.txn_id()).empty());
+  ASSERT_EQ(lock_manager.CollectGarbage(10), 1U);
+  ASSERT_EQ(lock_table_size(), 0U);
+
+  // The collected keys can be locked again
+  ASSERT_EQ(lock_manager.AcquireLocks(holder2.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_EQ(lock_manager.AcquireLocks(holder1.lock_only_txn(0)), AcquireLocksResult::WAITING);
+  ASSERT_EQ(lock_table_size(), 2U);
+}
+
+TEST(DDRLockManagerGCTest, CollectGarbageAboveLimit) {
+  DDRLockManager lock_manager({}, 1);
+  auto configs = MakeTestConfigurations("locking", 1, 1);
+  auto holder =
+      MakeTestTxnHolder(configs[0], 100, {{"A", KeyType::WRITE, 0}, {"B", KeyType::READ, 0}, {"C", KeyType::READ, 0}});
+  auto lock_table_size = [&lock_manager] {
+    rapidjson::Document stats;
+    stats.SetObject();
+    lock_manager.GetStats(stats, 0);
+    return stats[LOCK_TABLE_SIZE].GetUint64();
+  };
+
+  ASSERT_EQ(lock_manager.AcquireLocks(holder.lock_only_txn(0)), AcquireLocksResult::ACQUIRED);
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder.txn_id()).empty());
+  // As many entries as were added since the last call are checked even if max_entries is lower,
+  // but the last idle entry is kept
+  ASSERT_EQ(lock_manager.CollectGarbage(1), 2U);
+  ASSERT_EQ(lock_table_size(), 1U);
+  ASSERT_EQ(lock_manager.CollectGarbage(10), 0U);
+  ASSERT_EQ(lock_table_size(), 1U);
+}
@@ -0,0 +1,60 @@
+#include "module/scheduler_components/key_interner.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace slog;
+
+TEST(KeyInternerTest, SameTupleSameId) {
+  KeyInterner interner;
+  auto id = interner.Intern("A", 1);
+  ASSERT_EQ(interner.Intern("A", 1), id);
+  ASSERT_EQ(interner.key(id), "A");
+  ASSERT_EQ(interner.master(id), 1U);
+  ASSERT_EQ(interner.ToKeyReplica(id), MakeKeyReplica("A", 1));
+}
+
+TEST(KeyInternerTest, DifferentTuplesDifferentIds) {
+  KeyInterner interner;
+  auto a0 = interner.Intern("A", 0);
+  auto a1 = interner.Intern("A", 1);
+  auto b0 = interner.Intern("B", 0);
+  ASSERT_NE(a0, a1);
+  ASSERT_NE(a0, b0);
+  ASSERT_NE(a1, b0);
+  // The masters of a key share its index
+  ASSERT_EQ(interner.size(), 2U);
+  ASSERT_EQ(interner.key(a1), "A");
+  ASSERT_EQ(interner.key(b0), "B");
+}
+
+TEST(KeyInternerTest, ManyKeys) {
+  KeyInterner interner;
+  vector<KeyId> ids;
+  for (int i = 0; i < 10000; i++) {
+    ids.push_back(interner.Intern(to_string(i), i % 3));
+  }
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_EQ(interner.Intern(to_string(i), i % 3), ids[i]);
+    ASSERT_EQ(interner.key(ids[i]), to_string(i));
+    ASSERT_EQ(interner.master(ids[i]), static_cast<uint32_t>(i % 3));
+  }
+}
+
+TEST(KeyInternerTest, ReuseIndexOfReleasedKey) {
+  KeyInterner interner;
+  auto a0 = interner.Intern("A", 0);
+  auto a1 = interner.Intern("A", 1);
+  interner.Retain(a0);
+  interner.Retain(a1);
+  interner.Release(a0);
+  // The key is still retained through its other id
+  ASSERT_EQ(interner.Intern("A", 0), a0);
+  interner.Release(a1);
+  ASSERT_EQ(interner.size(), 0U);
+
+  auto b0 = interner.Intern("B", 0);
+  ASSERT_EQ(b0, a0);
+  ASSERT_EQ(interner.key(b0), "B");
+  ASSERT_NE(interner.Intern("A", 0), a0);
+}
@@ -119,3 +119,24 @@ TEST(OldLockManager, AcquireLocksWithLockOnlyholder2) {
   auto ready_txns = lock_manager.ReleaseLocks(holder1.txn_id());
   ASSERT_THAT(ready_txns, ElementsAre(200));
 }
+
+TEST(OldLockManager, AcquireLocksBatch) {
+  OldLockManager lock_manager;
+  auto configs = MakeTestConfigurations("locking", 2, 1);
+  auto holder1 = MakeTestTxnHolder(configs[0], 100, {{"A", KeyType::WRITE, 0}, {"B", KeyType::READ, 0}});
+  auto holder2 = MakeTestTxnHolder(configs[0], 200, {{"A", KeyType::READ, 1}, {"B", KeyType::WRITE, 0}});
+  auto holder3 = MakeTestTxnHolder(configs[0], 300, {{"B", KeyType::READ, 0}});
+  auto holder4 = MakeTestTxnHolder(configs[0], 400, {{"C", KeyType::WRITE, 0}});
+
+  auto result = lock_manager.AcquireLocksBatch({&holder1.lock_only_txn(0), &holder2.lock_only_txn(0),
+                                                 &holder2.lock_only_txn(1), &holder3.lock_only_txn(0),
+                                                 &holder4.lock_only_txn(0)});
+  ASSERT_THAT(result, ElementsAre(100, 400));
+
+  result = lock_manager.ReleaseLocks(holder1.txn_id());
+  ASSERT_THAT(result, ElementsAre(200));
+  result = lock_manager.ReleaseLocks(holder2.txn_id());
+  ASSERT_THAT(result, ElementsAre(300));
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder3.txn_id()).empty());
+  ASSERT_TRUE(lock_manager.ReleaseLocks(holder4.txn_id()).empty());
+}
@@ -0,0 +1,91 @@
+#include "module/scheduler_components/worker_dispatcher.h"
+
+#include <gtest/gtest.h>
+
+#include "common/proto_utils.h"
+#include "test/test_utils.h"
+
+using namespace std;
+using namespace slog;
+
+namespace {
+ConfigurationPtr MakeDispatchConfiguration(internal::DispatchPolicy policy) {
+  internal::Configuration common_config;
+  common_config.set_dispatch_policy(policy);
+  return MakeTestConfigurations("dispatch", 1, 1, common_config)[0];
+}
+
+size_t SelectAndDispatch(WorkerDispatcher& dispatcher, const vector<KeyMetadata>& keys) {
+  unique_ptr<Transaction> txn(MakeTransaction(keys));
+  auto worker = dispatcher.Select(*txn);
+  dispatcher.OnDispatched(worker);
+  return worker;
+}
+}  // namespace
+
+TEST(WorkerDispatcherTest, RoundRobin) {
+  WorkerDispatcher dispatcher(MakeDispatchConfiguration(internal::DispatchPolicy::ROUND_ROBIN), 3);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), 0U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), 1U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), 2U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), 0U);
+  ASSERT_EQ(dispatcher.num_inflight(0), 2U);
+}
+
+TEST(WorkerDispatcherTest, KeyHash) {
+  WorkerDispatcher dispatcher(MakeDispatchConfiguration(internal::DispatchPolicy::KEY_HASH), 4);
+  auto worker = SelectAndDispatch(dispatcher, {{"B", KeyType::WRITE, 0}});
+  // The written key decides the worker
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::READ, 0}, {"B", KeyType::WRITE, 0}}), worker);
+  // The first key decides the worker of a read-only txn
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"B", KeyType::READ, 0}, {"C", KeyType::READ, 0}}), worker);
+  ASSERT_EQ(dispatcher.num_inflight(worker), 3U);
+  ASSERT_EQ(dispatcher.num_rebalanced(), 0U);
+}
+
+TEST(WorkerDispatcherTest, FallBackToLeastLoadedWorker) {
+  WorkerDispatcher dispatcher(MakeDispatchConfiguration(internal::DispatchPolicy::KEY_HASH), 2);
+  size_t worker = 0;
+  for (uint32_t i = 0; i < kDispatchImbalanceThreshold; i++) {
+    worker = SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}});
+  }
+  ASSERT_EQ(dispatcher.num_inflight(worker), kDispatchImbalanceThreshold);
+
+  auto other_worker = 1 - worker;
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), other_worker);
+  ASSERT_EQ(dispatcher.num_rebalanced(), 1U);
+
+  // Back to the worker of the key once it catches up
+  dispatcher.OnFinished(worker);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"A", KeyType::WRITE, 0}}), worker);
+  ASSERT_EQ(dispatcher.num_rebalanced(), 1U);
+}
+
+TEST(WorkerDispatcherTest, KeyRange) {
+  internal::Configuration config_proto;
+  config_proto.set_protocol("ipc");
+  config_proto.add_broker_ports(0);
+  config_proto.set_server_port(5000);
+  config_proto.set_sequencer_port(5001);
+  config_proto.set_forwarder_port(5002);
+  config_proto.set_num_partitions(2);
+  config_proto.mutable_simple_partitioning()->set_num_records(100);
+  config_proto.add_replicas()->add_addresses("/tmp/test_dispatch_range0");
+  config_proto.mutable_replicas(0)->add_addresses("/tmp/test_dispatch_range1");
+  config_proto.set_dispatch_policy(internal::DispatchPolicy::KEY_RANGE);
+  auto config = make_shared<Configuration>(config_proto, "/tmp/test_dispatch_range0");
+
+  // Partition 0 has the 50 even keys, 25 for each worker
+  WorkerDispatcher dispatcher(config, 2);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"0", KeyType::WRITE, 0}}), 0U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"48", KeyType::WRITE, 0}}), 0U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"50", KeyType::WRITE, 0}}), 1U);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"98", KeyType::READ, 0}}), 1U);
+  // Keys of other partitions are ignored
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"1", KeyType::WRITE, 0}, {"60", KeyType::READ, 0}}), 1U);
+
+  // A key that is not a number is dispatched by hash
+  WorkerDispatcher hash_dispatcher(MakeDispatchConfiguration(internal::DispatchPolicy::KEY_HASH), 2);
+  ASSERT_EQ(SelectAndDispatch(dispatcher, {{"98x", KeyType::WRITE, 0}}),
+            SelectAndDispatch(hash_dispatcher, {{"98x", KeyType::WRITE, 0}}));
+}
@@ -0,0 +1,48 @@
+#include "module/scheduler_components/worker.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "test/test_utils.h"
+
+using namespace std;
+using namespace slog;
+
+namespace {
+// Does what the poller of a worker does when the eventfd wakes it up
+bool ConsumeSignal(int fd) {
+  uint64_t count;
+  return read(fd, &count, sizeof(count)) == sizeof(count);
+}
+}  // namespace
+
+TEST(WorkStealingGroupTest, SignalsAgainWhileTxnsAreLeft) {
+  auto config = MakeTestConfigurations("stealing", 1, 1)[0];
+  auto txn1 = MakeTestTxnHolder(config, 1000, {{"A", KeyType::WRITE, 0}}, {{"SLEEP", "1000"}});
+  auto txn2 = MakeTestTxnHolder(config, 2000, {{"B", KeyType::WRITE, 0}});
+
+  vector<shared_ptr<WorkerQueues>> queues{make_shared<WorkerQueues>(), make_shared<WorkerQueues>()};
+  WorkStealingGroup group(queues);
+
+  // Both txns are dispatched to worker 0 before any worker wakes up, so only one signal is sent
+  queues[0]->ready_txns.Push(&txn1);
+  group.Signal();
+  queues[0]->ready_txns.Push(&txn2);
+  group.Signal();
+
+  // Worker 0 wakes up and starts the sleeping txn, so it will not look for txns for a while
+  ASSERT_TRUE(ConsumeSignal(group.fd()));
+  TxnHolder* txn_holder;
+  ASSERT_TRUE(group.TryPop(0, txn_holder));
+  ASSERT_EQ(txn_holder, &txn1);
+
+  // Worker 1 must still be woken up to steal the other txn
+  ASSERT_TRUE(ConsumeSignal(group.fd()));
+  ASSERT_TRUE(group.TryPop(1, txn_holder));
+  ASSERT_EQ(txn_holder, &txn2);
+  ASSERT_EQ(group.num_stolen(), 1U);
+
+  // Nothing is left to wake up for
+  ASSERT_FALSE(ConsumeSignal(group.fd()));
+  ASSERT_FALSE(group.TryPop(1, txn_holder));
+}
@@ -15,7 +15,7 @@ class SchedulerTest : public ::testing::Test {
   static const uint32_t kNumPartitions = 3;
 
   void SetUp() {
-    ConfigVec configs = MakeTestConfigurations("scheduler", kNumReplicas, kNumPartitions);
+    ConfigVec configs = MakeTestConfigurations("scheduler", kNumReplicas, kNumPartitions, common_config_);
 
     for (size_t i = 0; i < kNumMachines; i++) {
       test_slogs[i] = make_unique<TestSlog>(configs[i]);
@@ -69,6 +69,23 @@ class SchedulerTest : public ::testing::Test {
     }
   }
 
+  // Sends the txns in a single message to each partition, like the interleaver does with a batch
+  void SendTransactions(const vector<Transaction*>& txns) {
+    auto sharder = Sharder::MakeSharder(test_slogs[0]->config());
+    for (uint32_t p = 0; p < kNumPartitions; p++) {
+      internal::Envelope env;
+      for (auto txn : txns) {
+        auto new_txn = GeneratePartitionedTxn(sharder, txn, p);
+        if (new_txn != nullptr) {
+          env.mutable_request()->mutable_forward_txns()->mutable_txns()->AddAllocated(new_txn);
+        }
+      }
+      if (env.request().forward_txns().txns_size() > 0) {
+        sender[0]->Send(env, p, kSchedulerChannel);
+      }
+    }
+  }
+
   Transaction ReceiveMultipleAndMerge(uint32_t receiver, uint32_t num_partitions) {
     Transaction txn;
     bool first_time = true;
@@ -93,6 +110,7 @@ class SchedulerTest : public ::testing::Test {
 
   MachineId MakeMachineId(int replica, int partition) { return replica * kNumPartitions + partition; }
 
+  internal::Configuration common_config_;
   unique_ptr<TestSlog> test_slogs[kNumMachines];
   unique_ptr<Sender> sender[kNumMachines];
 };
@@ -235,6 +253,25 @@ TEST_F(SchedulerTest, SimpleMultiHomeBatch) {
   ASSERT_EQ(TxnValueEntry(output_txn, "Z").new_value(), "newZ");
 }
 
+TEST_F(SchedulerTest, BatchOfConflictingTransactions) {
+  auto txn1 = MakeTestTransaction(test_slogs[0]->config(), 1000, {{"D", KeyType::WRITE, {{0, 1}}}},
+                                  {{"SET", "D", "newD"}});
+  auto txn2 = MakeTestTransaction(test_slogs[0]->config(), 2000, {{"D", KeyType::READ, {{0, 1}}}}, {{"GET", "D"}});
+
+  SendTransactions({txn1, txn2});
+  delete txn1;
+  delete txn2;
+
+  // The txns hold conflicting locks so they run in the order of the batch
+  auto output_txn1 = ReceiveMultipleAndMerge(0, 1);
+  ASSERT_EQ(output_txn1.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn1, "D").new_value(), "newD");
+
+  auto output_txn2 = ReceiveMultipleAndMerge(0, 1);
+  ASSERT_EQ(output_txn2.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn2, "D").value(), "newD");
+}
+
 TEST_F(SchedulerTest, SinglePartitionTransactionValidateMasters) {
   auto txn = MakeTestTransaction(test_slogs[0]->config(), 1000,
                                  {{"A", KeyType::READ, {{0, 1}}}, {"D", KeyType::WRITE, {{0, 1}}}},
@@ -387,6 +424,117 @@ TEST_F(SchedulerTest, AbortMultiHomeMultiPartition2Active) {
   ASSERT_EQ(output_txn.status(), TransactionStatus::ABORTED);
 }
 
+class SchedulerWithLockManagerShardsTest : public SchedulerTest {
+ protected:
+  SchedulerWithLockManagerShardsTest() { common_config_.set_num_lock_manager_shards(3); }
+};
+
+TEST_F(SchedulerWithLockManagerShardsTest, MultiHomeMultiPartitionTransaction) {
+  auto txn = MakeTestTransaction(test_slogs[0]->config(), 1000,
+                                 {{"A", KeyType::READ, {{0, 1}}},
+                                  {"D", KeyType::WRITE, {{0, 1}}},
+                                  {"X", KeyType::READ, {{1, 1}}},
+                                  {"Y", KeyType::WRITE, {{1, 1}}}},
+                                 {{"GET", "A"}, {"SET", "D", "newD"}, {"GET", "X"}, {"SET", "Y", "newY"}});
+
+  auto lo_txn_0 = GenerateLockOnlyTxn(txn, 0);
+  auto lo_txn_1 = GenerateLockOnlyTxn(txn, 1);
+
+  delete txn;
+
+  SendTransaction(lo_txn_0);
+  SendTransaction(lo_txn_1);
+
+  auto output_txn = ReceiveMultipleAndMerge(0, 2);
+  ASSERT_EQ(output_txn.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn, "A").value(), "valueA");
+  ASSERT_EQ(TxnValueEntry(output_txn, "D").new_value(), "newD");
+  ASSERT_EQ(TxnValueEntry(output_txn, "X").value(), "valueX");
+  ASSERT_EQ(TxnValueEntry(output_txn, "Y").new_value(), "newY");
+}
+
+TEST_F(SchedulerWithLockManagerShardsTest, BatchOfConflictingTransactions) {
+  auto txn1 = MakeTestTransaction(test_slogs[0]->config(), 1000,
+                                  {{"A", KeyType::WRITE, {{0, 1}}}, {"D", KeyType::WRITE, {{0, 1}}}},
+                                  {{"SET", "A", "newA"}, {"SET", "D", "newD"}});
+  auto txn2 = MakeTestTransaction(test_slogs[0]->config(), 2000,
+                                  {{"A", KeyType::READ, {{0, 1}}}, {"D", KeyType::READ, {{0, 1}}}},
+                                  {{"GET", "A"}, {"GET", "D"}});
+
+  SendTransactions({txn1, txn2});
+  delete txn1;
+  delete txn2;
+
+  // txn2 is only dispatched once every shard has released the locks of txn1
+  auto output_txn1 = ReceiveMultipleAndMerge(0, 1);
+  ASSERT_EQ(output_txn1.status(), TransactionStatus::COMMITTED);
+
+  auto output_txn2 = ReceiveMultipleAndMerge(0, 1);
+  ASSERT_EQ(output_txn2.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn2, "A").value(), "newA");
+  ASSERT_EQ(TxnValueEntry(output_txn2, "D").value(), "newD");
+}
+
+class SchedulerWithWorkStealingTest : public SchedulerTest {
+ protected:
+  SchedulerWithWorkStealingTest() { common_config_.set_work_stealing(true); }
+};
+
+// The remote reads must reach the worker that runs the txn, whichever worker it was stolen by
+TEST_F(SchedulerWithWorkStealingTest, MultiHomeMultiPartitionTransaction) {
+  auto txn = MakeTestTransaction(test_slogs[0]->config(), 1000,
+                                 {{"A", KeyType::READ, {{0, 1}}},
+                                  {"D", KeyType::WRITE, {{0, 1}}},
+                                  {"X", KeyType::READ, {{1, 1}}},
+                                  {"Y", KeyType::WRITE, {{1, 1}}}},
+                                 {{"GET", "A"}, {"SET", "D", "newD"}, {"GET", "X"}, {"SET", "Y", "newY"}});
+
+  auto lo_txn_0 = GenerateLockOnlyTxn(txn, 0);
+  auto lo_txn_1 = GenerateLockOnlyTxn(txn, 1);
+
+  delete txn;
+
+  SendTransaction(lo_txn_0);
+  SendTransaction(lo_txn_1);
+
+  auto output_txn = ReceiveMultipleAndMerge(0, 2);
+  ASSERT_EQ(output_txn.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn, "A").value(), "valueA");
+  ASSERT_EQ(TxnValueEntry(output_txn, "D").new_value(), "newD");
+  ASSERT_EQ(TxnValueEntry(output_txn, "X").value(), "valueX");
+  ASSERT_EQ(TxnValueEntry(output_txn, "Y").new_value(), "newY");
+}
+
+class SchedulerWithBatchedRemoteReadsTest : public SchedulerTest {
+ protected:
+  SchedulerWithBatchedRemoteReadsTest() { common_config_.set_batch_remote_reads(true); }
+};
+
+// Each partition may send the remote reads of both txns in one message, which the broker
+// on the other side has to split between the workers of the txns
+TEST_F(SchedulerWithBatchedRemoteReadsTest, BatchOfMultiPartitionTransactions) {
+  auto txn1 = MakeTestTransaction(test_slogs[0]->config(), 1000,
+                                  {{"B", KeyType::WRITE, {{0, 1}}}, {"C", KeyType::WRITE, {{0, 1}}}},
+                                  {{"COPY", "C", "B"}, {"COPY", "B", "C"}}, {}, MakeMachineId(0, 1));
+  auto txn2 = MakeTestTransaction(test_slogs[0]->config(), 2000,
+                                  {{"E", KeyType::WRITE, {{0, 1}}}, {"F", KeyType::WRITE, {{0, 1}}}},
+                                  {{"COPY", "F", "E"}, {"COPY", "E", "F"}}, {}, MakeMachineId(0, 2));
+
+  SendTransactions({txn1, txn2});
+  delete txn1;
+  delete txn2;
+
+  auto output_txn1 = ReceiveMultipleAndMerge(1, 2);
+  ASSERT_EQ(output_txn1.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn1, "B").new_value(), "valueC");
+  ASSERT_EQ(TxnValueEntry(output_txn1, "C").new_value(), "valueB");
+
+  auto output_txn2 = ReceiveMultipleAndMerge(2, 2);
+  ASSERT_EQ(output_txn2.status(), TransactionStatus::COMMITTED);
+  ASSERT_EQ(TxnValueEntry(output_txn2, "E").new_value(), "valueF");
+  ASSERT_EQ(TxnValueEntry(output_txn2, "F").new_value(), "valueE");
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   google::InstallFailureSignalHandler();
@@ -0,0 +1,59 @@
+#include "storage/bulk_loader.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "storage/mem_only_storage.h"
+#include "storage/ordered_storage.h"
+
+using namespace slog;
+
+TEST(BulkLoaderTest, LoadFromMultipleThreads) {
+  MemOnlyStorage storage;
+  BulkLoader loader(storage, 16 * kBulkLoadGroups);
+  const int kNumThreads = 4;
+  const int kRecordsPerThread = 1050;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&loader, t] {
+      BulkLoader::Buffer buffer;
+      for (int i = t * kRecordsPerThread; i < (t + 1) * kRecordsPerThread; i++) {
+        loader.Add(buffer, std::to_string(i), Record("value" + std::to_string(i), i % 3));
+      }
+      loader.Flush(buffer);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(loader.num_loaded(), static_cast<uint64_t>(kNumThreads * kRecordsPerThread));
+  for (int i = 0; i < kNumThreads * kRecordsPerThread; i++) {
+    Record record;
+    ASSERT_TRUE(storage.Read(std::to_string(i), record));
+    ASSERT_EQ(record.to_string(), "value" + std::to_string(i));
+    Metadata metadata;
+    ASSERT_TRUE(storage.GetMasterMetadata(std::to_string(i), metadata));
+    ASSERT_EQ(metadata.master, static_cast<uint32_t>(i % 3));
+  }
+}
+
+TEST(BulkLoaderTest, LoadSingleGroupStorage) {
+  // The ordered storage puts every key in the same bulk-load group
+  OrderedStorage storage;
+  BulkLoader loader(storage, kBulkLoadGroups);
+  BulkLoader::Buffer buffer;
+  for (int i = 0; i < 10; i++) {
+    loader.Add(buffer, std::to_string(i), Record("value" + std::to_string(i)));
+    // Each group holds a single record so it is loaded right away
+    ASSERT_EQ(loader.num_loaded(), static_cast<uint64_t>(i + 1));
+  }
+  loader.Flush(buffer);
+  ASSERT_EQ(loader.num_loaded(), 10U);
+  for (int i = 0; i < 10; i++) {
+    Record record;
+    ASSERT_TRUE(storage.Read(std::to_string(i), record));
+    ASSERT_EQ(record.to_string(), "value" + std::to_string(i));
+  }
+}
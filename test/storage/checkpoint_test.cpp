@@ -0,0 +1,88 @@
+#include "storage/checkpoint.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "storage/flat_storage.h"
+#include "storage/mem_only_storage.h"
+
+using namespace slog;
+
+class CheckpointTest : public ::testing::Test {
+ protected:
+  void SetUp() { path = ::testing::TempDir() + "checkpoint_test_" + std::to_string(getpid()) + ".ckpt"; }
+
+  void TearDown() { unlink(path.c_str()); }
+
+  std::string path;
+  CheckpointFingerprint fingerprint{2, 1, 0, 12345};
+};
+
+TEST_F(CheckpointTest, WriteAndLoad) {
+  MemOnlyStorage storage;
+  // Enough records to span multiple chunks, with both inline and out-of-line values
+  const int kNumRecords = 200000;
+  for (int i = 0; i < kNumRecords; i++) {
+    std::string value(i % 100, 'a' + i % 26);
+    storage.Write(std::to_string(i), Record(value, i % 3, i % 7));
+  }
+  ASSERT_TRUE(WriteCheckpoint(storage, fingerprint, path));
+
+  FlatStorage loaded;
+  ASSERT_TRUE(LoadCheckpoint(loaded, fingerprint, path, 4));
+  for (int i = 0; i < kNumRecords; i++) {
+    Record record;
+    ASSERT_TRUE(loaded.Read(std::to_string(i), record)) << "Failed at i = " << i;
+    ASSERT_EQ(record.to_string(), std::string(i % 100, 'a' + i % 26));
+    ASSERT_EQ(record.metadata().master, static_cast<uint32_t>(i % 3));
+    ASSERT_EQ(record.metadata().counter, static_cast<uint32_t>(i % 7));
+
+    Metadata metadata;
+    ASSERT_TRUE(loaded.GetMasterMetadata(std::to_string(i), metadata));
+    ASSERT_EQ(metadata.master, static_cast<uint32_t>(i % 3));
+  }
+}
+
+TEST_F(CheckpointTest, EmptyStorage) {
+  MemOnlyStorage storage;
+  ASSERT_TRUE(WriteCheckpoint(storage, fingerprint, path));
+  MemOnlyStorage loaded;
+  ASSERT_TRUE(LoadCheckpoint(loaded, fingerprint, path, 2));
+}
+
+TEST_F(CheckpointTest, RejectMalformedFile) {
+  MemOnlyStorage storage;
+  for (int i = 0; i < 1000; i++) {
+    storage.Write(std::to_string(i), Record("value"));
+  }
+  ASSERT_TRUE(WriteCheckpoint(storage, fingerprint, path));
+
+  // Truncate the chunk index
+  ASSERT_EQ(truncate(path.c_str(), 1000), 0);
+  MemOnlyStorage loaded;
+  ASSERT_FALSE(LoadCheckpoint(loaded, fingerprint, path, 2));
+
+  std::ofstream(path) << "not a checkpoint file, definitely not";
+  ASSERT_FALSE(LoadCheckpoint(loaded, fingerprint, path, 2));
+
+  ASSERT_FALSE(LoadCheckpoint(loaded, fingerprint, path + ".missing", 2));
+}
+
+TEST_F(CheckpointTest, RejectOtherFingerprint) {
+  MemOnlyStorage storage;
+  storage.Write("A", Record("value"));
+  ASSERT_TRUE(WriteCheckpoint(storage, fingerprint, path));
+
+  MemOnlyStorage loaded;
+  ASSERT_FALSE(LoadCheckpoint(loaded, {2, 0, 0, 12345}, path, 2));
+  ASSERT_FALSE(LoadCheckpoint(loaded, {3, 1, 0, 12345}, path, 2));
+  ASSERT_FALSE(LoadCheckpoint(loaded, {2, 1, 1, 12345}, path, 2));
+  ASSERT_FALSE(LoadCheckpoint(loaded, {2, 1, 0, 54321}, path, 2));
+  Record record;
+  ASSERT_FALSE(loaded.Read("A", record));
+
+  ASSERT_TRUE(LoadCheckpoint(loaded, fingerprint, path, 2));
+  ASSERT_TRUE(loaded.Read("A", record));
+}
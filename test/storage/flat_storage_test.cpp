@@ -0,0 +1,44 @@
+#include "storage/flat_storage.h"
+
+#include <gtest/gtest.h>
+
+#include "common/types.h"
+
+using namespace slog;
+
+TEST(FlatStorageTest, ReadWriteTest) {
+  FlatStorage storage;
+  Key key = "key1";
+  Value value = "value1";
+  Record record(value, 0);
+  ASSERT_FALSE(storage.Write(key, record));
+
+  Record ret;
+  bool ok = storage.Read(key, ret);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(value, ret.to_string());
+}
+
+TEST(FlatStorageTest, UpdateAndDelete) {
+  FlatStorage storage;
+  ASSERT_FALSE(storage.Write("key1", Record("value1", 1, 2)));
+  ASSERT_TRUE(storage.Write("key1", Record("value2", 3, 4)));
+
+  Record ret;
+  ASSERT_TRUE(storage.Read("key1", ret));
+  ASSERT_EQ(ret.to_string(), "value2");
+
+  Metadata metadata;
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 3U);
+  ASSERT_EQ(metadata.counter, 4U);
+
+  std::string value;
+  ASSERT_TRUE(storage.ReadView("key1", [&value](std::string_view v, const Metadata&) { value = v; }));
+  ASSERT_EQ(value, "value2");
+
+  ASSERT_TRUE(storage.Delete("key1"));
+  ASSERT_FALSE(storage.Read("key1", ret));
+  ASSERT_FALSE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_FALSE(storage.Delete("key1"));
+}
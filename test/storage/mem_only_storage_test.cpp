@@ -17,4 +17,137 @@ TEST(MemOnlyStorageTest, ReadWriteTest) {
   bool ok = storage.Read(key, ret);
   ASSERT_TRUE(ok);
   ASSERT_EQ(value, ret.to_string());
-}
\ No newline at end of file
+}
+
+TEST(MemOnlyStorageTest, ReadViewTest) {
+  MemOnlyStorage storage;
+  storage.Write("key1", Record("value1", 2, 3));
+
+  std::string value;
+  Metadata metadata;
+  ASSERT_TRUE(storage.ReadView("key1", [&](std::string_view v, const Metadata& m) {
+    value = v;
+    metadata = m;
+  }));
+  ASSERT_EQ(value, "value1");
+  ASSERT_EQ(metadata.master, 2U);
+  ASSERT_EQ(metadata.counter, 3U);
+
+  ASSERT_FALSE(storage.ReadView("key2", [](std::string_view, const Metadata&) { FAIL(); }));
+
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 2U);
+  ASSERT_FALSE(storage.GetMasterMetadata("key2", metadata));
+}
+
+TEST(MemOnlyStorageTest, MasterMetadataFollowsWrites) {
+  MemOnlyStorage storage;
+  Metadata metadata;
+  ASSERT_FALSE(storage.GetMasterMetadata("key1", metadata));
+
+  storage.Write("key1", Record("value1", 0, 0));
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 0U);
+  ASSERT_EQ(metadata.counter, 0U);
+
+  // Value-only update
+  storage.Write("key1", Record("value2", 0, 0));
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 0U);
+
+  // Remaster
+  storage.Write("key1", Record("value2", 1, 1));
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 1U);
+  ASSERT_EQ(metadata.counter, 1U);
+
+  storage.Delete("key1");
+  ASSERT_FALSE(storage.GetMasterMetadata("key1", metadata));
+}
+
+TEST(MemOnlyStorageTest, MasterMetadataIsPerKey) {
+  MemOnlyStorage storage;
+  for (int i = 0; i < 1000; i++) {
+    storage.Write(std::to_string(i), Record("value", 0, 0));
+  }
+
+  // Remastering or deleting a key does not affect the entries of the other keys
+  for (int i = 0; i < 1000; i += 2) {
+    storage.Write(std::to_string(i), Record("value", 1, 1));
+    storage.Delete(std::to_string(i + 1));
+  }
+  for (int i = 0; i < 1000; i++) {
+    Metadata metadata;
+    if (i % 2 == 0) {
+      ASSERT_TRUE(storage.GetMasterMetadata(std::to_string(i), metadata));
+      ASSERT_EQ(metadata.master, 1U);
+    } else {
+      ASSERT_FALSE(storage.GetMasterMetadata(std::to_string(i), metadata));
+    }
+  }
+}
+
+TEST(MemOnlyStorageTest, MultiReadTest) {
+  MemOnlyStorage storage;
+  storage.Write("key1", Record("value1", 1, 0));
+  storage.Write("key3", Record("value3", 3, 0));
+
+  std::vector<Key> keys{"key1", "key2", "key3"};
+  std::vector<const Key*> key_ptrs{&keys[0], &keys[1], &keys[2]};
+  std::vector<std::string> values(keys.size());
+  std::vector<uint32_t> masters(keys.size(), 0);
+  storage.MultiRead(key_ptrs, [&](size_t i, std::string_view v, const Metadata& m) {
+    values[i] = v;
+    masters[i] = m.master;
+  });
+  ASSERT_EQ(values, (std::vector<std::string>{"value1", "", "value3"}));
+  ASSERT_EQ(masters, (std::vector<uint32_t>{1, 0, 3}));
+}
+
+TEST(MemOnlyStorageTest, BulkLoadTest) {
+  MemOnlyStorage storage;
+  std::vector<std::pair<Key, Record>> records;
+  for (int i = 0; i < 1000; i++) {
+    records.emplace_back(std::to_string(i), Record("value" + std::to_string(i), i % 3, i % 5));
+  }
+  storage.Reserve(records.size());
+  storage.BulkLoad(std::move(records), 3);
+
+  for (int i = 0; i < 1000; i++) {
+    Record record;
+    ASSERT_TRUE(storage.Read(std::to_string(i), record));
+    ASSERT_EQ(record.to_string(), "value" + std::to_string(i));
+    Metadata metadata;
+    ASSERT_TRUE(storage.GetMasterMetadata(std::to_string(i), metadata));
+    ASSERT_EQ(metadata.master, static_cast<uint32_t>(i % 3));
+    ASSERT_EQ(metadata.counter, static_cast<uint32_t>(i % 5));
+  }
+}
+
+TEST(MemOnlyStorageTest, StatsTest) {
+  MemOnlyStorage storage;
+  for (int i = 0; i < 100; i++) {
+    storage.Write(std::to_string(i), Record(std::string(100, 'x')));
+  }
+  Record record;
+  for (int i = 0; i < 10; i++) {
+    storage.Read(std::to_string(i), record);
+  }
+  Metadata metadata;
+  storage.GetMasterMetadata("0", metadata);
+
+  StorageStats stats;
+  ASSERT_TRUE(storage.GetStats(stats));
+  // Lookups and updates of the master metadata index are not counted
+  ASSERT_EQ(stats.num_reads, 10U);
+  ASSERT_EQ(stats.num_writes, 100U);
+  size_t num_nodes = 0;
+  size_t bytes = 0;
+  for (const auto& segment : stats.segments) {
+    num_nodes += segment.num_nodes;
+    bytes += segment.bytes;
+  }
+  // One node for the record and one for its master metadata
+  ASSERT_EQ(num_nodes, 200U);
+  ASSERT_GE(bytes, 100U * 100);
+}
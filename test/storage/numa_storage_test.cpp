@@ -0,0 +1,79 @@
+#include "storage/numa_storage.h"
+
+#include <gtest/gtest.h>
+
+#include "common/types.h"
+
+using namespace slog;
+
+namespace {
+// Two nodes sharing the only CPU that is sure to exist
+NumaTopology TwoNodes() { return NumaTopology({{0}, {0}}); }
+}  // namespace
+
+TEST(NumaStorageTest, KeysAreSplitOverNodes) {
+  NumaStorage storage(TwoNodes());
+  const int kNumRecords = 1000;
+  std::vector<int> keys_of_node(2);
+  for (int i = 0; i < kNumRecords; i++) {
+    auto key = std::to_string(i);
+    ASSERT_FALSE(storage.Write(key, Record("value" + key, i % 3)));
+    keys_of_node[storage.NodeOf(key)]++;
+  }
+  ASSERT_GT(keys_of_node[0], kNumRecords / 4);
+  ASSERT_GT(keys_of_node[1], kNumRecords / 4);
+
+  for (int i = 0; i < kNumRecords; i++) {
+    auto key = std::to_string(i);
+    Record record;
+    ASSERT_TRUE(storage.Read(key, record));
+    ASSERT_EQ(record.to_string(), "value" + key);
+    Metadata metadata;
+    ASSERT_TRUE(storage.GetMasterMetadata(key, metadata));
+    ASSERT_EQ(metadata.master, static_cast<uint32_t>(i % 3));
+  }
+
+  ASSERT_TRUE(storage.Delete("0"));
+  Record record;
+  ASSERT_FALSE(storage.Read("0", record));
+}
+
+TEST(NumaStorageTest, MultiReadAcrossNodes) {
+  NumaStorage storage(TwoNodes());
+  std::vector<Key> keys;
+  for (int i = 0; i < 20; i++) {
+    keys.push_back(std::to_string(i));
+    if (i % 5 != 0) {
+      storage.Write(keys.back(), Record("value" + keys.back()));
+    }
+  }
+  std::vector<const Key*> key_ptrs;
+  for (const auto& key : keys) {
+    key_ptrs.push_back(&key);
+  }
+
+  std::vector<std::string> values(keys.size());
+  storage.MultiRead(key_ptrs, [&](size_t i, std::string_view value, const Metadata&) { values[i] = value; });
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(values[i], i % 5 != 0 ? "value" + keys[i] : "");
+  }
+}
+
+TEST(NumaStorageTest, BulkLoad) {
+  NumaStorage storage(TwoNodes());
+  const int kNumRecords = 10000;
+  std::vector<std::pair<Key, Record>> records;
+  for (int i = 0; i < kNumRecords; i++) {
+    records.emplace_back(std::to_string(i), Record(std::to_string(i), 1));
+  }
+  storage.Reserve(kNumRecords);
+  storage.BulkLoad(std::move(records), 4);
+
+  int num_records = 0;
+  storage.ForEach([&](const Key& key, std::string_view value, const Metadata& metadata) {
+    ASSERT_EQ(value, key);
+    ASSERT_EQ(metadata.master, 1U);
+    num_records++;
+  });
+  ASSERT_EQ(num_records, kNumRecords);
+}
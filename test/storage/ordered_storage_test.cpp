@@ -0,0 +1,48 @@
+#include "storage/ordered_storage.h"
+
+#include <gtest/gtest.h>
+
+#include "common/types.h"
+#include "storage/mem_only_storage.h"
+
+using namespace slog;
+
+TEST(OrderedStorageTest, UpdateAndDelete) {
+  OrderedStorage storage;
+  ASSERT_FALSE(storage.Write("key1", Record("value1", 1, 2)));
+  ASSERT_TRUE(storage.Write("key1", Record("value2", 3, 4)));
+
+  Record ret;
+  ASSERT_TRUE(storage.Read("key1", ret));
+  ASSERT_EQ(ret.to_string(), "value2");
+
+  Metadata metadata;
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 3U);
+  ASSERT_EQ(metadata.counter, 4U);
+
+  ASSERT_TRUE(storage.Delete("key1"));
+  ASSERT_FALSE(storage.Read("key1", ret));
+  ASSERT_FALSE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_FALSE(storage.Delete("key1"));
+}
+
+TEST(OrderedStorageTest, Scan) {
+  OrderedStorage storage;
+  for (auto key : {"b2", "a1", "b1", "c1", "b3"}) {
+    storage.Write(key, Record(std::string("value_") + key, 1));
+  }
+  storage.Delete("b2");
+
+  std::vector<std::string> keys;
+  ASSERT_TRUE(storage.Scan("b", "c", [&keys](const Key& key, std::string_view value, const Metadata& metadata) {
+    ASSERT_EQ(value, "value_" + key);
+    ASSERT_EQ(metadata.master, 1U);
+    keys.push_back(key);
+  }));
+  ASSERT_EQ(keys, (std::vector<std::string>{"b1", "b3"}));
+
+  // Hash-based storages cannot scan
+  MemOnlyStorage mem_only_storage;
+  ASSERT_FALSE(mem_only_storage.Scan("b", "c", [](const Key&, std::string_view, const Metadata&) {}));
+}
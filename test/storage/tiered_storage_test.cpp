@@ -0,0 +1,177 @@
+#include "storage/tiered_storage.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <thread>
+
+using namespace slog;
+using namespace std::chrono;
+
+namespace {
+// Each shard holds about 10 records of 100 bytes
+const size_t kMemoryBudget = 64 * 1000;
+
+std::string ValueOf(int key, int round = 0) {
+  auto value = std::to_string(key) + "_" + std::to_string(round);
+  value.resize(100, 'x');
+  return value;
+}
+}  // namespace
+
+class TieredStorageTest : public ::testing::Test {
+ protected:
+  void SetUp() { path = ::testing::TempDir() + "tiered_storage_test_" + std::to_string(getpid()); }
+
+  std::string path;
+};
+
+TEST_F(TieredStorageTest, EvictAndFaultIn) {
+  TieredStorage storage(path, kMemoryBudget);
+  const int kNumRecords = 2000;
+  for (int i = 0; i < kNumRecords; i++) {
+    ASSERT_FALSE(storage.Write(std::to_string(i), Record(ValueOf(i), i % 3, i)));
+  }
+  ASSERT_GT(storage.num_evictions(), 0U);
+  ASSERT_LE(storage.bytes_in_memory(), kMemoryBudget);
+  // The file is removed right away
+  ASSERT_NE(access(path.c_str(), F_OK), 0);
+
+  for (int i = 0; i < kNumRecords; i++) {
+    Record record;
+    ASSERT_TRUE(storage.Read(std::to_string(i), record));
+    ASSERT_EQ(record.to_string(), ValueOf(i));
+    ASSERT_EQ(record.metadata().master, static_cast<uint32_t>(i % 3));
+    ASSERT_EQ(record.metadata().counter, static_cast<uint32_t>(i));
+  }
+  ASSERT_GT(storage.num_faults(), 0U);
+  ASSERT_LE(storage.bytes_in_memory(), kMemoryBudget);
+
+  // The index keeps the metadata of the evicted records
+  Metadata metadata;
+  ASSERT_TRUE(storage.GetMasterMetadata("0", metadata));
+  ASSERT_EQ(metadata.master, 0U);
+  ASSERT_FALSE(storage.GetMasterMetadata("nonexistent", metadata));
+}
+
+TEST_F(TieredStorageTest, ExistingFileIsLeftAlone) {
+  std::ofstream(path) << "existing";
+  {
+    TieredStorage storage(path, kMemoryBudget);
+    for (int i = 0; i < 2000; i++) {
+      storage.Write(std::to_string(i), Record(ValueOf(i)));
+    }
+    ASSERT_GT(storage.num_evictions(), 0U);
+  }
+  std::string content;
+  std::ifstream(path) >> content;
+  ASSERT_EQ(content, "existing");
+  unlink(path.c_str());
+}
+
+TEST_F(TieredStorageTest, OverwriteAndDeleteEvictedRecords) {
+  TieredStorage storage(path, kMemoryBudget);
+  const int kNumRecords = 2000;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < kNumRecords; i++) {
+      ASSERT_EQ(storage.Write(std::to_string(i), Record(ValueOf(i, round))), round > 0);
+    }
+  }
+  for (int i = 0; i < kNumRecords; i += 2) {
+    ASSERT_TRUE(storage.Delete(std::to_string(i)));
+  }
+  ASSERT_FALSE(storage.Delete("0"));
+
+  for (int i = 0; i < kNumRecords; i++) {
+    Record record;
+    if (i % 2 == 0) {
+      ASSERT_FALSE(storage.Read(std::to_string(i), record));
+    } else {
+      ASSERT_TRUE(storage.Read(std::to_string(i), record));
+      ASSERT_EQ(record.to_string(), ValueOf(i, 2));
+    }
+  }
+}
+
+TEST_F(TieredStorageTest, ForEachReadsEvictedRecords) {
+  TieredStorage storage(path, kMemoryBudget);
+  const int kNumRecords = 2000;
+  for (int i = 0; i < kNumRecords; i++) {
+    storage.Write(std::to_string(i), Record(ValueOf(i)));
+  }
+  auto num_evictions = storage.num_evictions();
+
+  std::vector<bool> seen(kNumRecords);
+  storage.ForEach([&seen](const Key& key, std::string_view value, const Metadata&) {
+    auto i = std::stoi(key);
+    ASSERT_EQ(value, ValueOf(i));
+    seen[i] = true;
+  });
+  ASSERT_EQ(std::count(seen.begin(), seen.end(), true), kNumRecords);
+  // Nothing is loaded back into memory
+  ASSERT_EQ(storage.num_faults(), 0U);
+  ASSERT_EQ(storage.num_evictions(), num_evictions);
+}
+
+TEST_F(TieredStorageTest, Prefetch) {
+  TieredStorage storage(path, kMemoryBudget);
+  const int kNumRecords = 2000;
+  std::vector<Key> keys;
+  for (int i = 0; i < kNumRecords; i++) {
+    keys.push_back(std::to_string(i));
+    storage.Write(keys.back(), Record(ValueOf(i)));
+  }
+
+  // Only the evicted records are prefetched
+  auto num_evicted = storage.num_evictions();
+  std::vector<const Key*> key_ptrs;
+  for (const auto& key : keys) {
+    key_ptrs.push_back(&key);
+  }
+  storage.Prefetch(key_ptrs);
+  auto deadline = steady_clock::now() + seconds(10);
+  while (storage.num_prefetched() < num_evicted && steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  ASSERT_EQ(storage.num_prefetched(), num_evicted);
+  ASSERT_EQ(storage.num_faults(), 0U);
+}
+
+TEST_F(TieredStorageTest, ConcurrentReadsAndWrites) {
+  TieredStorage storage(path, kMemoryBudget, 2);
+  const int kNumRecords = 2000;
+  for (int i = 0; i < kNumRecords; i++) {
+    storage.Write(std::to_string(i), Record(ValueOf(i)));
+  }
+
+  // Values always start with their key so that readers can check them while writers overwrite them
+  auto Run = [&](int seed, bool write) {
+    std::mt19937 rg(seed);
+    std::uniform_int_distribution<int> dist(0, kNumRecords - 1);
+    for (int n = 0; n < 5000; n++) {
+      auto i = dist(rg);
+      auto key = std::to_string(i);
+      if (write) {
+        storage.Write(key, Record(ValueOf(i, n)));
+      } else if (n % 10 == 0) {
+        storage.Prefetch({&key});
+      } else {
+        Record record;
+        ASSERT_TRUE(storage.Read(key, record));
+        ASSERT_EQ(record.to_string().substr(0, key.size() + 1), key + "_");
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back(Run, t, t % 2 == 0);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_LE(storage.bytes_in_memory(), kMemoryBudget);
+}
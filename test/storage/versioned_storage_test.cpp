@@ -0,0 +1,137 @@
+#include "storage/versioned_storage.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "common/types.h"
+
+using namespace slog;
+using namespace std::chrono;
+
+namespace {
+std::string ReadAt(const VersionedStorage& storage, const Key& key, int64_t version) {
+  std::string value = "<none>";
+  storage.ReadViewAt(key, version, [&value](std::string_view v, const Metadata&) { value = v; });
+  return value;
+}
+}  // namespace
+
+TEST(VersionedStorageTest, ReadLatestVersion) {
+  VersionedStorage storage(milliseconds(0));
+  ASSERT_FALSE(storage.Write("key1", Record("value1", 1, 2)));
+  ASSERT_TRUE(storage.Write("key1", Record("value2", 1, 2), 5));
+
+  Record record;
+  ASSERT_TRUE(storage.Read("key1", record));
+  ASSERT_EQ(record.to_string(), "value2");
+
+  Metadata metadata;
+  ASSERT_TRUE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_EQ(metadata.master, 1U);
+  ASSERT_EQ(metadata.counter, 2U);
+
+  ASSERT_TRUE(storage.Delete("key1", 6));
+  ASSERT_FALSE(storage.Read("key1", record));
+  ASSERT_FALSE(storage.GetMasterMetadata("key1", metadata));
+  ASSERT_FALSE(storage.Delete("key1", 7));
+}
+
+TEST(VersionedStorageTest, ReadOlderVersions) {
+  VersionedStorage storage(milliseconds(0));
+  storage.Write("key1", Record("v0"));
+  storage.Write("key1", Record("v10"), 10);
+  storage.Write("key2", Record("v20"), 20);
+  storage.Delete("key1", 30);
+
+  ASSERT_EQ(ReadAt(storage, "key1", 0), "v0");
+  ASSERT_EQ(ReadAt(storage, "key1", 9), "v0");
+  ASSERT_EQ(ReadAt(storage, "key1", 10), "v10");
+  ASSERT_EQ(ReadAt(storage, "key1", 29), "v10");
+  ASSERT_EQ(ReadAt(storage, "key1", 30), "<none>");
+  // key2 did not exist before version 20
+  ASSERT_EQ(ReadAt(storage, "key2", 19), "<none>");
+  ASSERT_EQ(ReadAt(storage, "key2", 20), "v20");
+}
+
+TEST(VersionedStorageTest, SnapshotAtAppliedVersion) {
+  VersionedStorage storage(milliseconds(0));
+  storage.Write("key1", Record("v1"), 1);
+  storage.SetAppliedVersion(1);
+  VersionedStorage::Snapshot snapshot(storage);
+  ASSERT_EQ(snapshot.version(), 1);
+
+  // Writes after the applied version are invisible to the snapshot
+  storage.Write("key1", Record("v2"), 2);
+  storage.SetAppliedVersion(2);
+  std::string value;
+  ASSERT_TRUE(snapshot.ReadView("key1", [&value](std::string_view v, const Metadata&) { value = v; }));
+  ASSERT_EQ(value, "v1");
+  ASSERT_EQ(VersionedStorage::Snapshot(storage).version(), 2);
+}
+
+TEST(VersionedStorageTest, CollectGarbage) {
+  VersionedStorage storage(milliseconds(0));
+  for (int v = 1; v <= 5; v++) {
+    storage.Write("key1", Record("v" + std::to_string(v)), v);
+  }
+  storage.Write("key2", Record("v1"), 1);
+  storage.Delete("key2", 2);
+  storage.SetAppliedVersion(3);
+
+  {
+    // The snapshot at version 3 keeps v3 alive even after the applied version moves on
+    VersionedStorage::Snapshot snapshot(storage);
+    storage.SetAppliedVersion(5);
+    // v1 and v2 of key1 and both versions of key2
+    ASSERT_EQ(storage.CollectGarbage(), 4U);
+    ASSERT_EQ(ReadAt(storage, "key1", 3), "v3");
+    ASSERT_EQ(ReadAt(storage, "key1", 2), "<none>");
+    ASSERT_EQ(ReadAt(storage, "key2", 1), "<none>");
+  }
+
+  // v3 and v4 of key1
+  ASSERT_EQ(storage.CollectGarbage(), 2U);
+  ASSERT_EQ(ReadAt(storage, "key1", 5), "v5");
+  ASSERT_EQ(ReadAt(storage, "key1", 4), "<none>");
+  ASSERT_EQ(storage.CollectGarbage(), 0U);
+
+  // Nothing is left of key2 so it does not show up when iterating over the storage
+  int num_records = 0;
+  storage.ForEach([&num_records](const Key&, std::string_view, const Metadata&) { num_records++; });
+  ASSERT_EQ(num_records, 1);
+}
+
+TEST(VersionedStorageTest, SnapshotReadsDuringWritesAndGC) {
+  VersionedStorage storage(milliseconds(1));
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    storage.Write(std::to_string(i), Record("0"));
+  }
+
+  // Each version writes its number to all keys so a consistent snapshot sees the same value everywhere
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    for (int v = 1; v <= 2000; v++) {
+      for (int i = 0; i < kNumKeys; i++) {
+        storage.Write(std::to_string(i), Record(std::to_string(v)), v);
+      }
+      storage.SetAppliedVersion(v);
+    }
+    done = true;
+  });
+
+  int num_snapshots = 0;
+  while (!done) {
+    VersionedStorage::Snapshot snapshot(storage);
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string value;
+      ASSERT_TRUE(snapshot.ReadView(std::to_string(i), [&value](std::string_view v, const Metadata&) { value = v; }));
+      ASSERT_EQ(value, std::to_string(snapshot.version()));
+    }
+    num_snapshots++;
+  }
+  writer.join();
+  ASSERT_GT(num_snapshots, 0);
+}
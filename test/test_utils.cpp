@@ -121,9 +121,17 @@ ValueEntry TxnValueEntry(const Transaction& txn, const std::string& key) {
 TestSlog::TestSlog(const ConfigurationPtr& config)
     : config_(config),
       sharder_(Sharder::MakeSharder(config)),
-      storage_(new MemOnlyStorage()),
       broker_(Broker::New(config, kTestModuleTimeout)),
       client_context_(1) {
+  if (config->storage_type() == internal::StorageType::VERSIONED) {
+    versioned_storage_ = std::make_shared<VersionedStorage>();
+    storage_ = versioned_storage_;
+    lookup_master_index_ = versioned_storage_;
+  } else {
+    auto mem_only_storage = std::make_shared<MemOnlyStorage>();
+    storage_ = mem_only_storage;
+    lookup_master_index_ = mem_only_storage;
+  }
   client_context_.set(zmq::ctxopt::blocky, false);
   client_socket_ = zmq::socket_t(client_context_, ZMQ_DEALER);
 }
@@ -134,12 +142,14 @@ void TestSlog::Data(Key&& key, Record&& record) {
   storage_->Write(key, record);
 }
 
-void TestSlog::AddServerAndClient() { server_ = MakeRunnerFor<Server>(broker_, nullptr, kTestModuleTimeout); }
+void TestSlog::AddServerAndClient() {
+  server_ = MakeRunnerFor<Server>(broker_, versioned_storage_, nullptr, kTestModuleTimeout);
+}
 
 void TestSlog::AddForwarder() {
   metadata_initializer_ = std::make_shared<ConstantMetadataInitializer>(0);
-  forwarder_ = MakeRunnerFor<Forwarder>(broker_->context(), broker_->config(), storage_, metadata_initializer_, nullptr,
-                                        kTestModuleTimeout);
+  forwarder_ = MakeRunnerFor<Forwarder>(broker_->context(), broker_->config(), lookup_master_index_,
+                                        metadata_initializer_, nullptr, kTestModuleTimeout);
 }
 
 void TestSlog::AddSequencer() {
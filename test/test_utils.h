@@ -15,6 +15,7 @@
 #include "proto/internal.pb.h"
 #include "storage/mem_only_storage.h"
 #include "storage/metadata_initializer.h"
+#include "storage/versioned_storage.h"
 
 using std::pair;
 using std::shared_ptr;
@@ -75,7 +76,10 @@ class TestSlog {
  private:
   ConfigurationPtr config_;
   SharderPtr sharder_;
-  shared_ptr<MemOnlyStorage> storage_;
+  shared_ptr<Storage> storage_;
+  shared_ptr<LookupMasterIndex> lookup_master_index_;
+  // Only set if the storage type in the config is VERSIONED
+  shared_ptr<VersionedStorage> versioned_storage_;
   shared_ptr<MetadataInitializer> metadata_initializer_;
   shared_ptr<Broker> broker_;
   ModuleRunnerPtr server_;
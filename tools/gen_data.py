@@ -10,6 +10,7 @@ import logging
 import numpy as np
 import os
 import string
+import struct
 import time
 
 import google.protobuf.text_format as text_format
@@ -37,6 +38,13 @@ KEY_SIZE = 12   # 8 bytes + overhead from base64 encoding
 MASTER_SIZE = 2
 FILE_EXTENSION = '.dat'
 
+# Chunked data file format. See common/offline_data_reader.h for the layout
+DATA_MAGIC = b'SLOGDATA'
+DATA_VERSION = 1
+DATUMS_PER_CHUNK = 64 * 1024
+HEADER_FORMAT = '<8sIIQQ'
+CHUNK_INFO_FORMAT = '<QQQ'
+
 logging.basicConfig(
     level=logging.INFO,
     format='%(asctime)s - %(process)d - %(levelname)s: %(message)s'
@@ -84,7 +92,12 @@ class DataGenerator:
         encoded = encode_key(key)
         return fnv_hash(encoded, self.partition_bytes) % self.num_partitions
 
-    def gen_data(self, partition: int, as_text: bool) -> None:
+    def gen_data(
+        self,
+        partition: int,
+        as_text: bool,
+        legacy_format: bool = False,
+    ) -> None:
         if partition >= self.num_partitions:
             raise IndexError(
                 "Partition number cannot be larger than or equal to "
@@ -116,6 +129,7 @@ class DataGenerator:
         func = partial(
             DataGenerator.gen_data_per_partition,
             as_text=as_text,
+            legacy_format=legacy_format,
             obj=self,
         )
         with Pool(num_jobs) as pool:
@@ -129,19 +143,21 @@ class DataGenerator:
         partition: int,
         keys: list,
         as_text: bool,
+        legacy_format: bool,
         obj: object,
     ):
         """
         Wrapper for the class method __gen_data_per_partition so that it can be
         used in multiprocessing.
         """
-        obj.__gen_data_per_partition(partition, keys, as_text)
+        obj.__gen_data_per_partition(partition, keys, as_text, legacy_format)
 
     def __gen_data_per_partition(
         self,
         partition: int,
         keys: list,
         as_text: bool,
+        legacy_format: bool,
     ) -> None:
         # Set per-partition seed so that partitions have 
         # different data. Keys and master are not randomly
@@ -156,17 +172,28 @@ class DataGenerator:
         mode = 'w' if as_text else 'wb'
         part_file = open(file_name, mode)
 
+        chunked = not as_text and not legacy_format
         # Write number of keys in this partition
         if as_text:
             part_file.write(str(len(keys)) + "\n")
+        elif chunked:
+            # The header is rewritten with the final counts at the end
+            part_file.write(struct.pack(HEADER_FORMAT, bytes(8), 0, 0, 0, 0))
         else:
             part_file.write(_VarintBytes(len(keys)))
 
+        # Offset, size, and number of datums of each chunk
+        chunks = []
         last_time = time.time()
         last_index = 0
         for i, key in enumerate(keys):
             # Generate the datum for this key
             datum = self.__gen_datum(key, as_text)
+            if chunked:
+                if i % DATUMS_PER_CHUNK == 0:
+                    chunks.append([part_file.tell(), 0, 0])
+                chunks[-1][1] += len(datum)
+                chunks[-1][2] += 1
             # Append the datum to file
             part_file.write(datum)
 
@@ -183,6 +210,20 @@ class DataGenerator:
                 last_time = now
                 last_index = i
 
+        if chunked:
+            index_offset = part_file.tell()
+            for chunk in chunks:
+                part_file.write(struct.pack(CHUNK_INFO_FORMAT, *chunk))
+            part_file.seek(0)
+            part_file.write(struct.pack(
+                HEADER_FORMAT,
+                DATA_MAGIC,
+                DATA_VERSION,
+                len(chunks),
+                len(keys),
+                index_offset,
+            ))
+
         part_file.close()
 
     def __gen_datum(self, key: int, as_text=False):
@@ -291,6 +332,12 @@ if __name__ == "__main__":
         action='store_true',
         help="Generate data as human-readable text files"
     )
+    parser.add_argument(
+        "--legacy-format",
+        action='store_true',
+        help="Generate data in the original format that is read sequentially "
+             "instead of the chunked format that can be loaded in parallel"
+    )
     add_exported_gen_data_arguments(parser)
 
     args = parser.parse_args()
@@ -319,4 +366,5 @@ if __name__ == "__main__":
     ).gen_data(
         partition=args.partition,
         as_text=args.as_text,
+        legacy_format=args.legacy_format,
     )
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "workload/basic.h"
 
-#include <fcntl.h>
 #include <glog/logging.h>
 
 #include <algorithm>
@@ -122,20 +121,15 @@ BasicWorkload::BasicWorkload(const ConfigurationPtr& config, uint32_t region, co
     // Load and index the initial data from file if simple partitioning is not used
     for (uint32_t partition = 0; partition < num_partitions; partition++) {
       auto data_file = data_dir + "/" + std::to_string(partition) + ".dat";
-      auto fd = open(data_file.c_str(), O_RDONLY);
-      if (fd < 0) {
-        LOG(FATAL) << "Error while loading \"" << data_file << "\": " << strerror(errno);
-      }
-
-      OfflineDataReader reader(fd);
-      LOG(INFO) << "Loading " << reader.GetNumDatums() << " datums from " << data_file;
-      while (reader.HasNextDatum()) {
-        auto datum = reader.GetNextDatum();
+      auto IndexFn = [&](const Datum& datum) {
         CHECK_LT(datum.master(), num_replicas) << "Master number exceeds number of replicas";
 
         partition_to_key_lists_[partition][datum.master()].AddKey(datum.key());
+      };
+      // Use a single thread since the key lists are not thread-safe
+      if (!ReadOfflineData(data_file, 1, IndexFn)) {
+        LOG(FATAL) << "Error while loading \"" << data_file << "\"";
       }
-      close(fd);
     }
   }
 }